@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Background Backend Warm-up Implementation
+ */
+
+#include "backend_warmup.h"
+#include <memory>
+#include <system_error>
+
+namespace oceanbase {
+namespace jni {
+
+BackendWarmup::BackendWarmup()
+    : started_(false), ready_(false), time_to_ready_ms_(-1), stop_requested_(false), result_(0) {
+}
+
+BackendWarmup::~BackendWarmup() {
+    join();
+}
+
+bool BackendWarmup::start(const Task& task, const ReadyCallback& on_ready, const AfterReady& after_ready) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_) {
+        return false;
+    }
+
+    std::shared_ptr<std::promise<int>> promise = std::make_shared<std::promise<int>>();
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    try {
+        thread_ = std::thread([this, task, on_ready, after_ready, promise, start_time]() {
+            int result = task();
+            int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time).count();
+            result_ = result;
+            time_to_ready_ms_.store(elapsed, std::memory_order_release);
+            ready_.store(true, std::memory_order_release);
+            promise->set_value(result);
+            if (on_ready) {
+                on_ready(result, elapsed);
+            }
+            if (result == 0 && after_ready && !stop_requested()) {
+                after_ready();
+            }
+        });
+    } catch (const std::system_error&) {
+        // No thread: the first scan initializes as without warm-up
+        return false;
+    }
+    result_future_ = promise->get_future().share();
+    started_ = true;
+    return true;
+}
+
+bool BackendWarmup::wait(int& result) {
+    // Fast path once warm: no lock, no future
+    if (ready_.load(std::memory_order_acquire)) {
+        result = result_;
+        return true;
+    }
+
+    std::shared_future<int> future;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!started_) {
+            return false;
+        }
+        future = result_future_;
+    }
+    result = future.get();
+    return true;
+}
+
+void BackendWarmup::join() {
+    stop_requested_.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+} // namespace jni
+} // namespace oceanbase
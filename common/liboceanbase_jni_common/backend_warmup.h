@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Background Backend Warm-up
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace oceanbase {
+namespace jni {
+
+/**
+ * Backend Warm-up
+ * @brief Runs a plugin's initialization once on a background thread
+ * @details Without it, the first scan pays for JVM creation, class loading,
+ * dictionary loading and analyzer construction, and concurrent first scans
+ * all queue up behind the JVM creation lock. A plugin starts the warm-up
+ * from its init function; scans arriving before it finishes wait on the
+ * readiness future and share its result instead of initializing in turn.
+ * The time from start() to readiness is kept as a metric. Work that only
+ * makes the backend faster, such as replaying a training corpus, runs as
+ * a later stage on the same thread once the task has succeeded, so scans
+ * do not wait for it; join() asks that stage to stop and waits for it.
+ */
+class BackendWarmup {
+public:
+    /**
+     * Initialization to run, returning an OBP_* code
+     */
+    typedef std::function<int()> Task;
+
+    /**
+     * Called on the background thread when the task has finished, with its
+     * result and the time to ready in milliseconds
+     */
+    typedef std::function<void(int, int64_t)> ReadyCallback;
+
+    /**
+     * Run on the background thread after readiness, if the task succeeded;
+     * long-running work should return early once stop_requested() is set
+     */
+    typedef std::function<void()> AfterReady;
+
+    BackendWarmup();
+
+    /**
+     * Wait for a running warm-up to finish
+     */
+    ~BackendWarmup();
+
+    /**
+     * Start the task on a background thread; only the first call does anything
+     * @param on_ready Optional callback, e.g. to log the time to ready
+     * @param after_ready Optional stage run after readiness, e.g. a training replay
+     * @return true if the warm-up was started by this call
+     */
+    bool start(const Task& task, const ReadyCallback& on_ready = ReadyCallback(),
+               const AfterReady& after_ready = AfterReady());
+
+    /**
+     * Wait for the warm-up, if one was started
+     * @param result Output result of the task
+     * @return true if a warm-up was started, false if there is nothing to wait for
+     */
+    bool wait(int& result);
+
+    /**
+     * Check whether the warm-up has finished
+     */
+    bool is_ready() const { return ready_.load(std::memory_order_acquire); }
+
+    /**
+     * Milliseconds from start() until the task finished, -1 until then
+     */
+    int64_t time_to_ready_ms() const { return time_to_ready_ms_.load(std::memory_order_acquire); }
+
+    /**
+     * Check whether join() has asked the stage after readiness to stop
+     */
+    bool stop_requested() const { return stop_requested_.load(std::memory_order_acquire); }
+
+    /**
+     * Join the background thread, waiting for the task if it still runs and
+     * asking the stage after readiness to stop
+     */
+    void join();
+
+private:
+    std::mutex mutex_;
+    bool started_;
+    std::thread thread_;
+    std::shared_future<int> result_future_;
+    std::atomic<bool> ready_;
+    std::atomic<int64_t> time_to_ready_ms_;
+    std::atomic<bool> stop_requested_;
+    int result_;  // Valid once ready_ is set
+
+    // Disable copy
+    BackendWarmup(const BackendWarmup&) = delete;
+    BackendWarmup& operator=(const BackendWarmup&) = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,39 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Bigram Segmenter Backend Implementation
+ */
+
+#include "bigram_segmenter.h"
+#include "jni_manager.h"
+#include "oceanbase/ob_plugin_ftparser.h"
+
+namespace oceanbase {
+namespace jni {
+
+BigramTokenizer::Options BigramSegmenter::plugin_options(const std::string& plugin_name) {
+    BigramTokenizer::Options options;
+    options.output_unigrams = JNIConfigUtils::get_plugin_flag(plugin_name, "BIGRAM_UNIGRAMS", false);
+    return options;
+}
+
+BigramSegmenter::BigramSegmenter(const std::string& plugin_name)
+    : tokenizer_(plugin_options(plugin_name)) {
+}
+
+int BigramSegmenter::initialize() {
+    return OBP_SUCCESS;
+}
+
+int BigramSegmenter::segment(const char* text, size_t length, PackedTokenBuffer& tokens) {
+    tokens.clear();
+    if (!text || length == 0) {
+        return OBP_SUCCESS;
+    }
+    if (tokenizer_.append_tokens(text, length, tokens) != 0) {
+        return OBP_ALLOCATE_MEMORY_FAILED;
+    }
+    return OBP_SUCCESS;
+}
+
+} // namespace jni
+} // namespace oceanbase
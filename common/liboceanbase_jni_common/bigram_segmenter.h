@@ -0,0 +1,61 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Bigram Segmenter Backend
+ */
+
+#pragma once
+
+#include "bigram_tokenizer.h"
+#include "segmenter_backend.h"
+#include <string>
+
+namespace oceanbase {
+namespace jni {
+
+/**
+ * Bigram Segmenter
+ * @brief The "bigram" backend every plugin registers: BigramTokenizer without a JVM
+ * @details Selected per plugin with OCEANBASE_<PLUGIN>_BACKEND=bigram (for
+ * example OCEANBASE_JAPANESE_FTPARSER_BACKEND=bigram). Needs no dictionary,
+ * no JVM and no JNI call; OCEANBASE_<PLUGIN>_BIGRAM_UNIGRAMS=1 also emits
+ * the single characters of every bigram run, so one-character queries match.
+ */
+class BigramSegmenter : public SegmenterBackend {
+public:
+    /**
+     * @param plugin_name Plugin the backend serves, e.g. "japanese_ftparser"
+     */
+    explicit BigramSegmenter(const std::string& plugin_name);
+
+    /**
+     * Backend name used in OCEANBASE_<PLUGIN>_BACKEND
+     */
+    const char* name() const override { return "bigram"; }
+
+    /**
+     * Nothing to load
+     * @return OBP_SUCCESS
+     */
+    int initialize() override;
+
+    /**
+     * Segment a UTF-8 document into packed tokens
+     * @return OBP_SUCCESS on success, OBP_ALLOCATE_MEMORY_FAILED on allocation failure
+     */
+    int segment(const char* text, size_t length, PackedTokenBuffer& tokens) override;
+
+private:
+    /**
+     * Tokenizer options of a plugin, from OCEANBASE_<PLUGIN>_BIGRAM_*
+     */
+    static BigramTokenizer::Options plugin_options(const std::string& plugin_name);
+
+    BigramTokenizer tokenizer_;
+
+    // Disable copy
+    BigramSegmenter(const BigramSegmenter&) = delete;
+    BigramSegmenter& operator=(const BigramSegmenter&) = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,402 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Bigram Tokenizer Implementation
+ */
+
+#include "bigram_tokenizer.h"
+#include "packed_token_buffer.h"
+#include <cstdint>
+#include <new>
+#include <string>
+
+#if defined(__SSE2__)
+#define OBP_BIGRAM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace oceanbase {
+namespace jni {
+
+namespace {
+
+enum UnitClass {
+    UNIT_SEPARATOR = 0,  // Space, punctuation, symbol or malformed byte
+    UNIT_WORD = 1,       // Letter or digit outside the bigram scripts
+    UNIT_CJK = 2,        // Han, Kana or Hangul
+    UNIT_THAI = 3,       // Thai base character
+    UNIT_MARK = 4        // Combining mark, joins the preceding character
+};
+
+inline bool is_ascii_alnum(unsigned char c) {
+    unsigned char lower = c | 0x20;
+    return (c >= '0' && c <= '9') || (lower >= 'a' && lower <= 'z');
+}
+
+#ifdef OBP_BIGRAM_SSE2
+
+// Bit i is set when byte i is an ASCII letter or digit (bytes >= 0x80 are negative and never match)
+inline unsigned alnum_mask_16(__m128i bytes) {
+    __m128i lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                   _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(bytes, _mm_set1_epi8('9' + 1)));
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(letter, digit)));
+}
+
+#endif // OBP_BIGRAM_SSE2
+
+// Number of leading bytes that are ASCII letters or digits
+size_t ascii_alnum_prefix(const unsigned char* p, size_t n) {
+    size_t i = 0;
+#ifdef OBP_BIGRAM_SSE2
+    for (; i + 16 <= n; i += 16) {
+        unsigned alnum = alnum_mask_16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+        if (alnum != 0xFFFF) {
+            return i + static_cast<size_t>(__builtin_ctz(~alnum));
+        }
+    }
+#endif
+    while (i < n && is_ascii_alnum(p[i])) {
+        i++;
+    }
+    return i;
+}
+
+// Number of leading bytes that are ASCII but not letters or digits
+size_t ascii_separator_prefix(const unsigned char* p, size_t n) {
+    size_t i = 0;
+#ifdef OBP_BIGRAM_SSE2
+    for (; i + 16 <= n; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        unsigned stop = alnum_mask_16(bytes) | static_cast<unsigned>(_mm_movemask_epi8(bytes));
+        if (stop != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(stop));
+        }
+    }
+#endif
+    while (i < n && p[i] < 0x80 && !is_ascii_alnum(p[i])) {
+        i++;
+    }
+    return i;
+}
+
+// Decode one non-ASCII character, return its length in bytes or 0 if malformed
+size_t decode_utf8(const unsigned char* p, size_t n, uint32_t& cp) {
+    unsigned char c = p[0];
+    size_t len = 0;
+    uint32_t min = 0;
+    if (c >= 0xC2 && c <= 0xDF) {
+        len = 2;
+        cp = c & 0x1F;
+        min = 0x80;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        len = 3;
+        cp = c & 0x0F;
+        min = 0x800;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        len = 4;
+        cp = c & 0x07;
+        min = 0x10000;
+    } else {
+        return 0;
+    }
+    if (n < len) {
+        return 0;
+    }
+    for (size_t k = 1; k < len; ++k) {
+        if ((p[k] & 0xC0) != 0x80) {
+            return 0;
+        }
+        cp = (cp << 6) | (p[k] & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        return 0;
+    }
+    return len;
+}
+
+UnitClass classify(uint32_t cp) {
+    if (cp < 0x0300) {
+        // C1 controls, Latin-1 symbols and spaces; ª, µ and º are letters
+        if ((cp <= 0xBF && cp != 0xAA && cp != 0xB5 && cp != 0xBA) || cp == 0xD7 || cp == 0xF7) {
+            return UNIT_SEPARATOR;
+        }
+        return UNIT_WORD;
+    }
+    if (cp <= 0x036F || (cp >= 0x1AB0 && cp <= 0x1AFF) || (cp >= 0x1DC0 && cp <= 0x1DFF) ||
+        (cp >= 0x20D0 && cp <= 0x20FF) || (cp >= 0xFE20 && cp <= 0xFE2F) || cp == 0x3099 || cp == 0x309A) {
+        return UNIT_MARK;
+    }
+    if (cp >= 0x0E00 && cp <= 0x0E7F) {
+        if (cp == 0x0E31 || (cp >= 0x0E34 && cp <= 0x0E3A) || (cp >= 0x0E47 && cp <= 0x0E4E)) {
+            return UNIT_MARK;
+        }
+        if (cp >= 0x0E50 && cp <= 0x0E59) {
+            return UNIT_WORD;  // Thai digits, folded to ASCII
+        }
+        if (cp == 0x0E00 || cp == 0x0E3F || cp == 0x0E4F || cp >= 0x0E5A) {
+            return UNIT_SEPARATOR;  // Baht sign, Thai punctuation, unassigned
+        }
+        return UNIT_THAI;
+    }
+    if ((cp >= 0x1100 && cp <= 0x11FF) || (cp >= 0x3041 && cp <= 0x30FF && cp != 0x30FB) ||
+        (cp >= 0x3130 && cp <= 0x318F) || (cp >= 0x31F0 && cp <= 0x31FF) || (cp >= 0x3400 && cp <= 0x4DBF) ||
+        (cp >= 0x4E00 && cp <= 0x9FFF) || (cp >= 0xA960 && cp <= 0xA97F) || (cp >= 0xAC00 && cp <= 0xD7FF) ||
+        (cp >= 0xF900 && cp <= 0xFAFF) || (cp >= 0xFF66 && cp <= 0xFFDC) || (cp >= 0x20000 && cp <= 0x3134F) ||
+        (cp >= 0x3005 && cp <= 0x3007)) {
+        return UNIT_CJK;
+    }
+    if ((cp >= 0x2000 && cp <= 0x2BFF) || (cp >= 0x3000 && cp <= 0x303F) || cp == 0x30FB ||
+        (cp >= 0xFE30 && cp <= 0xFE6F) || (cp >= 0xFF00 && cp <= 0xFF65) || cp >= 0xFFF0 ||
+        (cp >= 0x1F000 && cp <= 0x1FAFF)) {
+        // Fullwidth letters and digits are words
+        if ((cp >= 0xFF10 && cp <= 0xFF19) || (cp >= 0xFF21 && cp <= 0xFF3A) || (cp >= 0xFF41 && cp <= 0xFF5A)) {
+            return UNIT_WORD;
+        }
+        return UNIT_SEPARATOR;
+    }
+    return UNIT_WORD;
+}
+
+// Lowercase a word character and fold fullwidth and Thai digits to ASCII
+uint32_t fold(uint32_t cp) {
+    if (cp >= 0xFF10 && cp <= 0xFF5A) {
+        cp -= 0xFF10 - 0x30;
+        return (cp >= 'A' && cp <= 'Z') ? cp + 0x20 : cp;
+    }
+    if (cp >= 0x0E50 && cp <= 0x0E59) {
+        return '0' + (cp - 0x0E50);
+    }
+    if ((cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) || (cp >= 0x0391 && cp <= 0x03AB && cp != 0x03A2) ||
+        (cp >= 0x0410 && cp <= 0x042F)) {
+        return cp + 0x20;
+    }
+    if (cp >= 0x0400 && cp <= 0x040F) {
+        return cp + 0x50;
+    }
+    if ((cp >= 0x0100 && cp <= 0x0137) || (cp >= 0x014A && cp <= 0x0177)) {
+        return cp | 1;
+    }
+    if ((cp >= 0x0139 && cp <= 0x0148) || (cp >= 0x0179 && cp <= 0x017E)) {
+        return (cp & 1) ? cp + 1 : cp;
+    }
+    return cp;
+}
+
+void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+/**
+ * Run state of one document: the open word, or the last two units of the
+ * open bigram run (a unit is a base character plus its combining marks)
+ */
+class RunEmitter {
+public:
+    RunEmitter(const BigramTokenizer::Options& options, const char* text, PackedTokenBuffer& tokens)
+        : options_(options), text_(text), tokens_(tokens), run_(UNIT_SEPARATOR),
+          word_chars_(0), prev_unit_start_(0), unit_start_(0), unit_end_(0), units_(0) {
+    }
+
+    // Close the open run
+    int end_run() {
+        int ret = 0;
+        if (run_ == UNIT_WORD) {
+            ret = flush_word();
+        } else if (run_ != UNIT_SEPARATOR) {
+            ret = close_unit();
+            if (ret == 0 && units_ == 1 && !options_.output_unigrams) {
+                ret = emit(unit_start_, unit_end_);
+            }
+        }
+        run_ = UNIT_SEPARATOR;
+        units_ = 0;
+        return ret;
+    }
+
+    // ASCII letters and digits
+    int ascii_word(const unsigned char* p, size_t n) {
+        int ret = start_run(UNIT_WORD);
+        while (ret == 0 && n > 0) {
+            size_t take = options_.max_word_length - word_chars_;
+            take = take < n ? take : n;
+            for (size_t i = 0; i < take; ++i) {
+                unsigned char c = p[i];
+                word_ += static_cast<char>((c >= 'A' && c <= 'Z') ? (c | 0x20) : c);
+            }
+            word_chars_ += take;
+            p += take;
+            n -= take;
+            if (word_chars_ >= options_.max_word_length) {
+                ret = flush_word();
+            }
+        }
+        return ret;
+    }
+
+    // One non-ASCII letter or digit
+    int word_char(uint32_t cp) {
+        int ret = start_run(UNIT_WORD);
+        if (ret == 0) {
+            append_utf8(word_, fold(cp));
+            if (++word_chars_ >= options_.max_word_length) {
+                ret = flush_word();
+            }
+        }
+        return ret;
+    }
+
+    // One character of a bigram script at [start, end)
+    int bigram_char(UnitClass kind, size_t start, size_t end) {
+        int ret = 0;
+        if (run_ != kind) {
+            ret = start_run(kind);
+        } else {
+            ret = close_unit();
+            prev_unit_start_ = unit_start_;
+        }
+        unit_start_ = start;
+        unit_end_ = end;
+        units_++;
+        return ret;
+    }
+
+    // Combining mark at [start, end), stays with the character before it
+    void mark(size_t start, size_t end) {
+        if (run_ == UNIT_WORD) {
+            word_.append(text_ + start, end - start);
+        } else if (run_ != UNIT_SEPARATOR) {
+            unit_end_ = end;
+        }
+    }
+
+private:
+    const BigramTokenizer::Options& options_;
+    const char* text_;
+    PackedTokenBuffer& tokens_;
+    UnitClass run_;
+    std::string word_;
+    size_t word_chars_;
+    size_t prev_unit_start_;
+    size_t unit_start_;
+    size_t unit_end_;
+    size_t units_;
+
+    int start_run(UnitClass kind) {
+        if (run_ == kind) {
+            return 0;
+        }
+        int ret = end_run();
+        run_ = kind;
+        return ret;
+    }
+
+    // The current unit is complete: emit its bigram with the previous unit
+    int close_unit() {
+        int ret = 0;
+        if (options_.output_unigrams) {
+            ret = emit(unit_start_, unit_end_);
+        }
+        if (ret == 0 && units_ >= 2) {
+            ret = emit(prev_unit_start_, unit_end_);
+        }
+        return ret;
+    }
+
+    int flush_word() {
+        int ret = 0;
+        if (!word_.empty()) {
+            ret = tokens_.append(word_.data(), word_.size());
+        }
+        word_.clear();
+        word_chars_ = 0;
+        return ret;
+    }
+
+    int emit(size_t start, size_t end) {
+        return tokens_.append(text_ + start, end - start);
+    }
+};
+
+} // anonymous namespace
+
+BigramTokenizer::BigramTokenizer(const Options& options)
+    : options_(options) {
+    if (options_.max_word_length == 0) {
+        options_.max_word_length = 1;
+    }
+}
+
+int BigramTokenizer::append_tokens(const char* text, size_t length, PackedTokenBuffer& tokens) const {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text);
+    RunEmitter emitter(options_, text, tokens);
+    int ret = 0;
+    size_t pos = 0;
+
+    try {
+        while (ret == 0 && pos < length) {
+            unsigned char c = bytes[pos];
+            if (c < 0x80) {
+                if (is_ascii_alnum(c)) {
+                    size_t n = ascii_alnum_prefix(bytes + pos, length - pos);
+                    ret = emitter.ascii_word(bytes + pos, n);
+                    pos += n;
+                } else {
+                    ret = emitter.end_run();
+                    pos += ascii_separator_prefix(bytes + pos, length - pos);
+                }
+                continue;
+            }
+
+            uint32_t cp = 0;
+            size_t n = decode_utf8(bytes + pos, length - pos, cp);
+            if (n == 0) {
+                ret = emitter.end_run();
+                pos++;
+                continue;
+            }
+            switch (classify(cp)) {
+                case UNIT_WORD:
+                    ret = emitter.word_char(cp);
+                    break;
+                case UNIT_CJK:
+                    ret = emitter.bigram_char(UNIT_CJK, pos, pos + n);
+                    break;
+                case UNIT_THAI:
+                    ret = emitter.bigram_char(UNIT_THAI, pos, pos + n);
+                    break;
+                case UNIT_MARK:
+                    emitter.mark(pos, pos + n);
+                    break;
+                default:
+                    ret = emitter.end_run();
+                    break;
+            }
+            pos += n;
+        }
+        if (ret == 0) {
+            ret = emitter.end_run();
+        }
+    } catch (const std::bad_alloc&) {
+        ret = -1;
+    }
+    return ret;
+}
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Bigram Tokenizer
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace oceanbase {
+namespace jni {
+
+class PackedTokenBuffer;
+
+/**
+ * Bigram Tokenizer
+ * @brief Dictionary-free tokenizer for indexes that favour write speed over precision
+ * @details Follows Lucene's CJKAnalyzer: runs of Han, Kana and Hangul
+ * characters are emitted as overlapping character bigrams (a run of one
+ * character as a unigram), and so are runs of Thai characters, whose
+ * combining vowels and tone marks stay attached to their base character.
+ * Letter and digit runs of every other script are emitted as words,
+ * lowercased, with fullwidth Latin letters and digits and Thai digits
+ * folded to ASCII; words longer than max_word_length characters are split
+ * as StandardTokenizer does. Spaces, punctuation and symbols only separate
+ * tokens; malformed UTF-8 bytes are treated as separators.
+ * ASCII stretches, the bulk of most documents, are classified 16 bytes at
+ * a time with SSE2 where available.
+ */
+class BigramTokenizer {
+public:
+    struct Options {
+        // Also emit every character of a bigram run as a unigram (CJKBigramFilter outputUnigrams)
+        bool output_unigrams;
+        // Longer words are split into pieces of this many characters
+        size_t max_word_length;
+
+        Options() : output_unigrams(false), max_word_length(255) {}
+    };
+
+    explicit BigramTokenizer(const Options& options);
+
+    /**
+     * Append the tokens of a UTF-8 document
+     * @return 0 on success, -1 on allocation failure
+     */
+    int append_tokens(const char* text, size_t length, PackedTokenBuffer& tokens) const;
+
+private:
+    Options options_;
+};
+
+} // namespace jni
+} // namespace oceanbase
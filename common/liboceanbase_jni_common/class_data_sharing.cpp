@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Application Class-Data Sharing Implementation
+ */
+
+#include "class_data_sharing.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <strings.h>
+#include <sys/stat.h>
+
+namespace oceanbase {
+namespace jni {
+
+static const char* const MODE_NAMES[] = {"off", "dump", "use"};
+
+int ClassDataSharing::parse_mode(const char* name, int default_mode) {
+    if (!name) {
+        return default_mode;
+    }
+    for (int mode = JNI_CDS_MODE_OFF; mode <= JNI_CDS_MODE_USE; ++mode) {
+        if (strcasecmp(name, MODE_NAMES[mode]) == 0) {
+            return mode;
+        }
+    }
+    return default_mode;
+}
+
+const char* ClassDataSharing::mode_name(int mode) {
+    if (mode < JNI_CDS_MODE_OFF || mode > JNI_CDS_MODE_USE) {
+        mode = JNI_CDS_MODE_OFF;
+    }
+    return MODE_NAMES[mode];
+}
+
+std::string ClassDataSharing::classpath_stamp(const std::string& classpath) {
+    std::ostringstream stamp;
+    std::istringstream entries(classpath);
+    std::string entry;
+    while (std::getline(entries, entry, ':')) {
+        if (entry.empty()) {
+            continue;
+        }
+        struct stat st;
+        stamp << entry << ' ';
+        if (stat(entry.c_str(), &st) == 0) {
+            stamp << static_cast<long long>(st.st_size) << ' ' << static_cast<long long>(st.st_mtime);
+        } else {
+            stamp << '-';
+        }
+        stamp << '\n';
+    }
+    return stamp.str();
+}
+
+std::string ClassDataSharing::class_list_path(const std::string& archive) {
+    return archive + ".classlist";
+}
+
+std::string ClassDataSharing::stamp_path(const std::string& archive) {
+    return archive + ".stamp";
+}
+
+static bool read_file(const std::string& path, std::string& content) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    content = buffer.str();
+    return true;
+}
+
+int ClassDataSharing::jvm_options(int mode, const std::string& archive, const std::string& classpath,
+                                  std::vector<std::string>& options, std::string& message) {
+    message.clear();
+    if (mode == JNI_CDS_MODE_OFF || archive.empty()) {
+        return 0;
+    }
+
+    if (mode == JNI_CDS_MODE_DUMP) {
+        std::ofstream out(stamp_path(archive).c_str(), std::ios::binary | std::ios::trunc);
+        if (!(out << classpath_stamp(classpath)) || !out.flush()) {
+            message = "cannot write " + stamp_path(archive) + ": " + strerror(errno);
+            return -1;
+        }
+        options.push_back("-XX:DumpLoadedClassList=" + class_list_path(archive));
+        message = "recording loaded classes to " + class_list_path(archive)
+                  + ", build the archive with: java -Xshare:dump -XX:SharedClassListFile="
+                  + class_list_path(archive) + " -XX:SharedArchiveFile=" + archive + " -cp " + classpath;
+        return 0;
+    }
+
+    struct stat st;
+    if (stat(archive.c_str(), &st) != 0) {
+        message = "archive " + archive + " not found, starting without class-data sharing";
+        return 0;
+    }
+    std::string recorded;
+    if (!read_file(stamp_path(archive), recorded) || recorded != classpath_stamp(classpath)) {
+        message = "archive " + archive + " was built for another classpath, starting without class-data sharing";
+        return 0;
+    }
+    // auto: should the JVM still reject the archive, it starts without it
+    options.push_back("-Xshare:auto");
+    options.push_back("-XX:SharedArchiveFile=" + archive);
+    message = "mapping class-data sharing archive " + archive;
+    return 0;
+}
+
+} // namespace jni
+} // namespace oceanbase
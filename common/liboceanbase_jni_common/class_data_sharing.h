@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Application Class-Data Sharing
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace oceanbase {
+namespace jni {
+
+/**
+ * Class-data sharing modes, selected by OCEANBASE_JNI_CDS_MODE
+ */
+enum ClassDataSharingMode {
+    JNI_CDS_MODE_OFF = 0,
+    JNI_CDS_MODE_DUMP = 1,   // Record the classes the segmenters load
+    JNI_CDS_MODE_USE = 2     // Map the archive built from that record
+};
+
+/**
+ * Application Class-Data Sharing
+ * @brief JVM options that dump and map an AppCDS archive of the segmenter classes
+ * @details Without an archive every JVM start parses and verifies the
+ * Lucene and segmenter classes again. In dump mode the JVM writes the
+ * classes it loads to <archive>.classlist (-XX:DumpLoadedClassList), and a
+ * stamp of the classpath (path, size and modification time of each entry)
+ * is written to <archive>.stamp; the archive itself is then built offline
+ * with java -Xshare:dump. In use mode the archive is mapped with
+ * -XX:SharedArchiveFile and -Xshare:auto, but only if it exists and the
+ * classpath still matches the stamp; otherwise the JVM starts without it.
+ */
+class ClassDataSharing {
+public:
+    /**
+     * Parse a mode name (off, dump, use), case-insensitive
+     * @return The mode, or default_mode if name is null or unknown
+     */
+    static int parse_mode(const char* name, int default_mode);
+
+    /**
+     * Get the name of a mode, as understood by parse_mode
+     */
+    static const char* mode_name(int mode);
+
+    /**
+     * Fingerprint a classpath: every entry with its size and modification time
+     * @details Missing entries are part of the stamp, so adding a jar later changes it
+     */
+    static std::string classpath_stamp(const std::string& classpath);
+
+    /**
+     * Get the JVM options of a mode
+     * @param archive Path of the archive, the class list and stamp are kept next to it
+     * @param options Output options (appended), empty when the archive is not used
+     * @param message Output description for the log: the command that builds
+     *        the archive, or why it is not used
+     * @return 0 on success, -1 if the stamp cannot be written in dump mode
+     */
+    static int jvm_options(int mode, const std::string& archive, const std::string& classpath,
+                           std::vector<std::string>& options, std::string& message);
+
+    /**
+     * Get the path of the class list written in dump mode
+     */
+    static std::string class_list_path(const std::string& archive);
+
+    /**
+     * Get the path of the classpath stamp written in dump mode
+     */
+    static std::string stamp_path(const std::string& archive);
+
+private:
+    // Disable construction
+    ClassDataSharing() = delete;
+    ~ClassDataSharing() = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
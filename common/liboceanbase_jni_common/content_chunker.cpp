@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Content-defined Chunker Implementation
+ */
+
+#include "content_chunker.h"
+
+namespace oceanbase {
+namespace jni {
+
+namespace {
+
+// Random 64-bit value per byte: (hash << 1) + GEAR[byte] depends on the last 64 bytes only
+struct GearTable {
+    uint64_t values[256];
+
+    GearTable() {
+        uint64_t state = 0x2545F4914F6CDD1DULL;
+        for (int i = 0; i < 256; ++i) {
+            // splitmix64
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            values[i] = z ^ (z >> 31);
+        }
+    }
+};
+
+const GearTable GEAR;
+
+inline bool is_ascii_space(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// 。｡！？．
+inline bool is_ideographic_terminator(const unsigned char* s) {
+    return (s[0] == 0xE3 && s[1] == 0x80 && s[2] == 0x82) ||
+           (s[0] == 0xEF && s[1] == 0xBD && s[2] == 0xA1) ||
+           (s[0] == 0xEF && s[1] == 0xBC && (s[2] == 0x81 || s[2] == 0x9F || s[2] == 0x8E));
+}
+
+// Ideographic space, Kana (U+3040-U+30FF), Han (U+3400-U+9FFF), Hangul syllables (U+AC00-U+D7A3)
+inline bool starts_new_cjk_sentence(const unsigned char* s, size_t available) {
+    if (available < 3) {
+        return false;
+    }
+    unsigned char b0 = s[0];
+    unsigned char b1 = s[1];
+    if (b0 == 0xE3) {
+        return (b1 == 0x80 && s[2] == 0x80) || (b1 >= 0x81 && b1 <= 0x83) || b1 >= 0x90;
+    }
+    if (b0 >= 0xE4 && b0 <= 0xE9) {
+        return true;
+    }
+    return (b0 == 0xEA && b1 >= 0xB0) || b0 == 0xEB || b0 == 0xEC || (b0 == 0xED && b1 <= 0x9E);
+}
+
+} // anonymous namespace
+
+ContentChunker::ContentChunker(const Options& options) : options_(options) {
+}
+
+bool ContentChunker::is_sentence_boundary(const char* text, size_t length, size_t pos) {
+    if (pos == 0 || pos >= length) {
+        return false;
+    }
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(text);
+    unsigned char prev = s[pos - 1];
+    if (prev == '\n') {
+        return true;
+    }
+    if (prev == '.' || prev == '!' || prev == '?') {
+        return is_ascii_space(s[pos]);
+    }
+    if (pos >= 3 && prev >= 0x80 && is_ideographic_terminator(s + pos - 3)) {
+        return is_ascii_space(s[pos]) || starts_new_cjk_sentence(s + pos, length - pos);
+    }
+    return false;
+}
+
+void ContentChunker::split(const char* text, size_t length, std::vector<TextSpan>& chunks) const {
+    chunks.clear();
+    if (length == 0) {
+        return;
+    }
+
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(text);
+    size_t start = 0;
+    size_t last_boundary = 0;  // Latest boundary past start, or start itself
+    uint64_t hash = 0;
+    for (size_t pos = 1; pos < length; ++pos) {
+        hash = (hash << 1) + GEAR.values[s[pos - 1]];
+        if (!is_sentence_boundary(text, length, pos)) {
+            continue;
+        }
+        if (pos - start > options_.max_chunk_bytes && last_boundary > start) {
+            chunks.push_back(TextSpan(text + start, last_boundary - start));
+            start = last_boundary;
+        }
+        // The high bits mix the most bytes
+        if (pos - start >= options_.min_chunk_bytes && ((hash >> 40) & options_.boundary_mask) == 0) {
+            chunks.push_back(TextSpan(text + start, pos - start));
+            start = pos;
+        }
+        last_boundary = pos;
+    }
+    if (length - start > options_.max_chunk_bytes && last_boundary > start) {
+        chunks.push_back(TextSpan(text + start, last_boundary - start));
+        start = last_boundary;
+    }
+    chunks.push_back(TextSpan(text + start, length - start));
+}
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Content-defined Chunker
+ */
+
+#pragma once
+
+#include "packed_token_buffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace oceanbase {
+namespace jni {
+
+/**
+ * Content Chunker
+ * @brief Cuts long documents into chunks at sentence boundaries chosen by content
+ * @details An UPDATE usually changes one paragraph of a long document. If
+ * the document is cut where its own content says so, the chunks before and
+ * after the edit come out the same as before, and their tokens can be taken
+ * from the segment cache: only the edited chunks need the segmenter.
+ *
+ * Cuts are only made at sentence boundaries the analyzers never carry a
+ * token or any context across: before the whitespace following '.', '!'
+ * or '?', after a line break, and after an ideographic full stop,
+ * exclamation or question mark directly followed by whitespace or a Kana,
+ * Han or Hangul character (not by a closing bracket or another mark). The
+ * tokens of the chunks, one after the other, are then the tokens of the
+ * whole document. Not so for Nori, whose space penalty depends on the
+ * punctuation before the space a chunk starts with: the Korean parser
+ * does not chunk. Among those boundaries a gear rolling hash of the
+ * preceding 64 bytes picks the cut points, so they move with the text
+ * rather than with byte offsets, and an edit only changes the chunks
+ * around it.
+ */
+class ContentChunker {
+public:
+    struct Options {
+        // No hash-chosen cut makes a chunk shorter than this
+        size_t min_chunk_bytes;
+        // A chunk growing past this is cut at its last boundary, if it has one
+        size_t max_chunk_bytes;
+        // A boundary past the minimum is a cut point when (hash & mask) == 0,
+        // 3 cuts at one sentence boundary in four on average
+        uint64_t boundary_mask;
+
+        Options() : min_chunk_bytes(512), max_chunk_bytes(4096), boundary_mask(3) {}
+    };
+
+    explicit ContentChunker(const Options& options);
+
+    /**
+     * Cut a document into chunks
+     * @param chunks Output chunks in document order, views into text (replaced);
+     * a document without a suitable boundary is a single chunk
+     */
+    void split(const char* text, size_t length, std::vector<TextSpan>& chunks) const;
+
+    /**
+     * Check whether a cut before text[pos] is a sentence boundary
+     */
+    static bool is_sentence_boundary(const char* text, size_t length, size_t pos);
+
+    const Options& options() const { return options_; }
+
+private:
+    Options options_;
+};
+
+} // namespace jni
+} // namespace oceanbase
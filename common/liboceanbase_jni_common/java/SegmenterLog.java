@@ -0,0 +1,73 @@
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicLong;
+
+/**
+ * Logging of the Java segmenters, compiled next to each of them
+ *
+ * Level and rate limit are passed by the native side when it creates the
+ * JVM. Every log statement has its own Site, so one statement repeated for
+ * every document cannot hide the others.
+ */
+final class SegmenterLog {
+    static final int ERROR = 0;
+    static final int WARN = 1;
+    static final int INFO = 2;
+    static final int DEBUG = 3;
+    private static final String[] LEVEL_NAMES = {"error", "warn", "info", "debug"};
+    static final int LEVEL = parseLevel(System.getProperty("oceanbase.jni.log.level"));
+    private static final int RATE_LIMIT = Integer.getInteger("oceanbase.jni.log.rate_limit", 10);
+    // Constant for the life of the JVM, so the JIT drops code guarded by it when false
+    static final boolean DEBUG_ENABLED = LEVEL >= DEBUG;
+
+    private final String prefix;
+
+    /**
+     * @param source Name printed in front of every message, e.g. the segmenter class
+     */
+    SegmenterLog(String source) {
+        this.prefix = "[" + source + "][";
+    }
+
+    /**
+     * Rate limit state of one log statement
+     */
+    static final class Site {
+        private final AtomicLong window = new AtomicLong(-1);
+        private final AtomicInteger count = new AtomicInteger();
+        private final AtomicInteger suppressed = new AtomicInteger();
+    }
+
+    static int parseLevel(String name) {
+        for (int level = ERROR; level <= DEBUG; level++) {
+            if (LEVEL_NAMES[level].equalsIgnoreCase(name)) {
+                return level;
+            }
+        }
+        return INFO;
+    }
+
+    /**
+     * Log to stderr if the level is enabled and the call site is within its rate limit
+     */
+    void log(Site site, int level, String message) {
+        if (level > LEVEL) {
+            return;
+        }
+        if (RATE_LIMIT > 0) {
+            long now = System.nanoTime() / 1_000_000_000L;
+            long window = site.window.get();
+            if (window != now && site.window.compareAndSet(window, now)) {
+                site.count.set(0);
+            }
+            if (site.count.getAndIncrement() >= RATE_LIMIT) {
+                site.suppressed.incrementAndGet();
+                return;
+            }
+            int suppressed = site.suppressed.getAndSet(0);
+            if (suppressed > 0) {
+                message += " (" + suppressed + " similar messages suppressed)";
+            }
+        }
+        System.err.println(prefix + LEVEL_NAMES[level].toUpperCase() + "] " + message);
+    }
+}
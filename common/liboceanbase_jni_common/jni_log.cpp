@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Logging Implementation
+ */
+
+#include "jni_log.h"
+#include "jni_manager.h"
+#include <chrono>
+#include <strings.h>
+
+namespace oceanbase {
+namespace jni {
+
+namespace {
+
+const char* const LEVEL_NAMES[] = {"error", "warn", "info", "debug"};
+
+} // anonymous namespace
+
+bool JNILog::enabled(int level) {
+    return level <= JNIConfigUtils::get_config().log_level;
+}
+
+bool JNILog::acquire(JNILogSite& site, int& suppressed) {
+    suppressed = 0;
+    int limit = JNIConfigUtils::get_config().log_rate_limit;
+    if (limit <= 0) {
+        return true;
+    }
+    
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t window = site.window.load(std::memory_order_relaxed);
+    if (window != now && site.window.compare_exchange_strong(window, now, std::memory_order_relaxed)) {
+        // First message of a new second: reset the budget
+        site.count.store(0, std::memory_order_relaxed);
+    }
+    
+    if (site.count.fetch_add(1, std::memory_order_relaxed) >= limit) {
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+int JNILog::parse_level(const char* name, int default_level) {
+    if (!name) {
+        return default_level;
+    }
+    for (int level = JNI_LOG_LEVEL_ERROR; level <= JNI_LOG_LEVEL_DEBUG; ++level) {
+        if (strcasecmp(name, LEVEL_NAMES[level]) == 0) {
+            return level;
+        }
+    }
+    return default_level;
+}
+
+const char* JNILog::level_name(int level) {
+    if (level < JNI_LOG_LEVEL_ERROR) {
+        level = JNI_LOG_LEVEL_ERROR;
+    } else if (level > JNI_LOG_LEVEL_DEBUG) {
+        level = JNI_LOG_LEVEL_DEBUG;
+    }
+    return LEVEL_NAMES[level];
+}
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Logging
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Use OceanBase plugin logging framework
+#include "oceanbase/ob_plugin_log.h"
+
+namespace oceanbase {
+namespace jni {
+
+/**
+ * Log levels, most severe first
+ * @details The same names are passed to the Java segmenters through
+ * -Doceanbase.jni.log.level when the JVM is created
+ */
+enum JNILogLevel {
+    JNI_LOG_LEVEL_ERROR = 0,
+    JNI_LOG_LEVEL_WARN = 1,
+    JNI_LOG_LEVEL_INFO = 2,
+    JNI_LOG_LEVEL_DEBUG = 3
+};
+
+/**
+ * Rate limit state of one log statement
+ * @details Declared static at each call site by the JNI_LOG_* macros;
+ * zero-initialized, so it needs no constructor
+ */
+struct JNILogSite {
+    std::atomic<int64_t> window;
+    std::atomic<int> count;
+    std::atomic<int> suppressed;
+};
+
+/**
+ * JNI Logging
+ * @brief Level filter and per-call-site rate limit in front of the OBP_LOG_* macros
+ * @details Level and rate come from OCEANBASE_JNI_LOG_LEVEL and
+ * OCEANBASE_JNI_LOG_RATE_LIMIT through the configuration snapshot. A call
+ * site that logs more than the rate limit per second drops the extra
+ * messages and reports how many it dropped with its next message.
+ */
+class JNILog {
+public:
+    /**
+     * Check whether messages of a level are logged
+     */
+    static bool enabled(int level);
+    
+    /**
+     * Take one message from a call site's budget for the current second
+     * @param site Call site state
+     * @param suppressed Set to the number of messages dropped since the last one logged
+     * @return true if the message should be logged
+     */
+    static bool acquire(JNILogSite& site, int& suppressed);
+    
+    /**
+     * Parse a level name (error, warn, info, debug)
+     * @return The level, or default_level for null or unknown names
+     */
+    static int parse_level(const char* name, int default_level);
+    
+    /**
+     * Get the name of a level, as understood by parse_level
+     */
+    static const char* level_name(int level);
+
+private:
+    // Disable construction
+    JNILog() = delete;
+    ~JNILog() = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
+
+#define JNI_LOG_AT(level, obp_log, prefix, fmt, ...) \
+    do { \
+        if (::oceanbase::jni::JNILog::enabled(level)) { \
+            static ::oceanbase::jni::JNILogSite jni_log_site_; \
+            int jni_log_suppressed_ = 0; \
+            if (::oceanbase::jni::JNILog::acquire(jni_log_site_, jni_log_suppressed_)) { \
+                if (jni_log_suppressed_ > 0) { \
+                    obp_log(prefix "%d similar messages suppressed", jni_log_suppressed_); \
+                } \
+                obp_log(prefix fmt, ##__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+// ERROR level is not provided by OceanBase, it is logged as a tagged warning
+#define JNI_LOG_ERROR(fmt, ...) \
+    JNI_LOG_AT(::oceanbase::jni::JNI_LOG_LEVEL_ERROR, OBP_LOG_WARN, "[ERROR][JNI] ", fmt, ##__VA_ARGS__)
+#define JNI_LOG_WARN(fmt, ...) \
+    JNI_LOG_AT(::oceanbase::jni::JNI_LOG_LEVEL_WARN, OBP_LOG_WARN, "[JNI] ", fmt, ##__VA_ARGS__)
+#define JNI_LOG_INFO(fmt, ...) \
+    JNI_LOG_AT(::oceanbase::jni::JNI_LOG_LEVEL_INFO, OBP_LOG_INFO, "[JNI] ", fmt, ##__VA_ARGS__)
+
+// Debug logs are compiled out unless built with -DOCEANBASE_JNI_DEBUG_LOG=ON
+#ifdef OCEANBASE_JNI_DEBUG_LOG
+#define JNI_LOG_DEBUG(fmt, ...) \
+    JNI_LOG_AT(::oceanbase::jni::JNI_LOG_LEVEL_DEBUG, OBP_LOG_TRACE, "[JNI] ", fmt, ##__VA_ARGS__)
+#else
+#define JNI_LOG_DEBUG(fmt, ...) do { } while (0)
+#endif
@@ -4,26 +4,60 @@
  */
 
 #include "jni_manager.h"
+#include "class_data_sharing.h"
+#include "jni_log.h"
+#include "jvm_options.h"
+#include "segment_cache.h"
 #include <iostream>
 #include <sstream>
+#include <cctype>
 #include <cstring>
+#include <strings.h>
 #include <dirent.h>
 #include <algorithm>
 
-// Use OceanBase plugin logging framework
-#include "oceanbase/ob_plugin_log.h"
-
-// Define ERROR level logging since it's not provided by OceanBase
-#define OBP_LOG_ERROR(fmt, ...) \
-    do { \
-        printf("[ERROR][JNI_COMMON] " fmt "\n", ##__VA_ARGS__); \
-        fflush(stdout); \
-    } while(0)
-
 namespace oceanbase {
 namespace jni {
 
+// JNIConfig implementation
+JNIConfig::JNIConfig()
+    : classpath(JNIConfigUtils::get_unified_classpath())
+    , max_heap_mb(JNIConfigUtils::get_unified_max_heap_mb())
+    , init_heap_mb(JNIConfigUtils::get_unified_init_heap_mb())
+    , direct_buffer_input(JNIConfigUtils::get_unified_direct_buffer_input())
+    , packed_token_output(JNIConfigUtils::get_unified_packed_token_output())
+    , reject_invalid_utf8(JNIConfigUtils::get_unified_reject_invalid_utf8())
+    , aggregate_tokens(JNIConfigUtils::get_unified_aggregate_tokens())
+    , native_ascii_runs(JNIConfigUtils::get_unified_native_ascii_runs())
+    , max_batch_bytes(JNIConfigUtils::get_unified_max_batch_bytes())
+    , streaming_threshold(JNIConfigUtils::get_unified_streaming_threshold())
+    , streaming_chunk_bytes(JNIConfigUtils::get_unified_streaming_chunk_bytes())
+    , log_level(JNIConfigUtils::get_unified_log_level())
+    , log_rate_limit(JNIConfigUtils::get_unified_log_rate_limit())
+    , segment_cache_bytes(JNIConfigUtils::get_unified_segment_cache_bytes())
+    , segment_cache_max_doc_bytes(JNIConfigUtils::get_unified_segment_cache_max_doc_bytes())
+    , chunk_cache(JNIConfigUtils::get_unified_chunk_cache())
+    , warmup(JNIConfigUtils::get_unified_warmup())
+    , warmup_corpus(JNIConfigUtils::get_unified_warmup_corpus())
+    , warmup_documents(JNIConfigUtils::get_unified_warmup_documents())
+    , persistent_cache_dir(JNIConfigUtils::get_unified_persistent_cache_dir())
+    , persistent_cache_bytes(JNIConfigUtils::get_unified_persistent_cache_bytes())
+    , cds_mode(JNIConfigUtils::get_unified_cds_mode())
+    , cds_archive(JNIConfigUtils::get_unified_cds_archive())
+    , jvm_profile(JNIConfigUtils::get_unified_jvm_profile())
+    , jvm_extra_opts(JNIConfigUtils::get_unified_jvm_extra_opts())
+    , pool(JNIConfigUtils::get_unified_pool())
+    , pool_threads(JNIConfigUtils::get_unified_pool_threads())
+    , pool_inline_bytes(JNIConfigUtils::get_unified_pool_inline_bytes()) {
+}
+
 // JNIConfigUtils implementation
+const JNIConfig& JNIConfigUtils::get_config() {
+    // Thread-safe one-time initialization, a plain read afterwards
+    static const JNIConfig config;
+    return config;
+}
+
 std::string JNIConfigUtils::build_dynamic_classpath(const std::string& base_dir) {
     std::string lib_dir = base_dir + "/lib";
     std::vector<std::string> jar_files;
@@ -100,9 +134,194 @@ size_t JNIConfigUtils::get_unified_init_heap_mb() {
     return 128;  // Unified default: 128MB
 }
 
+bool JNIConfigUtils::get_unified_direct_buffer_input() {
+    return get_env_flag("OCEANBASE_JNI_DIRECT_BUFFER_INPUT", true);
+}
+
+bool JNIConfigUtils::get_unified_packed_token_output() {
+    return get_env_flag("OCEANBASE_JNI_PACKED_TOKEN_OUTPUT", true);
+}
+
+bool JNIConfigUtils::get_unified_reject_invalid_utf8() {
+    return get_env_flag("OCEANBASE_JNI_REJECT_INVALID_UTF8", false);
+}
+
+bool JNIConfigUtils::get_unified_aggregate_tokens() {
+    return get_env_flag("OCEANBASE_JNI_AGGREGATE_TOKENS", false);
+}
+
+bool JNIConfigUtils::get_unified_native_ascii_runs() {
+    return get_env_flag("OCEANBASE_JNI_NATIVE_ASCII_RUNS", false);
+}
+
+size_t JNIConfigUtils::get_unified_max_batch_bytes() {
+    const char* env_batch_bytes = std::getenv("OCEANBASE_JNI_MAX_BATCH_BYTES");
+    if (env_batch_bytes && strlen(env_batch_bytes) > 0) {
+        return static_cast<size_t>(std::atoll(env_batch_bytes));
+    }
+    return 4 * 1024 * 1024;  // Unified default: 4MB
+}
+
+size_t JNIConfigUtils::get_unified_streaming_threshold() {
+    const char* env_threshold = std::getenv("OCEANBASE_JNI_STREAMING_THRESHOLD");
+    if (env_threshold && strlen(env_threshold) > 0) {
+        return static_cast<size_t>(std::atoll(env_threshold));
+    }
+    return 1024 * 1024;  // Unified default: 1MB
+}
+
+size_t JNIConfigUtils::get_unified_streaming_chunk_bytes() {
+    const char* env_chunk_bytes = std::getenv("OCEANBASE_JNI_STREAMING_CHUNK_BYTES");
+    if (env_chunk_bytes && strlen(env_chunk_bytes) > 0) {
+        size_t chunk_bytes = static_cast<size_t>(std::atoll(env_chunk_bytes));
+        if (chunk_bytes > 0) {
+            return chunk_bytes;
+        }
+    }
+    return 64 * 1024;  // Unified default: 64KB
+}
+
+int JNIConfigUtils::get_unified_log_level() {
+    return JNILog::parse_level(std::getenv("OCEANBASE_JNI_LOG_LEVEL"), JNI_LOG_LEVEL_INFO);  // Unified default: info
+}
+
+int JNIConfigUtils::get_unified_log_rate_limit() {
+    const char* env_rate_limit = std::getenv("OCEANBASE_JNI_LOG_RATE_LIMIT");
+    if (env_rate_limit && strlen(env_rate_limit) > 0) {
+        return std::atoi(env_rate_limit);
+    }
+    return 10;  // Unified default: 10 messages per second per call site
+}
+
+size_t JNIConfigUtils::get_unified_segment_cache_bytes() {
+    return SegmentCache::configured_capacity_bytes();
+}
+
+size_t JNIConfigUtils::get_unified_segment_cache_max_doc_bytes() {
+    return SegmentCache::configured_max_document_bytes();
+}
+
+bool JNIConfigUtils::get_unified_chunk_cache() {
+    return get_env_flag("OCEANBASE_JNI_CHUNK_CACHE", false);
+}
+
+bool JNIConfigUtils::get_unified_warmup() {
+    return get_env_flag("OCEANBASE_JNI_WARMUP", false);
+}
+
+std::string JNIConfigUtils::get_unified_warmup_corpus() {
+    const char* env_corpus = std::getenv("OCEANBASE_JNI_WARMUP_CORPUS");
+    if (env_corpus && strlen(env_corpus) > 0) {
+        return std::string(env_corpus);
+    }
+    return "";  // Unified default: the plugin's bundled sentences
+}
+
+size_t JNIConfigUtils::get_unified_warmup_documents() {
+    const char* env_documents = std::getenv("OCEANBASE_JNI_WARMUP_DOCUMENTS");
+    if (env_documents && strlen(env_documents) > 0) {
+        return static_cast<size_t>(std::atoll(env_documents));
+    }
+    return 50000;  // Unified default: enough for C2 to compile the analysis chain
+}
+
+std::string JNIConfigUtils::get_unified_persistent_cache_dir() {
+    const char* env_cache_dir = std::getenv("OCEANBASE_JNI_PERSISTENT_CACHE_DIR");
+    if (env_cache_dir && strlen(env_cache_dir) > 0) {
+        return std::string(env_cache_dir);
+    }
+    return "";  // Unified default: disabled
+}
+
+size_t JNIConfigUtils::get_unified_persistent_cache_bytes() {
+    const char* env_cache_bytes = std::getenv("OCEANBASE_JNI_PERSISTENT_CACHE_BYTES");
+    if (env_cache_bytes && strlen(env_cache_bytes) > 0) {
+        return static_cast<size_t>(std::atoll(env_cache_bytes));
+    }
+    return static_cast<size_t>(1024) * 1024 * 1024;  // Unified default: 1GB per plugin
+}
+
+int JNIConfigUtils::get_unified_cds_mode() {
+    return ClassDataSharing::parse_mode(std::getenv("OCEANBASE_JNI_CDS_MODE"), JNI_CDS_MODE_OFF);  // Unified default: off
+}
+
+std::string JNIConfigUtils::get_unified_cds_archive() {
+    const char* env_archive = std::getenv("OCEANBASE_JNI_CDS_ARCHIVE");
+    if (env_archive && strlen(env_archive) > 0) {
+        return std::string(env_archive);
+    }
+    return "";  // Unified default: disabled
+}
+
+int JNIConfigUtils::get_unified_jvm_profile() {
+    return JVMOptions::parse_profile(std::getenv("OCEANBASE_JNI_JVM_PROFILE"), JNI_JVM_PROFILE_DEFAULT);  // Unified default: G1
+}
+
+std::string JNIConfigUtils::get_unified_jvm_extra_opts() {
+    const char* env_extra_opts = std::getenv("OCEANBASE_JNI_EXTRA_OPTS");
+    if (env_extra_opts && strlen(env_extra_opts) > 0) {
+        return std::string(env_extra_opts);
+    }
+    return "";  // Unified default: none
+}
+
+bool JNIConfigUtils::get_unified_pool() {
+    return get_env_flag("OCEANBASE_JNI_POOL", false);
+}
+
+size_t JNIConfigUtils::get_unified_pool_threads() {
+    const char* env_threads = std::getenv("OCEANBASE_JNI_POOL_THREADS");
+    if (env_threads && strlen(env_threads) > 0) {
+        return static_cast<size_t>(std::atoll(env_threads));
+    }
+    return 0;  // Unified default: one per core
+}
+
+size_t JNIConfigUtils::get_unified_pool_inline_bytes() {
+    const char* env_inline_bytes = std::getenv("OCEANBASE_JNI_POOL_INLINE_BYTES");
+    if (env_inline_bytes && strlen(env_inline_bytes) > 0) {
+        return static_cast<size_t>(std::atoll(env_inline_bytes));
+    }
+    return 0;  // Unified default: every document goes to the pool, scan threads never attach
+}
+
+// OCEANBASE_<PLUGIN>_<OPTION>, e.g. OCEANBASE_THAI_FTPARSER_BACKEND
+static std::string plugin_env_name(const std::string& plugin_name, const char* option) {
+    std::string env_name = "OCEANBASE_";
+    for (char c : plugin_name) {
+        env_name += static_cast<char>(toupper(static_cast<unsigned char>(c)));
+    }
+    env_name += "_";
+    env_name += option;
+    return env_name;
+}
+
+std::string JNIConfigUtils::get_plugin_backend(const std::string& plugin_name) {
+    std::string env_name = plugin_env_name(plugin_name, "BACKEND");
+    
+    const char* env_backend = std::getenv(env_name.c_str());
+    if (env_backend && strlen(env_backend) > 0) {
+        return std::string(env_backend);
+    }
+    return "jvm";  // Unified default: Java segmenter through JNI
+}
+
+bool JNIConfigUtils::get_plugin_flag(const std::string& plugin_name, const char* option, bool default_value) {
+    return get_env_flag(plugin_env_name(plugin_name, option).c_str(), default_value);
+}
+
+bool JNIConfigUtils::get_env_flag(const char* name, bool default_value) {
+    const char* value = std::getenv(name);
+    if (!value || strlen(value) == 0) {
+        return default_value;
+    }
+    return !(strcmp(value, "0") == 0 || strcasecmp(value, "false") == 0 || strcasecmp(value, "off") == 0);
+}
+
 // GlobalJVMManager static members
 std::mutex GlobalJVMManager::global_mutex_;
 JavaVM* GlobalJVMManager::shared_jvm_ = nullptr;
+std::atomic<JavaVM*> GlobalJVMManager::published_jvm_{nullptr};
 std::atomic<int> GlobalJVMManager::plugin_count_{0};
 bool GlobalJVMManager::jvm_created_by_us_ = false;
 std::unordered_set<std::string> GlobalJVMManager::registered_plugins_;
@@ -113,11 +332,39 @@ bool GlobalJVMManager::config_recorded_ = false;
 
 // GlobalThreadManager static members
 std::mutex GlobalThreadManager::thread_mutex_;
-std::unordered_map<std::thread::id, int> GlobalThreadManager::global_thread_ref_count_;
+std::unordered_map<std::thread::id, std::atomic<int>*> GlobalThreadManager::global_thread_ref_count_;
 std::unordered_set<std::thread::id> GlobalThreadManager::attached_threads_;
 // TODO: thread_plugin_map_ is currently not utilized, kept for future debugging/monitoring needs
 // std::unordered_map<std::thread::id, std::unordered_set<std::string>> GlobalThreadManager::thread_plugin_map_;
 
+// Create a JVM from option strings, which only need to live during the call
+static jint create_java_vm(JavaVM** jvm, const std::vector<std::string>& option_strings) {
+    std::vector<JavaVMOption> options(option_strings.size());
+    for (size_t i = 0; i < option_strings.size(); ++i) {
+        options[i].optionString = const_cast<char*>(option_strings[i].c_str());
+    }
+    
+    JavaVMInitArgs vm_args;
+    vm_args.version = JNI_VERSION_1_8;
+    vm_args.nOptions = static_cast<jint>(options.size());
+    vm_args.options = options.data();
+    vm_args.ignoreUnrecognized = JNI_FALSE;
+    
+    JNIEnv* env = nullptr;
+    return JNI_CreateJavaVM(jvm, (void**)&env, &vm_args);
+}
+
+static std::string join_options(const std::vector<std::string>& options) {
+    std::string joined;
+    for (const std::string& option : options) {
+        if (!joined.empty()) {
+            joined += ' ';
+        }
+        joined += option;
+    }
+    return joined;
+}
+
 JavaVM* GlobalJVMManager::get_or_create_jvm(const std::string& classpath, 
                                            size_t max_heap_mb, 
                                            size_t init_heap_mb) {
@@ -128,7 +375,7 @@ JavaVM* GlobalJVMManager::get_or_create_jvm(const std::string& classpath,
     
     // If JVM already exists, return it
     if (shared_jvm_) {
-        OBP_LOG_INFO("Using existing global JVM instance");
+        JNI_LOG_DEBUG("Using existing global JVM instance");
         return shared_jvm_;
     }
     
@@ -138,55 +385,80 @@ JavaVM* GlobalJVMManager::get_or_create_jvm(const std::string& classpath,
     
     if (result == JNI_OK && jvm_count > 0) {
         // Found existing JVM
-        OBP_LOG_INFO("Found existing JVM in process, reusing it");
+        JNI_LOG_INFO("Found existing JVM in process, reusing it");
         jvm_created_by_us_ = false;
+        published_jvm_.store(shared_jvm_, std::memory_order_release);
         return shared_jvm_;
     }
     
     // Create new JVM
-    OBP_LOG_INFO("Creating new JVM with classpath: %s", classpath.c_str());
-    
-    JavaVMInitArgs vm_args;
-    JavaVMOption options[5];
-    
-    // Create persistent copies of option strings to avoid dangling pointers
-    static std::string classpath_option = "-Djava.class.path=" + classpath;
-    static std::string max_heap_option = "-Xmx" + std::to_string(max_heap_mb) + "m";
-    static std::string init_heap_option = "-Xms" + std::to_string(init_heap_mb) + "m";
-    
-    options[0].optionString = const_cast<char*>(classpath_option.c_str());
-    options[1].optionString = const_cast<char*>(max_heap_option.c_str());
-    options[2].optionString = const_cast<char*>(init_heap_option.c_str());
-    options[3].optionString = const_cast<char*>("-XX:+UseG1GC");
-    options[4].optionString = const_cast<char*>("-Dfile.encoding=UTF-8");
-    
-    vm_args.version = JNI_VERSION_1_8;
-    vm_args.nOptions = 5;
-    vm_args.options = options;
-    vm_args.ignoreUnrecognized = JNI_FALSE;
-    
-    JNIEnv* env = nullptr;
-    result = JNI_CreateJavaVM(&shared_jvm_, (void**)&env, &vm_args);
+    JNI_LOG_INFO("Creating new JVM with classpath: %s", classpath.c_str());
+    
+    // Base options, profile, then the extra options, which may override the profile
+    const JNIConfig& config = JNIConfigUtils::get_config();
+    std::vector<std::string> extra_options;
+    JVMOptions::split_extra_options(config.jvm_extra_opts, extra_options);
+    std::vector<std::string> option_strings;
+    JVMOptions::build(classpath, max_heap_mb, init_heap_mb, JNILog::level_name(config.log_level),
+                      config.log_rate_limit, config.jvm_profile, extra_options, option_strings);
+    
+    // Class-data sharing archive of the segmenter classes, if configured
+    std::vector<std::string> cds_options;
+    std::string cds_message;
+    if (ClassDataSharing::jvm_options(config.cds_mode, config.cds_archive, classpath,
+                                      cds_options, cds_message) != 0) {
+        JNI_LOG_WARN("Class-data sharing %s skipped: %s", ClassDataSharing::mode_name(config.cds_mode),
+                     cds_message.c_str());
+    } else if (!cds_message.empty()) {
+        JNI_LOG_INFO("Class-data sharing %s: %s", ClassDataSharing::mode_name(config.cds_mode),
+                     cds_message.c_str());
+    }
+    std::vector<std::string> cds_option_strings = option_strings;
+    cds_option_strings.insert(cds_option_strings.end() - extra_options.size(), cds_options.begin(), cds_options.end());
+    
+    JNI_LOG_INFO("JVM profile '%s', options: %s", JVMOptions::profile_name(config.jvm_profile),
+                 join_options(cds_option_strings).c_str());
+    result = create_java_vm(&shared_jvm_, cds_option_strings);
+    
+    if (result != JNI_OK && !cds_options.empty()) {
+        // A JVM without AppCDS rejects the options while parsing them, before
+        // anything is created, so it can be created again without them
+        JNI_LOG_WARN("Failed to create JVM with class-data sharing (error %d), retrying without it", result);
+        shared_jvm_ = nullptr;
+        result = create_java_vm(&shared_jvm_, option_strings);
+    }
     
     if (result == JNI_OK) {
         jvm_created_by_us_ = true;
-        OBP_LOG_INFO("JVM created successfully");
+        JNI_LOG_INFO("JVM created successfully");
+        published_jvm_.store(shared_jvm_, std::memory_order_release);
         return shared_jvm_;
     } else {
-        OBP_LOG_ERROR("Failed to create JVM, error code: %d", result);
+        JNI_LOG_ERROR("Failed to create JVM, error code: %d", result);
         shared_jvm_ = nullptr;
         return nullptr;
     }
 }
 
+JavaVM* GlobalJVMManager::get_or_create_default_jvm() {
+    // Fast path: the JVM exists, nothing to resolve or validate
+    JavaVM* jvm = published_jvm_.load(std::memory_order_acquire);
+    if (jvm) {
+        return jvm;
+    }
+    
+    const JNIConfig& config = JNIConfigUtils::get_config();
+    return get_or_create_jvm(config.classpath, config.max_heap_mb, config.init_heap_mb);
+}
+
 void GlobalJVMManager::register_plugin(const std::string& plugin_name) {
     std::lock_guard<std::mutex> lock(global_mutex_);
     
     if (registered_plugins_.insert(plugin_name).second) {
         int count = ++plugin_count_;
-        OBP_LOG_INFO("Plugin '%s' registered, total count: %d", plugin_name.c_str(), count);
+        JNI_LOG_INFO("Plugin '%s' registered, total count: %d", plugin_name.c_str(), count);
     } else {
-        OBP_LOG_WARN("Plugin '%s' already registered", plugin_name.c_str());
+        JNI_LOG_WARN("Plugin '%s' already registered", plugin_name.c_str());
     }
 }
 
@@ -195,13 +467,13 @@ void GlobalJVMManager::unregister_plugin(const std::string& plugin_name) {
     
     if (registered_plugins_.erase(plugin_name) > 0) {
         int count = --plugin_count_;
-        OBP_LOG_INFO("Plugin '%s' unregistered, remaining count: %d", plugin_name.c_str(), count);
+        JNI_LOG_INFO("Plugin '%s' unregistered, remaining count: %d", plugin_name.c_str(), count);
         
         if (count == 0) {
-            OBP_LOG_INFO("Last plugin unregistered, keeping JVM alive for stability");
+            JNI_LOG_INFO("Last plugin unregistered, keeping JVM alive for stability");
         }
     } else {
-        OBP_LOG_WARN("Plugin '%s' was not registered", plugin_name.c_str());
+        JNI_LOG_WARN("Plugin '%s' was not registered", plugin_name.c_str());
     }
 }
 
@@ -212,7 +484,8 @@ int GlobalJVMManager::get_plugin_count() {
 void GlobalJVMManager::force_shutdown_jvm() {
     std::lock_guard<std::mutex> lock(global_mutex_);
     if (shared_jvm_ && jvm_created_by_us_) {
-        OBP_LOG_WARN("Force shutting down JVM");
+        JNI_LOG_WARN("Force shutting down JVM");
+        published_jvm_.store(nullptr, std::memory_order_release);
         shared_jvm_->DestroyJavaVM();
         shared_jvm_ = nullptr;
         jvm_created_by_us_ = false;
@@ -220,8 +493,7 @@ void GlobalJVMManager::force_shutdown_jvm() {
 }
 
 JavaVM* GlobalJVMManager::get_jvm() {
-    std::lock_guard<std::mutex> lock(global_mutex_);
-    return shared_jvm_;
+    return published_jvm_.load(std::memory_order_acquire);
 }
 
 bool GlobalJVMManager::validate_config_consistency(const std::string& classpath, 
@@ -233,7 +505,7 @@ bool GlobalJVMManager::validate_config_consistency(const std::string& classpath,
         first_instance_max_heap_mb_ = max_heap_mb;
         first_instance_init_heap_mb_ = init_heap_mb;
         config_recorded_ = true;
-        OBP_LOG_INFO("JVM configuration recorded: classpath=%s, max_heap=%zuMB, init_heap=%zuMB", 
+        JNI_LOG_INFO("JVM configuration recorded: classpath=%s, max_heap=%zuMB, init_heap=%zuMB", 
                      classpath.c_str(), max_heap_mb, init_heap_mb);
         return true;
     }
@@ -242,20 +514,20 @@ bool GlobalJVMManager::validate_config_consistency(const std::string& classpath,
     bool is_consistent = true;
     
     if (classpath != first_instance_classpath_) {
-        OBP_LOG_WARN("JVM classpath mismatch detected:");
-        OBP_LOG_WARN("  First instance: %s", first_instance_classpath_.c_str());
-        OBP_LOG_WARN("  Current instance: %s", classpath.c_str());
+        JNI_LOG_WARN("JVM classpath mismatch detected:");
+        JNI_LOG_WARN("  First instance: %s", first_instance_classpath_.c_str());
+        JNI_LOG_WARN("  Current instance: %s", classpath.c_str());
         is_consistent = false;
     }
     
     if (max_heap_mb != first_instance_max_heap_mb_) {
-        OBP_LOG_WARN("JVM max heap size mismatch: first=%zuMB, current=%zuMB", 
+        JNI_LOG_WARN("JVM max heap size mismatch: first=%zuMB, current=%zuMB", 
                      first_instance_max_heap_mb_, max_heap_mb);
         is_consistent = false;
     }
     
     if (init_heap_mb != first_instance_init_heap_mb_) {
-        OBP_LOG_WARN("JVM init heap size mismatch: first=%zuMB, current=%zuMB", 
+        JNI_LOG_WARN("JVM init heap size mismatch: first=%zuMB, current=%zuMB", 
                      first_instance_init_heap_mb_, init_heap_mb);
         is_consistent = false;
     }
@@ -263,38 +535,88 @@ bool GlobalJVMManager::validate_config_consistency(const std::string& classpath,
     return is_consistent;
 }
 
+GlobalThreadManager::ThreadState::ThreadState()
+    : jvm(nullptr), env(nullptr), ref_count(0), attached_by_us(false), registered(false) {
+}
+
+GlobalThreadManager::ThreadState::~ThreadState() {
+    if (!registered) {
+        return;
+    }
+    
+    // Only detach from the JVM we attached to, and only while it is still alive
+    if (env && attached_by_us && jvm == GlobalJVMManager::get_jvm()) {
+        jvm->DetachCurrentThread();
+    }
+    forget_current_thread(*this);
+}
+
+GlobalThreadManager::ThreadState& GlobalThreadManager::current_thread_state() {
+    static thread_local ThreadState state;
+    return state;
+}
+
 JNIEnv* GlobalThreadManager::acquire_jni_env_for_plugin(JavaVM* jvm, const std::string& plugin_name) {
     if (!jvm) {
-        OBP_LOG_ERROR("JVM is null");
+        JNI_LOG_ERROR("JVM is null");
         return nullptr;
     }
     
-    std::lock_guard<std::mutex> lock(thread_mutex_);
+    ThreadState& state = current_thread_state();
+    
+    // Fast path: thread already attached to this JVM, no lock needed
+    if (state.env && state.jvm == jvm) {
+        state.ref_count.fetch_add(1, std::memory_order_relaxed);
+        return state.env;
+    }
+    
+    return attach_current_thread(state, jvm, plugin_name);
+}
+
+JNIEnv* GlobalThreadManager::attach_current_thread(ThreadState& state, JavaVM* jvm, 
+                                                   const std::string& plugin_name) {
+    if (state.env) {
+        // Cached state belongs to a JVM that no longer exists
+        forget_current_thread(state);
+    }
+    
     std::thread::id current_thread_id = std::this_thread::get_id();
     
     JNIEnv* env = nullptr;
     jint result = jvm->GetEnv((void**)&env, JNI_VERSION_1_8);
     
     if (result == JNI_OK) {
-        // Thread already attached, increase global reference count
-        global_thread_ref_count_[current_thread_id]++;
-        return env;
+        // Thread attached by someone else, use it but never detach it
+        state.attached_by_us = false;
     } else if (result == JNI_EDETACHED) {
         // Need to attach thread
         result = jvm->AttachCurrentThread((void**)&env, nullptr);
-        if (result == JNI_OK) {
-            attached_threads_.insert(current_thread_id);
-            global_thread_ref_count_[current_thread_id] = 1;
-            return env;
-        } else {
-            OBP_LOG_ERROR("[%s] Failed to attach thread %p to JVM, error: %d", 
+        if (result != JNI_OK) {
+            JNI_LOG_ERROR("[%s] Failed to attach thread %p to JVM, error: %d", 
                          plugin_name.c_str(), &current_thread_id, result);
             return nullptr;
         }
+        state.attached_by_us = true;
     } else {
-        OBP_LOG_ERROR("[%s] Unexpected JVM GetEnv result: %d", plugin_name.c_str(), result);
+        JNI_LOG_ERROR("[%s] Unexpected JVM GetEnv result: %d", plugin_name.c_str(), result);
         return nullptr;
     }
+    
+    state.jvm = jvm;
+    state.env = env;
+    state.ref_count.store(1, std::memory_order_relaxed);
+    
+    // A thread that was adopted before is still registered, re-adopting it takes no lock
+    if (state.registered && !state.attached_by_us) {
+        return env;
+    }
+    std::lock_guard<std::mutex> lock(thread_mutex_);
+    if (state.attached_by_us) {
+        attached_threads_.insert(current_thread_id);
+    }
+    global_thread_ref_count_[current_thread_id] = &state.ref_count;
+    state.registered = true;
+    return env;
 }
 
 void GlobalThreadManager::release_jni_env_for_plugin(JavaVM* jvm, const std::string& plugin_name) {
@@ -302,35 +624,49 @@ void GlobalThreadManager::release_jni_env_for_plugin(JavaVM* jvm, const std::str
         return;
     }
     
-    std::lock_guard<std::mutex> lock(thread_mutex_);
-    std::thread::id current_thread_id = std::this_thread::get_id();
-    
-    auto ref_it = global_thread_ref_count_.find(current_thread_id);
-    if (ref_it != global_thread_ref_count_.end()) {
-        ref_it->second--;
-        
-        OBP_LOG_INFO("[%s] Thread %p global ref count decreased to: %d", 
-                    plugin_name.c_str(), &current_thread_id, ref_it->second);
-        
-        if (ref_it->second <= 0) {
-            // Global reference count reached zero, detach thread
-            if (attached_threads_.count(current_thread_id) > 0) {
-                OBP_LOG_INFO("[%s] Thread %p detaching from JVM", plugin_name.c_str(), &current_thread_id);
-                jvm->DetachCurrentThread();
-                attached_threads_.erase(current_thread_id);
-            }
-            global_thread_ref_count_.erase(ref_it);
-        }
-    } else {
-        OBP_LOG_WARN("[%s] Thread %p was not found in global reference count", 
+    ThreadState& state = current_thread_state();
+    if (!state.env || state.jvm != jvm || state.ref_count.load(std::memory_order_relaxed) <= 0) {
+        std::thread::id current_thread_id = std::this_thread::get_id();
+        JNI_LOG_WARN("[%s] Thread %p was not found in global reference count", 
                     plugin_name.c_str(), &current_thread_id);
+        return;
     }
+    
+    if (state.ref_count.fetch_sub(1, std::memory_order_relaxed) > 1) {
+        return;
+    }
+    
+    if (state.attached_by_us) {
+        // Stay attached with the cached env until the thread exits (see
+        // ~ThreadState), so the next document pays neither attach nor detach
+        return;
+    }
+    
+    // Drop the cached env of a thread we did not attach: the next acquire
+    // re-checks whether the owner has detached it in the meantime. The thread
+    // stays registered, so that takes no lock either
+    state.jvm = nullptr;
+    state.env = nullptr;
+}
+
+void GlobalThreadManager::forget_current_thread(ThreadState& state) {
+    std::thread::id current_thread_id = std::this_thread::get_id();
+    {
+        std::lock_guard<std::mutex> lock(thread_mutex_);
+        global_thread_ref_count_.erase(current_thread_id);
+        attached_threads_.erase(current_thread_id);
+    }
+    state.jvm = nullptr;
+    state.env = nullptr;
+    state.ref_count.store(0, std::memory_order_relaxed);
+    state.attached_by_us = false;
+    state.registered = false;
 }
 
 int GlobalThreadManager::get_thread_ref_count(std::thread::id tid) {
     std::lock_guard<std::mutex> lock(thread_mutex_);
     auto it = global_thread_ref_count_.find(tid);
-    return (it != global_thread_ref_count_.end()) ? it->second : 0;
+    return (it != global_thread_ref_count_.end()) ? it->second->load(std::memory_order_relaxed) : 0;
 }
 
 int GlobalThreadManager::get_attached_thread_count() {
@@ -338,42 +674,52 @@ int GlobalThreadManager::get_attached_thread_count() {
     return static_cast<int>(attached_threads_.size());
 }
 
+SegmentationPool* GlobalThreadManager::get_segmentation_pool(size_t input_bytes) {
+    // Destroyed when the library is unloaded, joining the idle threads
+    static std::unique_ptr<SegmentationPool> pool;
+    static std::once_flag pool_once;
+    const JNIConfig& config = JNIConfigUtils::get_config();
+    if (!config.pool || input_bytes <= config.pool_inline_bytes) {
+        return nullptr;
+    }
+    
+    std::call_once(pool_once, [&config]() {
+        pool.reset(new SegmentationPool(config.pool_threads));
+        JNI_LOG_INFO("Segmentation pool started with %zu threads, documents up to %zu bytes stay on the scan thread",
+                     pool->thread_count(), config.pool_inline_bytes);
+    });
+    return pool->is_worker_thread() ? nullptr : pool.get();
+}
+
 ScopedJNIEnvironment::ScopedJNIEnvironment(const std::string& plugin_name, 
                                           const std::string& classpath,
                                           size_t max_heap_mb,
                                           size_t init_heap_mb) 
-    : env_(nullptr), plugin_name_(plugin_name), is_valid_(false) {
-    
-    OBP_LOG_INFO("[%s] ScopedJNIEnvironment constructor called", plugin_name.c_str());
+    : jvm_(nullptr), env_(nullptr), plugin_name_(plugin_name), is_valid_(false) {
     
     JavaVM* jvm = nullptr;
     
     if (!classpath.empty()) {
         // Use provided classpath (for backward compatibility)
-        OBP_LOG_INFO("[%s] Creating/getting JVM with provided classpath", plugin_name.c_str());
+        JNI_LOG_DEBUG("[%s] Creating/getting JVM with provided classpath", plugin_name.c_str());
         jvm = GlobalJVMManager::get_or_create_jvm(classpath, max_heap_mb, init_heap_mb);
     } else {
-        // Use unified configuration from JNIConfigUtils
-        jvm = GlobalJVMManager::get_or_create_jvm(
-            JNIConfigUtils::get_unified_classpath(),
-            JNIConfigUtils::get_unified_max_heap_mb(),
-            JNIConfigUtils::get_unified_init_heap_mb());
+        // Use the unified configuration snapshot, lock-free once the JVM exists
+        jvm = GlobalJVMManager::get_or_create_default_jvm();
     }
     
     if (jvm) {
+        jvm_ = jvm;
         env_ = GlobalThreadManager::acquire_jni_env_for_plugin(jvm, plugin_name);
         is_valid_ = (env_ != nullptr);
     } else {
-        OBP_LOG_ERROR("[%s] JVM is null, cannot acquire JNI environment", plugin_name.c_str());
+        JNI_LOG_ERROR("[%s] JVM is null, cannot acquire JNI environment", plugin_name.c_str());
     }
 }
 
 ScopedJNIEnvironment::~ScopedJNIEnvironment() {
     if (env_) {
-        JavaVM* jvm = GlobalJVMManager::get_jvm();
-        if (jvm) {
-            GlobalThreadManager::release_jni_env_for_plugin(jvm, plugin_name_);
-        }
+        GlobalThreadManager::release_jni_env_for_plugin(jvm_, plugin_name_);
     }
 }
 
@@ -385,13 +731,33 @@ jstring JNIUtils::cpp_string_to_jstring(JNIEnv* env, const std::string& str) {
     jstring jstr = env->NewStringUTF(str.c_str());
     std::string error_msg;
     if (check_and_handle_exception(env, error_msg)) {
-        OBP_LOG_ERROR("Failed to create Java string: %s", error_msg.c_str());
+        JNI_LOG_ERROR("Failed to create Java string: %s", error_msg.c_str());
         return nullptr;
     }
     
     return jstr;
 }
 
+jobject JNIUtils::cpp_bytes_to_direct_buffer(JNIEnv* env, const char* data, size_t length) {
+    // Java only reads input buffers, the const_cast never leads to a write
+    return cpp_bytes_to_direct_buffer(env, const_cast<char*>(data), length);
+}
+
+jobject JNIUtils::cpp_bytes_to_direct_buffer(JNIEnv* env, char* data, size_t length) {
+    if (!env || (!data && length > 0)) {
+        return nullptr;
+    }
+    
+    jobject buffer = env->NewDirectByteBuffer(data, static_cast<jlong>(length));
+    std::string error_msg;
+    if (!buffer || check_and_handle_exception(env, error_msg)) {
+        JNI_LOG_ERROR("Failed to create direct ByteBuffer: %s", error_msg.c_str());
+        return nullptr;
+    }
+    
+    return buffer;
+}
+
 std::string JNIUtils::jstring_to_cpp_string(JNIEnv* env, jstring jstr) {
     if (!env || !jstr) {
         return std::string();
@@ -419,7 +785,7 @@ int JNIUtils::jstring_array_to_cpp_vector(JNIEnv* env, jobjectArray jarray,
     jsize length = env->GetArrayLength(jarray);
     std::string error_msg;
     if (check_and_handle_exception(env, error_msg)) {
-        OBP_LOG_ERROR("Failed to get array length: %s", error_msg.c_str());
+        JNI_LOG_ERROR("Failed to get array length: %s", error_msg.c_str());
         return -1;
     }
     
@@ -431,7 +797,7 @@ int JNIUtils::jstring_array_to_cpp_vector(JNIEnv* env, jobjectArray jarray,
     
     for (jsize start = 0; start < length; start += BATCH_SIZE) {
         if (env->PushLocalFrame(BATCH_SIZE) < 0) {
-            OBP_LOG_ERROR("Failed to push JNI local reference frame");
+            JNI_LOG_ERROR("Failed to push JNI local reference frame");
             return -1;
         }
         
@@ -440,7 +806,7 @@ int JNIUtils::jstring_array_to_cpp_vector(JNIEnv* env, jobjectArray jarray,
         for (jsize i = start; i < end; i++) {
             jstring jstr = (jstring)env->GetObjectArrayElement(jarray, i);
             if (check_and_handle_exception(env, error_msg)) {
-                OBP_LOG_ERROR("Failed to get array element %d: %s", i, error_msg.c_str());
+                JNI_LOG_ERROR("Failed to get array element %d: %s", i, error_msg.c_str());
                 env->PopLocalFrame(nullptr);
                 return -1;
             }
@@ -475,7 +841,8 @@ bool JNIUtils::check_and_handle_exception(JNIEnv* env, std::string& error_messag
             jstring exception_string = (jstring)env->CallObjectMethod(exception, to_string_method);
             if (exception_string) {
                 error_message = jstring_to_cpp_string(env, exception_string);
-                OBP_LOG_WARN("Java exception occurred: %s", error_message.c_str());
+                JNI_LOG_WARN("Java exception occurred: %s", error_message.c_str());
+                env->DeleteLocalRef(exception_string);
             }
         }
         
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <jni.h>
+#include "segmentation_pool.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -18,12 +19,61 @@
 namespace oceanbase {
 namespace jni {
 
+/**
+ * JNI Configuration Snapshot
+ * @brief Immutable copy of every OCEANBASE_JNI_* setting
+ * @details Resolved once, on first use, so the per-document path never
+ * reads the environment or scans the classpath directory again.
+ */
+struct JNIConfig {
+    std::string classpath;
+    size_t max_heap_mb;
+    size_t init_heap_mb;
+    bool direct_buffer_input;
+    bool packed_token_output;
+    bool reject_invalid_utf8;
+    bool aggregate_tokens;
+    bool native_ascii_runs;
+    size_t max_batch_bytes;
+    size_t streaming_threshold;
+    size_t streaming_chunk_bytes;
+    int log_level;
+    int log_rate_limit;
+    size_t segment_cache_bytes;
+    size_t segment_cache_max_doc_bytes;
+    bool chunk_cache;
+    bool warmup;
+    std::string warmup_corpus;
+    size_t warmup_documents;
+    std::string persistent_cache_dir;
+    size_t persistent_cache_bytes;
+    int cds_mode;
+    std::string cds_archive;
+    int jvm_profile;
+    std::string jvm_extra_opts;
+    bool pool;
+    size_t pool_threads;
+    size_t pool_inline_bytes;
+    
+    /**
+     * Resolve every setting through the JNIConfigUtils getters
+     */
+    JNIConfig();
+};
+
 /**
  * JNI Configuration Utilities
  * @brief Provides unified configuration management for all plugins
  */
 class JNIConfigUtils {
 public:
+    /**
+     * Get the process-wide configuration snapshot
+     * @return Snapshot resolved on the first call, read-only afterwards
+     * @details Environment changes after the first call are not picked up
+     */
+    static const JNIConfig& get_config();
+    
     /**
      * Get unified Java classpath
      * @return Classpath string, checks OCEANBASE_JNI_CLASSPATH env var first
@@ -41,8 +91,181 @@ public:
      * @return Initial heap size in MB, checks OCEANBASE_JNI_INIT_HEAP env var first
      */
     static size_t get_unified_init_heap_mb();
+    
+    /**
+     * Whether documents are passed to Java as direct ByteBuffers over the original UTF-8 bytes
+     * @return true unless OCEANBASE_JNI_DIRECT_BUFFER_INPUT is set to 0/false/off
+     */
+    static bool get_unified_direct_buffer_input();
+    
+    /**
+     * Whether Java segmenters write all tokens into one packed native buffer
+     * @return true unless OCEANBASE_JNI_PACKED_TOKEN_OUTPUT is set to 0/false/off
+     */
+    static bool get_unified_packed_token_output();
+    
+    /**
+     * Check whether documents that are not valid UTF-8 are rejected
+     * @return true to fail scan_begin, checks OCEANBASE_JNI_REJECT_INVALID_UTF8 env var first
+     */
+    static bool get_unified_reject_invalid_utf8();
+    
+    /**
+     * Check whether identical tokens are aggregated before they are emitted
+     * @return true to emit each distinct token once with its frequency, checks OCEANBASE_JNI_AGGREGATE_TOKENS env var first
+     */
+    static bool get_unified_aggregate_tokens();
+    
+    /**
+     * Check whether pure-ASCII chunks are tokenized natively instead of by the Java segmenter
+     * @return true if OCEANBASE_JNI_NATIVE_ASCII_RUNS is set to 1/true/on (default off)
+     */
+    static bool get_unified_native_ascii_runs();
+    
+    /**
+     * Get the maximum input size of one batch segmentation JNI call
+     * @return Size in bytes, checks OCEANBASE_JNI_MAX_BATCH_BYTES env var first
+     */
+    static size_t get_unified_max_batch_bytes();
+    
+    /**
+     * Get the document size from which tokens are streamed through a Java cursor
+     * @return Size in bytes (0 disables streaming), checks OCEANBASE_JNI_STREAMING_THRESHOLD env var first
+     */
+    static size_t get_unified_streaming_threshold();
+    
+    /**
+     * Get the size of one streamed token chunk
+     * @return Size in bytes, checks OCEANBASE_JNI_STREAMING_CHUNK_BYTES env var first
+     */
+    static size_t get_unified_streaming_chunk_bytes();
+    
+    /**
+     * Get the log level of the native library and the Java segmenters
+     * @return A JNILogLevel, checks OCEANBASE_JNI_LOG_LEVEL env var (error/warn/info/debug) first
+     */
+    static int get_unified_log_level();
+    
+    /**
+     * Get the number of messages one log statement may write per second
+     * @return Messages per second (0 = unlimited), checks OCEANBASE_JNI_LOG_RATE_LIMIT env var first
+     */
+    static int get_unified_log_rate_limit();
+    
+    /**
+     * Get the size of the segmentation result cache shared by all parsers
+     * @return Size in bytes (0 disables the cache), checks OCEANBASE_JNI_SEGMENT_CACHE_BYTES env var first
+     */
+    static size_t get_unified_segment_cache_bytes();
+    
+    /**
+     * Get the longest document the segmentation result cache holds
+     * @return Size in bytes, checks OCEANBASE_JNI_SEGMENT_CACHE_MAX_DOC_BYTES env var first
+     */
+    static size_t get_unified_segment_cache_max_doc_bytes();
+    
+    /**
+     * Check whether longer documents are segmented in content-defined chunks cached one by one
+     * @return true if OCEANBASE_JNI_CHUNK_CACHE is set to 1/true/on (default off)
+     */
+    static bool get_unified_chunk_cache();
+    
+    /**
+     * Check whether plugins initialize their segmenter in the background from plugin init
+     * @return true if OCEANBASE_JNI_WARMUP is set to 1/true/on (default off)
+     */
+    static bool get_unified_warmup();
+    
+    /**
+     * Get the training corpus replayed during the warm-up, one document per line
+     * @return File path (empty uses the plugin's bundled sentences), checks OCEANBASE_JNI_WARMUP_CORPUS env var first
+     */
+    static std::string get_unified_warmup_corpus();
+    
+    /**
+     * Get the most documents replayed during the warm-up
+     * @return Document count (0 disables the replay), checks OCEANBASE_JNI_WARMUP_DOCUMENTS env var first
+     */
+    static size_t get_unified_warmup_documents();
+    
+    /**
+     * Get the directory of the persistent segmentation caches, one file per plugin
+     * @return Directory (empty disables the cache), checks OCEANBASE_JNI_PERSISTENT_CACHE_DIR env var first
+     */
+    static std::string get_unified_persistent_cache_dir();
+    
+    /**
+     * Get the size bound of each persistent segmentation cache file
+     * @return Size in bytes, checks OCEANBASE_JNI_PERSISTENT_CACHE_BYTES env var first
+     */
+    static size_t get_unified_persistent_cache_bytes();
+    
+    /**
+     * Get the class-data sharing mode of the JVM
+     * @return A ClassDataSharingMode, checks OCEANBASE_JNI_CDS_MODE env var (off, dump or use) first
+     */
+    static int get_unified_cds_mode();
+    
+    /**
+     * Get the path of the class-data sharing archive
+     * @return Path (empty disables class-data sharing), checks OCEANBASE_JNI_CDS_ARCHIVE env var first
+     */
+    static std::string get_unified_cds_archive();
+    
+    /**
+     * Get the option profile of the JVM
+     * @return A JVMProfile, checks OCEANBASE_JNI_JVM_PROFILE env var (default, low-latency,
+     *         throughput or small-footprint) first
+     */
+    static int get_unified_jvm_profile();
+    
+    /**
+     * Get the extra options passed to the JVM after those of the profile
+     * @return Options separated by whitespace, checks OCEANBASE_JNI_EXTRA_OPTS env var first
+     */
+    static std::string get_unified_jvm_extra_opts();
+    
+    /**
+     * Check whether segmentation runs on a fixed pool of permanently attached threads
+     * @return true if OCEANBASE_JNI_POOL is set to 1/true/on (default off)
+     */
+    static bool get_unified_pool();
+    
+    /**
+     * Get the number of segmentation pool threads
+     * @return Thread count (0 = one per core), checks OCEANBASE_JNI_POOL_THREADS env var first
+     */
+    static size_t get_unified_pool_threads();
+    
+    /**
+     * Get the size up to which documents are segmented on the scan thread despite the pool
+     * @return Size in bytes (0 = none), checks OCEANBASE_JNI_POOL_INLINE_BYTES env var first
+     */
+    static size_t get_unified_pool_inline_bytes();
+    
+    /**
+     * Get the segmenter backend selected for a plugin
+     * @param plugin_name Plugin name, e.g. "thai_ftparser"
+     * @return Backend name, checks OCEANBASE_<PLUGIN>_BACKEND env var (e.g. OCEANBASE_THAI_FTPARSER_BACKEND) first
+     */
+    static std::string get_plugin_backend(const std::string& plugin_name);
+    
+    /**
+     * Get a boolean option of a plugin
+     * @param plugin_name Plugin name, e.g. "thai_ftparser"
+     * @param option Option name, e.g. "BIGRAM_UNIGRAMS"
+     * @return Checks OCEANBASE_<PLUGIN>_<OPTION> env var (e.g. OCEANBASE_THAI_FTPARSER_BIGRAM_UNIGRAMS) first
+     */
+    static bool get_plugin_flag(const std::string& plugin_name, const char* option, bool default_value);
 
 private:
+    /**
+     * Read a boolean environment variable
+     * @param name Environment variable name
+     * @param default_value Value used when the variable is unset or empty
+     */
+    static bool get_env_flag(const char* name, bool default_value);
+    
     /**
      * Build dynamic classpath by scanning directory
      * @param base_dir Base directory (e.g., "./java")
@@ -70,6 +293,14 @@ public:
                                     size_t max_heap_mb = 512, 
                                     size_t init_heap_mb = 128);
     
+    /**
+     * Get or create the global JVM instance from the configuration snapshot
+     * @return Pointer to the global JVM instance, or nullptr on failure
+     * @details Once the JVM exists this is a single atomic load: no lock,
+     * no configuration lookup and no logging
+     */
+    static JavaVM* get_or_create_default_jvm();
+    
     /**
      * Register a plugin using the JVM
      * @param plugin_name Name of the plugin
@@ -100,6 +331,8 @@ public:
 private:
     static std::mutex global_mutex_;
     static JavaVM* shared_jvm_;
+    // shared_jvm_ published for lock-free readers once it is usable
+    static std::atomic<JavaVM*> published_jvm_;
     static std::atomic<int> plugin_count_;
     static bool jvm_created_by_us_;
     static std::unordered_set<std::string> registered_plugins_;
@@ -125,6 +358,11 @@ private:
  * @brief Manages JNI environment pointers for each thread globally
  * @details Ensures proper thread attachment/detachment coordination
  * across multiple plugins using reference counting.
+ * The JNIEnv and reference count of each thread are cached thread-locally,
+ * so acquire/release take no lock once the thread is attached. A thread
+ * attached by the manager stays attached when its reference count drops to
+ * zero and is detached when it exits; the global tables are only touched
+ * when a thread is first attached and when it exits.
  */
 class GlobalThreadManager {
 public:
@@ -140,6 +378,10 @@ public:
      * Release JNI environment for current thread for a plugin
      * @param jvm The JVM instance to detach from
      * @param plugin_name Name of the plugin releasing the environment
+     * @details A thread attached by us stays attached when its reference
+     * count drops to zero and is detached when it exits, so scan and pool
+     * threads do not pay attach/detach for every document. A thread attached
+     * by someone else only drops its cached env.
      */
     static void release_jni_env_for_plugin(JavaVM* jvm, const std::string& plugin_name);
     
@@ -154,10 +396,56 @@ public:
      * Get the number of threads currently attached
      */
     static int get_attached_thread_count();
+    
+    /**
+     * Get the segmentation pool for a job
+     * @param input_bytes Input size of the job
+     * @return The process-wide pool, created on first use, or nullptr if the
+     *         job should run on the calling thread: OCEANBASE_JNI_POOL is off,
+     *         the job is no larger than OCEANBASE_JNI_POOL_INLINE_BYTES, or the
+     *         caller is already a pool thread
+     * @details Pool threads attach to the JVM on their first job and stay
+     * attached until they exit
+     */
+    static SegmentationPool* get_segmentation_pool(size_t input_bytes);
 
 private:
+    /**
+     * Per-thread cached JNI state
+     */
+    struct ThreadState {
+        JavaVM* jvm;
+        JNIEnv* env;
+        std::atomic<int> ref_count;
+        bool attached_by_us;
+        bool registered;  // Listed in the global tables
+        
+        ThreadState();
+        
+        /**
+         * Detach a thread we attached, and unregister it, when it exits
+         */
+        ~ThreadState();
+    };
+    
+    /**
+     * Get the cached JNI state of the calling thread
+     */
+    static ThreadState& current_thread_state();
+    
+    /**
+     * Slow path: attach (or adopt) the calling thread and publish it in the global tables
+     */
+    static JNIEnv* attach_current_thread(ThreadState& state, JavaVM* jvm, const std::string& plugin_name);
+    
+    /**
+     * Remove the calling thread from the global tables and reset its cached state
+     */
+    static void forget_current_thread(ThreadState& state);
+
     static std::mutex thread_mutex_;
-    static std::unordered_map<std::thread::id, int> global_thread_ref_count_;
+    // Points at each registered thread's thread-local reference count
+    static std::unordered_map<std::thread::id, std::atomic<int>*> global_thread_ref_count_;
     static std::unordered_set<std::thread::id> attached_threads_;
     // TODO: thread_plugin_map_ is currently not utilized, kept for future debugging/monitoring needs
     // static std::unordered_map<std::thread::id, std::unordered_set<std::string>> thread_plugin_map_;
@@ -175,6 +463,7 @@ private:
  */
 class ScopedJNIEnvironment {
 private:
+    JavaVM* jvm_;
     JNIEnv* env_;
     std::string plugin_name_;
     bool is_valid_;
@@ -230,6 +519,17 @@ public:
      */
     static jstring cpp_string_to_jstring(JNIEnv* env, const std::string& str);
     
+    /**
+     * Wrap native UTF-8 bytes in a direct java.nio.ByteBuffer without copying
+     * @details The memory must stay valid while Java uses the buffer; Java only reads it
+     */
+    static jobject cpp_bytes_to_direct_buffer(JNIEnv* env, const char* data, size_t length);
+    
+    /**
+     * Wrap writable native memory in a direct java.nio.ByteBuffer that Java fills in
+     */
+    static jobject cpp_bytes_to_direct_buffer(JNIEnv* env, char* data, size_t length);
+    
     /**
      * Convert Java string to C++ string
      */
@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - JVM Option Profiles Implementation
+ */
+
+#include "jvm_options.h"
+#include <cctype>
+#include <strings.h>
+
+namespace oceanbase {
+namespace jni {
+
+static const char* const PROFILE_NAMES[] = {"default", "low-latency", "throughput", "small-footprint"};
+
+int JVMOptions::parse_profile(const char* name, int default_profile) {
+    if (!name) {
+        return default_profile;
+    }
+    for (int profile = JNI_JVM_PROFILE_DEFAULT; profile <= JNI_JVM_PROFILE_SMALL_FOOTPRINT; ++profile) {
+        if (strcasecmp(name, PROFILE_NAMES[profile]) == 0) {
+            return profile;
+        }
+    }
+    return default_profile;
+}
+
+const char* JVMOptions::profile_name(int profile) {
+    if (profile < JNI_JVM_PROFILE_DEFAULT || profile > JNI_JVM_PROFILE_SMALL_FOOTPRINT) {
+        profile = JNI_JVM_PROFILE_DEFAULT;
+    }
+    return PROFILE_NAMES[profile];
+}
+
+void JVMOptions::profile_options(int profile, std::vector<std::string>& options) {
+    switch (profile) {
+    case JNI_JVM_PROFILE_LOW_LATENCY:
+        // G1 rather than ZGC: the same options start on every JDK the plugins support
+        options.push_back("-XX:+UseG1GC");
+        options.push_back("-XX:MaxGCPauseMillis=20");
+        options.push_back("-XX:+ParallelRefProcEnabled");
+        options.push_back("-XX:+AlwaysPreTouch");
+        break;
+    case JNI_JVM_PROFILE_THROUGHPUT:
+        options.push_back("-XX:+UseParallelGC");
+        options.push_back("-XX:+UseTransparentHugePages");
+        break;
+    case JNI_JVM_PROFILE_SMALL_FOOTPRINT:
+        options.push_back("-XX:+UseSerialGC");
+        options.push_back("-XX:MaxMetaspaceSize=64m");
+        options.push_back("-XX:ReservedCodeCacheSize=32m");
+        options.push_back("-XX:CICompilerCount=2");
+        options.push_back("-Xss256k");
+        break;
+    default:
+        options.push_back("-XX:+UseG1GC");
+        break;
+    }
+}
+
+void JVMOptions::split_extra_options(const std::string& extra, std::vector<std::string>& options) {
+    std::string option;
+    bool in_option = false;
+    char quote = 0;
+    for (char c : extra) {
+        if (quote) {
+            if (c == quote) {
+                quote = 0;
+            } else {
+                option += c;
+            }
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+            in_option = true;
+        } else if (isspace(static_cast<unsigned char>(c))) {
+            if (in_option) {
+                options.push_back(option);
+                option.clear();
+                in_option = false;
+            }
+        } else {
+            option += c;
+            in_option = true;
+        }
+    }
+    if (in_option) {
+        options.push_back(option);
+    }
+}
+
+bool JVMOptions::is_gc_selector(const std::string& option) {
+    static const char PREFIX[] = "-XX:+Use";
+    static const char SUFFIX[] = "GC";
+    const size_t prefix_length = sizeof(PREFIX) - 1;
+    const size_t suffix_length = sizeof(SUFFIX) - 1;
+    return option.size() > prefix_length + suffix_length
+           && option.compare(0, prefix_length, PREFIX) == 0
+           && option.compare(option.size() - suffix_length, suffix_length, SUFFIX) == 0;
+}
+
+void JVMOptions::build(const std::string& classpath, size_t max_heap_mb, size_t init_heap_mb,
+                       const char* log_level_name, int log_rate_limit, int profile,
+                       const std::vector<std::string>& extra_options, std::vector<std::string>& options) {
+    options.clear();
+    options.push_back("-Djava.class.path=" + classpath);
+    options.push_back("-Xmx" + std::to_string(max_heap_mb) + "m");
+    options.push_back("-Xms" + std::to_string(init_heap_mb) + "m");
+    options.push_back("-Dfile.encoding=UTF-8");
+    // The Java segmenters log with the same level and rate limit as the native side
+    options.push_back(std::string("-Doceanbase.jni.log.level=") + log_level_name);
+    options.push_back("-Doceanbase.jni.log.rate_limit=" + std::to_string(log_rate_limit));
+
+    bool extra_gc = false;
+    for (const std::string& option : extra_options) {
+        extra_gc = extra_gc || is_gc_selector(option);
+    }
+    std::vector<std::string> profile_list;
+    profile_options(profile, profile_list);
+    for (const std::string& option : profile_list) {
+        if (!(extra_gc && is_gc_selector(option))) {
+            options.push_back(option);
+        }
+    }
+    options.insert(options.end(), extra_options.begin(), extra_options.end());
+}
+
+} // namespace jni
+} // namespace oceanbase
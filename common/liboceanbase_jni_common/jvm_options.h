@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - JVM Option Profiles
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace oceanbase {
+namespace jni {
+
+/**
+ * JVM option profiles, selected by OCEANBASE_JNI_JVM_PROFILE
+ */
+enum JVMProfile {
+    JNI_JVM_PROFILE_DEFAULT = 0,          // G1 with its default pause target
+    JNI_JVM_PROFILE_LOW_LATENCY = 1,      // Short G1 pauses, heap touched up front
+    JNI_JVM_PROFILE_THROUGHPUT = 2,       // Parallel GC on transparent huge pages
+    JNI_JVM_PROFILE_SMALL_FOOTPRINT = 3   // Serial GC, capped metaspace and code cache, few compiler threads
+};
+
+/**
+ * JVM Options
+ * @brief Builds the option list of the shared JVM
+ * @details The options are the classpath, heap sizes, file encoding and
+ * log settings every plugin needs, then the options of the profile, then
+ * OCEANBASE_JNI_EXTRA_OPTS, so that an extra option overrides the profile.
+ * An extra garbage collector (-XX:+Use...GC) replaces the profile's, as the
+ * JVM refuses to start with two.
+ */
+class JVMOptions {
+public:
+    /**
+     * Parse a profile name (default, low-latency, throughput, small-footprint), case-insensitive
+     * @return The profile, or default_profile if name is null or unknown
+     */
+    static int parse_profile(const char* name, int default_profile);
+
+    /**
+     * Get the name of a profile, as understood by parse_profile
+     */
+    static const char* profile_name(int profile);
+
+    /**
+     * Append the options of a profile
+     */
+    static void profile_options(int profile, std::vector<std::string>& options);
+
+    /**
+     * Split extra options on whitespace, single or double quotes keep a value with spaces together
+     * @param options Output options (appended)
+     */
+    static void split_extra_options(const std::string& extra, std::vector<std::string>& options);
+
+    /**
+     * Check whether an option selects a garbage collector, e.g. -XX:+UseZGC
+     */
+    static bool is_gc_selector(const std::string& option);
+
+    /**
+     * Build the options of the JVM
+     * @param log_level_name Log level passed to the Java segmenters, as named by JNILog::level_name
+     * @param extra_options Options appended last, from split_extra_options
+     * @param options Output options (replaced)
+     */
+    static void build(const std::string& classpath, size_t max_heap_mb, size_t init_heap_mb,
+                      const char* log_level_name, int log_rate_limit, int profile,
+                      const std::vector<std::string>& extra_options, std::vector<std::string>& options);
+
+private:
+    // Disable construction
+    JVMOptions() = delete;
+    ~JVMOptions() = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Read-only Mapped File
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace oceanbase {
+namespace jni {
+
+/**
+ * Mapped File
+ * @brief A whole file mapped read-only into memory
+ * @details Native dictionaries are used in place: pages are shared with
+ * the page cache and between processes, loading costs no parsing or
+ * copying, and nothing is read until a lookup touches it.
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    /**
+     * Map a file, unmapping the previous one
+     * @param path File to map
+     * @param error Output description of the failure
+     * @return 0 on success, -1 on failure
+     */
+    int open(const std::string& path, std::string& error);
+
+    /**
+     * Unmap the file
+     */
+    void close();
+
+    /**
+     * First byte of the mapping, nullptr when nothing is mapped
+     */
+    const char* data() const { return data_; }
+
+    /**
+     * Size of the mapping in bytes
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * Check whether a file is mapped
+     */
+    bool is_open() const { return data_ != nullptr; }
+
+private:
+    const char* data_;
+    size_t size_;
+
+    // Disable copy
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,189 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Packed Token Buffer Implementation
+ */
+
+#include "packed_token_buffer.h"
+#include "scan_arena.h"
+#include "utf8_kernel.h"
+#include <cstring>
+#include <new>
+
+namespace oceanbase {
+namespace jni {
+
+PackedTokenBuffer::PackedTokenBuffer()
+    : data_(nullptr), arena_(nullptr), capacity_(0), size_(0), read_pos_(0) {
+}
+
+PackedTokenBuffer::PackedTokenBuffer(PackedTokenBuffer&& other)
+    : owned_(std::move(other.owned_)), data_(other.data_), arena_(other.arena_)
+    , capacity_(other.capacity_), size_(other.size_), read_pos_(other.read_pos_) {
+    other.data_ = nullptr;
+    other.capacity_ = 0;
+    other.size_ = 0;
+    other.read_pos_ = 0;
+}
+
+PackedTokenBuffer& PackedTokenBuffer::operator=(PackedTokenBuffer&& other) {
+    if (this != &other) {
+        owned_ = std::move(other.owned_);
+        data_ = other.data_;
+        arena_ = other.arena_;
+        capacity_ = other.capacity_;
+        size_ = other.size_;
+        read_pos_ = other.read_pos_;
+        other.data_ = nullptr;
+        other.capacity_ = 0;
+        other.size_ = 0;
+        other.read_pos_ = 0;
+    }
+    return *this;
+}
+
+int PackedTokenBuffer::reserve(size_t capacity) {
+    if (capacity <= capacity_) {
+        return 0;
+    }
+    
+    // Arena memory is released with the arena, heap memory with the buffer
+    std::unique_ptr<char[]> new_owned;
+    char* new_data = nullptr;
+    if (arena_) {
+        new_data = static_cast<char*>(arena_->allocate(capacity));
+    } else {
+        new_owned.reset(new (std::nothrow) char[capacity]);
+        new_data = new_owned.get();
+    }
+    if (!new_data) {
+        return -1;
+    }
+    if (size_ > 0) {
+        memcpy(new_data, data_, size_);
+    }
+    owned_ = std::move(new_owned);
+    data_ = new_data;
+    capacity_ = capacity;
+    return 0;
+}
+
+void PackedTokenBuffer::set_size(size_t used_bytes) {
+    size_ = (used_bytes <= capacity_) ? used_bytes : capacity_;
+    read_pos_ = 0;
+}
+
+int PackedTokenBuffer::assign(const char* packed, size_t length) {
+    clear();
+    if (reserve(length) != 0) {
+        return -1;
+    }
+    if (length > 0) {
+        memcpy(data_, packed, length);
+    }
+    size_ = length;
+    return 0;
+}
+
+int PackedTokenBuffer::append_packed(const char* packed, size_t length) {
+    if (length == 0) {
+        return 0;
+    }
+    if (size_ + length > capacity_) {
+        size_t new_capacity = capacity_ > 0 ? capacity_ * 2 : 256;
+        while (new_capacity < size_ + length) {
+            new_capacity *= 2;
+        }
+        if (reserve(new_capacity) != 0) {
+            return -1;
+        }
+    }
+    memcpy(data_ + size_, packed, length);
+    size_ += length;
+    return 0;
+}
+
+int PackedTokenBuffer::append(const char* token, size_t length) {
+    return append(token, length, count_utf8_chars(token, length));
+}
+
+int PackedTokenBuffer::append(const char* token, size_t length, int64_t char_count) {
+    size_t required = size_ + TOKEN_HEADER_SIZE + length;
+    if (required > capacity_) {
+        size_t new_capacity = capacity_ > 0 ? capacity_ * 2 : 256;
+        while (new_capacity < required) {
+            new_capacity *= 2;
+        }
+        if (reserve(new_capacity) != 0) {
+            return -1;
+        }
+    }
+    
+    int32_t header[2] = { static_cast<int32_t>(length), static_cast<int32_t>(char_count) };
+    memcpy(data_ + size_, header, TOKEN_HEADER_SIZE);
+    if (length > 0) {
+        memcpy(data_ + size_ + TOKEN_HEADER_SIZE, token, length);
+    }
+    size_ = required;
+    return 0;
+}
+
+bool PackedTokenBuffer::next(const char*& word, int64_t& word_len, int64_t& char_cnt) {
+    if (read_pos_ + TOKEN_HEADER_SIZE > size_) {
+        return false;
+    }
+    
+    int32_t header[2];
+    memcpy(header, data_ + read_pos_, TOKEN_HEADER_SIZE);
+    if (header[0] < 0 || read_pos_ + TOKEN_HEADER_SIZE + header[0] > size_) {
+        // Truncated or corrupted entry, stop iteration
+        read_pos_ = size_;
+        return false;
+    }
+    
+    word = data_ + read_pos_ + TOKEN_HEADER_SIZE;
+    word_len = header[0];
+    char_cnt = header[1];
+    read_pos_ += TOKEN_HEADER_SIZE + header[0];
+    return true;
+}
+
+void PackedTokenBuffer::clear() {
+    size_ = 0;
+    read_pos_ = 0;
+}
+
+size_t PackedTokenBuffer::token_count() const {
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos + TOKEN_HEADER_SIZE <= size_) {
+        int32_t length;
+        memcpy(&length, data_ + pos, sizeof(length));
+        if (length < 0) {
+            break;
+        }
+        pos += TOKEN_HEADER_SIZE + length;
+        count++;
+    }
+    return count;
+}
+
+void PackedTokenBuffer::to_vector(std::vector<std::string>& tokens) const {
+    tokens.clear();
+    size_t pos = 0;
+    while (pos + TOKEN_HEADER_SIZE <= size_) {
+        int32_t length;
+        memcpy(&length, data_ + pos, sizeof(length));
+        if (length < 0 || pos + TOKEN_HEADER_SIZE + length > size_) {
+            break;
+        }
+        tokens.emplace_back(data_ + pos + TOKEN_HEADER_SIZE, length);
+        pos += TOKEN_HEADER_SIZE + length;
+    }
+}
+
+int64_t PackedTokenBuffer::count_utf8_chars(const char* text, size_t length) {
+    return Utf8Kernel::count_chars(text, length);
+}
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Packed Token Buffer
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace oceanbase {
+namespace jni {
+
+class ScanArena;
+
+/**
+ * Non-owning view of one UTF-8 document
+ */
+struct TextSpan {
+    const char* data;
+    size_t length;
+    
+    TextSpan() : data(nullptr), length(0) {}
+    TextSpan(const char* d, size_t l) : data(d), length(l) {}
+};
+
+/**
+ * Packed Token Buffer
+ * @brief All tokens of a document stored back to back in one C++-owned buffer
+ * @details Layout per token (native byte order, unaligned):
+ *   int32 byte length | int32 character count | UTF-8 bytes
+ * Java segmenters fill the buffer through a direct ByteBuffer in a single
+ * JNI call, and next_token walks it by offset without further copies.
+ */
+class PackedTokenBuffer {
+public:
+    /**
+     * Size of the per-token header (byte length + character count)
+     */
+    static const size_t TOKEN_HEADER_SIZE = 2 * sizeof(int32_t);
+    
+    PackedTokenBuffer();
+    PackedTokenBuffer(PackedTokenBuffer&& other);
+    PackedTokenBuffer& operator=(PackedTokenBuffer&& other);
+    
+    /**
+     * Take further allocations from a scan arena instead of the heap
+     * @param arena Arena outliving the buffer's use, nullptr for the heap
+     */
+    void set_arena(ScanArena* arena) { arena_ = arena; }
+    
+    /**
+     * Ensure the buffer can hold at least capacity bytes, keeping its content
+     * @return 0 on success, -1 on allocation failure
+     */
+    int reserve(size_t capacity);
+    
+    /**
+     * Raw buffer for producers writing the packed layout directly
+     */
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+    
+    /**
+     * Allocated size in bytes
+     */
+    size_t capacity() const { return capacity_; }
+    
+    /**
+     * Number of bytes holding tokens
+     */
+    size_t size() const { return size_; }
+    
+    /**
+     * Publish content written directly into data()
+     * @param used_bytes Number of bytes written, must not exceed capacity()
+     */
+    void set_size(size_t used_bytes);
+    
+    /**
+     * Replace the content with already packed tokens
+     * @return 0 on success, -1 on allocation failure
+     */
+    int assign(const char* packed, size_t length);
+    
+    /**
+     * Append already packed tokens after the current ones
+     * @return 0 on success, -1 on allocation failure
+     */
+    int append_packed(const char* packed, size_t length);
+    
+    /**
+     * Append one token, computing its UTF-8 character count
+     * @return 0 on success, -1 on allocation failure
+     */
+    int append(const char* token, size_t length);
+    
+    /**
+     * Append one token with a known character count
+     * @return 0 on success, -1 on allocation failure
+     */
+    int append(const char* token, size_t length, int64_t char_count);
+    
+    /**
+     * Read the next token, advancing the read cursor
+     * @param word Output pointer to the token bytes (not NUL-terminated)
+     * @param word_len Output token length in bytes
+     * @param char_cnt Output token length in characters
+     * @return false when all tokens have been read
+     */
+    bool next(const char*& word, int64_t& word_len, int64_t& char_cnt);
+    
+    /**
+     * Restart reading from the first token
+     */
+    void rewind() { read_pos_ = 0; }
+    
+    /**
+     * Drop all tokens, keeping the allocation for reuse
+     */
+    void clear();
+    
+    /**
+     * Count the tokens in the buffer
+     */
+    size_t token_count() const;
+    
+    /**
+     * Copy all tokens into a vector of strings
+     */
+    void to_vector(std::vector<std::string>& tokens) const;
+    
+    /**
+     * Count UTF-8 characters the way the parsers always have: invalid lead
+     * bytes are skipped and not counted (vectorized by Utf8Kernel)
+     */
+    static int64_t count_utf8_chars(const char* text, size_t length);
+
+private:
+    // data_ points into owned_ or into arena_ memory
+    std::unique_ptr<char[]> owned_;
+    char* data_;
+    ScanArena* arena_;
+    size_t capacity_;
+    size_t size_;
+    size_t read_pos_;
+    
+    // Disable copy
+    PackedTokenBuffer(const PackedTokenBuffer&) = delete;
+    PackedTokenBuffer& operator=(const PackedTokenBuffer&) = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
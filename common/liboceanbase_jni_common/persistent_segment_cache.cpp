@@ -0,0 +1,397 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Persistent Segmentation Result Cache Implementation
+ */
+
+#include "persistent_segment_cache.h"
+#include "packed_token_buffer.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace oceanbase {
+namespace jni {
+
+namespace {
+
+const char FILE_MAGIC[8] = {'O', 'B', 'S', 'E', 'G', 'L', 'O', 'G'};
+const uint32_t FORMAT_VERSION = 1;
+const uint64_t CONTENT_SEED = 0x9E3779B97F4A7C15ULL;
+const uint64_t CHECKSUM_SEED = 0xD6E8FEB86659FD93ULL;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t header_bytes;
+    uint64_t config_version;
+    uint64_t reserved[5];
+};
+
+// Followed by the document bytes and the packed tokens, padded to 8 bytes
+struct RecordHeader {
+    uint32_t text_length;
+    uint32_t tokens_bytes;
+    uint64_t hash;
+    uint64_t checksum;  // Of the fields above and the payload
+};
+
+const size_t HEADER_BYTES = sizeof(FileHeader);
+
+inline size_t record_bytes(size_t payload_bytes) {
+    return (sizeof(RecordHeader) + payload_bytes + 7) & ~static_cast<size_t>(7);
+}
+
+uint64_t hash_bytes(uint64_t seed, const char* data, size_t length) {
+    uint64_t hash = seed ^ length;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+        hash ^= hash >> 31;
+        data += 8;
+        length -= 8;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data, length);
+    hash = (hash ^ tail) * 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+uint64_t record_checksum(const RecordHeader& header, const char* payload) {
+    uint64_t seed = CHECKSUM_SEED ^ header.hash ^
+                    ((static_cast<uint64_t>(header.text_length) << 32) | header.tokens_bytes);
+    return hash_bytes(seed, payload, static_cast<size_t>(header.text_length) + header.tokens_bytes);
+}
+
+int write_fully(int fd, const char* data, size_t length, size_t offset) {
+    while (length > 0) {
+        ssize_t written = pwrite(fd, data, length, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+        offset += static_cast<size_t>(written);
+    }
+    return 0;
+}
+
+// Scoped shared and exclusive holds of a pthread read-write lock
+class ReadGuard {
+public:
+    explicit ReadGuard(pthread_rwlock_t& lock) : lock_(lock) { pthread_rwlock_rdlock(&lock_); }
+    ~ReadGuard() { pthread_rwlock_unlock(&lock_); }
+
+private:
+    pthread_rwlock_t& lock_;
+};
+
+class WriteGuard {
+public:
+    explicit WriteGuard(pthread_rwlock_t& lock) : lock_(lock) { pthread_rwlock_wrlock(&lock_); }
+    ~WriteGuard() { pthread_rwlock_unlock(&lock_); }
+
+private:
+    pthread_rwlock_t& lock_;
+};
+
+} // anonymous namespace
+
+PersistentSegmentCacheStats::PersistentSegmentCacheStats()
+    : hits(0), misses(0), appends(0), rejections(0), records(0), bytes(0), discarded_bytes(0) {
+}
+
+PersistentSegmentCache::PersistentSegmentCache()
+    : fd_(-1), data_(nullptr), capacity_(0), end_(0), append_failed_(false), writes_(0), hits_(0), misses_(0) {
+    pthread_rwlock_init(&index_lock_, nullptr);
+}
+
+PersistentSegmentCache::~PersistentSegmentCache() {
+    close();
+    pthread_rwlock_destroy(&index_lock_);
+}
+
+int PersistentSegmentCache::open(const std::string& path, uint64_t config_version, size_t capacity_bytes,
+                                 std::string& error) {
+    close();
+
+    size_t capacity = capacity_bytes & ~static_cast<size_t>(7);
+    if (capacity < HEADER_BYTES + record_bytes(0)) {
+        error = "capacity of " + path + " is too small";
+        return -1;
+    }
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = "cannot open " + path + ": " + strerror(errno);
+        return -1;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        error = path + " is in use by another process";
+        ::close(fd);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        error = "cannot stat " + path + ": " + strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    size_t file_size = static_cast<size_t>(st.st_size);
+
+    // Records are only reused under the configuration that produced them
+    FileHeader header;
+    bool valid = file_size >= HEADER_BYTES &&
+                 pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                 memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0 &&
+                 header.format_version == FORMAT_VERSION && header.header_bytes == HEADER_BYTES &&
+                 header.config_version == config_version;
+
+    // The whole bound is mapped once; pages past the end of the file are
+    // never touched, and appended records become visible through the page cache
+    void* mapping = mmap(nullptr, capacity, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        error = "cannot map " + path + ": " + strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+
+    fd_ = fd;
+    data_ = static_cast<const char*>(mapping);
+    capacity_ = capacity;
+    append_failed_ = false;
+    counters_ = PersistentSegmentCacheStats();
+    hits_.store(0, std::memory_order_relaxed);
+    misses_.store(0, std::memory_order_relaxed);
+
+    if (!valid) {
+        counters_.discarded_bytes = file_size;
+        if (reset(config_version, error) != 0) {
+            error = "cannot initialize " + path + ": " + error;
+            close();
+            return -1;
+        }
+        return 0;
+    }
+
+    end_ = recover(file_size);
+    if (end_ < file_size) {
+        // Torn or corrupt tail, or a file written with a larger bound
+        counters_.discarded_bytes = file_size - end_;
+        if (ftruncate(fd_, static_cast<off_t>(end_)) != 0) {
+            error = "cannot truncate " + path + ": " + strerror(errno);
+            close();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int PersistentSegmentCache::reset(uint64_t config_version, std::string& error) {
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.format_version = FORMAT_VERSION;
+    header.header_bytes = HEADER_BYTES;
+    header.config_version = config_version;
+
+    if (ftruncate(fd_, 0) != 0 ||
+        write_fully(fd_, reinterpret_cast<const char*>(&header), sizeof(header), 0) != 0 ||
+        fdatasync(fd_) != 0) {
+        error = strerror(errno);
+        return -1;
+    }
+    end_ = HEADER_BYTES;
+    return 0;
+}
+
+size_t PersistentSegmentCache::recover(size_t file_size) {
+    size_t limit = file_size < capacity_ ? file_size : capacity_;
+    size_t offset = HEADER_BYTES;
+    while (offset + sizeof(RecordHeader) <= limit) {
+        RecordHeader record;
+        memcpy(&record, data_ + offset, sizeof(record));
+        size_t payload_bytes = static_cast<size_t>(record.text_length) + record.tokens_bytes;
+        size_t size = record_bytes(payload_bytes);
+        if (size > limit - offset ||
+            record.checksum != record_checksum(record, data_ + offset + sizeof(RecordHeader))) {
+            break;
+        }
+        try {
+            index_.insert(std::make_pair(record.hash, offset));
+        } catch (const std::bad_alloc&) {
+            // The record stays in the file, it just cannot be found this time
+        }
+        counters_.records++;
+        offset += size;
+    }
+    return offset;
+}
+
+void PersistentSegmentCache::close() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Appends write without the lock, the file stays open until they are done
+    writes_done_.wait(lock, [this]() { return writes_ == 0; });
+    if (fd_ < 0) {
+        return;
+    }
+    fdatasync(fd_);
+    // No lookup reads the mapping from here on
+    WriteGuard index_guard(index_lock_);
+    munmap(const_cast<char*>(data_), capacity_);
+    // Closing also releases the lock
+    ::close(fd_);
+    fd_ = -1;
+    data_ = nullptr;
+    capacity_ = 0;
+    end_ = 0;
+    index_.clear();
+}
+
+bool PersistentSegmentCache::lookup(const char* text, size_t length, PackedTokenBuffer& tokens) {
+    if (!is_open()) {
+        return false;
+    }
+    uint64_t hash = hash_bytes(CONTENT_SEED, text, length);
+    // Shared with other lookups: published records are never changed, only
+    // publishing, a failed append and close() take the index exclusively
+    ReadGuard index_guard(index_lock_);
+
+    auto found = index_.find(hash);
+    if (found == index_.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const char* record = data_ + found->second;
+    RecordHeader header;
+    memcpy(&header, record, sizeof(header));
+    const char* stored_text = record + sizeof(RecordHeader);
+    if (header.text_length != length || (length > 0 && memcmp(stored_text, text, length) != 0)) {
+        misses_.fetch_add(1, std::memory_order_relaxed);  // Another document with the same hash
+        return false;
+    }
+    if (tokens.assign(stored_text + length, header.tokens_bytes) != 0) {
+        return false;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool PersistentSegmentCache::append(const char* text, size_t length, const PackedTokenBuffer& tokens) {
+    if (!is_open() || length > UINT32_MAX || tokens.size() > UINT32_MAX) {
+        return false;
+    }
+    uint64_t hash = hash_bytes(CONTENT_SEED, text, length);
+    size_t size = record_bytes(length + tokens.size());
+
+    // The record is built and written without the lock, which only covers
+    // claiming its offset and publishing it once its bytes are in the file
+    std::string record;
+    try {
+        record.resize(size, '\0');
+    } catch (const std::bad_alloc&) {
+        return false;
+    }
+    RecordHeader header;
+    header.text_length = static_cast<uint32_t>(length);
+    header.tokens_bytes = static_cast<uint32_t>(tokens.size());
+    header.hash = hash;
+    char* payload = &record[sizeof(RecordHeader)];
+    if (length > 0) {
+        memcpy(payload, text, length);
+    }
+    if (tokens.size() > 0) {
+        memcpy(payload + length, tokens.data(), tokens.size());
+    }
+    header.checksum = record_checksum(header, payload);
+    memcpy(&record[0], &header, sizeof(header));
+
+    int fd = -1;
+    size_t offset = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ < 0 || append_failed_ || index_.count(hash) > 0 || writing_.count(hash) > 0) {
+            // Stored by a concurrent miss, or a colliding document: keep the first one
+            return false;
+        }
+        if (size > capacity_ - end_) {
+            counters_.rejections++;
+            return false;
+        }
+        try {
+            writing_.insert(hash);
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+        fd = fd_;
+        offset = end_;
+        end_ += size;
+        writes_++;
+    }
+
+    bool written = write_fully(fd, record.data(), record.size(), offset) == 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    writing_.erase(hash);
+    if (!written) {
+        // Cut off whatever part was written and everything claimed after it,
+        // and stop appending
+        append_failed_ = true;
+        if (offset < end_) {
+            end_ = offset;
+            WriteGuard index_guard(index_lock_);
+            for (auto it = index_.begin(); it != index_.end();) {
+                if (it->second >= offset) {
+                    it = index_.erase(it);
+                    counters_.records--;
+                } else {
+                    ++it;
+                }
+            }
+            if (ftruncate(fd_, static_cast<off_t>(end_)) != 0) {
+                // The checksum rejects the partial record on the next open
+            }
+        }
+    } else if (offset >= end_) {
+        // Claimed after a write that failed: cut off with it
+        written = false;
+    } else {
+        try {
+            WriteGuard index_guard(index_lock_);
+            index_.insert(std::make_pair(hash, offset));
+        } catch (const std::bad_alloc&) {
+            // Written but not found until the next open
+        }
+        counters_.appends++;
+        counters_.records++;
+    }
+    if (--writes_ == 0) {
+        writes_done_.notify_all();
+    }
+    return written;
+}
+
+PersistentSegmentCacheStats PersistentSegmentCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PersistentSegmentCacheStats stats = counters_;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.bytes = end_;
+    return stats;
+}
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Persistent Segmentation Result Cache
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <pthread.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace oceanbase {
+namespace jni {
+
+class PackedTokenBuffer;
+
+/**
+ * Persistent Segment Cache Counters
+ */
+struct PersistentSegmentCacheStats {
+    uint64_t hits;             // Lookups answered from the file
+    uint64_t misses;           // Lookups of documents not in the file
+    uint64_t appends;          // Results appended since the file was opened
+    uint64_t rejections;       // Results not appended because the file is full
+    uint64_t records;          // Results held in the file
+    uint64_t bytes;            // Size of the file
+    uint64_t discarded_bytes;  // Bytes dropped when the file was opened: torn tail or other configuration
+
+    PersistentSegmentCacheStats();
+};
+
+/**
+ * Persistent Segment Cache
+ * @brief Append-only file of packed token results, reused across index builds
+ * @details Rebuilding or adding a fulltext index segments every row again,
+ * although most of the text has not changed since the last build. The file
+ * keeps one record per document (content hash, document bytes, packed
+ * tokens) and is mapped read-only; records are appended with pwrite() and
+ * read in place through the mapping, an in-memory index maps content
+ * hashes to record offsets.
+ *
+ * The file header carries a configuration version (a hash of everything
+ * that changes the tokens, see SegmentCache::make_namespace()): a file
+ * written under another configuration is emptied on open. Every record
+ * carries a checksum, and on open the log is cut at the first record that
+ * does not verify, so a crash in the middle of an append loses that record
+ * and those after it in the file, nothing else. An append claims its offset
+ * under the lock and writes without it, so concurrent misses write their
+ * records in parallel; a lookup finds a record only once all of its bytes
+ * are written. Lookups share a read lock on the index and never wait for
+ * each other, published records are never changed. Appends are not synced
+ * one by one; the file is synced when it is closed. Once the file reaches
+ * its size bound no more records are appended. The file is locked while
+ * open: a second process using the same directory fails to open it and
+ * runs without the cache.
+ */
+class PersistentSegmentCache {
+public:
+    PersistentSegmentCache();
+    ~PersistentSegmentCache();
+
+    /**
+     * Open or create the file, closing the previous one
+     * @param path File to use
+     * @param config_version Version of the analyzer configuration, including
+     *        the segmenter's pipeline fingerprint
+     * @param capacity_bytes Size bound of the file
+     * @param error Output description of the failure
+     * @return 0 on success, -1 on failure
+     */
+    int open(const std::string& path, uint64_t config_version, size_t capacity_bytes, std::string& error);
+
+    /**
+     * Sync and close the file
+     */
+    void close();
+
+    /**
+     * Check whether a file is open
+     */
+    bool is_open() const { return fd_ >= 0; }
+
+    /**
+     * Look up the tokens of a document
+     * @param tokens Output buffer, replaced with the stored tokens on a hit
+     * @return true on a hit
+     */
+    bool lookup(const char* text, size_t length, PackedTokenBuffer& tokens);
+
+    /**
+     * Append the tokens of a document that missed
+     * @return true if the record was appended
+     */
+    bool append(const char* text, size_t length, const PackedTokenBuffer& tokens);
+
+    /**
+     * Current counters
+     */
+    PersistentSegmentCacheStats stats() const;
+
+private:
+    mutable std::mutex mutex_;     // Appends, close() and the counters
+    pthread_rwlock_t index_lock_;  // index_ and the mapping, shared by lookups
+    int fd_;
+    const char* data_;     // Mapping of capacity_ bytes, valid up to end_
+    size_t capacity_;
+    size_t end_;           // Offset of the next record
+    bool append_failed_;   // A write failed, the file is only read from now on
+    size_t writes_;        // Appends writing their record without the lock
+    std::condition_variable writes_done_;
+    std::unordered_map<uint64_t, size_t> index_;  // Content hash -> record offset
+    std::unordered_set<uint64_t> writing_;        // Content hashes being written
+    PersistentSegmentCacheStats counters_;
+    std::atomic<uint64_t> hits_;   // Counted by lookups, outside mutex_
+    std::atomic<uint64_t> misses_;
+
+    int reset(uint64_t config_version, std::string& error);
+    size_t recover(size_t file_size);
+
+    // Disable copy
+    PersistentSegmentCache(const PersistentSegmentCache&) = delete;
+    PersistentSegmentCache& operator=(const PersistentSegmentCache&) = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Per-thread Scan Arena Implementation
+ */
+
+#include "scan_arena.h"
+
+namespace oceanbase {
+namespace jni {
+
+const size_t ScanArena::MIN_BLOCK_SIZE;
+const size_t ScanArena::RETAIN_BYTES;
+
+ScanArena& ScanArena::current() {
+    static thread_local ScanArena arena;
+    return arena;
+}
+
+ScanArena::ScanArena()
+    : current_block_(0), active_scans_(0) {
+}
+
+void ScanArena::begin_scan() {
+    if (active_scans_.load(std::memory_order_acquire) == 0) {
+        rewind();
+    }
+    active_scans_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ScanArena::end_scan() {
+    active_scans_.fetch_sub(1, std::memory_order_release);
+}
+
+void* ScanArena::allocate(size_t size, size_t alignment) {
+    if (alignment == 0 || alignment > alignof(std::max_align_t) || (alignment & (alignment - 1)) != 0) {
+        return nullptr;
+    }
+    
+    // Bump inside the current block, or move on to the next retained block that fits
+    for (; current_block_ < blocks_.size(); ++current_block_) {
+        Block& block = blocks_[current_block_];
+        size_t offset = (block.used + alignment - 1) & ~(alignment - 1);
+        if (offset <= block.size && size <= block.size - offset) {
+            block.used = offset + size;
+            return block.data.get() + offset;
+        }
+    }
+    
+    // Blocks start max_align_t-aligned, so a fresh block needs no padding
+    size_t block_size = size > MIN_BLOCK_SIZE ? size : MIN_BLOCK_SIZE;
+    Block block;
+    block.data.reset(new (std::nothrow) char[block_size]);
+    if (!block.data) {
+        return nullptr;
+    }
+    block.size = block_size;
+    block.used = size;
+    blocks_.push_back(std::move(block));
+    current_block_ = blocks_.size() - 1;
+    return blocks_.back().data.get();
+}
+
+size_t ScanArena::reserved_bytes() const {
+    size_t total = 0;
+    for (const Block& block : blocks_) {
+        total += block.size;
+    }
+    return total;
+}
+
+void ScanArena::rewind() {
+    // Keep blocks up to the retain budget, free the rest
+    size_t retained = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        if (retained + blocks_[i].size > RETAIN_BYTES) {
+            continue;
+        }
+        retained += blocks_[i].size;
+        blocks_[i].used = 0;
+        if (kept != i) {
+            blocks_[kept] = std::move(blocks_[i]);
+        }
+        ++kept;
+    }
+    blocks_.erase(blocks_.begin() + kept, blocks_.end());
+    current_block_ = 0;
+}
+
+} // namespace jni
+} // namespace oceanbase
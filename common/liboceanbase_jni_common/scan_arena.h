@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Per-thread Scan Arena
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace oceanbase {
+namespace jni {
+
+/**
+ * Scan Arena
+ * @brief Per-thread bump allocator for parser state and token storage
+ * @details Every scan_begin on a thread allocates from that thread's arena
+ * and scan_end only marks the scan finished. Once no scan of the arena is
+ * active, the next begin_scan() rewinds it, so a thread reuses the same
+ * contiguous blocks document after document instead of going through
+ * malloc/free for every scan.
+ *
+ * allocate() and begin_scan() must be called on the owning thread;
+ * end_scan() may be called from any thread.
+ */
+class ScanArena {
+public:
+    /**
+     * Get the arena of the calling thread
+     */
+    static ScanArena& current();
+    
+    ScanArena();
+    ~ScanArena() = default;
+    
+    /**
+     * Start a scan, rewinding the arena when no other scan is active
+     */
+    void begin_scan();
+    
+    /**
+     * Finish a scan started with begin_scan()
+     */
+    void end_scan();
+    
+    /**
+     * Allocate memory that stays valid until the arena is rewound
+     * @param size Number of bytes
+     * @param alignment Power of two, at most alignof(std::max_align_t)
+     * @return Pointer to the memory, nullptr on allocation failure
+     */
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    
+    /**
+     * Construct an object in the arena; its destructor must be called explicitly
+     * @return Pointer to the object, nullptr on allocation failure
+     */
+    template <typename T>
+    T* create() {
+        void* memory = allocate(sizeof(T), alignof(T));
+        return memory ? new (memory) T() : nullptr;
+    }
+    
+    /**
+     * Total bytes held by the arena's blocks
+     */
+    size_t reserved_bytes() const;
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+        size_t used;
+    };
+    
+    // Smallest block, large enough for the parser state and typical documents
+    static const size_t MIN_BLOCK_SIZE = 64 * 1024;
+    // Blocks beyond this total are freed on rewind (one huge document does not pin memory)
+    static const size_t RETAIN_BYTES = 4 * 1024 * 1024;
+    
+    void rewind();
+    
+    std::vector<Block> blocks_;
+    size_t current_block_;
+    std::atomic<int> active_scans_;
+    
+    // Disable copy
+    ScanArena(const ScanArena&) = delete;
+    ScanArena& operator=(const ScanArena&) = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
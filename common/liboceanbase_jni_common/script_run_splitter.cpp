@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Script Run Splitter Implementation
+ */
+
+#include "script_run_splitter.h"
+#include "packed_token_buffer.h"
+
+namespace oceanbase {
+namespace jni {
+
+namespace {
+
+inline bool is_ascii_space(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline bool is_ascii_letter(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+inline bool is_ascii_digit(unsigned char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool is_ascii_alnum(unsigned char c) {
+    return is_ascii_letter(c) || is_ascii_digit(c);
+}
+
+// Call fn(chunk, length) for every whitespace-delimited chunk
+template <typename Fn>
+bool for_each_chunk(const char* text, size_t length, Fn fn) {
+    size_t pos = 0;
+    while (pos < length) {
+        while (pos < length && is_ascii_space(static_cast<unsigned char>(text[pos]))) {
+            pos++;
+        }
+        size_t start = pos;
+        while (pos < length && !is_ascii_space(static_cast<unsigned char>(text[pos]))) {
+            pos++;
+        }
+        if (pos > start && !fn(text + start, pos - start)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+ScriptRunSplitter::ScriptRunSplitter(const Options& options)
+    : options_(options) {
+}
+
+bool ScriptRunSplitter::is_native_chunk(const char* chunk, size_t length) const {
+    size_t first_alnum = length;
+    size_t last_alnum = 0;
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char c = static_cast<unsigned char>(chunk[i]);
+        if (c >= 0x80) {
+            return false;
+        }
+        if (is_ascii_alnum(c)) {
+            if (first_alnum == length) {
+                first_alnum = i;
+            }
+            last_alnum = i;
+        }
+    }
+    
+    if (options_.punctuation_joins_words && first_alnum < length) {
+        // Leading and trailing punctuation is harmless, inner punctuation is not
+        for (size_t i = first_alnum; i < last_alnum; ++i) {
+            if (!is_ascii_alnum(static_cast<unsigned char>(chunk[i]))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool ScriptRunSplitter::collect_segmenter_text(const char* text, size_t length,
+                                               std::string& segmenter_text) const {
+    segmenter_text.clear();
+    for_each_chunk(text, length, [&](const char* chunk, size_t chunk_length) {
+        if (!is_native_chunk(chunk, chunk_length)) {
+            if (!segmenter_text.empty()) {
+                segmenter_text.push_back('\n');
+            }
+            segmenter_text.append(chunk, chunk_length);
+        }
+        return true;
+    });
+    return !segmenter_text.empty();
+}
+
+int ScriptRunSplitter::append_native_tokens(const char* text, size_t length,
+                                            PackedTokenBuffer& tokens) const {
+    bool ok = for_each_chunk(text, length, [&](const char* chunk, size_t chunk_length) {
+        if (!is_native_chunk(chunk, chunk_length)) {
+            return true;
+        }
+        
+        size_t pos = 0;
+        while (pos < chunk_length) {
+            while (pos < chunk_length && !is_ascii_alnum(static_cast<unsigned char>(chunk[pos]))) {
+                pos++;
+            }
+            size_t start = pos;
+            bool digits = pos < chunk_length && is_ascii_digit(static_cast<unsigned char>(chunk[pos]));
+            while (pos < chunk_length) {
+                unsigned char c = static_cast<unsigned char>(chunk[pos]);
+                if (!is_ascii_alnum(c) ||
+                    (options_.split_letters_and_digits && is_ascii_digit(c) != digits)) {
+                    break;
+                }
+                pos++;
+            }
+            if (pos == start) {
+                continue;
+            }
+            
+            // Append, then lowercase the copy in place (ASCII: one byte per character)
+            size_t token_length = pos - start;
+            if (tokens.append(chunk + start, token_length, static_cast<int64_t>(token_length)) != 0) {
+                return false;
+            }
+            char* token = tokens.data() + tokens.size() - token_length;
+            for (size_t i = 0; i < token_length; ++i) {
+                if (token[i] >= 'A' && token[i] <= 'Z') {
+                    token[i] = static_cast<char>(token[i] - 'A' + 'a');
+                }
+            }
+        }
+        return true;
+    });
+    return ok ? 0 : -1;
+}
+
+} // namespace jni
+} // namespace oceanbase
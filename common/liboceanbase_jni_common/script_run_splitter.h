@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Script Run Splitter
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace oceanbase {
+namespace jni {
+
+class PackedTokenBuffer;
+
+/**
+ * Script Run Splitter
+ * @brief Native pre-pass that keeps ASCII text away from the JVM
+ * @details The document is cut into whitespace-delimited chunks. A chunk
+ * made only of ASCII bytes is tokenized natively the way the Lucene
+ * analyzers treat it: punctuation is dropped, letter and digit runs are
+ * emitted lowercased. Every chunk containing a non-ASCII byte (CJK, Hangul,
+ * Thai, ...) is kept whole, so dictionary words mixing scripts still reach
+ * the segmenter, and all such chunks are sent in one call joined by '\n'.
+ * Tokens are produced per document without positions, so native and
+ * segmenter tokens may be emitted in any order.
+ */
+class ScriptRunSplitter {
+public:
+    struct Options {
+        // Kuromoji/Nori split "abc123" into "abc" and "123"; Thai keeps it whole
+        bool split_letters_and_digits;
+        // Thai word breaking keeps "don't" or "3.14" together: send such
+        // chunks to the segmenter instead of splitting them at punctuation
+        bool punctuation_joins_words;
+        
+        Options() : split_letters_and_digits(true), punctuation_joins_words(false) {}
+    };
+    
+    explicit ScriptRunSplitter(const Options& options);
+    
+    /**
+     * Collect the chunks that need the segmenter, joined with '\n'
+     * @param segmenter_text Output text for the segmenter (replaced)
+     * @return true if at least one chunk needs the segmenter
+     */
+    bool collect_segmenter_text(const char* text, size_t length, std::string& segmenter_text) const;
+    
+    /**
+     * Append the tokens of every chunk handled natively
+     * @return 0 on success, -1 on allocation failure
+     */
+    int append_native_tokens(const char* text, size_t length, PackedTokenBuffer& tokens) const;
+
+private:
+    /**
+     * Check whether a chunk is tokenized natively
+     */
+    bool is_native_chunk(const char* chunk, size_t length) const;
+    
+    Options options_;
+};
+
+} // namespace jni
+} // namespace oceanbase
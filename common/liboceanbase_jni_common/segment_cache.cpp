@@ -0,0 +1,267 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Segmentation Result Cache Implementation
+ */
+
+#include "segment_cache.h"
+#include "packed_token_buffer.h"
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <new>
+
+namespace oceanbase {
+namespace jni {
+
+namespace {
+
+// Bookkeeping charged to every entry besides its bytes (list node, index slot, string header)
+const size_t ENTRY_OVERHEAD = 96;
+// Typical entry size, used to size the sketch: a short query or title and its tokens
+const size_t TYPICAL_ENTRY_BYTES = ENTRY_OVERHEAD + 64;
+// Sketch row width bounds (counters per row and shard)
+const size_t MIN_SKETCH_WIDTH = 64;
+const size_t MAX_SKETCH_WIDTH = 65536;
+
+// One counter per entry a shard can hold, rounded up to a power of two
+size_t sketch_width(size_t shard_capacity) {
+    size_t width = MIN_SKETCH_WIDTH;
+    while (width < shard_capacity / TYPICAL_ENTRY_BYTES && width < MAX_SKETCH_WIDTH) {
+        width <<= 1;
+    }
+    return width;
+}
+
+inline uint64_t mix(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+} // anonymous namespace
+
+SegmentCacheStats::SegmentCacheStats()
+    : hits(0), misses(0), insertions(0), rejections(0), evictions(0), entries(0), bytes(0) {
+}
+
+// FrequencySketch
+SegmentCache::FrequencySketch::FrequencySketch(size_t width)
+    : counters_(width * DEPTH, 0)
+    , width_mask_(width - 1)
+    , additions_(0)
+    , sample_size_(width * 10) {
+}
+
+size_t SegmentCache::FrequencySketch::index(uint64_t hash, size_t row) const {
+    static const uint64_t SEEDS[DEPTH] = {
+        0x9E3779B97F4A7C15ULL, 0xBF58476D1CE4E5B9ULL, 0x94D049BB133111EBULL, 0xD6E8FEB86659FD93ULL
+    };
+    uint64_t h = (hash + SEEDS[row]) * SEEDS[(row + 1) % DEPTH];
+    return row * (width_mask_ + 1) + (static_cast<size_t>(h >> 32) & width_mask_);
+}
+
+void SegmentCache::FrequencySketch::record(uint64_t hash) {
+    for (size_t row = 0; row < DEPTH; ++row) {
+        uint8_t& counter = counters_[index(hash, row)];
+        if (counter < 15) {
+            counter++;
+        }
+    }
+    if (++additions_ >= sample_size_) {
+        // Age every count so that yesterday's hot documents can be replaced
+        for (size_t i = 0; i < counters_.size(); ++i) {
+            counters_[i] >>= 1;
+        }
+        additions_ /= 2;
+    }
+}
+
+unsigned SegmentCache::FrequencySketch::estimate(uint64_t hash) const {
+    unsigned count = 15;
+    for (size_t row = 0; row < DEPTH; ++row) {
+        unsigned counter = counters_[index(hash, row)];
+        count = counter < count ? counter : count;
+    }
+    return count;
+}
+
+// SegmentCache
+SegmentCache::SegmentCache(size_t capacity_bytes, size_t max_document_bytes)
+    : capacity_bytes_(capacity_bytes)
+    , shard_capacity_(capacity_bytes / SHARD_COUNT)
+    , max_document_bytes_(max_document_bytes) {
+    if (capacity_bytes_ == 0) {
+        return;
+    }
+    shards_.reserve(SHARD_COUNT);
+    for (size_t i = 0; i < SHARD_COUNT; ++i) {
+        shards_.emplace_back(new Shard(sketch_width(shard_capacity_)));
+    }
+}
+
+// Read here rather than from the JNI configuration, so the cache builds without a JDK
+SegmentCache& SegmentCache::instance() {
+    static SegmentCache cache(configured_capacity_bytes(), configured_max_document_bytes());
+    return cache;
+}
+
+size_t SegmentCache::configured_capacity_bytes() {
+    const char* env_cache_bytes = std::getenv("OCEANBASE_JNI_SEGMENT_CACHE_BYTES");
+    if (env_cache_bytes && strlen(env_cache_bytes) > 0) {
+        return static_cast<size_t>(std::atoll(env_cache_bytes));
+    }
+    return 16 * 1024 * 1024;  // Unified default: 16MB
+}
+
+size_t SegmentCache::configured_max_document_bytes() {
+    const char* env_max_doc_bytes = std::getenv("OCEANBASE_JNI_SEGMENT_CACHE_MAX_DOC_BYTES");
+    if (env_max_doc_bytes && strlen(env_max_doc_bytes) > 0) {
+        return static_cast<size_t>(std::atoll(env_max_doc_bytes));
+    }
+    return 4 * 1024;  // Unified default: 4KB, queries, titles and tags
+}
+
+uint64_t SegmentCache::make_namespace(const std::string& description) {
+    return hash_document(0, description.data(), description.size());
+}
+
+uint64_t SegmentCache::hash_document(uint64_t ns, const char* text, size_t length) {
+    // 8 bytes per multiply-xorshift round, then a full avalanche: the top
+    // bits pick the shard and the sketch reads the rest
+    uint64_t hash = (0x9E3779B97F4A7C15ULL ^ length) + ns;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, text, sizeof(word));
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+        hash ^= hash >> 31;
+        text += 8;
+        length -= 8;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, text, length);
+    return mix(hash ^ tail);
+}
+
+size_t SegmentCache::entry_bytes(const Entry& entry) {
+    return entry.data.size() + ENTRY_OVERHEAD;
+}
+
+void SegmentCache::remove(Shard& shard, EntryList::iterator it) {
+    shard.bytes -= entry_bytes(*it);
+    shard.index.erase(it->hash);
+    shard.lru.erase(it);
+}
+
+bool SegmentCache::lookup(uint64_t ns, const char* text, size_t length, PackedTokenBuffer& tokens) {
+    if (!cacheable(length)) {
+        return false;
+    }
+    uint64_t hash = hash_document(ns, text, length);
+    Shard& shard = shard_of(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    shard.sketch.record(hash);
+    auto found = shard.index.find(hash);
+    if (found == shard.index.end()) {
+        shard.counters.misses++;
+        return false;
+    }
+    const Entry& entry = *found->second;
+    if (entry.text_length != length || (length > 0 && memcmp(entry.data.data(), text, length) != 0)) {
+        shard.counters.misses++;  // Another document with the same hash
+        return false;
+    }
+    if (tokens.assign(entry.data.data() + length, entry.data.size() - length) != 0) {
+        return false;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+    shard.counters.hits++;
+    return true;
+}
+
+bool SegmentCache::insert(uint64_t ns, const char* text, size_t length, const PackedTokenBuffer& tokens) {
+    if (!cacheable(length)) {
+        return false;
+    }
+    uint64_t hash = hash_document(ns, text, length);
+    Shard& shard = shard_of(hash);
+    size_t needed = length + tokens.size() + ENTRY_OVERHEAD;
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (needed > shard_capacity_) {
+        shard.counters.rejections++;
+        return false;
+    }
+    // Already stored by a concurrent miss, or a colliding document: the newer
+    // one replaces it, but only once admitted, and its bytes count as free
+    auto found = shard.index.find(hash);
+    bool replacing = found != shard.index.end();
+    size_t replaced_bytes = replacing ? entry_bytes(*found->second) : 0;
+
+    // Admission: only a candidate used more often than the LRU victim may evict
+    if (shard.bytes - replaced_bytes + needed > shard_capacity_) {
+        auto victim = std::prev(shard.lru.end());
+        if (replacing && victim == found->second) {
+            // The replaced entry shares the candidate's hash and frequency
+            victim = std::prev(victim);
+        }
+        if (shard.sketch.estimate(hash) <= shard.sketch.estimate(victim->hash)) {
+            shard.counters.rejections++;
+            return false;
+        }
+    }
+
+    Entry entry;
+    try {
+        entry.hash = hash;
+        entry.text_length = length;
+        entry.data.reserve(length + tokens.size());
+        entry.data.append(text, length);
+        entry.data.append(tokens.data(), tokens.size());
+    } catch (const std::bad_alloc&) {
+        return false;
+    }
+    if (replacing) {
+        remove(shard, found->second);
+    }
+    try {
+        shard.lru.push_front(std::move(entry));
+    } catch (const std::bad_alloc&) {
+        return false;
+    }
+    try {
+        shard.index[hash] = shard.lru.begin();
+    } catch (const std::bad_alloc&) {
+        shard.lru.pop_front();
+        return false;
+    }
+    shard.bytes += entry_bytes(shard.lru.front());
+    shard.counters.insertions++;
+
+    while (shard.bytes > shard_capacity_) {
+        remove(shard, std::prev(shard.lru.end()));
+        shard.counters.evictions++;
+    }
+    return true;
+}
+
+SegmentCacheStats SegmentCache::stats() const {
+    SegmentCacheStats total;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total.hits += shard->counters.hits;
+        total.misses += shard->counters.misses;
+        total.insertions += shard->counters.insertions;
+        total.rejections += shard->counters.rejections;
+        total.evictions += shard->counters.evictions;
+        total.entries += shard->lru.size();
+        total.bytes += shard->bytes;
+    }
+    return total;
+}
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Segmentation Result Cache
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace oceanbase {
+namespace jni {
+
+class PackedTokenBuffer;
+
+/**
+ * Segment Cache Counters
+ */
+struct SegmentCacheStats {
+    uint64_t hits;         // Lookups answered from the cache
+    uint64_t misses;       // Lookups of cacheable documents that were not cached
+    uint64_t insertions;   // Results stored
+    uint64_t rejections;   // Results refused by the admission policy
+    uint64_t evictions;    // Results dropped to make room
+    uint64_t entries;      // Results held now
+    uint64_t bytes;        // Bytes held now, documents and tokens
+
+    SegmentCacheStats();
+};
+
+/**
+ * Segment Cache
+ * @brief Bounded cache of packed token results, shared by all parsers
+ * @details Results are keyed by a namespace (parser and analyzer
+ * configuration, see make_namespace()) and the document bytes; the full
+ * document is kept with its tokens and compared on lookup, so a hash
+ * collision is a miss, never a wrong answer. The cache is split into
+ * SHARD_COUNT independently locked LRU shards. Documents longer than
+ * max_document_bytes are never cached, and a result that does not fit is
+ * only admitted if it has been looked up more often than the least
+ * recently used entry it would evict (TinyLFU, counted in a small per-shard
+ * count-min sketch that is halved periodically), so a stream of one-off
+ * documents cannot flush frequent short queries and titles.
+ */
+class SegmentCache {
+public:
+    static const size_t SHARD_COUNT = 16;
+
+    /**
+     * @param capacity_bytes Total size bound, 0 disables the cache
+     * @param max_document_bytes Longest document worth caching
+     */
+    SegmentCache(size_t capacity_bytes, size_t max_document_bytes);
+
+    /**
+     * Process-wide cache, sized by OCEANBASE_JNI_SEGMENT_CACHE_BYTES and
+     * OCEANBASE_JNI_SEGMENT_CACHE_MAX_DOC_BYTES
+     */
+    static SegmentCache& instance();
+
+    /**
+     * Size of the process-wide cache
+     * @return Size in bytes (0 disables the cache), checks OCEANBASE_JNI_SEGMENT_CACHE_BYTES env var first
+     */
+    static size_t configured_capacity_bytes();
+
+    /**
+     * Longest document the process-wide cache holds
+     * @return Size in bytes, checks OCEANBASE_JNI_SEGMENT_CACHE_MAX_DOC_BYTES env var first
+     */
+    static size_t configured_max_document_bytes();
+
+    /**
+     * Namespace of one parser configuration
+     * @param description Everything that changes the tokens of a document,
+     * e.g. plugin name, segmenter class and options
+     */
+    static uint64_t make_namespace(const std::string& description);
+
+    /**
+     * Check whether a document may be cached at all
+     */
+    bool cacheable(size_t length) const { return capacity_bytes_ > 0 && length <= max_document_bytes_; }
+
+    /**
+     * Look up the tokens of a document
+     * @param tokens Output buffer, replaced with the cached tokens on a hit
+     * @return true on a hit
+     */
+    bool lookup(uint64_t ns, const char* text, size_t length, PackedTokenBuffer& tokens);
+
+    /**
+     * Offer the tokens of a document that missed
+     * @return true if the result was stored
+     */
+    bool insert(uint64_t ns, const char* text, size_t length, const PackedTokenBuffer& tokens);
+
+    /**
+     * Sum of the counters of all shards
+     */
+    SegmentCacheStats stats() const;
+
+private:
+    /**
+     * Count-min sketch of 4-bit access counts, halved every sample_size_ accesses
+     */
+    class FrequencySketch {
+    public:
+        explicit FrequencySketch(size_t width);
+        void record(uint64_t hash);
+        unsigned estimate(uint64_t hash) const;
+
+    private:
+        static const size_t DEPTH = 4;
+        std::vector<uint8_t> counters_;
+        size_t width_mask_;
+        size_t additions_;
+        size_t sample_size_;
+
+        size_t index(uint64_t hash, size_t row) const;
+    };
+
+    struct Entry {
+        uint64_t hash;
+        size_t text_length;
+        std::string data;  // Document bytes followed by the packed tokens
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    struct Shard {
+        std::mutex mutex;
+        EntryList lru;  // Most recently used first
+        std::unordered_map<uint64_t, EntryList::iterator> index;
+        FrequencySketch sketch;
+        size_t bytes;
+        SegmentCacheStats counters;
+
+        explicit Shard(size_t sketch_width) : sketch(sketch_width), bytes(0) {}
+    };
+
+    size_t capacity_bytes_;
+    size_t shard_capacity_;
+    size_t max_document_bytes_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    static uint64_t hash_document(uint64_t ns, const char* text, size_t length);
+    static size_t entry_bytes(const Entry& entry);
+    Shard& shard_of(uint64_t hash) { return *shards_[hash >> 60]; }
+    void remove(Shard& shard, EntryList::iterator it);
+
+    // Disable copy
+    SegmentCache(const SegmentCache&) = delete;
+    SegmentCache& operator=(const SegmentCache&) = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
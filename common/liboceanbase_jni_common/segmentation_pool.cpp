@@ -0,0 +1,177 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Work-Stealing Segmentation Pool Implementation
+ */
+
+#include "segmentation_pool.h"
+#include <system_error>
+
+namespace oceanbase {
+namespace jni {
+
+// Pool whose worker is the calling thread, if any
+static thread_local const SegmentationPool* current_pool = nullptr;
+
+/**
+ * Jobs of one run() call, waited for by the submitting thread
+ */
+struct SegmentationPool::Batch {
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    size_t remaining;
+
+    explicit Batch(size_t jobs) : remaining(jobs) {}
+};
+
+SegmentationPool::SegmentationPool(size_t threads)
+    : next_worker_(0), pending_(0), stopping_(false), jobs_(0), steals_(0), inline_jobs_(0) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(new Worker());
+    }
+    // The workers wait for this lock before touching workers_
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    for (size_t i = 0; i < threads; ++i) {
+        try {
+            workers_[i]->thread = std::thread(&SegmentationPool::work, this, i);
+        } catch (const std::system_error&) {
+            // Keep the workers that started
+            workers_.resize(i);
+            break;
+        }
+    }
+}
+
+SegmentationPool::~SegmentationPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (std::unique_ptr<Worker>& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+bool SegmentationPool::is_worker_thread() const {
+    return current_pool == this;
+}
+
+int SegmentationPool::run(const Job& job) {
+    std::vector<Job> jobs(1, job);
+    return run(jobs);
+}
+
+int SegmentationPool::run(const std::vector<Job>& jobs) {
+    std::vector<int> results(jobs.size(), 0);
+    if (is_worker_thread() || workers_.empty()) {
+        // Waiting on a worker could leave every worker waiting for the others
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            results[i] = jobs[i]();
+        }
+        inline_jobs_.fetch_add(jobs.size(), std::memory_order_relaxed);
+    } else if (!jobs.empty()) {
+        Batch batch(jobs.size());
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            Task task;
+            task.job = &jobs[i];
+            task.result = &results[i];
+            task.batch = &batch;
+            Worker& worker = *workers_[next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size()];
+            {
+                // Counted before it becomes visible: a worker taking it at once
+                // must not bring pending_ below zero
+                std::lock_guard<std::mutex> sleep_lock(sleep_mutex_);
+                pending_.fetch_add(1, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                worker.tasks.push_back(task);
+            }
+            sleep_cv_.notify_one();
+        }
+        std::unique_lock<std::mutex> lock(batch.mutex);
+        batch.done_cv.wait(lock, [&batch]() { return batch.remaining == 0; });
+    }
+
+    for (int result : results) {
+        if (result != 0) {
+            return result;
+        }
+    }
+    return 0;
+}
+
+SegmentationPool::Stats SegmentationPool::get_stats() const {
+    Stats stats;
+    stats.jobs = jobs_.load(std::memory_order_relaxed);
+    stats.steals = steals_.load(std::memory_order_relaxed);
+    stats.inline_jobs = inline_jobs_.load(std::memory_order_relaxed);
+    stats.pending = pending_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void SegmentationPool::work(size_t index) {
+    current_pool = this;
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    Task task;
+    while (true) {
+        if (pop(index, task) || steal(index, task)) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.wait(lock, [this]() { return stopping_ || pending_.load(std::memory_order_relaxed) > 0; });
+        if (stopping_ && pending_.load(std::memory_order_relaxed) == 0) {
+            break;
+        }
+    }
+    current_pool = nullptr;
+}
+
+bool SegmentationPool::pop(size_t index, Task& task) {
+    Worker& worker = *workers_[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = worker.tasks.back();
+    worker.tasks.pop_back();
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool SegmentationPool::steal(size_t index, Task& task) {
+    for (size_t i = 1; i < workers_.size(); ++i) {
+        Worker& victim = *workers_[(index + i) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void SegmentationPool::execute(const Task& task) {
+    *task.result = (*task.job)();
+    jobs_.fetch_add(1, std::memory_order_relaxed);
+    Batch& batch = *task.batch;
+    std::lock_guard<std::mutex> lock(batch.mutex);
+    if (--batch.remaining == 0) {
+        batch.done_cv.notify_one();
+    }
+}
+
+} // namespace jni
+} // namespace oceanbase
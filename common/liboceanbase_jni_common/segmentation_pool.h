@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Work-Stealing Segmentation Pool
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace oceanbase {
+namespace jni {
+
+/**
+ * Segmentation Pool
+ * @brief Fixed set of threads that run segmentation jobs for the scan threads
+ * @details Without the pool every database worker that segments a document
+ * attaches to the JVM, which can be hundreds of Java threads, each with its
+ * own analyzer state. With OCEANBASE_JNI_POOL the bridges hand the JNI part
+ * of segmentation to these threads and wait; a worker attaches the first
+ * time it calls into Java and stays attached until the pool is destroyed,
+ * so the number of attached threads is bounded by the pool size.
+ * Each worker has its own deque: jobs are dealt round-robin, a worker takes
+ * its newest job first and steals the oldest job of another worker when its
+ * own deque is empty, so the parts of one batch spread over all cores.
+ * A job submitted from a worker thread runs inline, so jobs may nest.
+ * All methods may be called from any thread.
+ */
+class SegmentationPool {
+public:
+    /**
+     * A job returns an OBP_* code
+     */
+    typedef std::function<int()> Job;
+
+    /**
+     * Counters since the pool was created
+     */
+    struct Stats {
+        uint64_t jobs;         // Jobs run by the workers
+        uint64_t steals;       // Jobs taken from another worker's deque
+        uint64_t inline_jobs;  // Jobs run by the submitting thread
+        uint64_t pending;      // Jobs queued and not yet taken by a worker
+    };
+
+    /**
+     * Start the workers
+     * @param threads Number of workers, 0 = one per core
+     * @details If the system refuses some threads the pool keeps those that
+     * started; without any, jobs run on the submitting thread
+     */
+    explicit SegmentationPool(size_t threads);
+
+    /**
+     * Stop the workers once their queued jobs are done, and join them
+     */
+    ~SegmentationPool();
+
+    /**
+     * Get the number of workers that started
+     */
+    size_t thread_count() const { return workers_.size(); }
+
+    /**
+     * Run one job on a worker and wait for it
+     * @return The job's result
+     */
+    int run(const Job& job);
+
+    /**
+     * Run jobs on the workers and wait for all of them
+     * @return OBP_SUCCESS, or the result of the first failed job in input order
+     */
+    int run(const std::vector<Job>& jobs);
+
+    /**
+     * Check whether the calling thread is a worker of this pool
+     */
+    bool is_worker_thread() const;
+
+    /**
+     * Get the counters
+     */
+    Stats get_stats() const;
+
+private:
+    struct Batch;
+
+    struct Task {
+        const Job* job;
+        int* result;
+        Batch* batch;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> next_worker_;
+    // Tasks pushed but not yet taken, incremented under sleep_mutex_ before the push
+    std::atomic<size_t> pending_;
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    bool stopping_;
+    std::atomic<uint64_t> jobs_;
+    std::atomic<uint64_t> steals_;
+    std::atomic<uint64_t> inline_jobs_;
+
+    /**
+     * Worker loop: own deque, then steal, then sleep
+     */
+    void work(size_t index);
+
+    /**
+     * Take the newest task of a worker's own deque
+     */
+    bool pop(size_t index, Task& task);
+
+    /**
+     * Take the oldest task of another worker's deque
+     */
+    bool steal(size_t index, Task& task);
+
+    /**
+     * Run a task and signal its batch
+     */
+    void execute(const Task& task);
+
+    // Disable copy
+    SegmentationPool(const SegmentationPool&) = delete;
+    SegmentationPool& operator=(const SegmentationPool&) = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Segmenter Backend Implementation
+ */
+
+#include "segmenter_backend.h"
+#include "jni_log.h"
+#include "jni_manager.h"
+#include "utf8_kernel.h"
+#include "oceanbase/ob_plugin_ftparser.h"
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace oceanbase {
+namespace jni {
+
+namespace {
+
+typedef std::map<std::pair<std::string, std::string>, SegmenterBackendRegistry::Factory> FactoryMap;
+
+// Constructed on first use, so backends may register from static initializers
+std::mutex& registry_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+FactoryMap& registry_factories() {
+    static FactoryMap factories;
+    return factories;
+}
+
+} // anonymous namespace
+
+int SegmenterBackend::segment_batch(const std::vector<TextSpan>& docs, std::vector<PackedTokenBuffer>& results) {
+    results.clear();
+    results.resize(docs.size());
+    int ret = OBP_SUCCESS;
+    for (size_t i = 0; i < docs.size() && ret == OBP_SUCCESS; ++i) {
+        ret = segment(docs[i].data, docs[i].length, results[i]);
+    }
+    return ret;
+}
+
+int SegmenterBackend::segment_uncached(const char* text, size_t length, PackedTokenBuffer& tokens) {
+    return segment(text, length, tokens);
+}
+
+int SegmenterBackend::check_document(const char* text, size_t length) {
+    if (Utf8Kernel::validate(text, length)) {
+        return OBP_SUCCESS;
+    }
+    if (JNIConfigUtils::get_config().reject_invalid_utf8) {
+        JNI_LOG_WARN("[%s] Document is not valid UTF-8 (%zu bytes), rejected", name(), length);
+        return OBP_INVALID_ARGUMENT;
+    }
+    JNI_LOG_WARN("[%s] Document is not valid UTF-8 (%zu bytes), malformed sequences are skipped", name(), length);
+    return OBP_SUCCESS;
+}
+
+bool SegmenterBackend::should_stream(size_t /*length*/) const {
+    return false;
+}
+
+int SegmenterBackend::open_cursor(const char* /*text*/, size_t /*length*/, std::unique_ptr<SegmenterCursor>& cursor) {
+    cursor.reset();
+    JNI_LOG_ERROR("[%s] Backend does not support streaming", name());
+    return OBP_PLUGIN_ERROR;
+}
+
+void SegmenterBackendRegistry::register_backend(const std::string& plugin_name, const std::string& backend_name,
+                                                Factory factory) {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    registry_factories()[std::make_pair(plugin_name, backend_name)] = factory;
+}
+
+std::shared_ptr<SegmenterBackend> SegmenterBackendRegistry::create(const std::string& plugin_name,
+                                                                   const std::string& backend_name) {
+    Factory factory = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex());
+        FactoryMap::const_iterator it = registry_factories().find(std::make_pair(plugin_name, backend_name));
+        if (it != registry_factories().end()) {
+            factory = it->second;
+        }
+    }
+    return factory ? factory() : std::shared_ptr<SegmenterBackend>();
+}
+
+std::string SegmenterBackendRegistry::backend_names(const std::string& plugin_name) {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    std::string names;
+    for (FactoryMap::const_iterator it = registry_factories().begin(); it != registry_factories().end(); ++it) {
+        if (it->first.first == plugin_name) {
+            if (!names.empty()) {
+                names += ",";
+            }
+            names += it->first.second;
+        }
+    }
+    return names;
+}
+
+} // namespace jni
+} // namespace oceanbase
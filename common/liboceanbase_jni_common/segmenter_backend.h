@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Segmenter Backend Interface
+ */
+
+#pragma once
+
+#include "packed_token_buffer.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace oceanbase {
+namespace jni {
+
+/**
+ * Segmenter Cursor
+ * @brief Incremental token source for a document too large to segment up front
+ * @details Owned by one scan; releases its engine-side state when destroyed
+ */
+class SegmenterCursor {
+public:
+    virtual ~SegmenterCursor() {}
+    
+    /**
+     * Fetch the next chunk of tokens
+     * @param tokens Output buffer, replaced with the chunk; empty once the document is exhausted
+     * @return OBP_SUCCESS on success, error code on failure
+     */
+    virtual int next_chunk(PackedTokenBuffer& tokens) = 0;
+};
+
+/**
+ * Segmenter Backend
+ * @brief Engine behind a parser plugin's scan_begin/next_token
+ * @details A plugin keeps one backend, shared by all threads, and selects
+ * it by name through OCEANBASE_<PLUGIN>_BACKEND (for example
+ * OCEANBASE_THAI_FTPARSER_BACKEND). The Java segmenters reached through JNI
+ * are the "jvm" backend of every plugin; other engines register under
+ * their own names with SegmenterBackendRegistry.
+ * All methods return OBP_* codes.
+ */
+class SegmenterBackend {
+public:
+    virtual ~SegmenterBackend() {}
+    
+    /**
+     * Get the name the backend is registered under
+     */
+    virtual const char* name() const = 0;
+    
+    /**
+     * Initialize the backend, called before every scan and cheap once done
+     * @return OBP_SUCCESS on success, error code on failure
+     */
+    virtual int initialize() = 0;
+    
+    /**
+     * Segment a UTF-8 document into packed tokens
+     * @param text Input UTF-8 bytes, must stay valid during the call
+     * @param length Length of the input in bytes
+     * @param tokens Output buffer, replaced with the document's tokens
+     * @return OBP_SUCCESS on success, error code on failure
+     */
+    virtual int segment(const char* text, size_t length, PackedTokenBuffer& tokens) = 0;
+    
+    /**
+     * Segment many documents
+     * @param docs Input UTF-8 documents, must stay valid during the call
+     * @param results Output buffers, one per document in input order
+     * @return OBP_SUCCESS on success, error code on failure
+     * @details The default calls segment() once per document
+     */
+    virtual int segment_batch(const std::vector<TextSpan>& docs, std::vector<PackedTokenBuffer>& results);
+    
+    /**
+     * Segment a document past any result cache, so that the engine does the work
+     * @details Used by the warm-up replay; the default calls segment()
+     */
+    virtual int segment_uncached(const char* text, size_t length, PackedTokenBuffer& tokens);
+    
+    /**
+     * Check that a document is well-formed UTF-8 before it is segmented
+     * @return OBP_SUCCESS, or OBP_INVALID_ARGUMENT when invalid documents are rejected
+     * @details The default validates with Utf8Kernel and follows OCEANBASE_JNI_REJECT_INVALID_UTF8
+     */
+    virtual int check_document(const char* text, size_t length);
+    
+    /**
+     * Check whether a document should be streamed through open_cursor()
+     * @details The default never streams
+     */
+    virtual bool should_stream(size_t length) const;
+    
+    /**
+     * Open a cursor that yields the tokens of a document chunk by chunk
+     * @param text Input UTF-8 bytes, must stay valid until the cursor is destroyed
+     * @param length Length of the input in bytes
+     * @param cursor Output cursor
+     * @return OBP_SUCCESS on success, error code on failure
+     * @details Only called when should_stream() is true; the default fails
+     */
+    virtual int open_cursor(const char* text, size_t length, std::unique_ptr<SegmenterCursor>& cursor);
+};
+
+/**
+ * Segmenter Backend Registry
+ * @brief Backend factories per plugin and backend name
+ */
+class SegmenterBackendRegistry {
+public:
+    typedef std::shared_ptr<SegmenterBackend> (*Factory)();
+    
+    /**
+     * Register (or replace) the factory of a backend
+     * @param plugin_name Plugin the backend serves, e.g. "thai_ftparser"
+     * @param backend_name Name used in configuration, e.g. "jvm"
+     */
+    static void register_backend(const std::string& plugin_name, const std::string& backend_name, Factory factory);
+    
+    /**
+     * Create a backend
+     * @return The backend, or nullptr if no such backend is registered for the plugin
+     */
+    static std::shared_ptr<SegmenterBackend> create(const std::string& plugin_name, const std::string& backend_name);
+    
+    /**
+     * Get the names of the backends registered for a plugin, comma separated
+     */
+    static std::string backend_names(const std::string& plugin_name);
+
+private:
+    // Disable construction
+    SegmenterBackendRegistry() = delete;
+    ~SegmenterBackendRegistry() = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Token Frequency Table Implementation
+ */
+
+#include "token_frequency_table.h"
+#include "packed_token_buffer.h"
+#include "scan_arena.h"
+#include <cstring>
+#include <new>
+
+namespace oceanbase {
+namespace jni {
+
+TokenFrequencyTable::TokenFrequencyTable()
+    : slots_(nullptr), entries_(nullptr), slot_mask_(0)
+    , entry_capacity_(0), entry_count_(0), read_pos_(0), arena_(nullptr) {
+}
+
+uint64_t TokenFrequencyTable::hash_bytes(const char* data, size_t length) {
+    // 8 bytes per multiply-xorshift round, tokens are short
+    uint64_t hash = 0x9E3779B97F4A7C15ULL ^ length;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+        hash ^= hash >> 31;
+        data += 8;
+        length -= 8;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data, length);
+    hash = (hash ^ tail) * 0x94D049BB133111EBULL;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+int TokenFrequencyTable::ensure_capacity(size_t token_count) {
+    size_t slot_count = 16;
+    while (slot_count < token_count * 2) {
+        slot_count *= 2;
+    }
+    if (token_count <= entry_capacity_ && slot_count <= slot_mask_ + 1) {
+        return 0;
+    }
+    
+    // One allocation for both arrays, entries first for alignment
+    size_t bytes = token_count * sizeof(Entry) + slot_count * sizeof(uint32_t);
+    char* memory = nullptr;
+    std::unique_ptr<char[]> owned;
+    if (arena_) {
+        memory = static_cast<char*>(arena_->allocate(bytes));
+    } else {
+        owned.reset(new (std::nothrow) char[bytes]);
+        memory = owned.get();
+    }
+    if (!memory) {
+        return -1;
+    }
+    
+    owned_ = std::move(owned);
+    entries_ = reinterpret_cast<Entry*>(memory);
+    slots_ = reinterpret_cast<uint32_t*>(memory + token_count * sizeof(Entry));
+    entry_capacity_ = token_count;
+    slot_mask_ = slot_count - 1;
+    return 0;
+}
+
+int TokenFrequencyTable::build(PackedTokenBuffer& tokens) {
+    entry_count_ = 0;
+    read_pos_ = 0;
+    
+    size_t token_count = tokens.token_count();
+    if (token_count == 0) {
+        return 0;
+    }
+    if (token_count >= UINT32_MAX) {
+        return -1;
+    }
+    if (ensure_capacity(token_count) != 0) {
+        return -1;
+    }
+    memset(slots_, 0, (slot_mask_ + 1) * sizeof(uint32_t));
+    
+    const char* word = nullptr;
+    int64_t word_len = 0;
+    int64_t char_cnt = 0;
+    tokens.rewind();
+    while (tokens.next(word, word_len, char_cnt)) {
+        uint64_t hash = hash_bytes(word, static_cast<size_t>(word_len));
+        size_t slot = static_cast<size_t>(hash) & slot_mask_;
+        
+        while (true) {
+            uint32_t index = slots_[slot];
+            if (index == 0) {
+                Entry& entry = entries_[entry_count_];
+                entry.word = word;
+                entry.word_len = word_len;
+                entry.char_cnt = char_cnt;
+                entry.word_freq = 1;
+                entry.hash = hash;
+                slots_[slot] = static_cast<uint32_t>(++entry_count_);
+                break;
+            }
+            Entry& entry = entries_[index - 1];
+            if (entry.hash == hash && entry.word_len == word_len &&
+                memcmp(entry.word, word, static_cast<size_t>(word_len)) == 0) {
+                entry.word_freq++;
+                break;
+            }
+            slot = (slot + 1) & slot_mask_;
+        }
+    }
+    tokens.rewind();
+    return 0;
+}
+
+bool TokenFrequencyTable::next(const char*& word, int64_t& word_len, int64_t& char_cnt, int64_t& word_freq) {
+    if (read_pos_ >= entry_count_) {
+        return false;
+    }
+    
+    const Entry& entry = entries_[read_pos_++];
+    word = entry.word;
+    word_len = entry.word_len;
+    char_cnt = entry.char_cnt;
+    word_freq = entry.word_freq;
+    return true;
+}
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Token Frequency Table
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace oceanbase {
+namespace jni {
+
+class PackedTokenBuffer;
+class ScanArena;
+
+/**
+ * Token Frequency Table
+ * @brief Aggregates identical tokens of a PackedTokenBuffer
+ * @details Open addressing with linear probing over a power-of-two slot
+ * array kept at most half full. Both arrays are sized from the token count
+ * before inserting, so a build never rehashes. Entries point into the
+ * source buffer (no token bytes are copied), which must therefore stay
+ * unchanged while the table is read. Distinct tokens are returned in
+ * order of first occurrence.
+ */
+class TokenFrequencyTable {
+public:
+    TokenFrequencyTable();
+    
+    /**
+     * Take storage from a scan arena instead of the heap
+     * @param arena Arena outliving the table's use, nullptr for the heap
+     */
+    void set_arena(ScanArena* arena) { arena_ = arena; }
+    
+    /**
+     * Replace the content with the aggregated tokens of a buffer
+     * @return 0 on success, -1 on allocation failure
+     */
+    int build(PackedTokenBuffer& tokens);
+    
+    /**
+     * Read the next distinct token, advancing the read cursor
+     * @param word Output pointer to the token bytes (inside the source buffer)
+     * @param word_len Output token length in bytes
+     * @param char_cnt Output token length in characters
+     * @param word_freq Output number of occurrences
+     * @return false when all distinct tokens have been read
+     */
+    bool next(const char*& word, int64_t& word_len, int64_t& char_cnt, int64_t& word_freq);
+    
+    /**
+     * Number of distinct tokens
+     */
+    size_t distinct_count() const { return entry_count_; }
+
+private:
+    struct Entry {
+        const char* word;
+        int64_t word_len;
+        int64_t char_cnt;
+        int64_t word_freq;
+        uint64_t hash;
+    };
+    
+    static uint64_t hash_bytes(const char* data, size_t length);
+    
+    int ensure_capacity(size_t token_count);
+    
+    // slots_ hold entry index + 1, 0 marks an empty slot
+    uint32_t* slots_;
+    Entry* entries_;
+    size_t slot_mask_;
+    size_t entry_capacity_;
+    size_t entry_count_;
+    size_t read_pos_;
+    ScanArena* arena_;
+    std::unique_ptr<char[]> owned_;
+    
+    // Disable copy
+    TokenFrequencyTable(const TokenFrequencyTable&) = delete;
+    TokenFrequencyTable& operator=(const TokenFrequencyTable&) = delete;
+};
+
+} // namespace jni
+} // namespace oceanbase
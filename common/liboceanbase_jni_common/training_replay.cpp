@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Training Corpus Replay Implementation
+ */
+
+#include "training_replay.h"
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace oceanbase {
+namespace jni {
+
+TrainingReplayReport::TrainingReplayReport()
+    : documents(0), bytes(0), elapsed_ms(0), first_ns_per_byte(0), last_ns_per_byte(0),
+      settled(false), cancelled(false), result(0) {
+}
+
+TrainingReplay::TrainingReplay(const Options& options) : options_(options) {
+}
+
+int TrainingReplay::load_corpus(const std::string& path, std::vector<std::string>& documents, std::string& error) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        error = "cannot open " + path + ": " + strerror(errno);
+        return -1;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);
+        }
+        if (!line.empty()) {
+            documents.push_back(line);
+        }
+    }
+    if (documents.empty()) {
+        error = path + " holds no documents";
+        return -1;
+    }
+    return 0;
+}
+
+int TrainingReplay::run(const std::vector<std::string>& corpus, const SegmentFunction& segment,
+                        TrainingReplayReport& report) const {
+    typedef std::chrono::steady_clock Clock;
+    report = TrainingReplayReport();
+    if (corpus.empty() || options_.max_documents == 0 || options_.window_documents == 0) {
+        return 0;
+    }
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point window_start = start;
+    size_t window_bytes = 0;
+    size_t window_documents = 0;
+    size_t windows = 0;
+    size_t stable = 0;
+    double previous = 0;
+    PackedTokenBuffer tokens;
+
+    while (report.documents < options_.max_documents) {
+        if (options_.cancel && options_.cancel()) {
+            report.cancelled = true;
+            break;
+        }
+        const std::string& doc = corpus[report.documents % corpus.size()];
+        int ret = segment(doc.data(), doc.size(), tokens);
+        if (ret != 0) {
+            report.result = ret;
+            break;
+        }
+        report.documents++;
+        report.bytes += doc.size();
+        window_bytes += doc.size();
+        if (++window_documents < options_.window_documents) {
+            continue;
+        }
+
+        // Window complete: compare its cost per byte with the previous one
+        Clock::time_point now = Clock::now();
+        double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - window_start).count());
+        double cost = window_bytes > 0 ? ns / static_cast<double>(window_bytes) : 0;
+        if (windows == 0) {
+            report.first_ns_per_byte = cost;
+        } else if (previous > 0 && std::fabs(cost - previous) <= options_.stable_tolerance * previous) {
+            stable++;
+        } else {
+            stable = 0;
+        }
+        report.last_ns_per_byte = cost;
+        previous = cost;
+        windows++;
+        window_start = now;
+        window_bytes = 0;
+        window_documents = 0;
+
+        if (stable >= options_.stable_windows && report.documents >= options_.min_documents) {
+            report.settled = true;
+            break;
+        }
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count() >= options_.max_millis) {
+            break;
+        }
+    }
+    report.elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+    return report.result;
+}
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - Training Corpus Replay
+ */
+
+#pragma once
+
+#include "packed_token_buffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace oceanbase {
+namespace jni {
+
+/**
+ * Training Replay Report
+ */
+struct TrainingReplayReport {
+    size_t documents;          // Documents segmented
+    size_t bytes;              // Bytes segmented
+    int64_t elapsed_ms;        // Wall time of the replay
+    double first_ns_per_byte;  // Cost in the first window
+    double last_ns_per_byte;   // Cost in the last complete window
+    bool settled;              // Stopped because the cost stopped falling, not at a limit
+    bool cancelled;            // Stopped because Options::cancel returned true
+    int result;                // First error returned by the segmenter, 0 if none
+
+    TrainingReplayReport();
+};
+
+/**
+ * Training Replay
+ * @brief Replays a training corpus through a segmenter until its hot path is compiled
+ * @details Right after the JVM starts, Lucene's analysis code runs
+ * interpreted or C1-compiled, and the first tens of thousands of documents
+ * are several times slower than in steady state. The replay cycles through
+ * a corpus (the plugin's bundled sentences, or a file given by
+ * OCEANBASE_JNI_WARMUP_CORPUS) in windows of window_documents and measures
+ * the cost per byte of each window. Past min_documents (a plateau before
+ * that is usually the interpreter, before C2 has compiled anything) it
+ * stops once stable_windows windows in a row are each within
+ * stable_tolerance of the previous one, and in any case at max_documents
+ * or max_millis.
+ */
+class TrainingReplay {
+public:
+    struct Options {
+        size_t min_documents;
+        size_t max_documents;     // 0 disables the replay
+        int64_t max_millis;
+        size_t window_documents;
+        size_t stable_windows;
+        double stable_tolerance;  // Relative change between windows, e.g. 0.1 = 10%
+        std::function<bool()> cancel;  // Optional, checked before each document
+
+        Options()
+            : min_documents(10000), max_documents(50000), max_millis(60000), window_documents(1000),
+              stable_windows(3), stable_tolerance(0.1) {}
+    };
+
+    /**
+     * Segments one document without any result cache, returning an OBP_* code
+     */
+    typedef std::function<int(const char*, size_t, PackedTokenBuffer&)> SegmentFunction;
+
+    explicit TrainingReplay(const Options& options);
+
+    /**
+     * Load a corpus file, one document per line, empty lines skipped
+     * @param documents Output documents (appended)
+     * @param error Output description of the failure
+     * @return 0 on success, -1 on failure
+     */
+    static int load_corpus(const std::string& path, std::vector<std::string>& documents, std::string& error);
+
+    /**
+     * Replay a corpus through a segmenter
+     * @param report Output summary
+     * @return 0 on success, otherwise the first error returned by segment
+     */
+    int run(const std::vector<std::string>& corpus, const SegmentFunction& segment, TrainingReplayReport& report) const;
+
+private:
+    Options options_;
+};
+
+} // namespace jni
+} // namespace oceanbase
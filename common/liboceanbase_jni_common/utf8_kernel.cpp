@@ -0,0 +1,398 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - UTF-8 Kernel Implementation
+ */
+
+#include "utf8_kernel.h"
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define OBP_UTF8_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace oceanbase {
+namespace jni {
+
+namespace {
+
+// Validate and count in one pass; *count is only set for valid input
+typedef bool (*ValidateCountFn)(const unsigned char* text, size_t length, int64_t* count);
+
+// Shorter inputs are not worth a vector setup
+const size_t MIN_VECTOR_LENGTH = 16;
+// Counting short tokens is cheapest with the plain loop alone
+const size_t MIN_VECTOR_COUNT_LENGTH = 64;
+
+bool validate_count_scalar(const unsigned char* text, size_t length, int64_t* count) {
+    int64_t chars = 0;
+    size_t i = 0;
+    
+    while (i < length) {
+        unsigned char c = text[i];
+        if (c < 0x80) {
+            i += 1;
+            chars++;
+            continue;
+        }
+        
+        // Sequence length and allowed range of the second byte (RFC 3629 table)
+        size_t seq_len = 0;
+        unsigned char lower = 0x80;
+        unsigned char upper = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            seq_len = 2;
+        } else if (c == 0xE0) {
+            seq_len = 3;
+            lower = 0xA0;    // overlong
+        } else if (c == 0xED) {
+            seq_len = 3;
+            upper = 0x9F;    // surrogates
+        } else if (c >= 0xE1 && c <= 0xEF) {
+            seq_len = 3;
+        } else if (c == 0xF0) {
+            seq_len = 4;
+            lower = 0x90;    // overlong
+        } else if (c == 0xF4) {
+            seq_len = 4;
+            upper = 0x8F;    // above U+10FFFF
+        } else if (c >= 0xF1 && c <= 0xF3) {
+            seq_len = 4;
+        } else {
+            return false;
+        }
+        
+        if (length - i < seq_len || text[i + 1] < lower || text[i + 1] > upper) {
+            return false;
+        }
+        for (size_t k = 2; k < seq_len; ++k) {
+            if ((text[i + k] & 0xC0) != 0x80) {
+                return false;
+            }
+        }
+        i += seq_len;
+        chars++;
+    }
+    
+    if (count) {
+        *count = chars;
+    }
+    return true;
+}
+
+#ifdef OBP_UTF8_KERNEL_X86
+
+/*
+ * Vector validation uses the lookup algorithm of Keiser and Lemire
+ * ("Validating UTF-8 In Less Than One Instruction Per Byte"): three nibble
+ * table lookups classify every byte pair, and a saturating subtraction
+ * marks where the 3rd/4th byte of a sequence must be a continuation.
+ * Characters are counted as the bytes that are not continuation bytes.
+ */
+
+const char TOO_SHORT = 1 << 0;
+const char TOO_LONG = 1 << 1;
+const char OVERLONG_3 = 1 << 2;
+const char TOO_LARGE = 1 << 3;
+const char SURROGATE = 1 << 4;
+const char OVERLONG_2 = 1 << 5;
+const char TOO_LARGE_1000 = 1 << 6;
+const char OVERLONG_4 = 1 << 6;
+const char TWO_CONTS = static_cast<char>(1 << 7);
+const char CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+__attribute__((target("sse4.1")))
+__m128i byte_1_high_table_128() {
+    return _mm_setr_epi8(
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2,
+        TOO_SHORT,
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+}
+
+__attribute__((target("sse4.1")))
+__m128i byte_1_low_table_128() {
+    return _mm_setr_epi8(
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+        CARRY | OVERLONG_2,
+        CARRY,
+        CARRY,
+        CARRY | TOO_LARGE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000);
+}
+
+__attribute__((target("sse4.1")))
+__m128i byte_2_high_table_128() {
+    return _mm_setr_epi8(
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+}
+
+__attribute__((target("sse4.1")))
+bool validate_count_sse4(const unsigned char* text, size_t length, int64_t* count) {
+    const __m128i byte_1_high = byte_1_high_table_128();
+    const __m128i byte_1_low = byte_1_low_table_128();
+    const __m128i byte_2_high = byte_2_high_table_128();
+    const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+    const __m128i high_bit = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m128i third_byte_floor = _mm_set1_epi8(static_cast<char>(0xE0 - 0x80));
+    const __m128i fourth_byte_floor = _mm_set1_epi8(static_cast<char>(0xF0 - 0x80));
+    const __m128i last_continuation = _mm_set1_epi8(-65);  // 0xBF as signed
+    // A lead byte this close to the end of the block needs the next block
+    const __m128i incomplete_max = _mm_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+    
+    __m128i error = _mm_setzero_si128();
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    int64_t chars = 0;
+    unsigned char tail[16];
+    
+    for (size_t i = 0; i < length; i += 16) {
+        __m128i input;
+        if (length - i >= 16) {
+            input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        } else {
+            // Zero padding is ASCII: it ends any open sequence and is not counted below
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, text + i, length - i);
+            input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tail));
+            chars -= static_cast<int64_t>(16 - (length - i));
+        }
+        
+        if (_mm_movemask_epi8(input) == 0) {
+            error = _mm_or_si128(error, prev_incomplete);
+        } else {
+            __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+            __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+            __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+            
+            __m128i special = _mm_and_si128(
+                _mm_and_si128(
+                    _mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble_mask)),
+                    _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble_mask))),
+                _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble_mask)));
+            __m128i must_be_continuation = _mm_and_si128(
+                _mm_or_si128(_mm_subs_epu8(prev2, third_byte_floor), _mm_subs_epu8(prev3, fourth_byte_floor)),
+                high_bit);
+            error = _mm_or_si128(error, _mm_xor_si128(must_be_continuation, special));
+        }
+        prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+        prev_input = input;
+        
+        chars += __builtin_popcount(static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpgt_epi8(input, last_continuation))));
+    }
+    
+    error = _mm_or_si128(error, prev_incomplete);
+    if (!_mm_testz_si128(error, error)) {
+        return false;
+    }
+    if (count) {
+        *count = chars;
+    }
+    return true;
+}
+
+__attribute__((target("avx2")))
+__m256i prev_bytes_256(__m256i input, __m256i prev_input, int n) {
+    // Bytes shifted in across the 128-bit lane boundary
+    __m256i carried = _mm256_permute2x128_si256(prev_input, input, 0x21);
+    switch (n) {
+        case 1: return _mm256_alignr_epi8(input, carried, 15);
+        case 2: return _mm256_alignr_epi8(input, carried, 14);
+        default: return _mm256_alignr_epi8(input, carried, 13);
+    }
+}
+
+__attribute__((target("avx2")))
+bool validate_count_avx2(const unsigned char* text, size_t length, int64_t* count) {
+    const __m256i byte_1_high = _mm256_broadcastsi128_si256(byte_1_high_table_128());
+    const __m256i byte_1_low = _mm256_broadcastsi128_si256(byte_1_low_table_128());
+    const __m256i byte_2_high = _mm256_broadcastsi128_si256(byte_2_high_table_128());
+    const __m256i nibble_mask = _mm256_set1_epi8(0x0F);
+    const __m256i high_bit = _mm256_set1_epi8(static_cast<char>(0x80));
+    const __m256i third_byte_floor = _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80));
+    const __m256i fourth_byte_floor = _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80));
+    const __m256i last_continuation = _mm256_set1_epi8(-65);  // 0xBF as signed
+    const __m256i incomplete_max = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+    
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    int64_t chars = 0;
+    unsigned char tail[32];
+    
+    for (size_t i = 0; i < length; i += 32) {
+        __m256i input;
+        if (length - i >= 32) {
+            input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        } else {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, text + i, length - i);
+            input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail));
+            chars -= static_cast<int64_t>(32 - (length - i));
+        }
+        
+        if (_mm256_movemask_epi8(input) == 0) {
+            error = _mm256_or_si256(error, prev_incomplete);
+        } else {
+            __m256i prev1 = prev_bytes_256(input, prev_input, 1);
+            __m256i prev2 = prev_bytes_256(input, prev_input, 2);
+            __m256i prev3 = prev_bytes_256(input, prev_input, 3);
+            
+            __m256i special = _mm256_and_si256(
+                _mm256_and_si256(
+                    _mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble_mask)),
+                    _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, nibble_mask))),
+                _mm256_shuffle_epi8(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble_mask)));
+            __m256i must_be_continuation = _mm256_and_si256(
+                _mm256_or_si256(_mm256_subs_epu8(prev2, third_byte_floor),
+                                _mm256_subs_epu8(prev3, fourth_byte_floor)),
+                high_bit);
+            error = _mm256_or_si256(error, _mm256_xor_si256(must_be_continuation, special));
+        }
+        prev_incomplete = _mm256_subs_epu8(input, incomplete_max);
+        prev_input = input;
+        
+        chars += __builtin_popcount(static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_cmpgt_epi8(input, last_continuation))));
+    }
+    
+    error = _mm256_or_si256(error, prev_incomplete);
+    if (!_mm256_testz_si256(error, error)) {
+        return false;
+    }
+    if (count) {
+        *count = chars;
+    }
+    return true;
+}
+
+#endif // OBP_UTF8_KERNEL_X86
+
+ValidateCountFn select_impl(Utf8Kernel::Isa isa) {
+#ifdef OBP_UTF8_KERNEL_X86
+    switch (isa) {
+        case Utf8Kernel::ISA_AVX2: return validate_count_avx2;
+        case Utf8Kernel::ISA_SSE4: return validate_count_sse4;
+        default: break;
+    }
+#else
+    (void)isa;
+#endif
+    return validate_count_scalar;
+}
+
+ValidateCountFn active_impl() {
+    static const ValidateCountFn impl = select_impl(Utf8Kernel::detected_isa());
+    return impl;
+}
+
+bool run_validate(ValidateCountFn impl, const char* text, size_t length) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text);
+    if (length < MIN_VECTOR_LENGTH) {
+        return validate_count_scalar(bytes, length, nullptr);
+    }
+    return impl(bytes, length, nullptr);
+}
+
+int64_t run_count(ValidateCountFn impl, const char* text, size_t length) {
+    // The plain loop is exact for any input; the vector pass is only faster
+    // when it can count and prove the input valid at the same time
+    int64_t count = 0;
+    if (length >= MIN_VECTOR_COUNT_LENGTH && impl != validate_count_scalar &&
+        impl(reinterpret_cast<const unsigned char*>(text), length, &count)) {
+        return count;
+    }
+    return Utf8Kernel::count_chars_scalar(text, length);
+}
+
+} // anonymous namespace
+
+Utf8Kernel::Isa Utf8Kernel::detected_isa() {
+#ifdef OBP_UTF8_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return ISA_AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return ISA_SSE4;
+    }
+#endif
+    return ISA_SCALAR;
+}
+
+const char* Utf8Kernel::isa_name(Isa isa) {
+    switch (isa) {
+        case ISA_AVX2: return "avx2";
+        case ISA_SSE4: return "sse4";
+        default: return "scalar";
+    }
+}
+
+bool Utf8Kernel::validate(const char* text, size_t length) {
+    return run_validate(active_impl(), text, length);
+}
+
+int64_t Utf8Kernel::count_chars(const char* text, size_t length) {
+    return run_count(active_impl(), text, length);
+}
+
+bool Utf8Kernel::validate(Isa isa, const char* text, size_t length) {
+    return run_validate(select_impl(isa), text, length);
+}
+
+int64_t Utf8Kernel::count_chars(Isa isa, const char* text, size_t length) {
+    return run_count(select_impl(isa), text, length);
+}
+
+int64_t Utf8Kernel::count_chars_scalar(const char* text, size_t length) {
+    int64_t char_count = 0;
+    const char* p = text;
+    const char* end = p + length;
+    
+    while (p < end) {
+        unsigned char c = *p;
+        
+        if ((c & 0x80) == 0) {
+            p += 1;  // ASCII character
+        } else if ((c & 0xE0) == 0xC0) {
+            p += 2;  // 2-byte UTF-8 character
+        } else if ((c & 0xF0) == 0xE0) {
+            p += 3;  // 3-byte UTF-8 character (most CJK characters)
+        } else if ((c & 0xF8) == 0xF0) {
+            p += 4;  // 4-byte UTF-8 character
+        } else {
+            p += 1;  // Invalid UTF-8, skip
+            continue;  // Don't count invalid characters
+        }
+        
+        char_count++;
+    }
+    
+    return char_count;
+}
+
+} // namespace jni
+} // namespace oceanbase
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase JNI Common Library - UTF-8 Kernel
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace oceanbase {
+namespace jni {
+
+/**
+ * UTF-8 Kernel
+ * @brief Shared UTF-8 validation and character counting for all parsers
+ * @details The implementation is picked once at runtime from the CPU
+ * features (AVX2, SSE4.1 or scalar). Validation follows RFC 3629: no
+ * overlong forms, no surrogates, nothing above U+10FFFF, no truncated
+ * sequences. Validation and counting run in one pass; only input that
+ * fails validation falls back to the scalar counting loop, so counts are
+ * identical to the original parsers for every input.
+ */
+class Utf8Kernel {
+public:
+    enum Isa {
+        ISA_SCALAR = 0,
+        ISA_SSE4 = 1,
+        ISA_AVX2 = 2
+    };
+    
+    /**
+     * Best implementation supported by this CPU
+     */
+    static Isa detected_isa();
+    
+    /**
+     * Printable name of an implementation
+     */
+    static const char* isa_name(Isa isa);
+    
+    /**
+     * Check that a buffer is well-formed UTF-8
+     */
+    static bool validate(const char* text, size_t length);
+    
+    /**
+     * Count UTF-8 characters the way the parsers always have: invalid lead
+     * bytes are skipped and not counted
+     */
+    static int64_t count_chars(const char* text, size_t length);
+    
+    /**
+     * Same as validate(), with an explicit implementation (for tests and benchmarks)
+     * @note The implementation must be supported by this CPU
+     */
+    static bool validate(Isa isa, const char* text, size_t length);
+    
+    /**
+     * Same as count_chars(), with an explicit implementation (for tests and benchmarks)
+     * @note The implementation must be supported by this CPU
+     */
+    static int64_t count_chars(Isa isa, const char* text, size_t length);
+    
+    /**
+     * Original scalar counting loop, the reference for every implementation
+     */
+    static int64_t count_chars_scalar(const char* text, size_t length);
+};
+
+} // namespace jni
+} // namespace oceanbase
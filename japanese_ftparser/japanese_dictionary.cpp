@@ -0,0 +1,211 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Japanese Fulltext Parser Plugin - Memory-mapped IPADIC Dictionary
+ */
+
+#include "japanese_dictionary.h"
+#include <cstring>
+
+namespace oceanbase {
+namespace japanese_ftparser {
+
+static_assert(sizeof(JapaneseDictionaryHeader) == 256, "dictionary header layout");
+static_assert(sizeof(JapaneseTrieNode) == 16, "trie node layout");
+static_assert(sizeof(JapaneseWordEntry) == 12, "word entry layout");
+
+static const char DICTIONARY_MAGIC[8] = {'O', 'B', 'J', 'A', 'D', 'I', 'C', '\0'};
+
+JapaneseDictionary::JapaneseDictionary()
+    : size_(0)
+    , header_(nullptr)
+    , costs_(nullptr)
+    , char_info_(nullptr)
+    , lower_(nullptr)
+    , nodes_(nullptr)
+    , edge_labels_(nullptr)
+    , edge_targets_(nullptr)
+    , entries_(nullptr)
+    , unknown_entries_(nullptr)
+    , stopwords_(nullptr)
+    , strings_(nullptr) {
+}
+
+int JapaneseDictionary::open(const std::string& path, std::string& error) {
+    if (file_.open(path, error) != 0) {
+        return -1;
+    }
+    if (attach(file_.data(), file_.size(), error) != 0) {
+        error = path + ": " + error;
+        file_.close();
+        return -1;
+    }
+    return 0;
+}
+
+int JapaneseDictionary::open_buffer(const char* data, size_t size, std::string& error) {
+    file_.close();
+    return attach(data, size, error);
+}
+
+// Check that count elements of element_size bytes fit at an aligned offset
+static bool section_fits(uint64_t offset, uint64_t count, uint64_t element_size, size_t file_size) {
+    return offset % 8 == 0 && offset <= file_size && count * element_size <= file_size - offset;
+}
+
+int JapaneseDictionary::attach(const char* data, size_t size, std::string& error) {
+    header_ = nullptr;
+    if (size < sizeof(JapaneseDictionaryHeader) || reinterpret_cast<uintptr_t>(data) % 8 != 0) {
+        error = "not a Japanese dictionary file";
+        return -1;
+    }
+
+    const JapaneseDictionaryHeader* header = reinterpret_cast<const JapaneseDictionaryHeader*>(data);
+    if (memcmp(header->magic, DICTIONARY_MAGIC, sizeof(DICTIONARY_MAGIC)) != 0) {
+        error = "not a Japanese dictionary file";
+        return -1;
+    }
+    if (header->version != FORMAT_VERSION || header->header_size != sizeof(JapaneseDictionaryHeader)) {
+        error = "unsupported dictionary format version " + std::to_string(header->version);
+        return -1;
+    }
+    if (header->left_size == 0 || header->right_size == 0 || header->left_size > 32768 ||
+        header->right_size > 32768 || header->node_count == 0 ||
+        !section_fits(header->costs_offset, static_cast<uint64_t>(header->left_size) * header->right_size, 2, size) ||
+        !section_fits(header->char_info_offset, 65536, 1, size) ||
+        !section_fits(header->lower_offset, 65536, 2, size) ||
+        !section_fits(header->nodes_offset, header->node_count, sizeof(JapaneseTrieNode), size) ||
+        !section_fits(header->edge_labels_offset, header->edge_count, 2, size) ||
+        !section_fits(header->edge_targets_offset, header->edge_count, 4, size) ||
+        !section_fits(header->entries_offset, header->entry_count, sizeof(JapaneseWordEntry), size) ||
+        !section_fits(header->unknown_entries_offset, header->unknown_entry_count, sizeof(JapaneseWordEntry), size) ||
+        !section_fits(header->stopwords_offset, header->stopword_count, 4, size) ||
+        !section_fits(header->strings_offset, header->string_bytes, 1, size)) {
+        error = "truncated or corrupt dictionary sections";
+        return -1;
+    }
+    for (uint32_t i = 0; i < MAX_CHAR_CLASSES; ++i) {
+        if (static_cast<uint64_t>(header->unknown_first[i]) + header->unknown_count[i] > header->unknown_entry_count) {
+            error = "corrupt unknown word table";
+            return -1;
+        }
+    }
+
+    const JapaneseTrieNode* nodes = reinterpret_cast<const JapaneseTrieNode*>(data + header->nodes_offset);
+    const uint32_t* targets = reinterpret_cast<const uint32_t*>(data + header->edge_targets_offset);
+    const JapaneseWordEntry* entries = reinterpret_cast<const JapaneseWordEntry*>(data + header->entries_offset);
+    const JapaneseWordEntry* unknown = reinterpret_cast<const JapaneseWordEntry*>(data + header->unknown_entries_offset);
+    const uint32_t* stopwords = reinterpret_cast<const uint32_t*>(data + header->stopwords_offset);
+
+    // Every index read by a lookup is checked once here, so lookups need no bounds checks
+    for (uint32_t i = 0; i < header->node_count; ++i) {
+        if (static_cast<uint64_t>(nodes[i].first_edge) + nodes[i].edge_count > header->edge_count ||
+            static_cast<uint64_t>(nodes[i].first_entry) + nodes[i].entry_count > header->entry_count) {
+            error = "corrupt surface trie";
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < header->edge_count; ++i) {
+        if (targets[i] >= header->node_count) {
+            error = "corrupt surface trie";
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < header->entry_count + header->unknown_entry_count; ++i) {
+        const JapaneseWordEntry& entry = i < header->entry_count ? entries[i] : unknown[i - header->entry_count];
+        if (entry.left_id < 0 || static_cast<uint32_t>(entry.left_id) >= header->left_size ||
+            entry.right_id < 0 || static_cast<uint32_t>(entry.right_id) >= header->right_size ||
+            (entry.base_form != NO_STRING && static_cast<uint64_t>(entry.base_form) + 2 > header->string_bytes)) {
+            error = "corrupt word entry";
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < header->stopword_count; ++i) {
+        if (static_cast<uint64_t>(stopwords[i]) + 2 > header->string_bytes) {
+            error = "corrupt stopword table";
+            return -1;
+        }
+    }
+
+    header_ = header;
+    size_ = size;
+    costs_ = reinterpret_cast<const int16_t*>(data + header->costs_offset);
+    char_info_ = reinterpret_cast<const uint8_t*>(data + header->char_info_offset);
+    lower_ = reinterpret_cast<const uint16_t*>(data + header->lower_offset);
+    nodes_ = nodes;
+    edge_labels_ = reinterpret_cast<const uint16_t*>(data + header->edge_labels_offset);
+    edge_targets_ = targets;
+    entries_ = entries;
+    unknown_entries_ = unknown;
+    stopwords_ = stopwords;
+    strings_ = data + header->strings_offset;
+
+    // String lengths are checked last, they need strings_
+    for (uint32_t i = 0; i < header->stopword_count; ++i) {
+        size_t length;
+        if (!string_data(stopwords[i], length)) {
+            error = "corrupt stopword table";
+            header_ = nullptr;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+uint32_t JapaneseDictionary::child(uint32_t index, uint16_t c) const {
+    const JapaneseTrieNode& current = nodes_[index];
+    const uint16_t* labels = edge_labels_ + current.first_edge;
+    // Binary search: the root has thousands of children
+    uint32_t low = 0;
+    uint32_t high = current.edge_count;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        if (labels[mid] < c) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < current.edge_count && labels[low] == c) {
+        return edge_targets_[current.first_edge + low];
+    }
+    return NO_NODE;
+}
+
+const char* JapaneseDictionary::string_data(uint32_t offset, size_t& length) const {
+    if (static_cast<uint64_t>(offset) + 2 > header_->string_bytes) {
+        return nullptr;
+    }
+    uint16_t bytes;
+    memcpy(&bytes, strings_ + offset, sizeof(bytes));
+    if (static_cast<uint64_t>(offset) + 2 + bytes > header_->string_bytes) {
+        return nullptr;
+    }
+    length = bytes;
+    return strings_ + offset + 2;
+}
+
+bool JapaneseDictionary::is_stopword(const char* token, size_t length) const {
+    uint32_t low = 0;
+    uint32_t high = header_->stopword_count;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        size_t word_length = 0;
+        const char* word = string_data(stopwords_[mid], word_length);
+        int cmp = memcmp(word, token, word_length < length ? word_length : length);
+        if (cmp == 0) {
+            if (word_length == length) {
+                return true;
+            }
+            cmp = word_length < length ? -1 : 1;
+        }
+        if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return false;
+}
+
+} // namespace japanese_ftparser
+} // namespace oceanbase
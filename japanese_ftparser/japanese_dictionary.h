@@ -0,0 +1,198 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Japanese Fulltext Parser Plugin - Memory-mapped IPADIC Dictionary
+ */
+
+#pragma once
+
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace oceanbase {
+namespace japanese_ftparser {
+
+/**
+ * Dictionary file header
+ * @details The file is written by java/KuromojiDictionaryExport from the
+ * IPADIC tables inside the Kuromoji jar. All integers are little endian,
+ * every section starts at an 8-byte aligned offset from the start of the
+ * file, and characters are UTF-16 code units as in Kuromoji.
+ */
+struct JapaneseDictionaryHeader {
+    char magic[8];                    // "OBJADIC\0"
+    uint32_t version;                 // JapaneseDictionary::FORMAT_VERSION
+    uint32_t header_size;             // sizeof(JapaneseDictionaryHeader)
+    uint32_t left_size;               // Connection matrix columns (left ids)
+    uint32_t right_size;              // Connection matrix rows (right ids)
+    uint32_t node_count;              // Surface trie nodes, node 0 is the root
+    uint32_t edge_count;              // Surface trie edges
+    uint32_t entry_count;             // Known word entries
+    uint32_t unknown_entry_count;     // Unknown word entries
+    uint32_t stopword_count;          // Stopwords
+    uint32_t string_bytes;            // Size of the string pool
+    uint32_t unknown_first[16];       // First unknown entry of each character class
+    uint32_t unknown_count[16];       // Unknown entries of each character class
+    uint64_t costs_offset;            // int16 [right_size][left_size]
+    uint64_t char_info_offset;        // uint8 [65536], see CHAR_* masks
+    uint64_t lower_offset;            // uint16 [65536], Character.toLowerCase
+    uint64_t nodes_offset;            // JapaneseTrieNode [node_count]
+    uint64_t edge_labels_offset;      // uint16 [edge_count], sorted per node
+    uint64_t edge_targets_offset;     // uint32 [edge_count]
+    uint64_t entries_offset;          // JapaneseWordEntry [entry_count]
+    uint64_t unknown_entries_offset;  // JapaneseWordEntry [unknown_entry_count]
+    uint64_t stopwords_offset;        // uint32 [stopword_count] string offsets, sorted by UTF-8 bytes
+    uint64_t strings_offset;          // Strings: uint16 byte length + UTF-8 bytes
+};
+
+/**
+ * Surface trie node: edges [first_edge, first_edge + edge_count), words
+ * ending here are entries [first_entry, first_entry + entry_count)
+ */
+struct JapaneseTrieNode {
+    uint32_t first_edge;
+    uint32_t edge_count;
+    uint32_t first_entry;
+    uint32_t entry_count;
+};
+
+/**
+ * One dictionary word (TokenInfoDictionary / UnknownDictionary entry)
+ */
+struct JapaneseWordEntry {
+    int16_t left_id;
+    int16_t right_id;
+    int16_t word_cost;
+    uint16_t flags;         // ENTRY_* flags
+    uint32_t base_form;     // String offset, NO_STRING if the base form is the surface
+};
+
+/**
+ * Japanese Dictionary
+ * @brief Read-only view of a mapped dictionary file
+ * @details Nothing is parsed or copied on open: lookups read the mapping
+ * directly, so all threads and processes share the same pages.
+ */
+class JapaneseDictionary {
+public:
+    static const uint32_t FORMAT_VERSION = 1;
+    static const uint32_t NO_NODE = 0xFFFFFFFFu;
+    static const uint32_t NO_STRING = 0xFFFFFFFFu;
+    static const uint32_t MAX_CHAR_CLASSES = 16;
+
+    // Character info masks (CharacterDefinition + JapaneseTokenizer.isPunctuation)
+    static const uint8_t CHAR_CLASS_MASK = 0x0F;
+    static const uint8_t CHAR_INVOKE = 0x10;
+    static const uint8_t CHAR_GROUP = 0x20;
+    static const uint8_t CHAR_KANJI = 0x40;
+    static const uint8_t CHAR_PUNCTUATION = 0x80;
+
+    // Entry flags
+    static const uint16_t ENTRY_STOP_TAG = 0x1;   // Part of speech removed by the POS stop filter
+
+    JapaneseDictionary();
+
+    /**
+     * Map and check a dictionary file
+     * @param error Output description of the failure
+     * @return 0 on success, -1 on failure
+     */
+    int open(const std::string& path, std::string& error);
+
+    /**
+     * Open over a buffer owned by the caller (tests), same checks as open()
+     */
+    int open_buffer(const char* data, size_t size, std::string& error);
+
+    /**
+     * Connection cost from a word's right id to the next word's left id
+     */
+    int connection_cost(int right_id, int left_id) const {
+        return costs_[static_cast<size_t>(right_id) * header_->left_size + static_cast<size_t>(left_id)];
+    }
+
+    /**
+     * Character info of a UTF-16 code unit
+     */
+    uint8_t char_info(uint16_t c) const { return char_info_[c]; }
+
+    /**
+     * Lower case of a UTF-16 code unit
+     */
+    uint16_t to_lower(uint16_t c) const { return lower_[c]; }
+
+    /**
+     * Follow the edge labelled c
+     * @return The child node, or NO_NODE
+     */
+    uint32_t child(uint32_t node, uint16_t c) const;
+
+    /**
+     * Trie node by index
+     */
+    const JapaneseTrieNode& node(uint32_t index) const { return nodes_[index]; }
+
+    /**
+     * Known entry by index
+     */
+    const JapaneseWordEntry& entry(uint32_t index) const { return entries_[index]; }
+
+    /**
+     * Unknown entry by index
+     */
+    const JapaneseWordEntry& unknown_entry(uint32_t index) const { return unknown_entries_[index]; }
+
+    /**
+     * Unknown entries of a character class
+     */
+    uint32_t unknown_first(uint32_t char_class) const { return header_->unknown_first[char_class]; }
+    uint32_t unknown_count(uint32_t char_class) const { return header_->unknown_count[char_class]; }
+
+    /**
+     * String from the pool
+     */
+    const char* string_data(uint32_t offset, size_t& length) const;
+
+    /**
+     * Check whether a UTF-8 token is a stopword
+     */
+    bool is_stopword(const char* token, size_t length) const;
+
+    /**
+     * Number of known entries
+     */
+    uint32_t entry_count() const { return header_->entry_count; }
+
+    /**
+     * Size of the mapped dictionary in bytes
+     */
+    size_t size() const { return size_; }
+
+private:
+    jni::MappedFile file_;
+    size_t size_;
+    const JapaneseDictionaryHeader* header_;
+    const int16_t* costs_;
+    const uint8_t* char_info_;
+    const uint16_t* lower_;
+    const JapaneseTrieNode* nodes_;
+    const uint16_t* edge_labels_;
+    const uint32_t* edge_targets_;
+    const JapaneseWordEntry* entries_;
+    const JapaneseWordEntry* unknown_entries_;
+    const uint32_t* stopwords_;
+    const char* strings_;
+
+    /**
+     * Check the header and locate the sections
+     */
+    int attach(const char* data, size_t size, std::string& error);
+
+    // Disable copy
+    JapaneseDictionary(const JapaneseDictionary&) = delete;
+    JapaneseDictionary& operator=(const JapaneseDictionary&) = delete;
+};
+
+} // namespace japanese_ftparser
+} // namespace oceanbase
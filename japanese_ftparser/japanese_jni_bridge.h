@@ -7,8 +7,15 @@
 
 #include "oceanbase/ob_plugin_ftparser.h"
 #include "jni_manager.h"  // 简化后的包含路径
+#include "packed_token_buffer.h"
+#include "script_run_splitter.h"
+#include "content_chunker.h"
+#include "backend_warmup.h"
+#include "segmenter_backend.h"
+#include "persistent_segment_cache.h"
 #include <string>
 #include <vector>
+#include <memory>
 #include <mutex>
 
 namespace oceanbase {
@@ -23,6 +30,28 @@ struct JapaneseJNIBridgeConfig {
     // Plugin-specific configurations only
     std::string segmenter_class_name;
     std::string segment_method_name;
+    std::string segment_into_method_name;
+    std::string segment_batch_method_name;
+    std::string open_cursor_method_name;
+    std::string next_tokens_method_name;
+    std::string close_cursor_method_name;
+    std::string pipeline_fingerprint_method_name;
+    // Pass documents as direct ByteBuffers over the original UTF-8 bytes
+    bool use_direct_buffer_input;
+    // Let Java write all tokens into one packed C++-owned buffer
+    bool use_packed_token_output;
+    // Fail scan_begin for documents that are not valid UTF-8 instead of warning
+    bool reject_invalid_utf8;
+    // Tokenize pure-ASCII chunks natively, send only the rest to Java
+    bool native_ascii_runs;
+    // Upper bound of the packed input carried by one segmentBatch call
+    size_t max_batch_bytes;
+    // Documents from this size on are streamed through a Java token cursor (0 = never)
+    size_t streaming_threshold_bytes;
+    // Packed bytes fetched per cursor call
+    size_t streaming_chunk_bytes;
+    // Segment documents too long for the segment cache in content-defined chunks cached one by one
+    bool chunk_cache;
     
     JapaneseJNIBridgeConfig();
 };
@@ -33,8 +62,9 @@ struct JapaneseJNIBridgeConfig {
  * @details This class uses oceanbase::jni::ScopedJNIEnvironment for
  * automatic JVM and thread management, eliminating the need for
  * complex manual resource management.
+ * It is the "jvm" segmenter backend of the plugin.
  */
-class JapaneseJNIBridge {
+class JapaneseJNIBridge : public oceanbase::jni::SegmenterBackend {
 private:
     JapaneseJNIBridgeConfig config_;
     std::string plugin_name_;
@@ -45,6 +75,28 @@ private:
     jclass segmenter_class_;
     jmethodID constructor_method_;
     jmethodID segment_method_;
+    jmethodID segment_buffer_method_;
+    jmethodID segment_into_method_;
+    jmethodID segment_batch_method_;
+    jmethodID open_cursor_method_;
+    jmethodID next_tokens_method_;
+    jmethodID close_cursor_method_;
+    
+    // Shared segmenter instance (global reference, reused by every call)
+    jobject segmenter_instance_;
+    
+    // Native pre-pass for chunks the segmenter does not need to see
+    oceanbase::jni::ScriptRunSplitter splitter_;
+    
+    // Sentence-boundary chunks of long documents, see segment_chunked()
+    oceanbase::jni::ContentChunker chunker_;
+    
+    // Segment cache namespace of this parser configuration, including the
+    // segmenter's analyzer chain once the Java classes are loaded
+    uint64_t cache_namespace_;
+    
+    // Results kept across index builds (OCEANBASE_JNI_PERSISTENT_CACHE_DIR), nullptr when disabled
+    std::unique_ptr<oceanbase::jni::PersistentSegmentCache> persistent_cache_;
     
     // Error handling
     struct ErrorInfo {
@@ -69,7 +121,12 @@ public:
      * Initialize the simplified JNI bridge
      * @return OBP_SUCCESS on success, error code on failure
      */
-    int initialize();
+    int initialize() override;
+    
+    /**
+     * Backend name used in OCEANBASE_JAPANESE_FTPARSER_BACKEND
+     */
+    const char* name() const override { return "jvm"; }
     
     /**
      * Segment text into tokens
@@ -79,6 +136,77 @@ public:
      */
     int segment(const std::string& text, std::vector<std::string>& tokens);
     
+    /**
+     * Segment a UTF-8 buffer into tokens without copying it
+     * @param text Input UTF-8 bytes, must stay valid during the call
+     * @param length Length of the input in bytes
+     * @param tokens Output vector to store tokens
+     * @return OBP_SUCCESS on success, error code on failure
+     */
+    int segment(const char* text, size_t length, std::vector<std::string>& tokens);
+    
+    /**
+     * Segment a UTF-8 buffer into packed tokens with one JNI round trip
+     * @param text Input UTF-8 bytes, must stay valid during the call
+     * @param length Length of the input in bytes
+     * @param tokens Output buffer, replaced with the document's tokens
+     * @return OBP_SUCCESS on success, error code on failure
+     */
+    int segment(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) override;
+    
+    /**
+     * Segment many documents, crossing JNI once per batch instead of once per document
+     * @param docs Input UTF-8 documents, must stay valid during the call
+     * @param results Output buffers, one per document in input order
+     * @return OBP_SUCCESS on success, error code on failure
+     */
+    int segment_batch(const std::vector<oceanbase::jni::TextSpan>& docs,
+                      std::vector<oceanbase::jni::PackedTokenBuffer>& results) override;
+    
+    /**
+     * Segment a document without consulting the segment caches
+     */
+    int segment_uncached(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) override;
+    
+    /**
+     * Check that a document is well-formed UTF-8 before it reaches Java
+     * @return OBP_SUCCESS, or OBP_INVALID_ARGUMENT when invalid documents are rejected
+     */
+    int check_document(const char* text, size_t length) override;
+    
+    /**
+     * Check whether a document is large enough to be streamed through a token cursor
+     */
+    bool should_stream(size_t length) const override;
+    
+    /**
+     * Open a Java token cursor over a UTF-8 buffer
+     * @param text Input UTF-8 bytes, must stay valid until the cursor is closed
+     * @param length Length of the input in bytes
+     * @param cursor Output global reference to the cursor
+     * @return OBP_SUCCESS on success, error code on failure
+     */
+    int open_cursor(const char* text, size_t length, jobject& cursor);
+    
+    /**
+     * Fetch the next chunk of tokens from a cursor
+     * @param cursor Cursor returned by open_cursor
+     * @param tokens Output buffer, replaced with the chunk; empty once the document is exhausted
+     * @return OBP_SUCCESS on success, error code on failure
+     */
+    int next_chunk(jobject cursor, oceanbase::jni::PackedTokenBuffer& tokens);
+    
+    /**
+     * Close a cursor and release its global reference
+     */
+    void close_cursor(jobject cursor);
+    
+    /**
+     * Open a Java token cursor wrapped as a backend cursor
+     */
+    int open_cursor(const char* text, size_t length,
+                    std::unique_ptr<oceanbase::jni::SegmenterCursor>& cursor) override;
+    
     /**
      * Get last error information
      */
@@ -98,7 +226,60 @@ private:
     /**
      * Perform actual segmentation with given JNI environment
      */
-    int do_segment(JNIEnv* env, const std::string& text, std::vector<std::string>& tokens);
+    int do_segment(JNIEnv* env, const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens);
+    
+    /**
+     * Open the persistent segment cache of this plugin, if one is configured
+     */
+    void open_persistent_cache();
+    
+    /**
+     * Segment a long document chunk by chunk, taking the tokens of the chunks
+     * seen before from the segment cache and segmenting the others in one batch
+     */
+    int segment_chunked(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens);
+    
+    /**
+     * Segment text with the Java segmenter on the calling thread
+     */
+    int segment_on_current_thread(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens);
+    
+    /**
+     * Get the text of a document the segmenter must see: the whole document,
+     * or with native_ascii_runs only its chunks containing non-ASCII text
+     * @param buffer Storage for those chunks, input may point into it
+     * @return false when the whole document is tokenized natively
+     */
+    bool segmenter_input(const char* text, size_t length, std::string& buffer,
+                         oceanbase::jni::TextSpan& input) const;
+    
+    /**
+     * Append the natively tokenized ASCII chunks of a document (native_ascii_runs only)
+     */
+    int append_native_tokens(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens);
+    
+    /**
+     * Let Java write the tokens into the packed buffer (segmentInto)
+     */
+    int do_segment_packed(JNIEnv* env, jobject jtext, size_t length, oceanbase::jni::PackedTokenBuffer& tokens);
+    
+    /**
+     * Segment docs[begin, end), input_bytes is their packed size, with its own JNI environment
+     */
+    int segment_batch_part(const std::vector<oceanbase::jni::TextSpan>& docs, size_t begin, size_t end,
+                           size_t input_bytes, std::vector<oceanbase::jni::PackedTokenBuffer>& results);
+    
+    /**
+     * Segment docs[begin, end) with segmentBatch calls, input_bytes is their packed size
+     */
+    int do_segment_batch(JNIEnv* env, const std::vector<oceanbase::jni::TextSpan>& docs,
+                         size_t begin, size_t end, size_t input_bytes,
+                         std::vector<oceanbase::jni::PackedTokenBuffer>& results);
+    
+    /**
+     * Convert a Java String[] result into the packed buffer (segment)
+     */
+    int do_segment_array(JNIEnv* env, jmethodID method, jobject jtext, oceanbase::jni::PackedTokenBuffer& tokens);
     
     /**
      * Set error information
@@ -110,6 +291,8 @@ private:
      */
     void clear_error();
     
+    friend class JapaneseJNICursor;
+    
     // Disable copy and move
     JapaneseJNIBridge(const JapaneseJNIBridge&) = delete;
     JapaneseJNIBridge& operator=(const JapaneseJNIBridge&) = delete;
@@ -127,20 +310,54 @@ public:
     static JapaneseJNIBridgeManager& get_instance();
     
     /**
-     * Get the JNI bridge
+     * Get the JNI bridge (the "jvm" backend)
      */
     std::shared_ptr<JapaneseJNIBridge> get_bridge();
     
     /**
-     * Initialize the bridge (thread-safe)
+     * Get the backend selected by OCEANBASE_JAPANESE_FTPARSER_BACKEND, resolved once
+     * @return The backend, or nullptr if the configured name is not registered
+     */
+    std::shared_ptr<oceanbase::jni::SegmenterBackend> get_backend();
+    
+    /**
+     * Initialize the selected backend (lazy initialization)
+     * @details Waits for the warm-up instead while one is running
      */
     int initialize();
+    
+    /**
+     * Start initializing the selected backend on a background thread, if
+     * OCEANBASE_JNI_WARMUP is set; once it is ready, the same thread replays
+     * the training corpus while scans proceed
+     */
+    void start_warmup();
+    
+    /**
+     * Stop the training replay and wait for a running warm-up, before the
+     * plugin is unloaded
+     */
+    void stop_warmup();
 
 private:
     std::shared_ptr<JapaneseJNIBridge> bridge_;
+    std::shared_ptr<oceanbase::jni::SegmenterBackend> backend_;
+    std::once_flag backend_once_;
     std::mutex mutex_;
+    // Declared last: a running warm-up is waited for before the backend goes away
+    oceanbase::jni::BackendWarmup warmup_;
     
-    JapaneseJNIBridgeManager() = default;
+    /**
+     * Initialize the backend and segment a first document, loading the
+     * dictionary and building the analyzer (the warm-up task); the training
+     * corpus is replayed after readiness, see start_warmup()
+     */
+    int warm_up();
+    
+    /**
+     * Register the backends of this plugin
+     */
+    JapaneseJNIBridgeManager();
     ~JapaneseJNIBridgeManager() = default;
     
     // Disable copy
@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Japanese Fulltext Parser Plugin - Native Segmenter Backend
+ */
+
+#include "japanese_native_segmenter.h"
+#include "jni_log.h"
+#include "oceanbase/ob_plugin_ftparser.h"
+#include <cstdlib>
+#include <new>
+
+using namespace oceanbase::jni;
+
+namespace oceanbase {
+namespace japanese_ftparser {
+
+static std::string get_env_string(const char* name) {
+    const char* value = std::getenv(name);
+    return value ? std::string(value) : std::string();
+}
+
+JapaneseNativeSegmenterConfig::JapaneseNativeSegmenterConfig()
+    : dictionary_path(get_env_string("OCEANBASE_JAPANESE_DICT_PATH")) {
+}
+
+JapaneseNativeSegmenter::JapaneseNativeSegmenter()
+    : tokenizer_(dictionary_, JapaneseTokenizerOptions())
+    , is_initialized_(false) {
+}
+
+int JapaneseNativeSegmenter::initialize() {
+    std::lock_guard<std::mutex> lock(init_mutex_);
+
+    if (is_initialized_) {
+        return OBP_SUCCESS;
+    }
+
+    if (config_.dictionary_path.empty()) {
+        JNI_LOG_ERROR("[JapaneseNativeSegmenter] OCEANBASE_JAPANESE_DICT_PATH is not set, "
+                      "the native backend needs a dictionary exported by KuromojiDictionaryExport");
+        return OBP_PLUGIN_ERROR;
+    }
+
+    std::string error;
+    if (dictionary_.open(config_.dictionary_path, error) != 0) {
+        JNI_LOG_ERROR("[JapaneseNativeSegmenter] Failed to open dictionary: %s", error.c_str());
+        return OBP_PLUGIN_ERROR;
+    }
+
+    JNI_LOG_INFO("[JapaneseNativeSegmenter] Mapped %s (%u words, %zu bytes)",
+                 config_.dictionary_path.c_str(), dictionary_.entry_count(), dictionary_.size());
+    is_initialized_ = true;
+    return OBP_SUCCESS;
+}
+
+int JapaneseNativeSegmenter::segment(const char* text, size_t length, PackedTokenBuffer& tokens) {
+    tokens.clear();
+    if (!text || length == 0) {
+        return OBP_SUCCESS;
+    }
+
+    try {
+        if (tokenizer_.segment(text, length, tokens) != 0) {
+            return OBP_ALLOCATE_MEMORY_FAILED;
+        }
+    } catch (const std::bad_alloc&) {
+        return OBP_ALLOCATE_MEMORY_FAILED;
+    }
+    return OBP_SUCCESS;
+}
+
+} // namespace japanese_ftparser
+} // namespace oceanbase
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Japanese Fulltext Parser Plugin - Native Segmenter Backend
+ */
+
+#pragma once
+
+#include "segmenter_backend.h"
+#include "japanese_dictionary.h"
+#include "japanese_tokenizer.h"
+#include <mutex>
+#include <string>
+
+namespace oceanbase {
+namespace japanese_ftparser {
+
+/**
+ * Japanese Native Segmenter Configuration
+ */
+struct JapaneseNativeSegmenterConfig {
+    // Dictionary exported by java/KuromojiDictionaryExport (OCEANBASE_JAPANESE_DICT_PATH, required)
+    std::string dictionary_path;
+
+    JapaneseNativeSegmenterConfig();
+};
+
+/**
+ * Japanese Native Segmenter
+ * @brief The "native" backend of japanese_ftparser: JapaneseTokenizer without a JVM
+ * @details Selected with OCEANBASE_JAPANESE_FTPARSER_BACKEND=native. The
+ * dictionary file is mapped read-only by the first scan; its pages are
+ * shared by all threads and by every process mapping the same file.
+ */
+class JapaneseNativeSegmenter : public oceanbase::jni::SegmenterBackend {
+public:
+    JapaneseNativeSegmenter();
+
+    /**
+     * Backend name used in OCEANBASE_JAPANESE_FTPARSER_BACKEND
+     */
+    const char* name() const override { return "native"; }
+
+    /**
+     * Map the dictionary (once)
+     * @return OBP_SUCCESS on success, OBP_PLUGIN_ERROR if the dictionary cannot be opened
+     */
+    int initialize() override;
+
+    /**
+     * Segment a UTF-8 document into packed tokens
+     * @return OBP_SUCCESS on success, error code on failure
+     */
+    int segment(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) override;
+
+private:
+    JapaneseNativeSegmenterConfig config_;
+    JapaneseDictionary dictionary_;
+    JapaneseTokenizer tokenizer_;
+    bool is_initialized_;
+    std::mutex init_mutex_;
+
+    // Disable copy
+    JapaneseNativeSegmenter(const JapaneseNativeSegmenter&) = delete;
+    JapaneseNativeSegmenter& operator=(const JapaneseNativeSegmenter&) = delete;
+};
+
+} // namespace japanese_ftparser
+} // namespace oceanbase
@@ -0,0 +1,572 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Japanese Fulltext Parser Plugin - Native Viterbi Tokenizer
+ */
+
+#include "japanese_tokenizer.h"
+#include <climits>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace oceanbase::jni;
+
+namespace oceanbase {
+namespace japanese_ftparser {
+
+namespace {
+
+// JapaneseTokenizer constants
+const uint32_t MAX_UNKNOWN_WORD_LENGTH = 1024;
+const uint32_t SEARCH_MODE_KANJI_LENGTH = 2;
+const uint32_t SEARCH_MODE_OTHER_LENGTH = 7;
+const int SEARCH_MODE_KANJI_PENALTY = 3000;
+const int SEARCH_MODE_OTHER_PENALTY = 1700;
+
+enum WordType : uint8_t {
+    WORD_BOS = 0,
+    WORD_KNOWN,
+    WORD_UNKNOWN
+};
+
+// A best way to reach a position through one word
+struct Arc {
+    int32_t cost;           // Path cost including the word
+    int32_t right_id;       // Right id of the word
+    uint32_t back_pos;      // Start of the word
+    uint32_t back_index;    // Arc at back_pos the path comes from
+    uint32_t word;          // Entry index
+    uint8_t type;           // WordType
+};
+
+// A word leaving a position, rebuilt while rescoring a compound
+struct ForwardArc {
+    uint32_t to_pos;
+    uint32_t word;
+    uint8_t type;
+};
+
+struct Position {
+    std::vector<Arc> arcs;
+    std::vector<ForwardArc> forward;
+};
+
+struct PendingToken {
+    uint32_t start;
+    uint32_t end;
+    uint32_t word;
+    uint8_t type;
+};
+
+// Per-thread lattice storage, reused across documents
+struct TokenizerScratch {
+    std::vector<uint16_t> units;
+    std::vector<Position> window;
+    size_t used;
+    std::vector<PendingToken> fragment;
+    std::vector<uint16_t> term;
+    std::string utf8;
+
+    TokenizerScratch() : used(0) {}
+};
+
+TokenizerScratch& scratch() {
+    static thread_local TokenizerScratch instance;
+    return instance;
+}
+
+// Decode UTF-8 into UTF-16 code units (invalid sequences become U+FFFD)
+void decode_utf16(const char* text, size_t length, std::vector<uint16_t>& units) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text);
+    units.clear();
+    size_t pos = 0;
+    while (pos < length) {
+        unsigned char lead = p[pos];
+        if (lead < 0x80) {
+            units.push_back(lead);
+            ++pos;
+            continue;
+        }
+        size_t needed;
+        uint32_t value;
+        uint32_t minimum;
+        if ((lead & 0xE0) == 0xC0) {
+            needed = 2; value = lead & 0x1F; minimum = 0x80;
+        } else if ((lead & 0xF0) == 0xE0) {
+            needed = 3; value = lead & 0x0F; minimum = 0x800;
+        } else if ((lead & 0xF8) == 0xF0) {
+            needed = 4; value = lead & 0x07; minimum = 0x10000;
+        } else {
+            units.push_back(0xFFFD);
+            ++pos;
+            continue;
+        }
+        bool valid = length - pos >= needed;
+        for (size_t i = 1; valid && i < needed; ++i) {
+            valid = (p[pos + i] & 0xC0) == 0x80;
+            value = (value << 6) | (p[pos + i] & 0x3F);
+        }
+        if (!valid || value < minimum || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF)) {
+            units.push_back(0xFFFD);
+            ++pos;
+            continue;
+        }
+        if (value >= 0x10000) {
+            value -= 0x10000;
+            units.push_back(static_cast<uint16_t>(0xD800 | (value >> 10)));
+            units.push_back(static_cast<uint16_t>(0xDC00 | (value & 0x3FF)));
+        } else {
+            units.push_back(static_cast<uint16_t>(value));
+        }
+        pos += needed;
+    }
+}
+
+// Encode UTF-16 code units as UTF-8 (an unpaired surrogate becomes '?', as String.getBytes does)
+void encode_utf8(const uint16_t* units, size_t count, std::string& out) {
+    out.clear();
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t c = units[i];
+        if (c >= 0xD800 && c <= 0xDBFF && i + 1 < count && units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (units[i + 1] - 0xDC00);
+            ++i;
+        } else if (c >= 0xD800 && c <= 0xDFFF) {
+            c = '?';
+        }
+        if (c < 0x80) {
+            out += static_cast<char>(c);
+        } else if (c < 0x800) {
+            out += static_cast<char>(0xC0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            out += static_cast<char>(0xE0 | (c >> 12));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (c >> 18));
+            out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+}
+
+// Halfwidth katakana U+FF65..U+FF9F to their fullwidth forms (CJKWidthFilter)
+const uint16_t KANA_NORM[] = {
+    0x30FB, 0x30F2, 0x30A1, 0x30A3, 0x30A5, 0x30A7, 0x30A9, 0x30E3, 0x30E5, 0x30E7,
+    0x30C3, 0x30FC, 0x30A2, 0x30A4, 0x30A6, 0x30A8, 0x30AA, 0x30AB, 0x30AD, 0x30AF,
+    0x30B1, 0x30B3, 0x30B5, 0x30B7, 0x30B9, 0x30BB, 0x30BD, 0x30BF, 0x30C1, 0x30C4,
+    0x30C6, 0x30C8, 0x30CA, 0x30CB, 0x30CC, 0x30CD, 0x30CE, 0x30CF, 0x30D2, 0x30D5,
+    0x30D8, 0x30DB, 0x30DE, 0x30DF, 0x30E0, 0x30E1, 0x30E2, 0x30E4, 0x30E6, 0x30E8,
+    0x30E9, 0x30EA, 0x30EB, 0x30EC, 0x30ED, 0x30EF, 0x30F3, 0x3099, 0x309A
+};
+
+// Offset a (half-)voiced sound mark adds to the preceding fullwidth katakana, 0 if it does not combine
+int kana_combine_offset(uint16_t previous, uint16_t mark) {
+    bool handakuten = mark == 0xFF9F;
+    if (previous == 0x30CF || previous == 0x30D2 || previous == 0x30D5 || previous == 0x30D8 || previous == 0x30DB) {
+        return handakuten ? 2 : 1;    // ハヒフヘホ -> バ/パ ...
+    }
+    if (handakuten) {
+        return 0;
+    }
+    if (previous >= 0x30AB && previous <= 0x30C1 && (previous - 0x30AB) % 2 == 0) {
+        return 1;                      // カ..チ -> ガ..ヂ
+    }
+    if (previous == 0x30C4 || previous == 0x30C6 || previous == 0x30C8 || previous == 0x30FD) {
+        return 1;                      // ツテト -> ヅデド, ヽ -> ヾ
+    }
+    if (previous == 0x30A6) {
+        return 0x30F4 - 0x30A6;        // ウ -> ヴ
+    }
+    if (previous >= 0x30EF && previous <= 0x30F2) {
+        return 8;                      // ワヰヱヲ -> ヷヸヹヺ
+    }
+    return 0;
+}
+
+// CJKWidthFilter: fullwidth ASCII to ASCII, halfwidth katakana to fullwidth
+void fold_width(std::vector<uint16_t>& term) {
+    size_t out = 0;
+    for (size_t i = 0; i < term.size(); ++i) {
+        uint16_t c = term[i];
+        if (c >= 0xFF01 && c <= 0xFF5E) {
+            c = static_cast<uint16_t>(c - 0xFEE0);
+        } else if (c >= 0xFF65 && c <= 0xFF9F) {
+            if ((c == 0xFF9E || c == 0xFF9F) && out > 0) {
+                int offset = kana_combine_offset(term[out - 1], c);
+                if (offset != 0) {
+                    term[out - 1] = static_cast<uint16_t>(term[out - 1] + offset);
+                    continue;
+                }
+            }
+            c = KANA_NORM[c - 0xFF65];
+        }
+        term[out++] = c;
+    }
+    term.resize(out);
+}
+
+/**
+ * One document's lattice, following JapaneseTokenizer.parse()
+ */
+class Lattice {
+public:
+    Lattice(const JapaneseDictionary& dictionary, const JapaneseTokenizerOptions& options, TokenizerScratch& s)
+        : dictionary_(dictionary), options_(options), s_(s), base_(0), last_backtrace_pos_(0), next_pos_(1) {}
+
+    int run(PackedTokenBuffer& tokens);
+
+private:
+    const JapaneseDictionary& dictionary_;
+    const JapaneseTokenizerOptions& options_;
+    TokenizerScratch& s_;
+    uint32_t base_;                 // Text position of window[0]
+    uint32_t last_backtrace_pos_;   // Tokens before this position are emitted
+    uint32_t next_pos_;             // One past the furthest position any arc reaches
+
+    // Position by text position; references are invalidated by the next call
+    Position& at(uint32_t pos);
+
+    const JapaneseWordEntry& word_entry(uint8_t type, uint32_t word) const {
+        return type == WORD_KNOWN ? dictionary_.entry(word) : dictionary_.unknown_entry(word);
+    }
+
+    int compute_penalty(uint32_t pos, uint32_t length) const;
+    void add(uint32_t from_pos, uint32_t end_pos, uint32_t word, uint8_t type, bool add_penalty);
+    void prune_and_rescore(uint32_t start_pos, uint32_t end_pos, uint32_t best_start_index);
+    int backtrace(uint32_t end_pos, uint32_t best_index, PackedTokenBuffer& tokens);
+    int emit(const PendingToken& token, PackedTokenBuffer& tokens);
+    void rebase(uint32_t pos);
+};
+
+Position& Lattice::at(uint32_t pos) {
+    size_t index = pos - base_;
+    if (index >= s_.window.size()) {
+        s_.window.resize(index + 1 > 2 * s_.window.size() ? index + 1 : 2 * s_.window.size());
+    }
+    while (s_.used <= index) {
+        s_.window[s_.used].arcs.clear();
+        s_.window[s_.used].forward.clear();
+        ++s_.used;
+    }
+    return s_.window[index];
+}
+
+int Lattice::compute_penalty(uint32_t pos, uint32_t length) const {
+    if (length <= SEARCH_MODE_KANJI_LENGTH) {
+        return 0;
+    }
+    bool all_kanji = true;
+    for (uint32_t i = pos; i < pos + length; ++i) {
+        if (!(dictionary_.char_info(s_.units[i]) & JapaneseDictionary::CHAR_KANJI)) {
+            all_kanji = false;
+            break;
+        }
+    }
+    if (all_kanji) {
+        return static_cast<int>(length - SEARCH_MODE_KANJI_LENGTH) * SEARCH_MODE_KANJI_PENALTY;
+    }
+    if (length > SEARCH_MODE_OTHER_LENGTH) {
+        return static_cast<int>(length - SEARCH_MODE_OTHER_LENGTH) * SEARCH_MODE_OTHER_PENALTY;
+    }
+    return 0;
+}
+
+void Lattice::add(uint32_t from_pos, uint32_t end_pos, uint32_t word, uint8_t type, bool add_penalty) {
+    const JapaneseWordEntry& entry = word_entry(type, word);
+    const std::vector<Arc>& from = at(from_pos).arcs;
+    int32_t least_cost = INT_MAX;
+    uint32_t least_index = 0;
+    for (size_t i = 0; i < from.size(); ++i) {
+        int32_t cost = from[i].cost + dictionary_.connection_cost(from[i].right_id, entry.left_id);
+        if (cost < least_cost) {
+            least_cost = cost;
+            least_index = static_cast<uint32_t>(i);
+        }
+    }
+    least_cost += entry.word_cost;
+    if (add_penalty) {
+        least_cost += compute_penalty(from_pos, end_pos - from_pos);
+    }
+
+    Arc arc = {least_cost, entry.right_id, from_pos, least_index, word, type};
+    at(end_pos).arcs.push_back(arc);
+    if (end_pos + 1 > next_pos_) {
+        next_pos_ = end_pos + 1;
+    }
+}
+
+void Lattice::prune_and_rescore(uint32_t start_pos, uint32_t end_pos, uint32_t best_start_index) {
+    // Walk backwards collecting the words inside [start_pos, end_pos], then drop their scores
+    for (uint32_t pos = end_pos; pos > start_pos; --pos) {
+        size_t count = at(pos).arcs.size();
+        for (size_t i = 0; i < count; ++i) {
+            Arc arc = at(pos).arcs[i];
+            if (arc.back_pos >= start_pos) {
+                ForwardArc forward = {pos, arc.word, arc.type};
+                at(arc.back_pos).forward.push_back(forward);
+            }
+        }
+        at(pos).arcs.clear();
+    }
+
+    // Walk forwards rescoring them with the search mode penalty
+    for (uint32_t pos = start_pos; pos < end_pos; ++pos) {
+        if (at(pos).arcs.empty()) {
+            at(pos).forward.clear();
+            continue;
+        }
+        size_t count = at(pos).forward.size();
+        if (pos == start_pos) {
+            // Only continue the best path into the compound, so the split stays in its context
+            Arc best = at(pos).arcs[best_start_index];
+            for (size_t i = 0; i < count; ++i) {
+                ForwardArc forward = at(pos).forward[i];
+                const JapaneseWordEntry& entry = word_entry(forward.type, forward.word);
+                int32_t cost = best.cost + entry.word_cost + dictionary_.connection_cost(best.right_id, entry.left_id)
+                             + compute_penalty(pos, forward.to_pos - pos);
+                Arc arc = {cost, entry.right_id, pos, best_start_index, forward.word, forward.type};
+                at(forward.to_pos).arcs.push_back(arc);
+            }
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                ForwardArc forward = at(pos).forward[i];
+                add(pos, forward.to_pos, forward.word, forward.type, true);
+            }
+        }
+        at(pos).forward.clear();
+    }
+}
+
+int Lattice::backtrace(uint32_t end_pos, uint32_t best_index, PackedTokenBuffer& tokens) {
+    s_.fragment.clear();
+    uint32_t pos = end_pos;
+    uint32_t best = best_index;
+    int32_t last_left_id = -1;
+    bool has_compound = false;
+    PendingToken compound = {0, 0, 0, 0};
+
+    while (pos > last_backtrace_pos_) {
+        Arc arc = at(pos).arcs[best];
+        uint32_t next_best = arc.back_index;
+
+        if (options_.search_mode && !has_compound) {
+            int penalty = compute_penalty(arc.back_pos, pos - arc.back_pos);
+            if (penalty > 0) {
+                // Accept the best split of a too long token if it costs less than the penalty
+                int32_t max_cost = arc.cost + penalty;
+                if (last_left_id != -1) {
+                    max_cost += dictionary_.connection_cost(arc.right_id, last_left_id);
+                }
+                prune_and_rescore(arc.back_pos, pos, arc.back_index);
+
+                const std::vector<Arc>& rescored = at(pos).arcs;
+                int32_t least_cost = INT_MAX;
+                size_t least_index = rescored.size();
+                for (size_t i = 0; i < rescored.size(); ++i) {
+                    int32_t cost = rescored[i].cost;
+                    if (last_left_id != -1) {
+                        cost += dictionary_.connection_cost(rescored[i].right_id, last_left_id);
+                    }
+                    if (cost < least_cost) {
+                        least_cost = cost;
+                        least_index = i;
+                    }
+                }
+                if (least_index < rescored.size() && least_cost <= max_cost &&
+                    rescored[least_index].back_pos != arc.back_pos) {
+                    PendingToken original = {arc.back_pos, pos, arc.word, arc.type};
+                    compound = original;
+                    has_compound = true;
+                    arc = rescored[least_index];
+                    best = static_cast<uint32_t>(least_index);
+                    next_best = arc.back_index;
+                }
+            }
+        }
+
+        PendingToken token = {arc.back_pos, pos, arc.word, arc.type};
+        s_.fragment.push_back(token);
+        if (has_compound && compound.start >= arc.back_pos) {
+            if (options_.output_compounds) {
+                s_.fragment.push_back(compound);
+            }
+            has_compound = false;
+        }
+
+        last_left_id = word_entry(arc.type, arc.word).left_id;
+        pos = arc.back_pos;
+        best = next_best;
+    }
+
+    // The fragment was collected back to front
+    for (size_t i = s_.fragment.size(); i > 0; --i) {
+        if (emit(s_.fragment[i - 1], tokens) != 0) {
+            return -1;
+        }
+    }
+    last_backtrace_pos_ = end_pos;
+    return 0;
+}
+
+int Lattice::emit(const PendingToken& token, PackedTokenBuffer& tokens) {
+    if (options_.discard_punctuation &&
+        (dictionary_.char_info(s_.units[token.start]) & JapaneseDictionary::CHAR_PUNCTUATION)) {
+        return 0;
+    }
+    const JapaneseWordEntry& entry = word_entry(token.type, token.word);
+    // JapanesePartOfSpeechStopFilter
+    if (entry.flags & JapaneseDictionary::ENTRY_STOP_TAG) {
+        return 0;
+    }
+
+    // JapaneseBaseFormFilter
+    s_.term.clear();
+    size_t base_length = 0;
+    const char* base_form = (token.type == WORD_KNOWN && entry.base_form != JapaneseDictionary::NO_STRING)
+        ? dictionary_.string_data(entry.base_form, base_length) : nullptr;
+    if (base_form) {
+        decode_utf16(base_form, base_length, s_.term);
+    } else {
+        s_.term.assign(s_.units.begin() + token.start, s_.units.begin() + token.end);
+    }
+
+    // CJKWidthFilter, LowerCaseFilter
+    fold_width(s_.term);
+    for (size_t i = 0; i < s_.term.size(); ++i) {
+        s_.term[i] = dictionary_.to_lower(s_.term[i]);
+    }
+    encode_utf8(s_.term.data(), s_.term.size(), s_.utf8);
+
+    // StopFilter
+    if (s_.utf8.empty() || dictionary_.is_stopword(s_.utf8.data(), s_.utf8.size())) {
+        return 0;
+    }
+
+    // JapaneseSegmenter trims every term (String.trim: code units up to U+0020, single bytes in UTF-8)
+    size_t begin = 0;
+    size_t end = s_.utf8.size();
+    while (begin < end && static_cast<unsigned char>(s_.utf8[begin]) <= 0x20) {
+        ++begin;
+    }
+    while (end > begin && static_cast<unsigned char>(s_.utf8[end - 1]) <= 0x20) {
+        --end;
+    }
+    if (begin == end) {
+        return 0;
+    }
+    return tokens.append(s_.utf8.data() + begin, end - begin);
+}
+
+void Lattice::rebase(uint32_t pos) {
+    size_t index = pos - base_;
+    if (index > 0) {
+        std::swap(s_.window[0], s_.window[index]);
+        for (size_t i = 1; i < s_.used; ++i) {
+            s_.window[i].arcs.clear();
+            s_.window[i].forward.clear();
+        }
+        s_.used = 1;
+        base_ = pos;
+    }
+}
+
+int Lattice::run(PackedTokenBuffer& tokens) {
+    const std::vector<uint16_t>& units = s_.units;
+    uint32_t length = static_cast<uint32_t>(units.size());
+
+    s_.used = 0;
+    Arc bos = {0, 0, 0, 0, 0, WORD_BOS};
+    at(0).arcs.push_back(bos);
+
+    for (uint32_t pos = 0; pos < length; ++pos) {
+        if (at(pos).arcs.empty()) {
+            continue;
+        }
+
+        // All paths meet here: emit what lies before, as JapaneseTokenizer does
+        if (pos > last_backtrace_pos_ && next_pos_ == pos + 1) {
+            const std::vector<Arc>& arcs = at(pos).arcs;
+            uint32_t least_index = 0;
+            for (size_t i = 1; i < arcs.size(); ++i) {
+                if (arcs[i].cost < arcs[least_index].cost) {
+                    least_index = static_cast<uint32_t>(i);
+                }
+            }
+            if (backtrace(pos, least_index, tokens) != 0) {
+                return -1;
+            }
+            rebase(pos);
+        }
+
+        // Known words starting here
+        bool any_matches = false;
+        uint32_t node = 0;
+        for (uint32_t ahead = pos; ahead < length; ++ahead) {
+            node = dictionary_.child(node, units[ahead]);
+            if (node == JapaneseDictionary::NO_NODE) {
+                break;
+            }
+            const JapaneseTrieNode& trie_node = dictionary_.node(node);
+            for (uint32_t i = 0; i < trie_node.entry_count; ++i) {
+                add(pos, ahead + 1, trie_node.first_entry + i, WORD_KNOWN, false);
+                any_matches = true;
+            }
+        }
+
+        // Unknown word: a run of the same character class (and punctuation-ness) if the class groups
+        uint8_t info = dictionary_.char_info(units[pos]);
+        if (!any_matches || (info & JapaneseDictionary::CHAR_INVOKE)) {
+            uint8_t char_class = info & JapaneseDictionary::CHAR_CLASS_MASK;
+            uint8_t punctuation = info & JapaneseDictionary::CHAR_PUNCTUATION;
+            uint32_t unknown_length = 1;
+            if (info & JapaneseDictionary::CHAR_GROUP) {
+                for (uint32_t ahead = pos + 1; ahead < length && unknown_length < MAX_UNKNOWN_WORD_LENGTH; ++ahead) {
+                    uint8_t next = dictionary_.char_info(units[ahead]);
+                    if ((next & JapaneseDictionary::CHAR_CLASS_MASK) != char_class ||
+                        (next & JapaneseDictionary::CHAR_PUNCTUATION) != punctuation) {
+                        break;
+                    }
+                    ++unknown_length;
+                }
+            }
+            uint32_t first = dictionary_.unknown_first(char_class);
+            for (uint32_t i = 0; i < dictionary_.unknown_count(char_class); ++i) {
+                add(pos, pos + unknown_length, first + i, WORD_UNKNOWN, false);
+            }
+        }
+    }
+
+    // End of text: the best path including the connection to EOS
+    const std::vector<Arc>& arcs = at(length).arcs;
+    if (length == 0 || arcs.empty()) {
+        return 0;
+    }
+    uint32_t least_index = 0;
+    int32_t least_cost = INT_MAX;
+    for (size_t i = 0; i < arcs.size(); ++i) {
+        int32_t cost = arcs[i].cost + dictionary_.connection_cost(arcs[i].right_id, 0);
+        if (cost < least_cost) {
+            least_cost = cost;
+            least_index = static_cast<uint32_t>(i);
+        }
+    }
+    return backtrace(length, least_index, tokens);
+}
+
+} // namespace
+
+JapaneseTokenizer::JapaneseTokenizer(const JapaneseDictionary& dictionary, const JapaneseTokenizerOptions& options)
+    : dictionary_(dictionary), options_(options) {
+}
+
+int JapaneseTokenizer::segment(const char* text, size_t length, PackedTokenBuffer& tokens) const {
+    TokenizerScratch& s = scratch();
+    decode_utf16(text, length, s.units);
+    Lattice lattice(dictionary_, options_, s);
+    return lattice.run(tokens);
+}
+
+} // namespace japanese_ftparser
+} // namespace oceanbase
@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Japanese Fulltext Parser Plugin - Native Viterbi Tokenizer
+ */
+
+#pragma once
+
+#include "japanese_dictionary.h"
+#include "packed_token_buffer.h"
+#include <cstddef>
+
+namespace oceanbase {
+namespace japanese_ftparser {
+
+/**
+ * Japanese Tokenizer Options
+ * @details Defaults match the "japanese" tokenizer of JapaneseSegmenter
+ */
+struct JapaneseTokenizerOptions {
+    // Split long tokens the way Kuromoji's SEARCH mode does
+    bool search_mode;
+    // Drop tokens starting with punctuation, whitespace or symbols
+    bool discard_punctuation;
+    // In search mode also emit the compound a split token replaced
+    bool output_compounds;
+
+    JapaneseTokenizerOptions() : search_mode(true), discard_punctuation(true), output_compounds(false) {}
+};
+
+/**
+ * Japanese Tokenizer
+ * @brief Native replacement for JapaneseSegmenter's Kuromoji pipeline
+ * @details Builds the same Viterbi lattice as Kuromoji's JapaneseTokenizer
+ * over a mapped IPADIC dictionary: known words from the surface trie,
+ * unknown words by character class, connection costs between neighbours,
+ * search mode penalties and second-best decompounding, backtracking each
+ * time all paths converge. Tokens then pass through the same filter chain:
+ * base form, part-of-speech stop tags, CJK width folding, lower case and
+ * stopwords.
+ * segment() is const and keeps its lattice per thread, so one tokenizer
+ * serves all threads.
+ */
+class JapaneseTokenizer {
+public:
+    /**
+     * @param dictionary Opened dictionary, must outlive the tokenizer
+     */
+    JapaneseTokenizer(const JapaneseDictionary& dictionary, const JapaneseTokenizerOptions& options);
+
+    /**
+     * Segment a UTF-8 document
+     * @param text Input UTF-8 bytes; invalid sequences are read as U+FFFD
+     * @param length Length of the input in bytes
+     * @param tokens Output buffer, tokens are appended
+     * @return 0 on success, -1 on allocation failure
+     */
+    int segment(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) const;
+
+private:
+    const JapaneseDictionary& dictionary_;
+    JapaneseTokenizerOptions options_;
+};
+
+} // namespace japanese_ftparser
+} // namespace oceanbase
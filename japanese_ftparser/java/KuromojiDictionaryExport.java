@@ -0,0 +1,412 @@
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.nio.file.StandardCopyOption;
+import java.nio.file.StandardOpenOption;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+
+import org.apache.lucene.analysis.ja.JapaneseAnalyzer;
+import org.apache.lucene.analysis.ja.dict.BinaryDictionary;
+import org.apache.lucene.analysis.ja.dict.CharacterDefinition;
+import org.apache.lucene.analysis.ja.dict.ConnectionCosts;
+import org.apache.lucene.analysis.ja.dict.TokenInfoDictionary;
+import org.apache.lucene.analysis.ja.dict.UnknownDictionary;
+import org.apache.lucene.util.IntsRef;
+import org.apache.lucene.util.fst.FST;
+import org.apache.lucene.util.fst.IntsRefFSTEnum;
+
+/**
+ * Kuromoji Dictionary Export
+ * Writes the IPADIC tables of the Kuromoji jar as the flat file mapped by the
+ * native Japanese backend (japanese_dictionary.h, OCEANBASE_JAPANESE_DICT_PATH):
+ * connection costs, character definitions, the surface trie with every word's
+ * ids, cost and base form, the unknown word entries and the default stopwords.
+ *
+ * The jar keeps these tables FST and codec encoded, so they are decoded once
+ * here rather than by the plugin at every startup.
+ */
+public class KuromojiDictionaryExport {
+    private static final byte[] MAGIC = {'O', 'B', 'J', 'A', 'D', 'I', 'C', 0};
+    private static final int FORMAT_VERSION = 1;
+    private static final int HEADER_SIZE = 256;
+    private static final int MAX_CHAR_CLASSES = 16;
+    private static final int NO_STRING = -1;
+
+    private static final int CHAR_INVOKE = 0x10;
+    private static final int CHAR_GROUP = 0x20;
+    private static final int CHAR_KANJI = 0x40;
+    private static final int CHAR_PUNCTUATION = 0x80;
+    private static final int ENTRY_STOP_TAG = 0x1;
+
+    // One word: TokenInfoDictionary or UnknownDictionary entry
+    private static final class Entry {
+        short leftId;
+        short rightId;
+        short wordCost;
+        int flags;
+        int baseForm = NO_STRING;
+    }
+
+    // A surface and the words sharing it
+    private static final class Surface {
+        final String text;
+        final List<Entry> entries = new ArrayList<>();
+
+        Surface(String text) {
+            this.text = text;
+        }
+    }
+
+    // Growable int array
+    private static final class IntList {
+        int[] values = new int[1024];
+        int size;
+
+        int add(int value) {
+            if (size == values.length) {
+                values = Arrays.copyOf(values, size * 2);
+            }
+            values[size] = value;
+            return size++;
+        }
+    }
+
+    private final Set<String> stopTags;
+    private final List<Surface> surfaces = new ArrayList<>();
+    private final List<Entry> entries = new ArrayList<>();
+    private final List<Entry> unknownEntries = new ArrayList<>();
+    private final int[] unknownFirst = new int[MAX_CHAR_CLASSES];
+    private final int[] unknownCount = new int[MAX_CHAR_CLASSES];
+    private final Map<String, Integer> stringOffsets = new HashMap<>();
+    private final List<byte[]> strings = new ArrayList<>();
+    private int stringBytes;
+    private int[] stopwords;
+    private int leftSize = 1;
+    private int rightSize = 1;
+
+    // Surface trie: nodes are 4 ints (first edge, edge count, first entry, entry count)
+    private final IntList nodes = new IntList();
+    private final IntList edgeLabels = new IntList();
+    private final IntList edgeTargets = new IntList();
+
+    private KuromojiDictionaryExport(Set<String> stopTags) {
+        this.stopTags = stopTags;
+    }
+
+    private Entry entry(BinaryDictionary dictionary, int wordId, char[] surface, int length) {
+        Entry entry = new Entry();
+        entry.leftId = (short) dictionary.getLeftId(wordId);
+        entry.rightId = (short) dictionary.getRightId(wordId);
+        entry.wordCost = (short) dictionary.getWordCost(wordId);
+        leftSize = Math.max(leftSize, entry.leftId + 1);
+        rightSize = Math.max(rightSize, entry.rightId + 1);
+        if (stopTags != null && stopTags.contains(dictionary.getPartOfSpeech(wordId))) {
+            entry.flags |= ENTRY_STOP_TAG;
+        }
+        String baseForm = surface == null ? null : dictionary.getBaseForm(wordId, surface, 0, length);
+        if (baseForm != null) {
+            entry.baseForm = string(baseForm);
+        }
+        return entry;
+    }
+
+    private int string(String value) {
+        Integer offset = stringOffsets.get(value);
+        if (offset == null) {
+            byte[] bytes = value.getBytes(StandardCharsets.UTF_8);
+            if (bytes.length > 0xFFFF) {
+                throw new IllegalStateException("string too long: " + value);
+            }
+            offset = stringBytes;
+            stringOffsets.put(value, offset);
+            strings.add(bytes);
+            stringBytes += 2 + bytes.length;
+        }
+        return offset;
+    }
+
+    private void readKnownWords() throws IOException {
+        TokenInfoDictionary dictionary = TokenInfoDictionary.getInstance();
+        FST<Long> fst = dictionary.getFST().getInternalFST();
+        IntsRefFSTEnum<Long> words = new IntsRefFSTEnum<>(fst);
+        IntsRef wordIds = new IntsRef();
+        IntsRefFSTEnum.InputOutput<Long> word;
+        while ((word = words.next()) != null) {
+            char[] surface = new char[word.input.length];
+            for (int i = 0; i < surface.length; i++) {
+                surface[i] = (char) word.input.ints[word.input.offset + i];
+            }
+            Surface current = new Surface(new String(surface));
+            dictionary.lookupWordIds(word.output.intValue(), wordIds);
+            for (int i = 0; i < wordIds.length; i++) {
+                current.entries.add(entry(dictionary, wordIds.ints[wordIds.offset + i], surface, surface.length));
+            }
+            surfaces.add(current);
+        }
+        // The FST enumerates in label order already; sort anyway, the trie relies on it
+        surfaces.sort((a, b) -> a.text.compareTo(b.text));
+    }
+
+    private void readUnknownWords() {
+        UnknownDictionary dictionary = UnknownDictionary.getInstance();
+        IntsRef wordIds = new IntsRef();
+        for (int charClass = 0; charClass < CharacterDefinition.CLASS_COUNT; charClass++) {
+            dictionary.lookupWordIds(charClass, wordIds);
+            unknownFirst[charClass] = unknownEntries.size();
+            unknownCount[charClass] = wordIds.length;
+            for (int i = 0; i < wordIds.length; i++) {
+                unknownEntries.add(entry(dictionary, wordIds.ints[wordIds.offset + i], null, 0));
+            }
+        }
+    }
+
+    private void readStopwords() {
+        List<byte[]> words = new ArrayList<>();
+        for (Object stopword : JapaneseAnalyzer.getDefaultStopSet()) {
+            words.add(new String((char[]) stopword).getBytes(StandardCharsets.UTF_8));
+        }
+        // Sorted by unsigned bytes, the order of memcmp in JapaneseDictionary::is_stopword
+        words.sort(KuromojiDictionaryExport::compareBytes);
+        stopwords = new int[words.size()];
+        for (int i = 0; i < stopwords.length; i++) {
+            stopwords[i] = string(new String(words.get(i), StandardCharsets.UTF_8));
+        }
+    }
+
+    private static int compareBytes(byte[] a, byte[] b) {
+        int length = Math.min(a.length, b.length);
+        for (int i = 0; i < length; i++) {
+            int cmp = (a[i] & 0xFF) - (b[i] & 0xFF);
+            if (cmp != 0) {
+                return cmp;
+            }
+        }
+        return a.length - b.length;
+    }
+
+    // Trie node for surfaces [from, to), which share their first depth characters
+    private int buildNode(int from, int to, int depth) {
+        int node = nodes.size / 4;
+        for (int i = 0; i < 4; i++) {
+            nodes.add(0);
+        }
+        if (from < to && surfaces.get(from).text.length() == depth) {
+            nodes.values[node * 4 + 2] = entries.size();
+            nodes.values[node * 4 + 3] = surfaces.get(from).entries.size();
+            entries.addAll(surfaces.get(from).entries);
+            from++;
+        }
+
+        // Edges of a node are contiguous: reserve them before building the children
+        List<int[]> groups = new ArrayList<>();
+        for (int start = from; start < to; ) {
+            char label = surfaces.get(start).text.charAt(depth);
+            int end = start + 1;
+            while (end < to && surfaces.get(end).text.charAt(depth) == label) {
+                end++;
+            }
+            groups.add(new int[] {label, start, end});
+            start = end;
+        }
+        int firstEdge = edgeLabels.size;
+        nodes.values[node * 4] = firstEdge;
+        nodes.values[node * 4 + 1] = groups.size();
+        for (int[] group : groups) {
+            edgeLabels.add(group[0]);
+            edgeTargets.add(0);
+        }
+        for (int i = 0; i < groups.size(); i++) {
+            int[] group = groups.get(i);
+            edgeTargets.values[firstEdge + i] = buildNode(group[1], group[2], depth + 1);
+        }
+        return node;
+    }
+
+    // JapaneseTokenizer.isPunctuation
+    private static boolean isPunctuation(char ch) {
+        switch (Character.getType(ch)) {
+            case Character.SPACE_SEPARATOR:
+            case Character.LINE_SEPARATOR:
+            case Character.PARAGRAPH_SEPARATOR:
+            case Character.CONTROL:
+            case Character.FORMAT:
+            case Character.DASH_PUNCTUATION:
+            case Character.START_PUNCTUATION:
+            case Character.END_PUNCTUATION:
+            case Character.CONNECTOR_PUNCTUATION:
+            case Character.OTHER_PUNCTUATION:
+            case Character.MATH_SYMBOL:
+            case Character.CURRENCY_SYMBOL:
+            case Character.MODIFIER_SYMBOL:
+            case Character.OTHER_SYMBOL:
+            case Character.INITIAL_QUOTE_PUNCTUATION:
+            case Character.FINAL_QUOTE_PUNCTUATION:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    private static long align(long offset) {
+        return (offset + 7) & ~7L;
+    }
+
+    private static void putEntry(ByteBuffer buffer, Entry entry) {
+        buffer.putShort(entry.leftId);
+        buffer.putShort(entry.rightId);
+        buffer.putShort(entry.wordCost);
+        buffer.putShort((short) entry.flags);
+        buffer.putInt(entry.baseForm);
+    }
+
+    private void write(Path path) throws IOException {
+        ConnectionCosts costs = ConnectionCosts.getInstance();
+        CharacterDefinition characters = CharacterDefinition.getInstance();
+
+        long costsOffset = HEADER_SIZE;
+        long charInfoOffset = align(costsOffset + 2L * leftSize * rightSize);
+        long lowerOffset = align(charInfoOffset + 65536);
+        long nodesOffset = align(lowerOffset + 2 * 65536);
+        int nodeCount = nodes.size / 4;
+        long edgeLabelsOffset = align(nodesOffset + 16L * nodeCount);
+        long edgeTargetsOffset = align(edgeLabelsOffset + 2L * edgeLabels.size);
+        long entriesOffset = align(edgeTargetsOffset + 4L * edgeTargets.size);
+        long unknownOffset = align(entriesOffset + 12L * entries.size());
+        long stopwordsOffset = align(unknownOffset + 12L * unknownEntries.size());
+        long stringsOffset = align(stopwordsOffset + 4L * stopwords.length);
+        long total = align(stringsOffset + stringBytes);
+        if (total > Integer.MAX_VALUE) {
+            throw new IllegalStateException("dictionary too large: " + total);
+        }
+
+        ByteBuffer buffer = ByteBuffer.allocate((int) total).order(ByteOrder.LITTLE_ENDIAN);
+        buffer.put(MAGIC);
+        buffer.putInt(FORMAT_VERSION);
+        buffer.putInt(HEADER_SIZE);
+        buffer.putInt(leftSize);
+        buffer.putInt(rightSize);
+        buffer.putInt(nodeCount);
+        buffer.putInt(edgeLabels.size);
+        buffer.putInt(entries.size());
+        buffer.putInt(unknownEntries.size());
+        buffer.putInt(stopwords.length);
+        buffer.putInt(stringBytes);
+        for (int value : unknownFirst) {
+            buffer.putInt(value);
+        }
+        for (int value : unknownCount) {
+            buffer.putInt(value);
+        }
+        for (long offset : new long[] {costsOffset, charInfoOffset, lowerOffset, nodesOffset, edgeLabelsOffset,
+                                       edgeTargetsOffset, entriesOffset, unknownOffset, stopwordsOffset,
+                                       stringsOffset}) {
+            buffer.putLong(offset);
+        }
+
+        buffer.position((int) costsOffset);
+        for (int right = 0; right < rightSize; right++) {
+            for (int left = 0; left < leftSize; left++) {
+                int cost = costs.get(right, left);
+                if (cost < Short.MIN_VALUE || cost > Short.MAX_VALUE) {
+                    throw new IllegalStateException("connection cost out of range: " + cost);
+                }
+                buffer.putShort((short) cost);
+            }
+        }
+
+        buffer.position((int) charInfoOffset);
+        for (int c = 0; c < 65536; c++) {
+            char ch = (char) c;
+            int info = characters.getCharacterClass(ch);
+            if (info >= MAX_CHAR_CLASSES) {
+                throw new IllegalStateException("character class out of range: " + info);
+            }
+            info |= characters.isInvoke(ch) ? CHAR_INVOKE : 0;
+            info |= characters.isGroup(ch) ? CHAR_GROUP : 0;
+            info |= characters.isKanji(ch) ? CHAR_KANJI : 0;
+            info |= isPunctuation(ch) ? CHAR_PUNCTUATION : 0;
+            buffer.put((byte) info);
+        }
+
+        buffer.position((int) lowerOffset);
+        for (int c = 0; c < 65536; c++) {
+            buffer.putShort((short) Character.toLowerCase((char) c));
+        }
+
+        buffer.position((int) nodesOffset);
+        for (int i = 0; i < nodes.size; i++) {
+            buffer.putInt(nodes.values[i]);
+        }
+        buffer.position((int) edgeLabelsOffset);
+        for (int i = 0; i < edgeLabels.size; i++) {
+            buffer.putShort((short) edgeLabels.values[i]);
+        }
+        buffer.position((int) edgeTargetsOffset);
+        for (int i = 0; i < edgeTargets.size; i++) {
+            buffer.putInt(edgeTargets.values[i]);
+        }
+        buffer.position((int) entriesOffset);
+        for (Entry entry : entries) {
+            putEntry(buffer, entry);
+        }
+        buffer.position((int) unknownOffset);
+        for (Entry entry : unknownEntries) {
+            putEntry(buffer, entry);
+        }
+        buffer.position((int) stopwordsOffset);
+        for (int offset : stopwords) {
+            buffer.putInt(offset);
+        }
+        buffer.position((int) stringsOffset);
+        for (byte[] bytes : strings) {
+            buffer.putShort((short) bytes.length);
+            buffer.put(bytes);
+        }
+
+        // Write aside and rename, so a running observer never maps a half written file
+        buffer.position(0);
+        Path temp = Paths.get(path.toString() + ".tmp");
+        try (FileChannel channel = FileChannel.open(temp, StandardOpenOption.CREATE, StandardOpenOption.WRITE,
+                                                    StandardOpenOption.TRUNCATE_EXISTING)) {
+            while (buffer.hasRemaining()) {
+                channel.write(buffer);
+            }
+        }
+        Files.move(temp, path, StandardCopyOption.REPLACE_EXISTING, StandardCopyOption.ATOMIC_MOVE);
+        System.out.println("Exported " + entries.size() + " words, " + nodeCount + " trie nodes, "
+                           + unknownEntries.size() + " unknown words, " + stopwords.length + " stopwords ("
+                           + total + " bytes) to " + path);
+    }
+
+    /**
+     * Main method for command line usage
+     * Usage: java KuromojiDictionaryExport <output.dic> [--default-stoptags]
+     *   --default-stoptags : mark the parts of speech of JapaneseAnalyzer.getDefaultStopTags() as
+     *                        stopped; JapaneseSegmenter configures japanesePartOfSpeechStop without
+     *                        tags, which stops nothing, so the default export stops nothing either
+     */
+    public static void main(String[] args) throws IOException {
+        if (args.length < 1 || args.length > 2 || (args.length == 2 && !args[1].equals("--default-stoptags"))) {
+            System.out.println("Usage: java KuromojiDictionaryExport <output.dic> [--default-stoptags]");
+            return;
+        }
+
+        KuromojiDictionaryExport export = new KuromojiDictionaryExport(
+            args.length == 2 ? JapaneseAnalyzer.getDefaultStopTags() : null);
+        export.readKnownWords();
+        export.readUnknownWords();
+        export.readStopwords();
+        export.buildNode(0, export.surfaces.size(), 0);
+        export.write(Paths.get(args[0]));
+    }
+}
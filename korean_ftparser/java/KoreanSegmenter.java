@@ -1,23 +1,66 @@
 import java.io.StringReader;
+import java.io.Closeable;
 import java.io.IOException;
+import java.io.Reader;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.channels.Channels;
+import java.nio.channels.ReadableByteChannel;
+import java.nio.charset.CodingErrorAction;
+import java.nio.charset.StandardCharsets;
 import java.util.ArrayList;
 import java.util.List;
+import java.util.TreeMap;
 
 import org.apache.lucene.analysis.Analyzer;
+import org.apache.lucene.analysis.AnalyzerWrapper;
 import org.apache.lucene.analysis.TokenStream;
 import org.apache.lucene.analysis.custom.CustomAnalyzer;
 import org.apache.lucene.analysis.tokenattributes.CharTermAttribute;
+import org.apache.lucene.analysis.util.AbstractAnalysisFactory;
+import org.apache.lucene.analysis.util.CharFilterFactory;
+import org.apache.lucene.analysis.util.TokenFilterFactory;
+import org.apache.lucene.util.Version;
 
 /**
  * Korean Segmenter using CustomAnalyzer
  * nori_tokenizer + lowercase (no excessive filtering)
+ *
+ * Thread-safe: one instance is shared by all native threads, Lucene keeps
+ * the TokenStream components per thread.
  */
 public class KoreanSegmenter {
-    private Analyzer analyzer;
-    private boolean initialized = false;
+    // Never hand out cached TokenStream components (one fresh pipeline per cursor)
+    private static final Analyzer.ReuseStrategy NO_REUSE = new Analyzer.ReuseStrategy() {
+        @Override
+        public Analyzer.TokenStreamComponents getReusableComponents(Analyzer analyzer, String fieldName) {
+            return null;
+        }
+        
+        @Override
+        public void setReusableComponents(Analyzer analyzer, String fieldName,
+                                          Analyzer.TokenStreamComponents components) {
+        }
+    };
+    
+    private static final SegmenterLog LOG = new SegmenterLog("KoreanSegmenter");
+    private static final boolean DEBUG = SegmenterLog.DEBUG_ENABLED;
+    
+    // Bump when a change here changes the tokens without changing the analyzer chain
+    private static final int PIPELINE_VERSION = 1;
+    
+    private static final SegmenterLog.Site LIFECYCLE_LOG = new SegmenterLog.Site();
+    private static final SegmenterLog.Site SEGMENT_LOG = new SegmenterLog.Site();
+    private static final SegmenterLog.Site ERROR_LOG = new SegmenterLog.Site();
+    
+    private final Analyzer analyzer;
+    // Same pipeline without per-thread reuse, so open cursors never share components
+    private final Analyzer cursorAnalyzer;
+    private volatile boolean initialized = false;
 
     /**
      * Constructor
+     * @throws IllegalStateException if the analyzer pipeline cannot be built
      */
     public KoreanSegmenter() {
         try {
@@ -27,14 +70,18 @@ public class KoreanSegmenter {
                 .addTokenFilter("lowercase")    // lowercase (basic normalization)
                 .build();
                 
+            this.cursorAnalyzer = new AnalyzerWrapper(NO_REUSE) {
+                @Override
+                protected Analyzer getWrappedAnalyzer(String fieldName) {
+                    return KoreanSegmenter.this.analyzer;
+                }
+            };
             this.initialized = true;
-            System.out.println("KoreanSegmenter initialized with MIXED mode (ES Database Best Practice)");
-            System.out.println("MIXED mode: preserves both original compound words and decomposed parts");
-            System.out.println("Benefits: precise search (완전한단어) + flexible search (부분단어)");
+            LOG.log(LIFECYCLE_LOG, SegmenterLog.INFO, "Initialized with MIXED mode (ES Database Best Practice): "
+                + "preserves both original compound words (완전한단어) and decomposed parts (부분단어)");
         } catch (Exception e) {
-            System.err.println("Failed to initialize MIXED mode CustomAnalyzer: " + e.getMessage());
-            e.printStackTrace();
-            this.initialized = false;
+            LOG.log(ERROR_LOG, SegmenterLog.ERROR, "Failed to initialize MIXED mode CustomAnalyzer: " + e);
+            throw new IllegalStateException("Failed to initialize KoreanSegmenter", e);
         }
     }
 
@@ -45,21 +92,22 @@ public class KoreanSegmenter {
      */
     public String[] segment(String text) {
         if (!initialized) {
-            System.err.println("KoreanSegmenter is not properly initialized");
+            LOG.log(ERROR_LOG, SegmenterLog.ERROR, "KoreanSegmenter is not properly initialized");
             return new String[0];
         }
 
         if (text == null || text.trim().isEmpty()) {
-            System.out.println("=== OCEANBASE JNI CALL === Korean segmentation: empty input");
             return new String[0];
         }
 
-        System.out.println("=== OCEANBASE JNI CALL === Segmenting Korean text with MIXED mode: \"" + text + "\" (length: " + text.length() + ")");
+        if (DEBUG) {
+            LOG.log(SEGMENT_LOG, SegmenterLog.DEBUG, "Segmenting Korean text with MIXED mode: \"" + text + "\" (length: " + text.length() + ")");
+        }
 
         List<String> tokens = new ArrayList<>();
 
-        try {
-            TokenStream tokenStream = analyzer.tokenStream("content", new StringReader(text));
+        // Always close the per-thread stream, even when tokenization fails
+        try (TokenStream tokenStream = analyzer.tokenStream("content", new StringReader(text))) {
             CharTermAttribute attr = tokenStream.addAttribute(CharTermAttribute.class);
             
             tokenStream.reset();
@@ -70,39 +118,281 @@ public class KoreanSegmenter {
                 }
             }
             tokenStream.end();
-            tokenStream.close();
 
         } catch (IOException e) {
-            System.err.println("Error during Korean tokenization: " + e.getMessage());
+            LOG.log(ERROR_LOG, SegmenterLog.ERROR, "Error during Korean tokenization: " + e);
             return new String[0];
         }
 
         String[] result = tokens.toArray(new String[0]);
-        System.out.println("=== OCEANBASE JNI RESULT === MIXED mode Korean result: " + java.util.Arrays.toString(result));
-
-        // Debug: Print each token's byte and char length
-        for (int i = 0; i < result.length; i++) {
-            try {
-                byte[] utf8Bytes = result[i].getBytes("UTF-8");
-                System.out.println("  Token[" + i + "]: '" + result[i] + "' -> " + utf8Bytes.length + " bytes, " + result[i].length() + " chars");
-            } catch (Exception e) {
-                System.out.println("  Token[" + i + "]: '" + result[i] + "' -> encoding error: " + e.getMessage());
+        if (DEBUG) {
+            // Each token with its UTF-8 byte and char length
+            StringBuilder message = new StringBuilder("MIXED mode Korean result:");
+            for (String token : result) {
+                message.append(" '").append(token).append("' (")
+                       .append(token.getBytes(StandardCharsets.UTF_8).length).append(" bytes, ")
+                       .append(token.length()).append(" chars)");
             }
+            LOG.log(SEGMENT_LOG, SegmenterLog.DEBUG, message.toString());
         }
 
         return result;
     }
 
+    /**
+     * Segment a document passed from native code as a direct ByteBuffer
+     * @param utf8Text Standard UTF-8 bytes of the document (only read during the call)
+     * @return Array of segmented tokens
+     */
+    public String[] segment(ByteBuffer utf8Text) {
+        if (utf8Text == null) {
+            return new String[0];
+        }
+        // Decode a duplicate so the caller's buffer position is left untouched
+        return segment(StandardCharsets.UTF_8.decode(utf8Text.duplicate()).toString());
+    }
+
+    /**
+     * Segment a document and write all tokens into a native-owned direct buffer
+     * Layout per token (native byte order): int32 UTF-8 byte length, int32 character count, UTF-8 bytes
+     * @param utf8Text Standard UTF-8 bytes of the document (only read during the call)
+     * @param output Native buffer receiving the packed tokens
+     * @return Number of bytes written, or the negated required size if output is too small
+     */
+    public int segmentInto(ByteBuffer utf8Text, ByteBuffer output) {
+        String[] tokens = segment(utf8Text);
+        byte[][] encoded = new byte[tokens.length][];
+        long required = 0;
+        for (int i = 0; i < tokens.length; i++) {
+            encoded[i] = tokens[i].getBytes(StandardCharsets.UTF_8);
+            required += 8 + encoded[i].length;
+        }
+        if (required > Integer.MAX_VALUE) {
+            throw new IllegalStateException("Segmentation result too large: " + required + " bytes");
+        }
+        if (required > output.capacity()) {
+            return (int) -required;
+        }
+        
+        output.clear();
+        output.order(ByteOrder.nativeOrder());
+        for (int i = 0; i < tokens.length; i++) {
+            output.putInt(encoded[i].length);
+            output.putInt(tokens[i].codePointCount(0, tokens[i].length()));
+            output.put(encoded[i]);
+        }
+        return (int) required;
+    }
+    
+    /**
+     * Segment many documents with a single JNI call
+     * Input layout per document (native byte order): int32 UTF-8 byte length, UTF-8 bytes
+     * Output layout per document: int32 block size, then its tokens in the segmentInto layout
+     * Documents are written in input order until the next one no longer fits; the caller
+     * resubmits the remaining documents.
+     * @param documents Packed input documents (only read during the call)
+     * @param output Native buffer receiving one token block per document
+     * @return Number of bytes written for the leading documents that fit, or the negated
+     *         size the first document needs if not even that one fits
+     */
+    public int segmentBatch(ByteBuffer documents, ByteBuffer output) {
+        ByteBuffer input = documents.duplicate().order(ByteOrder.nativeOrder());
+        output.clear();
+        output.order(ByteOrder.nativeOrder());
+        
+        while (input.remaining() >= 4) {
+            int length = input.getInt();
+            ByteBuffer document = input.slice();
+            document.limit(length);
+            input.position(input.position() + length);
+            
+            int blockStart = output.position();
+            ByteBuffer block;
+            if (output.remaining() >= 4) {
+                output.position(blockStart + 4);
+                block = output.slice();
+                output.position(blockStart);
+            } else {
+                block = ByteBuffer.allocate(0);
+            }
+            
+            int used = segmentInto(document, block);
+            if (used < 0 || output.remaining() < 4) {
+                if (blockStart > 0) {
+                    return blockStart;
+                }
+                return -(4 + Math.abs(used));
+            }
+            output.putInt(used);
+            output.position(blockStart + 4 + used);
+        }
+        return output.position();
+    }
+    
+    /**
+     * Open a cursor that segments a large document incrementally
+     * The cursor owns its TokenStream, so it neither blocks segment() on the calling
+     * thread nor holds more than one chunk of tokens at a time.
+     * @param utf8Text Standard UTF-8 bytes of the document, must stay valid until the cursor is closed
+     * @return Cursor positioned before the first token
+     * @throws IOException if the token stream cannot be opened
+     */
+    public TokenCursor openCursor(ByteBuffer utf8Text) throws IOException {
+        if (!initialized) {
+            throw new IllegalStateException("KoreanSegmenter not initialized");
+        }
+        return new TokenCursor(cursorAnalyzer.tokenStream("content", utf8Reader(utf8Text)));
+    }
+    
+    /**
+     * Write the next chunk of tokens of an open cursor (segmentInto layout)
+     * @param cursor Cursor returned by openCursor
+     * @param output Native buffer receiving the packed tokens
+     * @return Number of bytes written (0 once the document is exhausted), or the
+     *         negated required size if not even the next token fits
+     */
+    public int nextTokens(TokenCursor cursor, ByteBuffer output) throws IOException {
+        return cursor.next(output);
+    }
+    
+    /**
+     * Close an open cursor and release its TokenStream
+     * @param cursor Cursor returned by openCursor
+     */
+    public void closeCursor(TokenCursor cursor) throws IOException {
+        cursor.close();
+    }
+    
+    /**
+     * Decode UTF-8 lazily, so a large document is never copied into one String
+     */
+    private static Reader utf8Reader(ByteBuffer utf8Text) {
+        final ByteBuffer bytes = utf8Text.duplicate();
+        ReadableByteChannel channel = new ReadableByteChannel() {
+            @Override
+            public int read(ByteBuffer dst) {
+                if (!bytes.hasRemaining()) {
+                    return -1;
+                }
+                int count = Math.min(dst.remaining(), bytes.remaining());
+                ByteBuffer slice = bytes.duplicate();
+                slice.limit(slice.position() + count);
+                dst.put(slice);
+                bytes.position(bytes.position() + count);
+                return count;
+            }
+            
+            @Override
+            public boolean isOpen() {
+                return true;
+            }
+            
+            @Override
+            public void close() {
+            }
+        };
+        return Channels.newReader(channel, StandardCharsets.UTF_8.newDecoder()
+            .onMalformedInput(CodingErrorAction.REPLACE)
+            .onUnmappableCharacter(CodingErrorAction.REPLACE), -1);
+    }
+    
+    /**
+     * Incremental token cursor over one document
+     */
+    public static final class TokenCursor implements Closeable {
+        private final TokenStream tokenStream;
+        private final CharTermAttribute termAttr;
+        private byte[] pending;
+        private int pendingChars;
+        private boolean exhausted = false;
+        
+        TokenCursor(TokenStream tokenStream) throws IOException {
+            this.tokenStream = tokenStream;
+            this.termAttr = tokenStream.addAttribute(CharTermAttribute.class);
+            tokenStream.reset();
+        }
+        
+        int next(ByteBuffer output) throws IOException {
+            output.clear();
+            output.order(ByteOrder.nativeOrder());
+            while (pending != null || advance()) {
+                int required = 8 + pending.length;
+                if (required > output.remaining()) {
+                    // Keep the token for the next chunk
+                    if (output.position() == 0) {
+                        return -required;
+                    }
+                    break;
+                }
+                output.putInt(pending.length);
+                output.putInt(pendingChars);
+                output.put(pending);
+                pending = null;
+            }
+            return output.position();
+        }
+        
+        private boolean advance() throws IOException {
+            while (!exhausted) {
+                if (!tokenStream.incrementToken()) {
+                    tokenStream.end();
+                    exhausted = true;
+                    break;
+                }
+                String token = termAttr.toString();
+                if (!token.trim().isEmpty()) {
+                    pending = token.getBytes(StandardCharsets.UTF_8);
+                    pendingChars = token.codePointCount(0, token.length());
+                    return true;
+                }
+            }
+            return false;
+        }
+        
+        @Override
+        public void close() throws IOException {
+            tokenStream.close();
+        }
+    }
+
     /**
      * Cleanup resources
      */
     public void close() {
+        initialized = false;
         if (analyzer != null) {
             analyzer.close();
-            System.out.println("KoreanSegmenter closed");
+            cursorAnalyzer.close();
+            LOG.log(LIFECYCLE_LOG, SegmenterLog.INFO, "Closed");
         }
     }
 
+    /**
+     * Describe everything that decides the tokens: PIPELINE_VERSION, the
+     * Lucene version, and the tokenizer and filters with their arguments.
+     * The native side only reuses cached results under the same fingerprint
+     * @return The fingerprint of the analyzer chain
+     */
+    public String pipelineFingerprint() {
+        CustomAnalyzer custom = (CustomAnalyzer) analyzer;
+        StringBuilder fingerprint = new StringBuilder();
+        fingerprint.append("pipeline=").append(PIPELINE_VERSION).append("|lucene=").append(Version.LATEST);
+        for (CharFilterFactory factory : custom.getCharFilterFactories()) {
+            appendFactory(fingerprint, factory);
+        }
+        appendFactory(fingerprint, custom.getTokenizerFactory());
+        for (TokenFilterFactory factory : custom.getTokenFilterFactories()) {
+            appendFactory(fingerprint, factory);
+        }
+        return fingerprint.toString();
+    }
+    
+    private static void appendFactory(StringBuilder fingerprint, AbstractAnalysisFactory factory) {
+        // Sorted, so the same arguments always give the same text
+        fingerprint.append('|').append(factory.getClass().getName())
+            .append(new TreeMap<String, String>(factory.getOriginalArgs()));
+    }
+    
     /**
      * Main method for testing
      */
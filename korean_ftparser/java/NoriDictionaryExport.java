@@ -0,0 +1,428 @@
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.nio.file.StandardCopyOption;
+import java.nio.file.StandardOpenOption;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+import org.apache.lucene.analysis.ko.POS;
+import org.apache.lucene.analysis.ko.dict.BinaryDictionary;
+import org.apache.lucene.analysis.ko.dict.CharacterDefinition;
+import org.apache.lucene.analysis.ko.dict.ConnectionCosts;
+import org.apache.lucene.analysis.ko.dict.Dictionary;
+import org.apache.lucene.analysis.ko.dict.TokenInfoDictionary;
+import org.apache.lucene.analysis.ko.dict.UnknownDictionary;
+import org.apache.lucene.util.IntsRef;
+import org.apache.lucene.util.fst.FST;
+import org.apache.lucene.util.fst.IntsRefFSTEnum;
+
+/**
+ * Nori Dictionary Export
+ * Writes the mecab-ko-dic tables of the Nori jar as the flat file mapped by the
+ * native Korean backend (korean_dictionary.h, OCEANBASE_KOREAN_DICT_PATH):
+ * connection costs, character definitions and scripts, the surface trie with
+ * every word's ids, cost and morphemes, and the unknown word entries.
+ *
+ * The jar keeps these tables FST and codec encoded, so they are decoded once
+ * here rather than by the plugin at every startup.
+ */
+public class NoriDictionaryExport {
+    private static final byte[] MAGIC = {'O', 'B', 'K', 'O', 'D', 'I', 'C', 0};
+    private static final int FORMAT_VERSION = 1;
+    private static final int HEADER_SIZE = 264;
+    private static final int MAX_CHAR_CLASSES = 16;
+    private static final int NO_MORPHEMES = -1;
+
+    private static final int CHAR_INVOKE = 0x0010;
+    private static final int CHAR_GROUP = 0x0020;
+    private static final int CHAR_PUNCTUATION = 0x0040;
+    private static final int CHAR_DIGIT = 0x0080;
+    private static final int CHAR_NON_SPACING_MARK = 0x0100;
+    private static final int CHAR_SPACE = 0x0200;
+    private static final int ENTRY_SPACE_PENALTY = 0x1;
+
+    // One word: TokenInfoDictionary or UnknownDictionary entry
+    private static final class Entry {
+        short leftId;
+        short rightId;
+        short wordCost;
+        int type;
+        int flags;
+        int morphemes = NO_MORPHEMES;
+    }
+
+    // A surface and the words sharing it
+    private static final class Surface {
+        final String text;
+        final List<Entry> entries = new ArrayList<>();
+
+        Surface(String text) {
+            this.text = text;
+        }
+    }
+
+    // Growable int array
+    private static final class IntList {
+        int[] values = new int[1024];
+        int size;
+
+        int add(int value) {
+            if (size == values.length) {
+                values = Arrays.copyOf(values, size * 2);
+            }
+            values[size] = value;
+            return size++;
+        }
+    }
+
+    private final List<Surface> surfaces = new ArrayList<>();
+    private final List<Entry> entries = new ArrayList<>();
+    private final List<Entry> unknownEntries = new ArrayList<>();
+    private final int[] unknownFirst = new int[MAX_CHAR_CLASSES];
+    private final int[] unknownCount = new int[MAX_CHAR_CLASSES];
+    private final Map<String, Integer> stringOffsets = new HashMap<>();
+    private final List<byte[]> strings = new ArrayList<>();
+    private final IntList morphemes = new IntList();
+    private int stringBytes;
+    private int leftSize = 1;
+    private int rightSize = 1;
+
+    // Surface trie: nodes are 4 ints (first edge, edge count, first entry, entry count)
+    private final IntList nodes = new IntList();
+    private final IntList edgeLabels = new IntList();
+    private final IntList edgeTargets = new IntList();
+
+    // KoreanTokenizer.computeSpacePenalty
+    private static boolean hasSpacePenalty(POS.Tag leftPOS) {
+        switch (leftPOS) {
+            case E:
+            case J:
+            case VCP:
+            case XSA:
+            case XSN:
+            case XSV:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    private Entry entry(BinaryDictionary dictionary, int wordId, char[] surface, int length) {
+        Entry entry = new Entry();
+        entry.leftId = (short) dictionary.getLeftId(wordId);
+        entry.rightId = (short) dictionary.getRightId(wordId);
+        entry.wordCost = (short) dictionary.getWordCost(wordId);
+        entry.type = dictionary.getPOSType(wordId).ordinal();
+        leftSize = Math.max(leftSize, entry.leftId + 1);
+        rightSize = Math.max(rightSize, entry.rightId + 1);
+        if (hasSpacePenalty(dictionary.getLeftPOS(wordId))) {
+            entry.flags |= ENTRY_SPACE_PENALTY;
+        }
+        if (surface != null && dictionary.getPOSType(wordId) != POS.Type.MORPHEME) {
+            Dictionary.Morpheme[] parts = dictionary.getMorphemes(wordId, surface, 0, length);
+            if (parts != null && parts.length > 0) {
+                entry.morphemes = morphemes.add(parts.length);
+                for (Dictionary.Morpheme part : parts) {
+                    morphemes.add(string(part.surfaceForm));
+                }
+            }
+        }
+        return entry;
+    }
+
+    private int string(String value) {
+        Integer offset = stringOffsets.get(value);
+        if (offset == null) {
+            byte[] bytes = value.getBytes(StandardCharsets.UTF_8);
+            if (bytes.length > 0xFFFF) {
+                throw new IllegalStateException("string too long: " + value);
+            }
+            offset = stringBytes;
+            stringOffsets.put(value, offset);
+            strings.add(bytes);
+            stringBytes += 2 + bytes.length;
+        }
+        return offset;
+    }
+
+    private void readKnownWords() throws IOException {
+        TokenInfoDictionary dictionary = TokenInfoDictionary.getInstance();
+        FST<Long> fst = dictionary.getFST().getInternalFST();
+        IntsRefFSTEnum<Long> words = new IntsRefFSTEnum<>(fst);
+        IntsRef wordIds = new IntsRef();
+        IntsRefFSTEnum.InputOutput<Long> word;
+        while ((word = words.next()) != null) {
+            char[] surface = new char[word.input.length];
+            for (int i = 0; i < surface.length; i++) {
+                surface[i] = (char) word.input.ints[word.input.offset + i];
+            }
+            Surface current = new Surface(new String(surface));
+            dictionary.lookupWordIds(word.output.intValue(), wordIds);
+            for (int i = 0; i < wordIds.length; i++) {
+                current.entries.add(entry(dictionary, wordIds.ints[wordIds.offset + i], surface, surface.length));
+            }
+            surfaces.add(current);
+        }
+        // The FST enumerates in label order already; sort anyway, the trie relies on it
+        surfaces.sort((a, b) -> a.text.compareTo(b.text));
+    }
+
+    private void readUnknownWords() {
+        UnknownDictionary dictionary = UnknownDictionary.getInstance();
+        IntsRef wordIds = new IntsRef();
+        for (int charClass = 0; charClass < CharacterDefinition.CLASS_COUNT; charClass++) {
+            dictionary.lookupWordIds(charClass, wordIds);
+            unknownFirst[charClass] = unknownEntries.size();
+            unknownCount[charClass] = wordIds.length;
+            for (int i = 0; i < wordIds.length; i++) {
+                unknownEntries.add(entry(dictionary, wordIds.ints[wordIds.offset + i], null, 0));
+            }
+        }
+    }
+
+    // Trie node for surfaces [from, to), which share their first depth characters
+    private int buildNode(int from, int to, int depth) {
+        int node = nodes.size / 4;
+        for (int i = 0; i < 4; i++) {
+            nodes.add(0);
+        }
+        if (from < to && surfaces.get(from).text.length() == depth) {
+            nodes.values[node * 4 + 2] = entries.size();
+            nodes.values[node * 4 + 3] = surfaces.get(from).entries.size();
+            entries.addAll(surfaces.get(from).entries);
+            from++;
+        }
+
+        // Edges of a node are contiguous: reserve them before building the children
+        List<int[]> groups = new ArrayList<>();
+        for (int start = from; start < to; ) {
+            char label = surfaces.get(start).text.charAt(depth);
+            int end = start + 1;
+            while (end < to && surfaces.get(end).text.charAt(depth) == label) {
+                end++;
+            }
+            groups.add(new int[] {label, start, end});
+            start = end;
+        }
+        int firstEdge = edgeLabels.size;
+        nodes.values[node * 4] = firstEdge;
+        nodes.values[node * 4 + 1] = groups.size();
+        for (int[] group : groups) {
+            edgeLabels.add(group[0]);
+            edgeTargets.add(0);
+        }
+        for (int i = 0; i < groups.size(); i++) {
+            int[] group = groups.get(i);
+            edgeTargets.values[firstEdge + i] = buildNode(group[1], group[2], depth + 1);
+        }
+        return node;
+    }
+
+    // KoreanTokenizer.isPunctuation
+    private static boolean isPunctuation(char ch) {
+        // special case for Hangul Letter Araea (interpunct)
+        if (ch == 0x318D) {
+            return true;
+        }
+        switch (Character.getType(ch)) {
+            case Character.SPACE_SEPARATOR:
+            case Character.LINE_SEPARATOR:
+            case Character.PARAGRAPH_SEPARATOR:
+            case Character.CONTROL:
+            case Character.FORMAT:
+            case Character.DASH_PUNCTUATION:
+            case Character.START_PUNCTUATION:
+            case Character.END_PUNCTUATION:
+            case Character.CONNECTOR_PUNCTUATION:
+            case Character.OTHER_PUNCTUATION:
+            case Character.MATH_SYMBOL:
+            case Character.CURRENCY_SYMBOL:
+            case Character.MODIFIER_SYMBOL:
+            case Character.OTHER_SYMBOL:
+            case Character.INITIAL_QUOTE_PUNCTUATION:
+            case Character.FINAL_QUOTE_PUNCTUATION:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Script code of a UTF-16 code unit: 0 for Common and Inherited (compatible with every script)
+    private static int scriptCode(char ch) {
+        Character.UnicodeScript script = Character.UnicodeScript.of(ch);
+        if (script == Character.UnicodeScript.COMMON || script == Character.UnicodeScript.INHERITED) {
+            return 0;
+        }
+        int code = script.ordinal() + 1;
+        if (code > 0xFF) {
+            throw new IllegalStateException("script code out of range: " + script);
+        }
+        return code;
+    }
+
+    private static long align(long offset) {
+        return (offset + 7) & ~7L;
+    }
+
+    private static void putEntry(ByteBuffer buffer, Entry entry) {
+        buffer.putShort(entry.leftId);
+        buffer.putShort(entry.rightId);
+        buffer.putShort(entry.wordCost);
+        buffer.put((byte) entry.type);
+        buffer.put((byte) entry.flags);
+        buffer.putInt(entry.morphemes);
+    }
+
+    private void write(Path path) throws IOException {
+        ConnectionCosts costs = ConnectionCosts.getInstance();
+        CharacterDefinition characters = CharacterDefinition.getInstance();
+
+        long costsOffset = HEADER_SIZE;
+        long charInfoOffset = align(costsOffset + 2L * leftSize * rightSize);
+        long scriptOffset = align(charInfoOffset + 2 * 65536);
+        long lowerOffset = align(scriptOffset + 65536);
+        long nodesOffset = align(lowerOffset + 2 * 65536);
+        int nodeCount = nodes.size / 4;
+        long edgeLabelsOffset = align(nodesOffset + 16L * nodeCount);
+        long edgeTargetsOffset = align(edgeLabelsOffset + 2L * edgeLabels.size);
+        long entriesOffset = align(edgeTargetsOffset + 4L * edgeTargets.size);
+        long unknownOffset = align(entriesOffset + 12L * entries.size());
+        long morphemesOffset = align(unknownOffset + 12L * unknownEntries.size());
+        long stringsOffset = align(morphemesOffset + 4L * morphemes.size);
+        long total = align(stringsOffset + stringBytes);
+        if (total > Integer.MAX_VALUE) {
+            throw new IllegalStateException("dictionary too large: " + total);
+        }
+
+        ByteBuffer buffer = ByteBuffer.allocate((int) total).order(ByteOrder.LITTLE_ENDIAN);
+        buffer.put(MAGIC);
+        buffer.putInt(FORMAT_VERSION);
+        buffer.putInt(HEADER_SIZE);
+        buffer.putInt(leftSize);
+        buffer.putInt(rightSize);
+        buffer.putInt(nodeCount);
+        buffer.putInt(edgeLabels.size);
+        buffer.putInt(entries.size());
+        buffer.putInt(unknownEntries.size());
+        buffer.putInt(morphemes.size);
+        buffer.putInt(stringBytes);
+        for (int value : unknownFirst) {
+            buffer.putInt(value);
+        }
+        for (int value : unknownCount) {
+            buffer.putInt(value);
+        }
+        for (long offset : new long[] {costsOffset, charInfoOffset, scriptOffset, lowerOffset, nodesOffset,
+                                       edgeLabelsOffset, edgeTargetsOffset, entriesOffset, unknownOffset,
+                                       morphemesOffset, stringsOffset}) {
+            buffer.putLong(offset);
+        }
+
+        buffer.position((int) costsOffset);
+        for (int right = 0; right < rightSize; right++) {
+            for (int left = 0; left < leftSize; left++) {
+                int cost = costs.get(right, left);
+                if (cost < Short.MIN_VALUE || cost > Short.MAX_VALUE) {
+                    throw new IllegalStateException("connection cost out of range: " + cost);
+                }
+                buffer.putShort((short) cost);
+            }
+        }
+
+        buffer.position((int) charInfoOffset);
+        for (int c = 0; c < 65536; c++) {
+            char ch = (char) c;
+            int info = characters.getCharacterClass(ch);
+            if (info >= MAX_CHAR_CLASSES) {
+                throw new IllegalStateException("character class out of range: " + info);
+            }
+            int type = Character.getType(ch);
+            info |= characters.isInvoke(ch) ? CHAR_INVOKE : 0;
+            info |= characters.isGroup(ch) ? CHAR_GROUP : 0;
+            info |= isPunctuation(ch) ? CHAR_PUNCTUATION : 0;
+            info |= Character.isDigit(ch) ? CHAR_DIGIT : 0;
+            info |= type == Character.NON_SPACING_MARK ? CHAR_NON_SPACING_MARK : 0;
+            info |= type == Character.SPACE_SEPARATOR ? CHAR_SPACE : 0;
+            buffer.putShort((short) info);
+        }
+
+        buffer.position((int) scriptOffset);
+        for (int c = 0; c < 65536; c++) {
+            buffer.put((byte) scriptCode((char) c));
+        }
+
+        buffer.position((int) lowerOffset);
+        for (int c = 0; c < 65536; c++) {
+            buffer.putShort((short) Character.toLowerCase((char) c));
+        }
+
+        buffer.position((int) nodesOffset);
+        for (int i = 0; i < nodes.size; i++) {
+            buffer.putInt(nodes.values[i]);
+        }
+        buffer.position((int) edgeLabelsOffset);
+        for (int i = 0; i < edgeLabels.size; i++) {
+            buffer.putShort((short) edgeLabels.values[i]);
+        }
+        buffer.position((int) edgeTargetsOffset);
+        for (int i = 0; i < edgeTargets.size; i++) {
+            buffer.putInt(edgeTargets.values[i]);
+        }
+        buffer.position((int) entriesOffset);
+        for (Entry entry : entries) {
+            putEntry(buffer, entry);
+        }
+        buffer.position((int) unknownOffset);
+        for (Entry entry : unknownEntries) {
+            putEntry(buffer, entry);
+        }
+        buffer.position((int) morphemesOffset);
+        for (int i = 0; i < morphemes.size; i++) {
+            buffer.putInt(morphemes.values[i]);
+        }
+        buffer.position((int) stringsOffset);
+        for (byte[] bytes : strings) {
+            buffer.putShort((short) bytes.length);
+            buffer.put(bytes);
+        }
+
+        // Write aside and rename, so a running observer never maps a half written file
+        buffer.position(0);
+        Path temp = Paths.get(path.toString() + ".tmp");
+        try (FileChannel channel = FileChannel.open(temp, StandardOpenOption.CREATE, StandardOpenOption.WRITE,
+                                                    StandardOpenOption.TRUNCATE_EXISTING)) {
+            while (buffer.hasRemaining()) {
+                channel.write(buffer);
+            }
+        }
+        Files.move(temp, path, StandardCopyOption.REPLACE_EXISTING, StandardCopyOption.ATOMIC_MOVE);
+        System.out.println("Exported " + entries.size() + " words, " + nodeCount + " trie nodes, "
+                           + unknownEntries.size() + " unknown words (" + total + " bytes) to " + path);
+    }
+
+    /**
+     * Main method for command line usage
+     * Usage: java NoriDictionaryExport <output.dic>
+     */
+    public static void main(String[] args) throws IOException {
+        if (args.length != 1) {
+            System.out.println("Usage: java NoriDictionaryExport <output.dic>");
+            return;
+        }
+
+        NoriDictionaryExport export = new NoriDictionaryExport();
+        export.readKnownWords();
+        export.readUnknownWords();
+        export.buildNode(0, export.surfaces.size(), 0);
+        export.write(Paths.get(args[0]));
+    }
+}
@@ -0,0 +1,196 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Korean Fulltext Parser Plugin - Memory-mapped mecab-ko-dic Dictionary
+ */
+
+#include "korean_dictionary.h"
+#include <cstring>
+#include <vector>
+
+namespace oceanbase {
+namespace korean_ftparser {
+
+static_assert(sizeof(KoreanDictionaryHeader) == 264, "dictionary header layout");
+static_assert(sizeof(KoreanTrieNode) == 16, "trie node layout");
+static_assert(sizeof(KoreanWordEntry) == 12, "word entry layout");
+
+static const char DICTIONARY_MAGIC[8] = {'O', 'B', 'K', 'O', 'D', 'I', 'C', '\0'};
+
+KoreanDictionary::KoreanDictionary()
+    : size_(0)
+    , header_(nullptr)
+    , costs_(nullptr)
+    , char_info_(nullptr)
+    , script_(nullptr)
+    , lower_(nullptr)
+    , nodes_(nullptr)
+    , edge_labels_(nullptr)
+    , edge_targets_(nullptr)
+    , entries_(nullptr)
+    , unknown_entries_(nullptr)
+    , morphemes_(nullptr)
+    , strings_(nullptr) {
+}
+
+int KoreanDictionary::open(const std::string& path, std::string& error) {
+    if (file_.open(path, error) != 0) {
+        return -1;
+    }
+    if (attach(file_.data(), file_.size(), error) != 0) {
+        error = path + ": " + error;
+        file_.close();
+        return -1;
+    }
+    return 0;
+}
+
+int KoreanDictionary::open_buffer(const char* data, size_t size, std::string& error) {
+    file_.close();
+    return attach(data, size, error);
+}
+
+// Check that count elements of element_size bytes fit at an aligned offset
+static bool section_fits(uint64_t offset, uint64_t count, uint64_t element_size, size_t file_size) {
+    return offset % 8 == 0 && offset <= file_size && count * element_size <= file_size - offset;
+}
+
+int KoreanDictionary::attach(const char* data, size_t size, std::string& error) {
+    header_ = nullptr;
+    if (size < sizeof(KoreanDictionaryHeader) || reinterpret_cast<uintptr_t>(data) % 8 != 0) {
+        error = "not a Korean dictionary file";
+        return -1;
+    }
+
+    const KoreanDictionaryHeader* header = reinterpret_cast<const KoreanDictionaryHeader*>(data);
+    if (memcmp(header->magic, DICTIONARY_MAGIC, sizeof(DICTIONARY_MAGIC)) != 0) {
+        error = "not a Korean dictionary file";
+        return -1;
+    }
+    if (header->version != FORMAT_VERSION || header->header_size != sizeof(KoreanDictionaryHeader)) {
+        error = "unsupported dictionary format version " + std::to_string(header->version);
+        return -1;
+    }
+    if (header->left_size == 0 || header->right_size == 0 || header->left_size > 32768 ||
+        header->right_size > 32768 || header->node_count == 0 ||
+        !section_fits(header->costs_offset, static_cast<uint64_t>(header->left_size) * header->right_size, 2, size) ||
+        !section_fits(header->char_info_offset, 65536, 2, size) ||
+        !section_fits(header->script_offset, 65536, 1, size) ||
+        !section_fits(header->lower_offset, 65536, 2, size) ||
+        !section_fits(header->nodes_offset, header->node_count, sizeof(KoreanTrieNode), size) ||
+        !section_fits(header->edge_labels_offset, header->edge_count, 2, size) ||
+        !section_fits(header->edge_targets_offset, header->edge_count, 4, size) ||
+        !section_fits(header->entries_offset, header->entry_count, sizeof(KoreanWordEntry), size) ||
+        !section_fits(header->unknown_entries_offset, header->unknown_entry_count, sizeof(KoreanWordEntry), size) ||
+        !section_fits(header->morphemes_offset, header->morpheme_words, 4, size) ||
+        !section_fits(header->strings_offset, header->string_bytes, 1, size)) {
+        error = "truncated or corrupt dictionary sections";
+        return -1;
+    }
+    for (uint32_t i = 0; i < MAX_CHAR_CLASSES; ++i) {
+        if (static_cast<uint64_t>(header->unknown_first[i]) + header->unknown_count[i] > header->unknown_entry_count) {
+            error = "corrupt unknown word table";
+            return -1;
+        }
+    }
+
+    const KoreanTrieNode* nodes = reinterpret_cast<const KoreanTrieNode*>(data + header->nodes_offset);
+    const uint32_t* targets = reinterpret_cast<const uint32_t*>(data + header->edge_targets_offset);
+    const KoreanWordEntry* entries = reinterpret_cast<const KoreanWordEntry*>(data + header->entries_offset);
+    const KoreanWordEntry* unknown = reinterpret_cast<const KoreanWordEntry*>(data + header->unknown_entries_offset);
+    const uint32_t* morphemes = reinterpret_cast<const uint32_t*>(data + header->morphemes_offset);
+
+    // Every index read by a lookup is checked once here, so lookups need no bounds checks
+    for (uint32_t i = 0; i < header->node_count; ++i) {
+        if (static_cast<uint64_t>(nodes[i].first_edge) + nodes[i].edge_count > header->edge_count ||
+            static_cast<uint64_t>(nodes[i].first_entry) + nodes[i].entry_count > header->entry_count) {
+            error = "corrupt surface trie";
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < header->edge_count; ++i) {
+        if (targets[i] >= header->node_count) {
+            error = "corrupt surface trie";
+            return -1;
+        }
+    }
+
+    header_ = header;
+    size_ = size;
+    strings_ = data + header->strings_offset;
+
+    // Morpheme lists are stored back to back: find where each starts and check its strings
+    std::vector<bool> list_starts(header->morpheme_words, false);
+    for (uint64_t i = 0; i < header->morpheme_words; i += 1 + static_cast<uint64_t>(morphemes[i])) {
+        list_starts[i] = true;
+        bool valid = morphemes[i] > 0 && i + 1 + morphemes[i] <= header->morpheme_words;
+        for (uint32_t m = 0; valid && m < morphemes[i]; ++m) {
+            size_t length;
+            valid = string_data(morphemes[i + 1 + m], length) != nullptr;
+        }
+        if (!valid) {
+            error = "corrupt morpheme table";
+            header_ = nullptr;
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < header->entry_count + header->unknown_entry_count; ++i) {
+        const KoreanWordEntry& entry = i < header->entry_count ? entries[i] : unknown[i - header->entry_count];
+        if (entry.left_id < 0 || static_cast<uint32_t>(entry.left_id) >= header->left_size ||
+            entry.right_id < 0 || static_cast<uint32_t>(entry.right_id) >= header->right_size ||
+            entry.type > TYPE_PREANALYSIS ||
+            (entry.morphemes != NO_MORPHEMES &&
+             (entry.morphemes >= header->morpheme_words || !list_starts[entry.morphemes]))) {
+            error = "corrupt word entry";
+            header_ = nullptr;
+            return -1;
+        }
+    }
+
+    costs_ = reinterpret_cast<const int16_t*>(data + header->costs_offset);
+    char_info_ = reinterpret_cast<const uint16_t*>(data + header->char_info_offset);
+    script_ = reinterpret_cast<const uint8_t*>(data + header->script_offset);
+    lower_ = reinterpret_cast<const uint16_t*>(data + header->lower_offset);
+    nodes_ = nodes;
+    edge_labels_ = reinterpret_cast<const uint16_t*>(data + header->edge_labels_offset);
+    edge_targets_ = targets;
+    entries_ = entries;
+    unknown_entries_ = unknown;
+    morphemes_ = morphemes;
+    return 0;
+}
+
+uint32_t KoreanDictionary::child(uint32_t index, uint16_t c) const {
+    const KoreanTrieNode& current = nodes_[index];
+    const uint16_t* labels = edge_labels_ + current.first_edge;
+    // Binary search: the root has thousands of children
+    uint32_t low = 0;
+    uint32_t high = current.edge_count;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        if (labels[mid] < c) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < current.edge_count && labels[low] == c) {
+        return edge_targets_[current.first_edge + low];
+    }
+    return NO_NODE;
+}
+
+const char* KoreanDictionary::string_data(uint32_t offset, size_t& length) const {
+    if (static_cast<uint64_t>(offset) + 2 > header_->string_bytes) {
+        return nullptr;
+    }
+    uint16_t bytes;
+    memcpy(&bytes, strings_ + offset, sizeof(bytes));
+    if (static_cast<uint64_t>(offset) + 2 + bytes > header_->string_bytes) {
+        return nullptr;
+    }
+    length = bytes;
+    return strings_ + offset + 2;
+}
+
+} // namespace korean_ftparser
+} // namespace oceanbase
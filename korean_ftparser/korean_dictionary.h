@@ -0,0 +1,220 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Korean Fulltext Parser Plugin - Memory-mapped mecab-ko-dic Dictionary
+ */
+
+#pragma once
+
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace oceanbase {
+namespace korean_ftparser {
+
+/**
+ * Dictionary file header
+ * @details The file is written by java/NoriDictionaryExport from the
+ * mecab-ko-dic tables inside the Nori jar. All integers are little endian,
+ * every section starts at an 8-byte aligned offset from the start of the
+ * file, and characters are UTF-16 code units as in Nori.
+ */
+struct KoreanDictionaryHeader {
+    char magic[8];                    // "OBKODIC\0"
+    uint32_t version;                 // KoreanDictionary::FORMAT_VERSION
+    uint32_t header_size;             // sizeof(KoreanDictionaryHeader)
+    uint32_t left_size;               // Connection matrix columns (left ids)
+    uint32_t right_size;              // Connection matrix rows (right ids)
+    uint32_t node_count;              // Surface trie nodes, node 0 is the root
+    uint32_t edge_count;              // Surface trie edges
+    uint32_t entry_count;             // Known word entries
+    uint32_t unknown_entry_count;     // Unknown word entries
+    uint32_t morpheme_words;          // Size of the morpheme lists in uint32 words
+    uint32_t string_bytes;            // Size of the string pool
+    uint32_t unknown_first[16];       // First unknown entry of each character class
+    uint32_t unknown_count[16];       // Unknown entries of each character class
+    uint64_t costs_offset;            // int16 [right_size][left_size]
+    uint64_t char_info_offset;        // uint16 [65536], see CHAR_* masks
+    uint64_t script_offset;           // uint8 [65536], Character.UnicodeScript, 0 for Common and Inherited
+    uint64_t lower_offset;            // uint16 [65536], Character.toLowerCase
+    uint64_t nodes_offset;            // KoreanTrieNode [node_count]
+    uint64_t edge_labels_offset;      // uint16 [edge_count], sorted per node
+    uint64_t edge_targets_offset;     // uint32 [edge_count]
+    uint64_t entries_offset;          // KoreanWordEntry [entry_count]
+    uint64_t unknown_entries_offset;  // KoreanWordEntry [unknown_entry_count]
+    uint64_t morphemes_offset;        // uint32 lists: count, then count string offsets
+    uint64_t strings_offset;          // Strings: uint16 byte length + UTF-8 bytes
+};
+
+/**
+ * Surface trie node: edges [first_edge, first_edge + edge_count), words
+ * ending here are entries [first_entry, first_entry + entry_count)
+ */
+struct KoreanTrieNode {
+    uint32_t first_edge;
+    uint32_t edge_count;
+    uint32_t first_entry;
+    uint32_t entry_count;
+};
+
+/**
+ * One dictionary word (TokenInfoDictionary / UnknownDictionary entry)
+ */
+struct KoreanWordEntry {
+    int16_t left_id;
+    int16_t right_id;
+    int16_t word_cost;
+    uint8_t type;           // POS.Type: TYPE_*
+    uint8_t flags;          // ENTRY_* flags
+    uint32_t morphemes;     // Morpheme list index, NO_MORPHEMES for a single morpheme
+};
+
+/**
+ * Korean Dictionary
+ * @brief Read-only view of a mapped dictionary file
+ * @details Nothing is parsed or copied on open: lookups read the mapping
+ * directly, so all threads and processes share the same pages.
+ */
+class KoreanDictionary {
+public:
+    static const uint32_t FORMAT_VERSION = 1;
+    static const uint32_t NO_NODE = 0xFFFFFFFFu;
+    static const uint32_t NO_MORPHEMES = 0xFFFFFFFFu;
+    static const uint32_t MAX_CHAR_CLASSES = 16;
+
+    // Character info masks (CharacterDefinition + KoreanTokenizer.isPunctuation)
+    static const uint16_t CHAR_CLASS_MASK = 0x000F;
+    static const uint16_t CHAR_INVOKE = 0x0010;
+    static const uint16_t CHAR_GROUP = 0x0020;
+    static const uint16_t CHAR_PUNCTUATION = 0x0040;
+    static const uint16_t CHAR_DIGIT = 0x0080;            // Character.isDigit
+    static const uint16_t CHAR_NON_SPACING_MARK = 0x0100; // Character.NON_SPACING_MARK
+    static const uint16_t CHAR_SPACE = 0x0200;            // Character.SPACE_SEPARATOR
+
+    // Word types (POS.Type)
+    static const uint8_t TYPE_MORPHEME = 0;
+    static const uint8_t TYPE_COMPOUND = 1;
+    static const uint8_t TYPE_INFLECT = 2;
+    static const uint8_t TYPE_PREANALYSIS = 3;
+
+    // Entry flags
+    static const uint8_t ENTRY_SPACE_PENALTY = 0x1;  // Left POS is E, J, VCP, XSA, XSN or XSV
+
+    KoreanDictionary();
+
+    /**
+     * Map and check a dictionary file
+     * @param error Output description of the failure
+     * @return 0 on success, -1 on failure
+     */
+    int open(const std::string& path, std::string& error);
+
+    /**
+     * Open over a buffer owned by the caller (tests), same checks as open()
+     */
+    int open_buffer(const char* data, size_t size, std::string& error);
+
+    /**
+     * Connection cost from a word's right id to the next word's left id
+     */
+    int connection_cost(int right_id, int left_id) const {
+        return costs_[static_cast<size_t>(right_id) * header_->left_size + static_cast<size_t>(left_id)];
+    }
+
+    /**
+     * Character info of a UTF-16 code unit
+     */
+    uint16_t char_info(uint16_t c) const { return char_info_[c]; }
+
+    /**
+     * Script of a UTF-16 code unit, 0 for Common and Inherited
+     */
+    uint8_t script(uint16_t c) const { return script_[c]; }
+
+    /**
+     * Lower case of a UTF-16 code unit
+     */
+    uint16_t to_lower(uint16_t c) const { return lower_[c]; }
+
+    /**
+     * Follow the edge labelled c
+     * @return The child node, or NO_NODE
+     */
+    uint32_t child(uint32_t node, uint16_t c) const;
+
+    /**
+     * Trie node by index
+     */
+    const KoreanTrieNode& node(uint32_t index) const { return nodes_[index]; }
+
+    /**
+     * Known entry by index
+     */
+    const KoreanWordEntry& entry(uint32_t index) const { return entries_[index]; }
+
+    /**
+     * Unknown entry by index
+     */
+    const KoreanWordEntry& unknown_entry(uint32_t index) const { return unknown_entries_[index]; }
+
+    /**
+     * Unknown entries of a character class
+     */
+    uint32_t unknown_first(uint32_t char_class) const { return header_->unknown_first[char_class]; }
+    uint32_t unknown_count(uint32_t char_class) const { return header_->unknown_count[char_class]; }
+
+    /**
+     * Morphemes of a compound, inflected or pre-analyzed word
+     * @param index KoreanWordEntry::morphemes
+     * @param count Output number of morphemes
+     * @return String offsets of the morpheme surfaces
+     */
+    const uint32_t* morphemes(uint32_t index, uint32_t& count) const {
+        count = morphemes_[index];
+        return morphemes_ + index + 1;
+    }
+
+    /**
+     * String from the pool
+     */
+    const char* string_data(uint32_t offset, size_t& length) const;
+
+    /**
+     * Number of known entries
+     */
+    uint32_t entry_count() const { return header_->entry_count; }
+
+    /**
+     * Size of the mapped dictionary in bytes
+     */
+    size_t size() const { return size_; }
+
+private:
+    jni::MappedFile file_;
+    size_t size_;
+    const KoreanDictionaryHeader* header_;
+    const int16_t* costs_;
+    const uint16_t* char_info_;
+    const uint8_t* script_;
+    const uint16_t* lower_;
+    const KoreanTrieNode* nodes_;
+    const uint16_t* edge_labels_;
+    const uint32_t* edge_targets_;
+    const KoreanWordEntry* entries_;
+    const KoreanWordEntry* unknown_entries_;
+    const uint32_t* morphemes_;
+    const char* strings_;
+
+    /**
+     * Check the header and locate the sections
+     */
+    int attach(const char* data, size_t size, std::string& error);
+
+    // Disable copy
+    KoreanDictionary(const KoreanDictionary&) = delete;
+    KoreanDictionary& operator=(const KoreanDictionary&) = delete;
+};
+
+} // namespace korean_ftparser
+} // namespace oceanbase
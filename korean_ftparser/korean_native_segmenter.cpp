@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Korean Fulltext Parser Plugin - Native Segmenter Backend
+ */
+
+#include "korean_native_segmenter.h"
+#include "jni_log.h"
+#include "oceanbase/ob_plugin_ftparser.h"
+#include <cstdlib>
+#include <new>
+
+using namespace oceanbase::jni;
+
+namespace oceanbase {
+namespace korean_ftparser {
+
+static std::string get_env_string(const char* name) {
+    const char* value = std::getenv(name);
+    return value ? std::string(value) : std::string();
+}
+
+KoreanNativeSegmenterConfig::KoreanNativeSegmenterConfig()
+    : dictionary_path(get_env_string("OCEANBASE_KOREAN_DICT_PATH"))
+    , decompound_mode(get_env_string("OCEANBASE_KOREAN_DECOMPOUND_MODE")) {
+}
+
+KoreanNativeSegmenter::KoreanNativeSegmenter()
+    : is_initialized_(false) {
+}
+
+int KoreanNativeSegmenter::initialize() {
+    std::lock_guard<std::mutex> lock(init_mutex_);
+
+    if (is_initialized_) {
+        return OBP_SUCCESS;
+    }
+
+    KoreanTokenizerOptions options;
+    if (config_.decompound_mode == "none") {
+        options.decompound_mode = DECOMPOUND_NONE;
+    } else if (config_.decompound_mode == "discard") {
+        options.decompound_mode = DECOMPOUND_DISCARD;
+    } else if (!config_.decompound_mode.empty() && config_.decompound_mode != "mixed") {
+        JNI_LOG_ERROR("[KoreanNativeSegmenter] Unknown OCEANBASE_KOREAN_DECOMPOUND_MODE '%s' (none, discard or mixed)",
+                      config_.decompound_mode.c_str());
+        return OBP_PLUGIN_ERROR;
+    }
+
+    if (config_.dictionary_path.empty()) {
+        JNI_LOG_ERROR("[KoreanNativeSegmenter] OCEANBASE_KOREAN_DICT_PATH is not set, "
+                      "the native backend needs a dictionary exported by NoriDictionaryExport");
+        return OBP_PLUGIN_ERROR;
+    }
+
+    std::string error;
+    if (dictionary_.open(config_.dictionary_path, error) != 0) {
+        JNI_LOG_ERROR("[KoreanNativeSegmenter] Failed to open dictionary: %s", error.c_str());
+        return OBP_PLUGIN_ERROR;
+    }
+
+    try {
+        tokenizer_.reset(new KoreanTokenizer(dictionary_, options));
+    } catch (const std::bad_alloc&) {
+        return OBP_ALLOCATE_MEMORY_FAILED;
+    }
+
+    JNI_LOG_INFO("[KoreanNativeSegmenter] Mapped %s (%u words, %zu bytes), decompound mode %s",
+                 config_.dictionary_path.c_str(), dictionary_.entry_count(), dictionary_.size(),
+                 config_.decompound_mode.empty() ? "mixed" : config_.decompound_mode.c_str());
+    is_initialized_ = true;
+    return OBP_SUCCESS;
+}
+
+int KoreanNativeSegmenter::segment(const char* text, size_t length, PackedTokenBuffer& tokens) {
+    tokens.clear();
+    if (!text || length == 0) {
+        return OBP_SUCCESS;
+    }
+
+    try {
+        if (tokenizer_->segment(text, length, tokens) != 0) {
+            return OBP_ALLOCATE_MEMORY_FAILED;
+        }
+    } catch (const std::bad_alloc&) {
+        return OBP_ALLOCATE_MEMORY_FAILED;
+    }
+    return OBP_SUCCESS;
+}
+
+} // namespace korean_ftparser
+} // namespace oceanbase
@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Korean Fulltext Parser Plugin - Native Segmenter Backend
+ */
+
+#pragma once
+
+#include "segmenter_backend.h"
+#include "korean_dictionary.h"
+#include "korean_tokenizer.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace oceanbase {
+namespace korean_ftparser {
+
+/**
+ * Korean Native Segmenter Configuration
+ */
+struct KoreanNativeSegmenterConfig {
+    // Dictionary exported by java/NoriDictionaryExport (OCEANBASE_KOREAN_DICT_PATH, required)
+    std::string dictionary_path;
+    // none, discard or mixed (OCEANBASE_KOREAN_DECOMPOUND_MODE, default mixed as KoreanSegmenter)
+    std::string decompound_mode;
+
+    KoreanNativeSegmenterConfig();
+};
+
+/**
+ * Korean Native Segmenter
+ * @brief The "native" backend of korean_ftparser: KoreanTokenizer without a JVM
+ * @details Selected with OCEANBASE_KOREAN_FTPARSER_BACKEND=native. The
+ * dictionary file is mapped read-only by the first scan; its pages are
+ * shared by all threads and by every process mapping the same file.
+ */
+class KoreanNativeSegmenter : public oceanbase::jni::SegmenterBackend {
+public:
+    KoreanNativeSegmenter();
+
+    /**
+     * Backend name used in OCEANBASE_KOREAN_FTPARSER_BACKEND
+     */
+    const char* name() const override { return "native"; }
+
+    /**
+     * Map the dictionary (once)
+     * @return OBP_SUCCESS on success, OBP_PLUGIN_ERROR if the dictionary cannot be opened
+     */
+    int initialize() override;
+
+    /**
+     * Segment a UTF-8 document into packed tokens
+     * @return OBP_SUCCESS on success, error code on failure
+     */
+    int segment(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) override;
+
+private:
+    KoreanNativeSegmenterConfig config_;
+    KoreanDictionary dictionary_;
+    std::unique_ptr<KoreanTokenizer> tokenizer_;
+    bool is_initialized_;
+    std::mutex init_mutex_;
+
+    // Disable copy
+    KoreanNativeSegmenter(const KoreanNativeSegmenter&) = delete;
+    KoreanNativeSegmenter& operator=(const KoreanNativeSegmenter&) = delete;
+};
+
+} // namespace korean_ftparser
+} // namespace oceanbase
@@ -0,0 +1,407 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Korean Fulltext Parser Plugin - Native Viterbi Tokenizer
+ */
+
+#include "korean_tokenizer.h"
+#include <climits>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace oceanbase::jni;
+
+namespace oceanbase {
+namespace korean_ftparser {
+
+namespace {
+
+// KoreanTokenizer constants
+const uint32_t MAX_UNKNOWN_WORD_LENGTH = 1024;
+const int SPACE_PENALTY = 3000;
+const uint32_t WHOLE_WORD = 0xFFFFFFFFu;
+
+enum WordType : uint8_t {
+    WORD_BOS = 0,
+    WORD_KNOWN,
+    WORD_UNKNOWN
+};
+
+// A best way to reach a position through one word
+struct Arc {
+    int32_t cost;           // Path cost including the word
+    int32_t right_id;       // Right id of the word
+    uint32_t back_pos;      // End of the previous word
+    uint32_t word_pos;      // Start of the word, after any spaces
+    uint32_t back_index;    // Arc at back_pos the path comes from
+    uint32_t word;          // Entry index
+    uint8_t type;           // WordType
+};
+
+struct Position {
+    std::vector<Arc> arcs;
+};
+
+struct PendingToken {
+    uint32_t start;
+    uint32_t end;
+    uint32_t morpheme;      // String offset of a decompounded part, WHOLE_WORD for the surface
+};
+
+// Per-thread lattice storage, reused across documents
+struct TokenizerScratch {
+    std::vector<uint16_t> units;
+    std::vector<Position> window;
+    size_t used;
+    std::vector<PendingToken> fragment;
+    std::vector<uint16_t> term;
+    std::string utf8;
+
+    TokenizerScratch() : used(0) {}
+};
+
+TokenizerScratch& scratch() {
+    static thread_local TokenizerScratch instance;
+    return instance;
+}
+
+// Decode UTF-8 into UTF-16 code units (invalid sequences become U+FFFD)
+void decode_utf16(const char* text, size_t length, std::vector<uint16_t>& units) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text);
+    units.clear();
+    size_t pos = 0;
+    while (pos < length) {
+        unsigned char lead = p[pos];
+        if (lead < 0x80) {
+            units.push_back(lead);
+            ++pos;
+            continue;
+        }
+        size_t needed;
+        uint32_t value;
+        uint32_t minimum;
+        if ((lead & 0xE0) == 0xC0) {
+            needed = 2; value = lead & 0x1F; minimum = 0x80;
+        } else if ((lead & 0xF0) == 0xE0) {
+            needed = 3; value = lead & 0x0F; minimum = 0x800;
+        } else if ((lead & 0xF8) == 0xF0) {
+            needed = 4; value = lead & 0x07; minimum = 0x10000;
+        } else {
+            units.push_back(0xFFFD);
+            ++pos;
+            continue;
+        }
+        bool valid = length - pos >= needed;
+        for (size_t i = 1; valid && i < needed; ++i) {
+            valid = (p[pos + i] & 0xC0) == 0x80;
+            value = (value << 6) | (p[pos + i] & 0x3F);
+        }
+        if (!valid || value < minimum || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF)) {
+            units.push_back(0xFFFD);
+            ++pos;
+            continue;
+        }
+        if (value >= 0x10000) {
+            value -= 0x10000;
+            units.push_back(static_cast<uint16_t>(0xD800 | (value >> 10)));
+            units.push_back(static_cast<uint16_t>(0xDC00 | (value & 0x3FF)));
+        } else {
+            units.push_back(static_cast<uint16_t>(value));
+        }
+        pos += needed;
+    }
+}
+
+// Encode UTF-16 code units as UTF-8 (an unpaired surrogate becomes '?', as String.getBytes does)
+void encode_utf8(const uint16_t* units, size_t count, std::string& out) {
+    out.clear();
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t c = units[i];
+        if (c >= 0xD800 && c <= 0xDBFF && i + 1 < count && units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (units[i + 1] - 0xDC00);
+            ++i;
+        } else if (c >= 0xD800 && c <= 0xDFFF) {
+            c = '?';
+        }
+        if (c < 0x80) {
+            out += static_cast<char>(c);
+        } else if (c < 0x800) {
+            out += static_cast<char>(0xC0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            out += static_cast<char>(0xE0 | (c >> 12));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (c >> 18));
+            out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+}
+
+/**
+ * One document's lattice, following KoreanTokenizer.parse()
+ */
+class Lattice {
+public:
+    Lattice(const KoreanDictionary& dictionary, const KoreanTokenizerOptions& options, TokenizerScratch& s)
+        : dictionary_(dictionary), options_(options), s_(s), base_(0), last_backtrace_pos_(0), next_pos_(1) {}
+
+    int run(PackedTokenBuffer& tokens);
+
+private:
+    const KoreanDictionary& dictionary_;
+    const KoreanTokenizerOptions& options_;
+    TokenizerScratch& s_;
+    uint32_t base_;                 // Text position of window[0]
+    uint32_t last_backtrace_pos_;   // Tokens before this position are emitted
+    uint32_t next_pos_;             // One past the furthest position any arc reaches
+
+    // Position by text position; references are invalidated by the next call
+    Position& at(uint32_t pos);
+
+    const KoreanWordEntry& word_entry(uint8_t type, uint32_t word) const {
+        return type == WORD_KNOWN ? dictionary_.entry(word) : dictionary_.unknown_entry(word);
+    }
+
+    void add(uint32_t from_pos, uint32_t word_pos, uint32_t end_pos, uint32_t word, uint8_t type);
+    int backtrace(uint32_t end_pos, uint32_t best_index, PackedTokenBuffer& tokens);
+    int emit(const PendingToken& token, PackedTokenBuffer& tokens);
+    void rebase(uint32_t pos);
+};
+
+Position& Lattice::at(uint32_t pos) {
+    size_t index = pos - base_;
+    if (index >= s_.window.size()) {
+        s_.window.resize(index + 1 > 2 * s_.window.size() ? index + 1 : 2 * s_.window.size());
+    }
+    while (s_.used <= index) {
+        s_.window[s_.used].arcs.clear();
+        ++s_.used;
+    }
+    return s_.window[index];
+}
+
+void Lattice::add(uint32_t from_pos, uint32_t word_pos, uint32_t end_pos, uint32_t word, uint8_t type) {
+    const KoreanWordEntry& entry = word_entry(type, word);
+    // Dependent morphemes (endings, particles, suffixes) rarely follow a space
+    int penalty = (word_pos > from_pos && (entry.flags & KoreanDictionary::ENTRY_SPACE_PENALTY)) ? SPACE_PENALTY : 0;
+    const std::vector<Arc>& from = at(from_pos).arcs;
+    int32_t least_cost = INT_MAX;
+    uint32_t least_index = 0;
+    for (size_t i = 0; i < from.size(); ++i) {
+        int32_t cost = from[i].cost + dictionary_.connection_cost(from[i].right_id, entry.left_id) + penalty;
+        if (cost < least_cost) {
+            least_cost = cost;
+            least_index = static_cast<uint32_t>(i);
+        }
+    }
+    least_cost += entry.word_cost;
+
+    Arc arc = {least_cost, entry.right_id, from_pos, word_pos, least_index, word, type};
+    at(end_pos).arcs.push_back(arc);
+    if (end_pos + 1 > next_pos_) {
+        next_pos_ = end_pos + 1;
+    }
+}
+
+int Lattice::backtrace(uint32_t end_pos, uint32_t best_index, PackedTokenBuffer& tokens) {
+    s_.fragment.clear();
+    uint32_t pos = end_pos;
+    uint32_t best = best_index;
+
+    while (pos > last_backtrace_pos_) {
+        Arc arc = at(pos).arcs[best];
+        const KoreanWordEntry& entry = word_entry(arc.type, arc.word);
+        PendingToken token = {arc.word_pos, pos, WHOLE_WORD};
+
+        if (entry.type == KoreanDictionary::TYPE_MORPHEME || entry.morphemes == KoreanDictionary::NO_MORPHEMES ||
+            options_.decompound_mode == DECOMPOUND_NONE) {
+            if (!(options_.discard_punctuation &&
+                  (dictionary_.char_info(s_.units[arc.word_pos]) & KoreanDictionary::CHAR_PUNCTUATION))) {
+                s_.fragment.push_back(token);
+            }
+        } else {
+            // Parts are collected back to front like the words, the compound itself goes before them
+            uint32_t count = 0;
+            const uint32_t* parts = dictionary_.morphemes(entry.morphemes, count);
+            for (uint32_t i = count; i > 0; --i) {
+                PendingToken part = {arc.word_pos, pos, parts[i - 1]};
+                s_.fragment.push_back(part);
+            }
+            if (options_.decompound_mode == DECOMPOUND_MIXED) {
+                s_.fragment.push_back(token);
+            }
+        }
+
+        pos = arc.back_pos;
+        best = arc.back_index;
+    }
+
+    // The fragment was collected back to front
+    for (size_t i = s_.fragment.size(); i > 0; --i) {
+        if (emit(s_.fragment[i - 1], tokens) != 0) {
+            return -1;
+        }
+    }
+    last_backtrace_pos_ = end_pos;
+    return 0;
+}
+
+int Lattice::emit(const PendingToken& token, PackedTokenBuffer& tokens) {
+    s_.term.clear();
+    if (token.morpheme == WHOLE_WORD) {
+        s_.term.assign(s_.units.begin() + token.start, s_.units.begin() + token.end);
+    } else {
+        size_t length = 0;
+        const char* part = dictionary_.string_data(token.morpheme, length);
+        decode_utf16(part, length, s_.term);
+    }
+
+    // LowerCaseFilter
+    bool blank = true;
+    for (size_t i = 0; i < s_.term.size(); ++i) {
+        s_.term[i] = dictionary_.to_lower(s_.term[i]);
+        blank = blank && s_.term[i] <= 0x20;
+    }
+    // KoreanSegmenter skips terms that are empty once trimmed
+    if (blank) {
+        return 0;
+    }
+    encode_utf8(s_.term.data(), s_.term.size(), s_.utf8);
+    return tokens.append(s_.utf8.data(), s_.utf8.size());
+}
+
+void Lattice::rebase(uint32_t pos) {
+    size_t index = pos - base_;
+    if (index > 0) {
+        std::swap(s_.window[0], s_.window[index]);
+        for (size_t i = 1; i < s_.used; ++i) {
+            s_.window[i].arcs.clear();
+        }
+        s_.used = 1;
+        base_ = pos;
+    }
+}
+
+int Lattice::run(PackedTokenBuffer& tokens) {
+    const std::vector<uint16_t>& units = s_.units;
+    uint32_t length = static_cast<uint32_t>(units.size());
+
+    s_.used = 0;
+    Arc bos = {0, 0, 0, 0, 0, 0, WORD_BOS};
+    at(0).arcs.push_back(bos);
+
+    for (uint32_t pos = 0; pos < length; ++pos) {
+        if (at(pos).arcs.empty()) {
+            continue;
+        }
+
+        // All paths meet here: emit what lies before, as KoreanTokenizer does
+        if (pos > last_backtrace_pos_ && next_pos_ == pos + 1) {
+            const std::vector<Arc>& arcs = at(pos).arcs;
+            uint32_t least_index = 0;
+            for (size_t i = 1; i < arcs.size(); ++i) {
+                if (arcs[i].cost < arcs[least_index].cost) {
+                    least_index = static_cast<uint32_t>(i);
+                }
+            }
+            if (backtrace(pos, least_index, tokens) != 0) {
+                return -1;
+            }
+            rebase(pos);
+        }
+
+        // Words start after the spaces, which only count towards the space penalty
+        uint32_t word_pos = pos;
+        while (word_pos < length && (dictionary_.char_info(units[word_pos]) & KoreanDictionary::CHAR_SPACE)) {
+            ++word_pos;
+        }
+        if (word_pos == length) {
+            word_pos = pos;
+        }
+
+        // Known words starting here
+        bool any_matches = false;
+        uint32_t node = 0;
+        for (uint32_t ahead = word_pos; ahead < length; ++ahead) {
+            node = dictionary_.child(node, units[ahead]);
+            if (node == KoreanDictionary::NO_NODE) {
+                break;
+            }
+            const KoreanTrieNode& trie_node = dictionary_.node(node);
+            for (uint32_t i = 0; i < trie_node.entry_count; ++i) {
+                add(pos, word_pos, ahead + 1, trie_node.first_entry + i, WORD_KNOWN);
+                any_matches = true;
+            }
+        }
+
+        // Unknown word: a run of the same script, punctuation-ness and digit-ness if the class groups
+        uint16_t info = dictionary_.char_info(units[word_pos]);
+        if (!any_matches || (info & KoreanDictionary::CHAR_INVOKE)) {
+            uint16_t char_class = info & KoreanDictionary::CHAR_CLASS_MASK;
+            uint32_t unknown_length = 1;
+            if (info & KoreanDictionary::CHAR_GROUP) {
+                uint8_t script = dictionary_.script(units[word_pos]);
+                uint16_t kind = info & (KoreanDictionary::CHAR_PUNCTUATION | KoreanDictionary::CHAR_DIGIT);
+                for (uint32_t ahead = word_pos + 1; ahead < length && unknown_length < MAX_UNKNOWN_WORD_LENGTH; ++ahead) {
+                    uint16_t next = dictionary_.char_info(units[ahead]);
+                    uint8_t next_script = dictionary_.script(units[ahead]);
+                    // Common and Inherited characters join any script, non-spacing marks join their base
+                    bool same_script = next_script == script || script == 0 || next_script == 0 ||
+                                       (next & KoreanDictionary::CHAR_NON_SPACING_MARK);
+                    if (!same_script || !(next & KoreanDictionary::CHAR_GROUP) ||
+                        (next & (KoreanDictionary::CHAR_PUNCTUATION | KoreanDictionary::CHAR_DIGIT)) != kind) {
+                        break;
+                    }
+                    ++unknown_length;
+                    if (script == 0 && next_script != 0) {
+                        script = next_script;
+                        char_class = next & KoreanDictionary::CHAR_CLASS_MASK;
+                    }
+                }
+            }
+            uint32_t first = dictionary_.unknown_first(char_class);
+            for (uint32_t i = 0; i < dictionary_.unknown_count(char_class); ++i) {
+                add(pos, word_pos, word_pos + unknown_length, first + i, WORD_UNKNOWN);
+            }
+        }
+
+        // Continue after the skipped spaces, as KoreanTokenizer does
+        pos = word_pos;
+    }
+
+    // End of text: the best path including the connection to EOS
+    const std::vector<Arc>& arcs = at(length).arcs;
+    if (length == 0 || arcs.empty()) {
+        return 0;
+    }
+    uint32_t least_index = 0;
+    int32_t least_cost = INT_MAX;
+    for (size_t i = 0; i < arcs.size(); ++i) {
+        int32_t cost = arcs[i].cost + dictionary_.connection_cost(arcs[i].right_id, 0);
+        if (cost < least_cost) {
+            least_cost = cost;
+            least_index = static_cast<uint32_t>(i);
+        }
+    }
+    return backtrace(length, least_index, tokens);
+}
+
+} // namespace
+
+KoreanTokenizer::KoreanTokenizer(const KoreanDictionary& dictionary, const KoreanTokenizerOptions& options)
+    : dictionary_(dictionary), options_(options) {
+}
+
+int KoreanTokenizer::segment(const char* text, size_t length, PackedTokenBuffer& tokens) const {
+    TokenizerScratch& s = scratch();
+    decode_utf16(text, length, s.units);
+    Lattice lattice(dictionary_, options_, s);
+    return lattice.run(tokens);
+}
+
+} // namespace korean_ftparser
+} // namespace oceanbase
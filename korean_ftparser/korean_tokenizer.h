@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Korean Fulltext Parser Plugin - Native Viterbi Tokenizer
+ */
+
+#pragma once
+
+#include "korean_dictionary.h"
+#include "packed_token_buffer.h"
+#include <cstddef>
+
+namespace oceanbase {
+namespace korean_ftparser {
+
+/**
+ * Decompound mode (KoreanTokenizer.DecompoundMode)
+ */
+enum KoreanDecompoundMode {
+    DECOMPOUND_NONE = 0,    // Keep compounds whole
+    DECOMPOUND_DISCARD,     // Emit only the parts of a compound
+    DECOMPOUND_MIXED        // Emit the compound, then its parts
+};
+
+/**
+ * Korean Tokenizer Options
+ * @details Defaults match the "korean" tokenizer of KoreanSegmenter
+ */
+struct KoreanTokenizerOptions {
+    KoreanDecompoundMode decompound_mode;
+    // Drop tokens starting with punctuation, whitespace or symbols
+    bool discard_punctuation;
+
+    KoreanTokenizerOptions() : decompound_mode(DECOMPOUND_MIXED), discard_punctuation(true) {}
+};
+
+/**
+ * Korean Tokenizer
+ * @brief Native replacement for KoreanSegmenter's Nori pipeline
+ * @details Builds the same Viterbi lattice as Nori's KoreanTokenizer over a
+ * mapped mecab-ko-dic dictionary: known words from the surface trie,
+ * unknown words grouped by script, connection costs and the space penalty
+ * of dependent morphemes, backtracking each time all paths converge.
+ * Compound, inflected and pre-analyzed words are decompounded as the mode
+ * asks, then lower-cased.
+ * segment() is const and keeps its lattice per thread, so one tokenizer
+ * serves all threads.
+ */
+class KoreanTokenizer {
+public:
+    /**
+     * @param dictionary Opened dictionary, must outlive the tokenizer
+     */
+    KoreanTokenizer(const KoreanDictionary& dictionary, const KoreanTokenizerOptions& options);
+
+    /**
+     * Segment a UTF-8 document
+     * @param text Input UTF-8 bytes; invalid sequences are read as U+FFFD
+     * @param length Length of the input in bytes
+     * @param tokens Output buffer, tokens are appended
+     * @return 0 on success, -1 on allocation failure
+     */
+    int segment(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) const;
+
+private:
+    const KoreanDictionary& dictionary_;
+    KoreanTokenizerOptions options_;
+};
+
+} // namespace korean_ftparser
+} // namespace oceanbase
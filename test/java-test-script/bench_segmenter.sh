@@ -0,0 +1,38 @@
+#!/bin/bash
+
+# Segmenter Benchmark Script
+# Compares per-document cost of a new segmenter per call vs one shared segmenter instance
+
+echo "⏱️  Segmenter Benchmark"
+echo ""
+
+# Check if language is provided
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <japanese|korean|thai> [docs_per_thread] [threads] [input_file.txt]"
+    echo "Example: $0 japanese 2000 8"
+    echo ""
+    echo "This script will:"
+    echo "  1. Segment the documents with a new segmenter per document (per-call)"
+    echo "  2. Segment the documents with one shared segmenter instance (shared)"
+    echo "  3. Print the average cost per document for both modes"
+    exit 1
+fi
+
+LANGUAGE="$1"
+DOCS_PER_THREAD="${2:-2000}"
+THREADS="${3:-$(nproc)}"
+INPUT_FILE="$4"
+
+# Change to java directory and run the benchmark
+cd java
+if [ -n "$INPUT_FILE" ]; then
+    # Convert relative path to absolute path if needed
+    if [[ "$INPUT_FILE" = /* ]]; then
+        ABS_INPUT_FILE="$INPUT_FILE"
+    else
+        ABS_INPUT_FILE="../$INPUT_FILE"
+    fi
+    java -cp ".:lib/*" SegmenterBenchmark "$LANGUAGE" "$DOCS_PER_THREAD" "$THREADS" "$ABS_INPUT_FILE"
+else
+    java -cp ".:lib/*" SegmenterBenchmark "$LANGUAGE" "$DOCS_PER_THREAD" "$THREADS"
+fi
@@ -0,0 +1,38 @@
+import java.io.BufferedReader;
+import java.io.BufferedWriter;
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+
+/**
+ * Japanese Reference Tokens
+ * Writes what the native Japanese backend is compared against:
+ *   reference : the JapaneseSegmenter tokens of every corpus line, tab separated (empty line if none)
+ */
+public class JapaneseReferenceTokens {
+
+    /**
+     * Main method for command line usage
+     * Usage: java JapaneseReferenceTokens <corpus.txt> <reference.txt>
+     */
+    public static void main(String[] args) throws IOException {
+        if (args.length != 2) {
+            System.out.println("Usage: java JapaneseReferenceTokens <corpus.txt> <reference.txt>");
+            return;
+        }
+
+        JapaneseSegmenter segmenter = new JapaneseSegmenter();
+        int lines = 0;
+        try (BufferedReader reader = Files.newBufferedReader(Paths.get(args[0]), StandardCharsets.UTF_8);
+             BufferedWriter writer = Files.newBufferedWriter(Paths.get(args[1]), StandardCharsets.UTF_8)) {
+            String line;
+            while ((line = reader.readLine()) != null) {
+                writer.write(String.join("\t", segmenter.segment(line)));
+                writer.newLine();
+                lines++;
+            }
+        }
+        System.out.println("Reference tokens written for " + lines + " lines");
+    }
+}
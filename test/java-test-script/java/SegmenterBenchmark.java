@@ -0,0 +1,154 @@
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Segmenter Benchmark
+ * Measures the per-document cost of the two ways the JNI bridge can drive a segmenter:
+ *   per-call : a new segmenter (and Lucene analyzer pipeline) for every document (old bridge behaviour)
+ *   shared   : one segmenter instance reused by all documents and threads (current bridge behaviour)
+ */
+public class SegmenterBenchmark {
+
+    /** Minimal view of the three segmenter classes */
+    private interface Segmenter {
+        String[] segment(String text);
+    }
+
+    private static final String[] JAPANESE_SAMPLES = {
+        "東京都渋谷区でコンピューターを勉強しています",
+        "OceanBaseデータベースを選ぶ理由",
+        "ご質問がございましたら、営業日にお気軽にお問い合わせください"
+    };
+
+    private static final String[] KOREAN_SAMPLES = {
+        "학교에 갑니다",
+        "OpenBase 데이터베이스 관리 시스템",
+        "한국어 형태소 분석기를 사용하여 문장을 분석합니다"
+    };
+
+    private static final String[] THAI_SAMPLES = {
+        "สวัสดีครับ",
+        "ฐานข้อมูลแบบกระจาย",
+        "ระบบจัดการฐานข้อมูลที่มีประสิทธิภาพสูง"
+    };
+
+    private static Segmenter create(String language) {
+        switch (language) {
+            case "japanese": {
+                final JapaneseSegmenter segmenter = new JapaneseSegmenter();
+                return text -> segmenter.segment(text);
+            }
+            case "korean": {
+                final KoreanSegmenter segmenter = new KoreanSegmenter();
+                return text -> segmenter.segment(text);
+            }
+            case "thai": {
+                final ThaiSegmenter segmenter = new ThaiSegmenter();
+                return text -> segmenter.segment(text);
+            }
+            default:
+                throw new IllegalArgumentException("Unknown language: " + language);
+        }
+    }
+
+    private static String[] defaultSamples(String language) {
+        switch (language) {
+            case "japanese": return JAPANESE_SAMPLES;
+            case "korean":   return KOREAN_SAMPLES;
+            case "thai":     return THAI_SAMPLES;
+            default:
+                throw new IllegalArgumentException("Unknown language: " + language);
+        }
+    }
+
+    /**
+     * Run the given number of documents per thread and return the average cost in microseconds
+     */
+    private static double run(final String language, final List<String> docs, final int docsPerThread,
+                              int threads, final boolean shared) throws Exception {
+        final Segmenter sharedSegmenter = shared ? create(language) : null;
+        ExecutorService pool = Executors.newFixedThreadPool(threads);
+        List<Future<?>> futures = new ArrayList<>();
+
+        long start = System.nanoTime();
+        for (int t = 0; t < threads; t++) {
+            final int offset = t;
+            futures.add(pool.submit(() -> {
+                for (int i = 0; i < docsPerThread; i++) {
+                    String doc = docs.get((offset + i) % docs.size());
+                    Segmenter segmenter = shared ? sharedSegmenter : create(language);
+                    segmenter.segment(doc);
+                }
+            }));
+        }
+        for (Future<?> future : futures) {
+            future.get();
+        }
+        long elapsed = System.nanoTime() - start;
+
+        pool.shutdown();
+        pool.awaitTermination(1, TimeUnit.MINUTES);
+        return elapsed / 1000.0 / ((long) docsPerThread * threads);
+    }
+
+    /**
+     * Main method for command line usage
+     * Usage: java SegmenterBenchmark <japanese|korean|thai> [docs_per_thread] [threads] [input_file.txt]
+     */
+    public static void main(String[] args) throws Exception {
+        if (args.length < 1) {
+            System.out.println("Usage: java SegmenterBenchmark <japanese|korean|thai> [docs_per_thread] [threads] [input_file.txt]");
+            return;
+        }
+
+        String language = args[0];
+        int docsPerThread = args.length > 1 ? Integer.parseInt(args[1]) : 2000;
+        int threads = args.length > 2 ? Integer.parseInt(args[2]) : Runtime.getRuntime().availableProcessors();
+
+        List<String> docs = new ArrayList<>();
+        if (args.length > 3) {
+            try {
+                for (String line : Files.readAllLines(Paths.get(args[3]), StandardCharsets.UTF_8)) {
+                    if (!line.trim().isEmpty()) {
+                        docs.add(line.trim());
+                    }
+                }
+            } catch (IOException e) {
+                System.err.println("Failed to read input file: " + e.getMessage());
+                System.exit(1);
+            }
+        }
+        if (docs.isEmpty()) {
+            for (String sample : defaultSamples(language)) {
+                docs.add(sample);
+            }
+        }
+
+        // The per-call path creates a segmenter per document, keep its info log out of the
+        // measurement (read when the segmenter classes are initialized, i.e. below)
+        if (System.getProperty("oceanbase.jni.log.level") == null) {
+            System.setProperty("oceanbase.jni.log.level", "warn");
+        }
+
+        // Warm up both paths so JIT compilation does not skew the first measurement
+        run(language, docs, Math.max(1, docsPerThread / 10), threads, false);
+        run(language, docs, Math.max(1, docsPerThread / 10), threads, true);
+
+        double perCallUs = run(language, docs, docsPerThread, threads, false);
+        double sharedUs = run(language, docs, docsPerThread, threads, true);
+
+        System.out.println("Language: " + language + ", threads: " + threads
+                           + ", documents per thread: " + docsPerThread);
+        System.out.printf("  per-call segmenter : %10.2f us/doc%n", perCallUs);
+        System.out.printf("  shared segmenter   : %10.2f us/doc%n", sharedUs);
+        System.out.printf("  speedup            : %10.2fx%n", perCallUs / sharedUs);
+    }
+}
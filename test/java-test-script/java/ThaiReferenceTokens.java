@@ -0,0 +1,48 @@
+import java.io.BufferedReader;
+import java.io.BufferedWriter;
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+
+import org.apache.lucene.analysis.th.ThaiAnalyzer;
+
+/**
+ * Thai Reference Tokens
+ * Writes what the native Thai backend is compared against:
+ *   reference : the ThaiAnalyzer tokens of every corpus line, tab separated (empty line if none)
+ *   stopwords : the ThaiAnalyzer default stopwords, one per line (OCEANBASE_THAI_STOPWORDS_PATH)
+ */
+public class ThaiReferenceTokens {
+
+    /**
+     * Main method for command line usage
+     * Usage: java ThaiReferenceTokens <corpus.txt> <reference.txt> <stopwords.txt>
+     */
+    public static void main(String[] args) throws IOException {
+        if (args.length != 3) {
+            System.out.println("Usage: java ThaiReferenceTokens <corpus.txt> <reference.txt> <stopwords.txt>");
+            return;
+        }
+
+        try (BufferedWriter writer = Files.newBufferedWriter(Paths.get(args[2]), StandardCharsets.UTF_8)) {
+            for (Object stopword : ThaiAnalyzer.getDefaultStopSet()) {
+                writer.write(new String((char[]) stopword));
+                writer.newLine();
+            }
+        }
+
+        ThaiSegmenter segmenter = new ThaiSegmenter();
+        int lines = 0;
+        try (BufferedReader reader = Files.newBufferedReader(Paths.get(args[0]), StandardCharsets.UTF_8);
+             BufferedWriter writer = Files.newBufferedWriter(Paths.get(args[1]), StandardCharsets.UTF_8)) {
+            String line;
+            while ((line = reader.readLine()) != null) {
+                writer.write(String.join("\t", segmenter.segment(line)));
+                writer.newLine();
+                lines++;
+            }
+        }
+        System.out.println("Reference tokens written for " + lines + " lines");
+    }
+}
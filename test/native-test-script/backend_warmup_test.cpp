@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Backend warm-up tests
+ *
+ * Checks that scans arriving during the warm-up wait for it and share its
+ * result, that the task runs once however often the warm-up is started,
+ * the time-to-ready metric and callback, that the stage after readiness
+ * runs without holding up the scans and stops when asked to, and that
+ * nothing waits when no warm-up runs.
+ * Usage: backend_warmup_test
+ */
+
+#include "backend_warmup.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using oceanbase::jni::BackendWarmup;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                  \
+    do {                                                             \
+        if (!(cond)) {                                               \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);  \
+            failures++;                                              \
+        }                                                            \
+    } while (0)
+
+static void check_waiting_scans() {
+    BackendWarmup warmup;
+    std::atomic<int> runs(0);
+    std::atomic<bool> finished(false);
+    BackendWarmup::Task task = [&runs, &finished]() {
+        runs++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        finished = true;
+        return 7;
+    };
+
+    CHECK(!warmup.is_ready() && warmup.time_to_ready_ms() == -1);
+    CHECK(warmup.start(task));
+    CHECK(!warmup.start(task));
+
+    // Every early scan waits for the same warm-up and sees its result
+    std::atomic<int> early(0);
+    std::vector<std::thread> scans;
+    for (int i = 0; i < 8; ++i) {
+        scans.emplace_back([&warmup, &finished, &early]() {
+            int result = 0;
+            bool waited = warmup.wait(result);
+            if (waited && result == 7 && finished) {
+                early++;
+            }
+        });
+    }
+    for (std::thread& scan : scans) {
+        scan.join();
+    }
+    CHECK(early == 8);
+    CHECK(warmup.is_ready());
+    CHECK(warmup.time_to_ready_ms() >= 200);
+
+    // Later scans take the fast path
+    int result = 0;
+    CHECK(warmup.wait(result) && result == 7);
+    CHECK(!warmup.start(task));
+    warmup.join();
+    CHECK(runs == 1);
+}
+
+static void check_without_warmup() {
+    BackendWarmup warmup;
+    int result = 42;
+    CHECK(!warmup.wait(result));
+    CHECK(result == 42);
+    CHECK(!warmup.is_ready());
+    warmup.join();
+}
+
+static void check_failed_warmup() {
+    BackendWarmup warmup;
+    std::atomic<int> reported(0);
+    CHECK(warmup.start([]() { return -4002; }, [&reported](int result, int64_t time_to_ready_ms) {
+        reported = time_to_ready_ms >= 0 ? result : 1;
+    }));
+    int result = 0;
+    CHECK(warmup.wait(result) && result == -4002);
+    CHECK(warmup.time_to_ready_ms() >= 0);
+    warmup.join();
+    CHECK(reported == -4002);
+}
+
+static void check_after_ready() {
+    // The scans see the warm-up ready while the stage after it still runs
+    BackendWarmup warmup;
+    std::atomic<bool> replaying(false);
+    std::atomic<int> replayed(0);
+    CHECK(warmup.start([]() { return 0; }, BackendWarmup::ReadyCallback(), [&warmup, &replaying, &replayed]() {
+        replaying = true;
+        while (!warmup.stop_requested()) {
+            replayed++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }));
+    int result = -1;
+    CHECK(warmup.wait(result) && result == 0);
+    CHECK(warmup.is_ready());
+    while (!replaying) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(!warmup.stop_requested());
+
+    // Unloading asks the stage to stop and waits for it
+    warmup.join();
+    CHECK(warmup.stop_requested());
+    int after_join = replayed;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(replayed == after_join);
+
+    // Not run after a failed task
+    BackendWarmup failed;
+    std::atomic<bool> ran(false);
+    CHECK(failed.start([]() { return -4002; }, BackendWarmup::ReadyCallback(), [&ran]() { ran = true; }));
+    failed.join();
+    CHECK(!ran);
+}
+
+static void check_destroy_while_running() {
+    // Unloading the plugin during the warm-up waits for it
+    std::atomic<bool> finished(false);
+    {
+        BackendWarmup warmup;
+        warmup.start([&finished]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            finished = true;
+            return 0;
+        });
+    }
+    CHECK(finished);
+}
+
+int main() {
+    check_waiting_scans();
+    check_without_warmup();
+    check_failed_warmup();
+    check_after_ready();
+    check_destroy_while_running();
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All backend warm-up checks passed\n");
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Bigram tokenizer tests
+ *
+ * Checks the bigrams of Han/Kana/Hangul and Thai runs, the words of other
+ * scripts, and that the vectorized ASCII scan agrees with a plain loop at
+ * every block offset. Also reports the throughput on a mixed document.
+ * Usage: bigram_tokenizer_test
+ */
+
+#include "bigram_tokenizer.h"
+#include "packed_token_buffer.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using oceanbase::jni::BigramTokenizer;
+using oceanbase::jni::PackedTokenBuffer;
+
+static int failures = 0;
+
+static std::string join(const std::vector<std::string>& tokens) {
+    std::string joined;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        joined += (i > 0 ? "|" : "") + tokens[i];
+    }
+    return joined;
+}
+
+static std::string tokenize(const BigramTokenizer::Options& options, const std::string& text) {
+    BigramTokenizer tokenizer(options);
+    PackedTokenBuffer packed;
+    std::vector<std::string> tokens;
+    if (tokenizer.append_tokens(text.data(), text.size(), packed) != 0) {
+        return "<allocation failed>";
+    }
+    packed.to_vector(tokens);
+    return join(tokens);
+}
+
+static void check(const BigramTokenizer::Options& options, const std::string& text, const std::string& expected) {
+    std::string tokens = tokenize(options, text);
+    if (tokens != expected) {
+        printf("FAIL \"%s\": \"%s\" (expected \"%s\")\n", text.c_str(), tokens.c_str(), expected.c_str());
+        failures++;
+    }
+}
+
+static void check(const std::string& text, const std::string& expected) {
+    check(BigramTokenizer::Options(), text, expected);
+}
+
+// Reference for ASCII text: lowercased letter/digit runs
+static std::string ascii_reference(const std::string& text) {
+    std::vector<std::string> tokens;
+    std::string word;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        char c = i < text.size() ? text[i] : ' ';
+        if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            word += static_cast<char>((c >= 'A' && c <= 'Z') ? c + 32 : c);
+        } else if (!word.empty()) {
+            tokens.push_back(word);
+            word.clear();
+        }
+    }
+    return join(tokens);
+}
+
+static void check_ascii_blocks() {
+    // Runs of every length up to 40 at every offset cross the 16-byte blocks in all positions
+    const char* separators = " ,.-\t/!";
+    for (size_t offset = 0; offset < 17; ++offset) {
+        std::string text(offset, ' ');
+        for (size_t len = 1; len <= 40; ++len) {
+            for (size_t i = 0; i < len; ++i) {
+                text += static_cast<char>((i % 3 == 0) ? 'A' + (i % 26) : (i % 3 == 1) ? 'a' + (i % 26) : '0' + (i % 10));
+            }
+            text.append(len % 5 + 1, separators[len % 7]);
+        }
+        std::string tokens = tokenize(BigramTokenizer::Options(), text);
+        if (tokens != ascii_reference(text)) {
+            printf("FAIL ASCII blocks at offset %zu\n", offset);
+            failures++;
+        }
+    }
+    // A word running into non-ASCII text inside a block
+    check("abcdefghijklmnopqrstuvwxyzé日本", "abcdefghijklmnopqrstuvwxyzé|日本");
+    check("----------------------------x日本語", "x|日本|本語");
+}
+
+static void report_throughput() {
+    std::string doc;
+    while (doc.size() < (8u << 20)) {
+        doc += "OceanBase は分散データベースです。데이터베이스 검색 ฐานข้อมูลแบบกระจาย 2024 release notes, v4.3.5; ";
+    }
+    BigramTokenizer tokenizer((BigramTokenizer::Options()));
+    PackedTokenBuffer tokens;
+    auto start = std::chrono::steady_clock::now();
+    const int rounds = 5;
+    for (int i = 0; i < rounds; ++i) {
+        tokens.clear();
+        if (tokenizer.append_tokens(doc.data(), doc.size(), tokens) != 0) {
+            printf("FAIL throughput document: allocation failed\n");
+            failures++;
+            return;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("Mixed document: %.1f MB/s, %zu tokens per %zu bytes\n",
+           rounds * doc.size() / seconds / (1 << 20), tokens.size(), doc.size());
+}
+
+int main() {
+    BigramTokenizer::Options unigrams;
+    unigrams.output_unigrams = true;
+    BigramTokenizer::Options short_words;
+    short_words.max_word_length = 4;
+
+    // Han, Kana and Hangul runs become overlapping bigrams, a lone character a unigram
+    check("", "");
+    check(" \t\n ", "");
+    check("東京都に住む", "東京|京都|都に|に住|住む");
+    check("日本語。中文，한국어", "日本|本語|中文|한국|국어");
+    check("本 한", "本|한");
+    check("々〆〇", "々〆|〆〇");
+    check("ｶﾀｶﾅ", "ｶﾀ|ﾀｶ|ｶﾅ");
+    check("𠮷野家", "𠮷野|野家");
+    check(unigrams, "東京都", "東|京|東京|都|京都");
+    check(unigrams, "本", "本");
+
+    // Thai runs are bigrams of characters with their vowels and tone marks
+    check("ภาษาไทย", "ภา|าษ|ษา|าไ|ไท|ทย");
+    check("กินข้าว", "กิน|นข้|ข้า|าว");
+    check("ฯ ๑๒๓ ฿100", "ฯ|123|100");
+
+    // Other scripts are lowercased words, script changes end a token
+    check("OceanBase 4.3, MySQL-compatible!", "oceanbase|4|3|mysql|compatible");
+    check("SKU123abc", "sku123abc");
+    check("Tシャツ iPhone을 2024年", "t|シャ|ャツ|iphone|을|2024|年");
+    check("Café ÉCOLE Straße", "café|école|straße");
+    check("ＯｃｅａｎＢａｓｅ　４．３", "oceanbase|4|3");
+    check("ΑΘΗΝΑ Москва ĄŁŻ", "αθηνα|москва|ąłż");
+    check("cafe\xCC\x81 x", "cafe\xCC\x81|x");
+    check(short_words, "abcdefghij", "abcd|efgh|ij");
+    check(short_words, "ÀÉÎÕÜàéîõü", "àéîõ|üàéî|õü");
+
+    // Punctuation, symbols and malformed bytes only separate
+    check("a\xFF" "b\xE6\x97" "c", "a|b|c");
+    check("日\xC0本", "日|本");
+    check("😀東京😀", "東京");
+    check("「東京」・『大阪』", "東京|大阪");
+
+    check_ascii_blocks();
+    report_throughput();
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All bigram tokenizer checks passed\n");
+    return 0;
+}
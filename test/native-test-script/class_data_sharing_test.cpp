@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Class-data sharing tests
+ *
+ * Checks the JVM options of each OCEANBASE_JNI_CDS_MODE: dump mode records
+ * the class list and a classpath stamp, use mode maps the archive only
+ * while the classpath matches the stamp, and the JVM starts without the
+ * archive when it is missing or stale.
+ * Usage: class_data_sharing_test [directory]
+ */
+
+#include "class_data_sharing.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <vector>
+
+using oceanbase::jni::ClassDataSharing;
+using oceanbase::jni::JNI_CDS_MODE_DUMP;
+using oceanbase::jni::JNI_CDS_MODE_OFF;
+using oceanbase::jni::JNI_CDS_MODE_USE;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                  \
+    do {                                                             \
+        if (!(cond)) {                                               \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);  \
+            failures++;                                              \
+        }                                                            \
+    } while (0)
+
+static void write_file(const std::string& path, const std::string& content) {
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+static bool exists(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+static void check_modes() {
+    CHECK(ClassDataSharing::parse_mode("dump", JNI_CDS_MODE_OFF) == JNI_CDS_MODE_DUMP);
+    CHECK(ClassDataSharing::parse_mode("USE", JNI_CDS_MODE_OFF) == JNI_CDS_MODE_USE);
+    CHECK(ClassDataSharing::parse_mode("off", JNI_CDS_MODE_USE) == JNI_CDS_MODE_OFF);
+    CHECK(ClassDataSharing::parse_mode("sometimes", JNI_CDS_MODE_OFF) == JNI_CDS_MODE_OFF);
+    CHECK(ClassDataSharing::parse_mode(nullptr, JNI_CDS_MODE_USE) == JNI_CDS_MODE_USE);
+    CHECK(std::string(ClassDataSharing::mode_name(JNI_CDS_MODE_DUMP)) == "dump");
+    CHECK(std::string(ClassDataSharing::mode_name(42)) == "off");
+}
+
+static void check_dump_and_use(const std::string& dir) {
+    std::string lucene = dir + "/lucene-core.jar";
+    std::string segmenter = dir + "/segmenter.jar";
+    std::string archive = dir + "/segmenters.jsa";
+    std::string classpath = lucene + ":" + segmenter;
+    write_file(lucene, "lucene classes");
+    write_file(segmenter, "segmenter classes");
+    unlink(archive.c_str());
+
+    std::vector<std::string> options;
+    std::string message;
+
+    // Off, or no archive configured: nothing changes
+    CHECK(ClassDataSharing::jvm_options(JNI_CDS_MODE_OFF, archive, classpath, options, message) == 0);
+    CHECK(ClassDataSharing::jvm_options(JNI_CDS_MODE_USE, "", classpath, options, message) == 0);
+    CHECK(options.empty() && message.empty());
+
+    // Use before any dump: no archive yet
+    CHECK(ClassDataSharing::jvm_options(JNI_CDS_MODE_USE, archive, classpath, options, message) == 0);
+    CHECK(options.empty() && message.find("not found") != std::string::npos);
+
+    // Dump: class list option, stamp written, command to build the archive
+    CHECK(ClassDataSharing::jvm_options(JNI_CDS_MODE_DUMP, archive, classpath, options, message) == 0);
+    CHECK(options.size() == 1 && options[0] == "-XX:DumpLoadedClassList=" + archive + ".classlist");
+    CHECK(exists(ClassDataSharing::stamp_path(archive)));
+    CHECK(message.find("-Xshare:dump") != std::string::npos && message.find(classpath) != std::string::npos);
+
+    // The archive built offline is mapped while the classpath is unchanged
+    write_file(archive, "archive");
+    options.clear();
+    CHECK(ClassDataSharing::jvm_options(JNI_CDS_MODE_USE, archive, classpath, options, message) == 0);
+    CHECK(options.size() == 2 && options[0] == "-Xshare:auto" && options[1] == "-XX:SharedArchiveFile=" + archive);
+
+    // A rebuilt jar, a new jar or another order: the archive is stale
+    std::string stamp = ClassDataSharing::classpath_stamp(classpath);
+    write_file(segmenter, "segmenter classes, rebuilt");
+    CHECK(ClassDataSharing::classpath_stamp(classpath) != stamp);
+    options.clear();
+    CHECK(ClassDataSharing::jvm_options(JNI_CDS_MODE_USE, archive, classpath, options, message) == 0);
+    CHECK(options.empty() && message.find("another classpath") != std::string::npos);
+
+    CHECK(ClassDataSharing::jvm_options(JNI_CDS_MODE_DUMP, archive, classpath, options, message) == 0);
+    options.clear();
+    CHECK(ClassDataSharing::jvm_options(JNI_CDS_MODE_USE, archive, classpath + ":" + dir + "/extra.jar",
+                                        options, message) == 0);
+    CHECK(options.empty());
+    CHECK(ClassDataSharing::jvm_options(JNI_CDS_MODE_USE, archive, segmenter + ":" + lucene, options, message) == 0);
+    CHECK(options.empty());
+
+    // Same size, new modification time
+    stamp = ClassDataSharing::classpath_stamp(classpath);
+    struct timeval times[2];
+    times[0].tv_sec = times[1].tv_sec = 1000000000;
+    times[0].tv_usec = times[1].tv_usec = 0;
+    CHECK(utimes(lucene.c_str(), times) == 0);
+    CHECK(ClassDataSharing::classpath_stamp(classpath) != stamp);
+
+    // Stamp cannot be written: dump is skipped
+    CHECK(ClassDataSharing::jvm_options(JNI_CDS_MODE_DUMP, dir + "/missing/segmenters.jsa", classpath,
+                                        options, message) != 0);
+    CHECK(options.empty() && !message.empty());
+
+    unlink(lucene.c_str());
+    unlink(segmenter.c_str());
+    unlink(archive.c_str());
+    unlink(ClassDataSharing::stamp_path(archive).c_str());
+}
+
+int main(int argc, char** argv) {
+    std::string dir = argc > 1 ? argv[1] : "/tmp";
+    check_modes();
+    check_dump_and_use(dir);
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All class-data sharing checks passed\n");
+    return 0;
+}
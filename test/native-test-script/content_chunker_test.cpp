@@ -0,0 +1,272 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Content-defined chunker tests
+ *
+ * Checks where sentence boundaries are, that the chunks cover the document
+ * and respect the size bounds, that an edited paragraph only changes the
+ * chunks around it, and that the tokens of the chunks are the tokens of
+ * the whole document (with the bigram tokenizer standing in for the
+ * analyzers), also with the native ASCII pre-pass applied to each chunk.
+ * Also reports the chunking throughput.
+ * Usage: content_chunker_test
+ */
+
+#include "content_chunker.h"
+#include "bigram_tokenizer.h"
+#include "packed_token_buffer.h"
+#include "script_run_splitter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+using oceanbase::jni::BigramTokenizer;
+using oceanbase::jni::ContentChunker;
+using oceanbase::jni::PackedTokenBuffer;
+using oceanbase::jni::ScriptRunSplitter;
+using oceanbase::jni::TextSpan;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                  \
+    do {                                                             \
+        if (!(cond)) {                                               \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);  \
+            failures++;                                              \
+        }                                                            \
+    } while (0)
+
+// Chunks of a document cut at every sentence boundary, joined with '|'
+static std::string boundaries(const std::string& text) {
+    ContentChunker::Options options;
+    options.min_chunk_bytes = 0;
+    options.boundary_mask = 0;
+    ContentChunker chunker(options);
+    std::vector<TextSpan> chunks;
+    chunker.split(text.data(), text.size(), chunks);
+    std::string joined;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        joined += (i > 0 ? "|" : "") + std::string(chunks[i].data, chunks[i].length);
+    }
+    return joined;
+}
+
+static void check_boundaries(const std::string& text, const std::string& expected) {
+    std::string actual = boundaries(text);
+    if (actual != expected) {
+        printf("FAIL \"%s\": \"%s\" (expected \"%s\")\n", text.c_str(), actual.c_str(), expected.c_str());
+        failures++;
+    }
+}
+
+// Paragraph i of a mixed-script document
+static std::string paragraph(int i) {
+    std::string n = std::to_string(i);
+    switch (i % 4) {
+    case 0:
+        return "第" + n + "章。東京都は日本の首都です。人口は約1400万人、面積は2194km²。「本当ですか。」と聞いた。\n";
+    case 1:
+        return "Section " + n + ". OceanBase stores data in LSM trees! Version 4.3.5 adds vectors? Yes. Mr.Smith agrees.\n";
+    case 2:
+        return "제" + n + "장. 데이터베이스 검색은 빠릅니다. 서울은 한국의 수도입니다！다음 문장입니다。끝\n";
+    default:
+        return "ส่วนที่ " + n + " ฐานข้อมูลแบบกระจาย รองรับภาษาไทย. ข้อความถัดไป!\n";
+    }
+}
+
+static std::string document(int paragraphs, int edited) {
+    std::string doc;
+    for (int i = 0; i < paragraphs; ++i) {
+        doc += paragraph(i);
+        if (i == edited) {
+            doc += "一文だけ追加した。 An inserted sentence.\n";
+        }
+    }
+    return doc;
+}
+
+static std::vector<std::string> chunk_strings(const ContentChunker& chunker, const std::string& doc) {
+    std::vector<TextSpan> chunks;
+    chunker.split(doc.data(), doc.size(), chunks);
+    std::vector<std::string> strings;
+    for (const TextSpan& chunk : chunks) {
+        strings.push_back(std::string(chunk.data, chunk.length));
+    }
+    return strings;
+}
+
+static void check_cover_and_bounds() {
+    ContentChunker chunker((ContentChunker::Options()));
+    std::string doc = document(400, -1);
+    std::vector<TextSpan> chunks;
+    chunker.split(doc.data(), doc.size(), chunks);
+    CHECK(chunks.size() > 10);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const TextSpan& chunk = chunks[i];
+        CHECK(chunk.data == doc.data() + offset);
+        CHECK(chunk.length > 0);
+        if (i > 0) {
+            CHECK(ContentChunker::is_sentence_boundary(doc.data(), doc.size(), offset));
+        }
+        if (chunk.length > chunker.options().max_chunk_bytes) {
+            // Only a chunk without an inner boundary may be longer
+            for (size_t pos = offset + 1; pos < offset + chunk.length; ++pos) {
+                CHECK(!ContentChunker::is_sentence_boundary(doc.data(), doc.size(), pos));
+            }
+        }
+        offset += chunk.length;
+    }
+    CHECK(offset == doc.size());
+
+    // No boundary at all: one chunk, however long
+    std::string run(10000, 'x');
+    chunker.split(run.data(), run.size(), chunks);
+    CHECK(chunks.size() == 1 && chunks[0].length == run.size());
+    chunker.split("", 0, chunks);
+    CHECK(chunks.empty());
+}
+
+static void check_locality() {
+    // An edit in the middle leaves almost all chunks as they were
+    ContentChunker chunker((ContentChunker::Options()));
+    std::vector<std::string> before = chunk_strings(chunker, document(400, -1));
+    std::vector<std::string> after = chunk_strings(chunker, document(400, 200));
+    std::set<std::string> known(before.begin(), before.end());
+    size_t reused = 0;
+    for (const std::string& chunk : after) {
+        reused += known.count(chunk);
+    }
+    printf("Edited document: %zu of %zu chunks reused\n", reused, after.size());
+    CHECK(after.size() - reused <= 3);
+}
+
+static std::string bigram_tokens(const char* text, size_t length) {
+    BigramTokenizer tokenizer((BigramTokenizer::Options()));
+    PackedTokenBuffer packed;
+    tokenizer.append_tokens(text, length, packed);
+    std::vector<std::string> tokens;
+    packed.to_vector(tokens);
+    std::string joined;
+    for (const std::string& token : tokens) {
+        joined += token + "|";
+    }
+    return joined;
+}
+
+static void check_tokens_unchanged() {
+    // Chunked at every boundary, the tokens stay the same
+    ContentChunker::Options every;
+    every.min_chunk_bytes = 0;
+    every.boundary_mask = 0;
+    ContentChunker chunker(every);
+    std::string doc = document(40, 7);
+    std::vector<TextSpan> chunks;
+    chunker.split(doc.data(), doc.size(), chunks);
+    std::string chunked;
+    PackedTokenBuffer joined;
+    for (const TextSpan& chunk : chunks) {
+        chunked += bigram_tokens(chunk.data, chunk.length);
+    }
+    CHECK(chunks.size() > 100);
+    CHECK(chunked == bigram_tokens(doc.data(), doc.size()));
+
+    // Packed token buffers of the chunks concatenate to those of the document
+    BigramTokenizer tokenizer((BigramTokenizer::Options()));
+    PackedTokenBuffer whole;
+    tokenizer.append_tokens(doc.data(), doc.size(), whole);
+    for (const TextSpan& chunk : chunks) {
+        PackedTokenBuffer part;
+        tokenizer.append_tokens(chunk.data, chunk.length, part);
+        CHECK(joined.append_packed(part.data(), part.size()) == 0);
+    }
+    CHECK(joined.size() == whole.size() && std::string(joined.data(), joined.size()) == std::string(whole.data(), whole.size()));
+}
+
+static std::string without_newlines(std::string text) {
+    text.erase(std::remove(text.begin(), text.end(), '\n'), text.end());
+    return text;
+}
+
+static void check_native_ascii_unchanged() {
+    // Chunks are segmented with the native ASCII pre-pass like any document:
+    // cuts never fall inside an ASCII chunk, so the chunks give the native
+    // tokens of the whole document and send the segmenter the same text
+    ContentChunker::Options every;
+    every.min_chunk_bytes = 0;
+    every.boundary_mask = 0;
+    ContentChunker chunker(every);
+    std::string doc = document(40, 7) + "Trailing ASCII words. 3.14 don't stop\nend";
+    std::vector<TextSpan> chunks;
+    chunker.split(doc.data(), doc.size(), chunks);
+    CHECK(chunks.size() > 100);
+
+    ScriptRunSplitter::Options thai;
+    thai.split_letters_and_digits = false;
+    thai.punctuation_joins_words = true;
+    const ScriptRunSplitter::Options options[] = {ScriptRunSplitter::Options(), thai};
+    for (const ScriptRunSplitter::Options& option : options) {
+        ScriptRunSplitter splitter(option);
+        PackedTokenBuffer whole;
+        std::string whole_text;
+        CHECK(splitter.append_native_tokens(doc.data(), doc.size(), whole) == 0);
+        splitter.collect_segmenter_text(doc.data(), doc.size(), whole_text);
+
+        PackedTokenBuffer joined;
+        std::string joined_text;
+        for (const TextSpan& chunk : chunks) {
+            PackedTokenBuffer part;
+            std::string part_text;
+            CHECK(splitter.append_native_tokens(chunk.data, chunk.length, part) == 0);
+            CHECK(joined.append_packed(part.data(), part.size()) == 0);
+            splitter.collect_segmenter_text(chunk.data, chunk.length, part_text);
+            joined_text += part_text;
+        }
+        CHECK(whole.token_count() > 0);
+        CHECK(std::string(joined.data(), joined.size()) == std::string(whole.data(), whole.size()));
+        CHECK(without_newlines(joined_text) == without_newlines(whole_text));
+    }
+}
+
+static void report_throughput() {
+    ContentChunker chunker((ContentChunker::Options()));
+    std::string doc = document(20000, -1);
+    std::vector<TextSpan> chunks;
+    auto start = std::chrono::steady_clock::now();
+    const int rounds = 5;
+    for (int i = 0; i < rounds; ++i) {
+        chunker.split(doc.data(), doc.size(), chunks);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("Chunking: %.1f MB/s, %zu chunks of %zu bytes on average\n",
+           rounds * doc.size() / seconds / (1 << 20), chunks.size(), doc.size() / chunks.size());
+}
+
+int main() {
+    // Sentence boundaries
+    check_boundaries("", "");
+    check_boundaries("One. Two! Three? Four", "One.| Two!| Three?| Four");
+    check_boundaries("line one\nline two\n", "line one\n|line two\n");
+    check_boundaries("3.14 and e.g. Mr.Smith...", "3.14 and e.g.| Mr.Smith...");
+    check_boundaries("今日は晴れ。明日は雨！本当？はい", "今日は晴れ。|明日は雨！|本当？|はい");
+    check_boundaries("「はい。」と言った。。終わり。 次", "「はい。」と言った。。|終わり。| 次");
+    check_boundaries("끝입니다。다음。ABC。　全角", "끝입니다。|다음。ABC。|　全角");
+    check_boundaries("３．１４．", "３．１４．");
+    check_boundaries("ภาษาไทย. ต่อไป", "ภาษาไทย.| ต่อไป");
+
+    check_cover_and_bounds();
+    check_locality();
+    check_tokens_unchanged();
+    check_native_ascii_unchanged();
+    report_throughput();
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All content chunker checks passed\n");
+    return 0;
+}
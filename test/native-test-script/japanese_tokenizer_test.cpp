@@ -0,0 +1,481 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Native Japanese tokenizer tests
+ *
+ * Builds a small dictionary file in memory and checks the lattice, unknown
+ * words, search mode decompounding and the JapaneseSegmenter filter chain,
+ * and that a document segmented in the sentence chunks of the chunk cache
+ * gives the tokens of the whole document. Optionally compares the tokenizer
+ * with Lucene tokens on a reference corpus using a dictionary exported by
+ * KuromojiDictionaryExport, and the chunked tokens of the corpus text with
+ * its whole-document tokens.
+ * Usage: japanese_tokenizer_test
+ *        japanese_tokenizer_test --compare <dictionary.dic> <corpus.txt> <reference.txt>
+ */
+
+#include "content_chunker.h"
+#include "japanese_dictionary.h"
+#include "japanese_tokenizer.h"
+#include "packed_token_buffer.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+using oceanbase::jni::ContentChunker;
+using oceanbase::jni::PackedTokenBuffer;
+using oceanbase::jni::TextSpan;
+using oceanbase::japanese_ftparser::JapaneseDictionary;
+using oceanbase::japanese_ftparser::JapaneseDictionaryHeader;
+using oceanbase::japanese_ftparser::JapaneseTokenizer;
+using oceanbase::japanese_ftparser::JapaneseTokenizerOptions;
+using oceanbase::japanese_ftparser::JapaneseTrieNode;
+using oceanbase::japanese_ftparser::JapaneseWordEntry;
+
+static int failures = 0;
+
+// Character classes of the test dictionary (a subset of IPADIC char.def)
+enum TestCharClass { DEFAULT = 0, SPACE, KANJI, HIRAGANA, KATAKANA, ALPHA, NUMERIC, SYMBOL, CLASS_COUNT };
+
+/**
+ * Writes the dictionary file format of japanese_dictionary.h, as KuromojiDictionaryExport does
+ */
+class TestDictionaryBuilder {
+public:
+    TestDictionaryBuilder() : strings_() {
+        for (int c = 0; c < CLASS_COUNT; ++c) {
+            // Unknown words: one noun entry per class, kanji unknowns are expensive
+            add_unknown(static_cast<TestCharClass>(c), c == KANJI ? 8000 : 4000);
+        }
+    }
+
+    void add_word(const std::u16string& surface, int16_t cost, const char* base_form = nullptr, uint16_t flags = 0) {
+        JapaneseWordEntry entry = {1, 1, cost, flags, JapaneseDictionary::NO_STRING};
+        if (base_form) {
+            entry.base_form = add_string(base_form);
+        }
+        words_[surface].push_back(entry);
+    }
+
+    void add_unknown(TestCharClass char_class, int16_t cost) {
+        JapaneseWordEntry entry = {1, 1, cost, 0, JapaneseDictionary::NO_STRING};
+        unknown_[char_class].push_back(entry);
+    }
+
+    // Stopwords must be added in unsigned byte order
+    void add_stopword(const char* word) {
+        stopwords_.push_back(add_string(word));
+    }
+
+    void build(std::vector<uint64_t>& storage) {
+        nodes_.clear();
+        labels_.clear();
+        targets_.clear();
+        entries_.clear();
+        std::vector<std::pair<std::u16string, std::vector<JapaneseWordEntry> > > sorted(words_.begin(), words_.end());
+        build_node(sorted, 0, sorted.size(), 0);
+
+        JapaneseDictionaryHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "OBJADIC", 8);
+        header.version = JapaneseDictionary::FORMAT_VERSION;
+        header.header_size = sizeof(header);
+        header.left_size = 2;
+        header.right_size = 2;
+        header.node_count = static_cast<uint32_t>(nodes_.size());
+        header.edge_count = static_cast<uint32_t>(labels_.size());
+        header.entry_count = static_cast<uint32_t>(entries_.size());
+        header.stopword_count = static_cast<uint32_t>(stopwords_.size());
+        header.string_bytes = static_cast<uint32_t>(strings_.size());
+        std::vector<JapaneseWordEntry> unknown;
+        for (int c = 0; c < CLASS_COUNT; ++c) {
+            header.unknown_first[c] = static_cast<uint32_t>(unknown.size());
+            header.unknown_count[c] = static_cast<uint32_t>(unknown_[c].size());
+            unknown.insert(unknown.end(), unknown_[c].begin(), unknown_[c].end());
+        }
+        header.unknown_entry_count = static_cast<uint32_t>(unknown.size());
+
+        // No connection costs: the word costs alone decide the tests
+        std::vector<int16_t> costs(header.left_size * header.right_size, 0);
+        std::vector<uint8_t> char_info(65536);
+        std::vector<uint16_t> lower(65536);
+        for (uint32_t c = 0; c < 65536; ++c) {
+            char_info[c] = classify(static_cast<uint16_t>(c));
+            lower[c] = static_cast<uint16_t>(c >= 'A' && c <= 'Z' ? c + 32 : c);
+        }
+
+        std::string file(reinterpret_cast<const char*>(&header), sizeof(header));
+        header.costs_offset = append(file, costs.data(), costs.size() * 2);
+        header.char_info_offset = append(file, char_info.data(), char_info.size());
+        header.lower_offset = append(file, lower.data(), lower.size() * 2);
+        header.nodes_offset = append(file, nodes_.data(), nodes_.size() * sizeof(JapaneseTrieNode));
+        header.edge_labels_offset = append(file, labels_.data(), labels_.size() * 2);
+        header.edge_targets_offset = append(file, targets_.data(), targets_.size() * 4);
+        header.entries_offset = append(file, entries_.data(), entries_.size() * sizeof(JapaneseWordEntry));
+        header.unknown_entries_offset = append(file, unknown.data(), unknown.size() * sizeof(JapaneseWordEntry));
+        header.stopwords_offset = append(file, stopwords_.data(), stopwords_.size() * 4);
+        header.strings_offset = append(file, strings_.data(), strings_.size());
+        memcpy(&file[0], &header, sizeof(header));
+
+        // uint64_t storage keeps the buffer 8-byte aligned, as a mapping is
+        storage.assign((file.size() + 7) / 8, 0);
+        memcpy(storage.data(), file.data(), file.size());
+    }
+
+private:
+    std::map<std::u16string, std::vector<JapaneseWordEntry> > words_;
+    std::vector<JapaneseWordEntry> unknown_[CLASS_COUNT];
+    std::vector<uint32_t> stopwords_;
+    std::string strings_;
+    std::vector<JapaneseTrieNode> nodes_;
+    std::vector<uint16_t> labels_;
+    std::vector<uint32_t> targets_;
+    std::vector<JapaneseWordEntry> entries_;
+
+    uint32_t add_string(const char* value) {
+        uint32_t offset = static_cast<uint32_t>(strings_.size());
+        uint16_t length = static_cast<uint16_t>(strlen(value));
+        strings_.append(reinterpret_cast<const char*>(&length), 2);
+        strings_.append(value, length);
+        return offset;
+    }
+
+    static uint64_t append(std::string& file, const void* data, size_t size) {
+        file.resize((file.size() + 7) / 8 * 8, '\0');
+        uint64_t offset = file.size();
+        file.append(static_cast<const char*>(data), size);
+        return offset;
+    }
+
+    // IPADIC-like classes: KATAKANA, ALPHA, NUMERIC and SYMBOL invoke and group, HIRAGANA groups
+    static uint8_t classify(uint16_t c) {
+        uint8_t info;
+        if (c == ' ' || c == 0x3000) {
+            info = SPACE | JapaneseDictionary::CHAR_GROUP | JapaneseDictionary::CHAR_PUNCTUATION;
+        } else if (c >= 0x4E00 && c <= 0x9FFF) {
+            info = KANJI | JapaneseDictionary::CHAR_KANJI;
+        } else if (c >= 0x3041 && c <= 0x309F) {
+            info = HIRAGANA | JapaneseDictionary::CHAR_GROUP;
+        } else if ((c >= 0x30A1 && c <= 0x30FF && c != 0x30FB) || (c >= 0xFF66 && c <= 0xFF9F)) {
+            info = KATAKANA | JapaneseDictionary::CHAR_INVOKE | JapaneseDictionary::CHAR_GROUP;
+        } else if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= 0xFF21 && c <= 0xFF3A) ||
+                   (c >= 0xFF41 && c <= 0xFF5A)) {
+            info = ALPHA | JapaneseDictionary::CHAR_INVOKE | JapaneseDictionary::CHAR_GROUP;
+        } else if ((c >= '0' && c <= '9') || (c >= 0xFF10 && c <= 0xFF19)) {
+            info = NUMERIC | JapaneseDictionary::CHAR_INVOKE | JapaneseDictionary::CHAR_GROUP;
+        } else if (c < 0x80 || c == 0x3001 || c == 0x3002 || c == 0x30FB || c == 0xFF01) {
+            info = SYMBOL | JapaneseDictionary::CHAR_INVOKE | JapaneseDictionary::CHAR_GROUP |
+                   JapaneseDictionary::CHAR_PUNCTUATION;
+        } else {
+            info = DEFAULT | JapaneseDictionary::CHAR_GROUP;
+        }
+        return info;
+    }
+
+    uint32_t build_node(const std::vector<std::pair<std::u16string, std::vector<JapaneseWordEntry> > >& words,
+                        size_t from, size_t to, size_t depth) {
+        uint32_t index = static_cast<uint32_t>(nodes_.size());
+        JapaneseTrieNode node = {0, 0, 0, 0};
+        nodes_.push_back(node);
+        if (from < to && words[from].first.size() == depth) {
+            nodes_[index].first_entry = static_cast<uint32_t>(entries_.size());
+            nodes_[index].entry_count = static_cast<uint32_t>(words[from].second.size());
+            entries_.insert(entries_.end(), words[from].second.begin(), words[from].second.end());
+            ++from;
+        }
+        std::vector<size_t> starts;
+        for (size_t i = from; i < to; ++i) {
+            if (i == from || words[i].first[depth] != words[i - 1].first[depth]) {
+                starts.push_back(i);
+            }
+        }
+        starts.push_back(to);
+        uint32_t first_edge = static_cast<uint32_t>(labels_.size());
+        nodes_[index].first_edge = first_edge;
+        nodes_[index].edge_count = static_cast<uint32_t>(starts.size() - 1);
+        for (size_t g = 0; g + 1 < starts.size(); ++g) {
+            labels_.push_back(words[starts[g]].first[depth]);
+            targets_.push_back(0);
+        }
+        for (size_t g = 0; g + 1 < starts.size(); ++g) {
+            uint32_t child = build_node(words, starts[g], starts[g + 1], depth + 1);
+            targets_[first_edge + g] = child;
+        }
+        return index;
+    }
+};
+
+static std::string join(const std::vector<std::string>& tokens, const char* separator) {
+    std::string joined;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        joined += (i > 0 ? separator : "") + tokens[i];
+    }
+    return joined;
+}
+
+static std::string segment(const JapaneseTokenizer& tokenizer, const std::string& text, const char* separator) {
+    PackedTokenBuffer packed;
+    std::vector<std::string> tokens;
+    if (tokenizer.segment(text.data(), text.size(), packed) != 0) {
+        return "<allocation failed>";
+    }
+    packed.to_vector(tokens);
+    return join(tokens, separator);
+}
+
+static void check(const JapaneseTokenizer& tokenizer, const std::string& text, const std::string& expected) {
+    std::string tokens = segment(tokenizer, text, "|");
+    if (tokens != expected) {
+        printf("FAIL \"%s\": \"%s\" (expected \"%s\")\n", text.c_str(), tokens.c_str(), expected.c_str());
+        failures++;
+    }
+}
+
+// Tokens of a document segmented chunk by chunk, cut at every sentence boundary of the chunk cache
+static std::string segment_chunked(const JapaneseTokenizer& tokenizer, const std::string& text,
+                                   const char* separator, size_t* chunk_count) {
+    ContentChunker::Options every;
+    every.min_chunk_bytes = 0;
+    every.boundary_mask = 0;
+    ContentChunker chunker(every);
+    std::vector<TextSpan> chunks;
+    chunker.split(text.data(), text.size(), chunks);
+    *chunk_count = chunks.size();
+    PackedTokenBuffer joined;
+    for (const TextSpan& chunk : chunks) {
+        PackedTokenBuffer part;
+        if (tokenizer.segment(chunk.data, chunk.length, part) != 0 ||
+            joined.append_packed(part.data(), part.size()) != 0) {
+            return "<allocation failed>";
+        }
+    }
+    std::vector<std::string> tokens;
+    joined.to_vector(tokens);
+    return join(tokens, separator);
+}
+
+// Up to eight tokens of a joined token list
+static std::string tokens_from(const std::string& joined, size_t from, char separator) {
+    size_t end = from;
+    for (int i = 0; i < 8 && end != std::string::npos; ++i) {
+        end = joined.find(separator, end + 1);
+    }
+    return joined.substr(from, end == std::string::npos ? std::string::npos : end - from);
+}
+
+// The first differing token of two joined token lists, with the tokens before it
+static std::string first_difference(const std::string& whole, const std::string& chunked, char separator) {
+    size_t at = 0;
+    size_t token_start = 0;
+    size_t previous_start = 0;
+    while (at < whole.size() && at < chunked.size() && whole[at] == chunked[at]) {
+        if (whole[at] == separator) {
+            previous_start = token_start;
+            token_start = at + 1;
+        }
+        ++at;
+    }
+    return "whole \"" + tokens_from(whole, previous_start, separator) + "\", chunked \"" +
+           tokens_from(chunked, previous_start, separator) + "\"";
+}
+
+static void check_chunked(const JapaneseTokenizer& tokenizer, const std::string& text) {
+    size_t chunks = 0;
+    std::string whole = segment(tokenizer, text, "|");
+    std::string chunked = segment_chunked(tokenizer, text, "|", &chunks);
+    if (chunks < 2 || whole.empty()) {
+        printf("FAIL chunked document: %zu chunks, %zu token bytes\n", chunks, whole.size());
+        failures++;
+    } else if (chunked != whole) {
+        printf("FAIL chunked document: %s\n", first_difference(whole, chunked, '|').c_str());
+        failures++;
+    }
+}
+
+static void check_rejected(std::vector<uint64_t> storage, size_t size, size_t corrupt_at, const char* what) {
+    if (corrupt_at < size) {
+        reinterpret_cast<char*>(storage.data())[corrupt_at] ^= 0x7F;
+    }
+    JapaneseDictionary dictionary;
+    std::string error;
+    if (dictionary.open_buffer(reinterpret_cast<const char*>(storage.data()), size, error) == 0) {
+        printf("FAIL %s dictionary was accepted\n", what);
+        failures++;
+    }
+}
+
+static int run_checks() {
+    TestDictionaryBuilder builder;
+    builder.add_word(u"東京", 100);
+    builder.add_word(u"京都", 200);
+    builder.add_word(u"東", 300);
+    builder.add_word(u"京", 300);
+    builder.add_word(u"都", 300);
+    builder.add_word(u"関西国際空港", 1000);
+    builder.add_word(u"関西", 1000);
+    builder.add_word(u"国際", 1000);
+    builder.add_word(u"空港", 1000);
+    builder.add_word(u"食べ", 500, "食べる");
+    builder.add_word(u"た", 100);
+    builder.add_word(u"の", 100);
+    builder.add_word(u"は", 100, nullptr, JapaneseDictionary::ENTRY_STOP_TAG);
+    builder.add_word(u"寿司", 500);
+    builder.add_word(u"を", 100);
+    builder.add_stopword("た");
+    builder.add_stopword("の");
+
+    std::vector<uint64_t> storage;
+    builder.build(storage);
+    const char* data = reinterpret_cast<const char*>(storage.data());
+    size_t size = storage.size() * 8;
+
+    JapaneseDictionary dictionary;
+    std::string error;
+    if (dictionary.open_buffer(data, size, error) != 0) {
+        printf("FAIL test dictionary rejected: %s\n", error.c_str());
+        return 1;
+    }
+    if (dictionary.entry_count() != 15) {
+        printf("FAIL entry count %u (expected 15)\n", dictionary.entry_count());
+        failures++;
+    }
+
+    // Corrupt or truncated files are rejected on open, never read out of bounds later
+    check_rejected(storage, size, 0, "bad magic");
+    check_rejected(storage, sizeof(JapaneseDictionaryHeader) + 8, size, "truncated");
+    check_rejected(storage, size, offsetof(JapaneseDictionaryHeader, node_count) + 3, "corrupt node count");
+    check_rejected(storage, size, offsetof(JapaneseDictionaryHeader, unknown_count) + 3, "corrupt unknown table");
+
+    JapaneseTokenizerOptions search;
+    JapaneseTokenizer tokenizer(dictionary, search);
+
+    // Least cost path over known words
+    check(tokenizer, "", "");
+    check(tokenizer, "東京都", "東京|都");
+    check(tokenizer, "京都", "京都");
+
+    // Unknown words: grouped by class, fullwidth folded, lower-cased
+    check(tokenizer, "東京でOceanBaseを", "東京|で|oceanbase|を");
+    check(tokenizer, "ＯｃｅａｎＢａｓｅ１２３", "oceanbase|123");
+    check(tokenizer, "ﾃﾞｰﾀﾍﾞｰｽ テスト", "データベース|テスト");
+    check(tokenizer, "ﾊﾟﾝ ｳﾞ", "パン|ヴ");
+
+    // Search mode splits the compound, normal mode keeps it
+    check(tokenizer, "関西国際空港", "関西|国際|空港");
+    JapaneseTokenizerOptions compounds;
+    compounds.output_compounds = true;
+    check(JapaneseTokenizer(dictionary, compounds), "関西国際空港", "関西国際空港|関西|国際|空港");
+    JapaneseTokenizerOptions normal;
+    normal.search_mode = false;
+    check(JapaneseTokenizer(dictionary, normal), "関西国際空港", "関西国際空港");
+
+    // Base form, part-of-speech stop tag, stopwords
+    check(tokenizer, "寿司を食べた", "寿司|を|食べる");
+    check(tokenizer, "東京は京都の", "東京|京都");
+
+    // Punctuation is discarded unless asked to keep it
+    check(tokenizer, "東京、京都。 !", "東京|京都");
+    JapaneseTokenizerOptions punctuation;
+    punctuation.discard_punctuation = false;
+    check(JapaneseTokenizer(dictionary, punctuation), "東京、京都", "東京|、|京都");
+
+    // Invalid UTF-8 and supplementary characters
+    check(tokenizer, "東京\xFF\xFE京都", "東京|\xEF\xBF\xBD\xEF\xBF\xBD|京都");
+    check(tokenizer, "\xF0\xA0\xAE\xB7野家", "\xF0\xA0\xAE\xB7|野|家");
+
+    // Long documents are emitted piecewise every time the paths converge
+    std::string text;
+    std::string expected;
+    for (int i = 0; i < 2000; ++i) {
+        text += "東京都、";
+        expected += i > 0 ? "|東京|都" : "東京|都";
+    }
+    check(tokenizer, text, expected);
+
+    // The chunk cache cuts only where no path of the lattice crosses: the
+    // tokens of the chunks are those of the whole document, in every mode
+    std::string document;
+    for (int i = 0; i < 200; ++i) {
+        document += "東京都は京都の寿司を食べた。関西国際空港から東京へ！「本当か？」と聞いた。"
+                    "OceanBaseはﾃﾞｰﾀﾍﾞｰｽです。 東京、京都。\n";
+        document += i % 3 == 0 ? "ＯｃｅａｎＢａｓｅ１２３。テスト！東京\n" : "関西国際空港。　寿司を食べた\n";
+    }
+    check_chunked(tokenizer, document);
+    check_chunked(JapaneseTokenizer(dictionary, compounds), document);
+    check_chunked(JapaneseTokenizer(dictionary, normal), document);
+    check_chunked(JapaneseTokenizer(dictionary, punctuation), document);
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All Japanese tokenizer checks passed\n");
+    return 0;
+}
+
+// Compare with Lucene: reference.txt holds the tab-separated JapaneseSegmenter tokens of each corpus line
+static int run_compare(const char* dictionary_path, const char* corpus_path, const char* reference_path) {
+    JapaneseDictionary dictionary;
+    std::string error;
+    if (dictionary.open(dictionary_path, error) != 0) {
+        printf("Failed to open dictionary: %s\n", error.c_str());
+        return 1;
+    }
+    printf("Dictionary: %u words, %zu bytes\n", dictionary.entry_count(), dictionary.size());
+    JapaneseTokenizer tokenizer(dictionary, JapaneseTokenizerOptions());
+
+    std::ifstream corpus(corpus_path);
+    std::ifstream reference(reference_path);
+    if (!corpus || !reference) {
+        printf("Failed to open %s or %s\n", corpus_path, reference_path);
+        return 1;
+    }
+
+    size_t lines = 0;
+    size_t matched = 0;
+    size_t shown = 0;
+    size_t bytes = 0;
+    double seconds = 0;
+    std::string text;
+    std::string expected;
+    while (std::getline(corpus, text) && std::getline(reference, expected)) {
+        lines++;
+        bytes += text.size();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::string actual = segment(tokenizer, text, "\t");
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (actual == expected) {
+            matched++;
+        } else if (shown++ < 10) {
+            printf("DIFF line %zu\n  lucene: %s\n  native: %s\n", lines, expected.c_str(), actual.c_str());
+        }
+    }
+    printf("Lines identical to Lucene: %zu / %zu (%.2f%%)\n", matched, lines,
+           lines > 0 ? 100.0 * matched / lines : 100.0);
+    printf("Native throughput: %.2f MB/s\n", seconds > 0 ? bytes / seconds / 1e6 : 0.0);
+
+    // The corpus as one document: segmented in the chunks of the chunk cache, the tokens must not change
+    std::ifstream again(corpus_path);
+    std::string document;
+    while (std::getline(again, text)) {
+        document += text + "\n";
+    }
+    size_t chunks = 0;
+    std::string whole = segment(tokenizer, document, "\t");
+    std::string chunked = segment_chunked(tokenizer, document, "\t", &chunks);
+    bool chunks_match = chunked == whole;
+    printf("Corpus in %zu chunks: %s\n", chunks,
+           chunks_match ? "tokens identical to the whole document" : first_difference(whole, chunked, '\t').c_str());
+    return matched == lines && chunks_match ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 5 && strcmp(argv[1], "--compare") == 0) {
+        return run_compare(argv[2], argv[3], argv[4]);
+    }
+    return run_checks();
+}
@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * JVM option profile tests
+ *
+ * Checks the options of each OCEANBASE_JNI_JVM_PROFILE, the splitting of
+ * OCEANBASE_JNI_EXTRA_OPTS, and that extra options come last and replace
+ * the profile's garbage collector.
+ * Usage: jvm_options_test
+ */
+
+#include "jvm_options.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using oceanbase::jni::JVMOptions;
+using oceanbase::jni::JNI_JVM_PROFILE_DEFAULT;
+using oceanbase::jni::JNI_JVM_PROFILE_LOW_LATENCY;
+using oceanbase::jni::JNI_JVM_PROFILE_SMALL_FOOTPRINT;
+using oceanbase::jni::JNI_JVM_PROFILE_THROUGHPUT;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                  \
+    do {                                                             \
+        if (!(cond)) {                                               \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);  \
+            failures++;                                              \
+        }                                                            \
+    } while (0)
+
+static bool contains(const std::vector<std::string>& options, const std::string& option) {
+    return std::find(options.begin(), options.end(), option) != options.end();
+}
+
+static size_t gc_count(const std::vector<std::string>& options) {
+    return static_cast<size_t>(std::count_if(options.begin(), options.end(), JVMOptions::is_gc_selector));
+}
+
+static void check_profiles() {
+    CHECK(JVMOptions::parse_profile("low-latency", JNI_JVM_PROFILE_DEFAULT) == JNI_JVM_PROFILE_LOW_LATENCY);
+    CHECK(JVMOptions::parse_profile("Throughput", JNI_JVM_PROFILE_DEFAULT) == JNI_JVM_PROFILE_THROUGHPUT);
+    CHECK(JVMOptions::parse_profile("small-footprint", JNI_JVM_PROFILE_DEFAULT) == JNI_JVM_PROFILE_SMALL_FOOTPRINT);
+    CHECK(JVMOptions::parse_profile("fast", JNI_JVM_PROFILE_DEFAULT) == JNI_JVM_PROFILE_DEFAULT);
+    CHECK(JVMOptions::parse_profile(nullptr, JNI_JVM_PROFILE_THROUGHPUT) == JNI_JVM_PROFILE_THROUGHPUT);
+    CHECK(std::string(JVMOptions::profile_name(JNI_JVM_PROFILE_SMALL_FOOTPRINT)) == "small-footprint");
+    CHECK(std::string(JVMOptions::profile_name(-1)) == "default");
+
+    // Every profile selects exactly one collector
+    for (int profile = JNI_JVM_PROFILE_DEFAULT; profile <= JNI_JVM_PROFILE_SMALL_FOOTPRINT; ++profile) {
+        std::vector<std::string> options;
+        JVMOptions::profile_options(profile, options);
+        CHECK(gc_count(options) == 1);
+    }
+
+    std::vector<std::string> options;
+    JVMOptions::profile_options(JNI_JVM_PROFILE_DEFAULT, options);
+    CHECK(options.size() == 1 && options[0] == "-XX:+UseG1GC");
+    options.clear();
+    JVMOptions::profile_options(JNI_JVM_PROFILE_LOW_LATENCY, options);
+    CHECK(contains(options, "-XX:+AlwaysPreTouch") && contains(options, "-XX:MaxGCPauseMillis=20"));
+    options.clear();
+    JVMOptions::profile_options(JNI_JVM_PROFILE_THROUGHPUT, options);
+    CHECK(contains(options, "-XX:+UseParallelGC"));
+    options.clear();
+    JVMOptions::profile_options(JNI_JVM_PROFILE_SMALL_FOOTPRINT, options);
+    CHECK(contains(options, "-XX:+UseSerialGC") && contains(options, "-XX:MaxMetaspaceSize=64m")
+          && contains(options, "-Xss256k"));
+}
+
+static void check_extra_options() {
+    std::vector<std::string> options;
+    JVMOptions::split_extra_options("", options);
+    JVMOptions::split_extra_options("   \t ", options);
+    CHECK(options.empty());
+
+    JVMOptions::split_extra_options("  -XX:+UseZGC\t-Dname=\"two words\" '-Dempty=' -Xlog:gc*:file=/tmp/gc.log  ",
+                                    options);
+    CHECK(options.size() == 4);
+    CHECK(options.size() == 4 && options[0] == "-XX:+UseZGC" && options[1] == "-Dname=two words"
+          && options[2] == "-Dempty=" && options[3] == "-Xlog:gc*:file=/tmp/gc.log");
+
+    options.clear();
+    JVMOptions::split_extra_options("\"\"", options);
+    CHECK(options.size() == 1 && options[0].empty());
+
+    CHECK(JVMOptions::is_gc_selector("-XX:+UseShenandoahGC"));
+    CHECK(!JVMOptions::is_gc_selector("-XX:+UseStringDeduplication"));
+    CHECK(!JVMOptions::is_gc_selector("-XX:-UseG1GC"));
+    CHECK(!JVMOptions::is_gc_selector("-XX:+UseGC"));
+}
+
+static void check_build() {
+    std::vector<std::string> options;
+    std::vector<std::string> extra;
+    JVMOptions::build("/opt/lib/a.jar:/opt/lib/b.jar", 512, 128, "warn", 10, JNI_JVM_PROFILE_DEFAULT, extra, options);
+    CHECK(options.size() == 7);
+    CHECK(options.size() == 7 && options[0] == "-Djava.class.path=/opt/lib/a.jar:/opt/lib/b.jar"
+          && options[1] == "-Xmx512m" && options[2] == "-Xms128m" && options[3] == "-Dfile.encoding=UTF-8"
+          && options[4] == "-Doceanbase.jni.log.level=warn" && options[5] == "-Doceanbase.jni.log.rate_limit=10"
+          && options[6] == "-XX:+UseG1GC");
+
+    // Extra options come last, an extra collector replaces the profile's
+    JVMOptions::split_extra_options("-XX:+UseZGC -XX:MaxMetaspaceSize=128m", extra);
+    JVMOptions::build("a.jar", 256, 64, "warn", 0, JNI_JVM_PROFILE_SMALL_FOOTPRINT, extra, options);
+    CHECK(gc_count(options) == 1 && contains(options, "-XX:+UseZGC") && !contains(options, "-XX:+UseSerialGC"));
+    CHECK(contains(options, "-Xss256k"));
+    CHECK(options.size() >= 2 && options[options.size() - 2] == "-XX:+UseZGC"
+          && options.back() == "-XX:MaxMetaspaceSize=128m");
+
+    // Without an extra collector the profile keeps its own
+    extra.clear();
+    JVMOptions::split_extra_options("-XX:ParallelGCThreads=4", extra);
+    JVMOptions::build("a.jar", 256, 64, "warn", 0, JNI_JVM_PROFILE_THROUGHPUT, extra, options);
+    CHECK(contains(options, "-XX:+UseParallelGC") && options.back() == "-XX:ParallelGCThreads=4");
+}
+
+int main() {
+    check_profiles();
+    check_extra_options();
+    check_build();
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All JVM option checks passed\n");
+    return 0;
+}
@@ -0,0 +1,458 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Native Korean tokenizer tests
+ *
+ * Builds a small dictionary file in memory and checks the lattice, the
+ * space penalty, unknown words grouped by script and the three decompound
+ * modes, and why a document segmented in the sentence chunks of the chunk
+ * cache does not give the tokens of the whole document. Optionally compares
+ * the tokenizer with Lucene tokens on a reference corpus using a dictionary
+ * exported by NoriDictionaryExport, and reports whether the chunked tokens
+ * of the corpus text differ from its whole-document tokens.
+ * Usage: korean_tokenizer_test
+ *        korean_tokenizer_test --compare <dictionary.dic> <corpus.txt> <reference.txt>
+ */
+
+#include "content_chunker.h"
+#include "korean_dictionary.h"
+#include "korean_tokenizer.h"
+#include "packed_token_buffer.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+using oceanbase::jni::ContentChunker;
+using oceanbase::jni::PackedTokenBuffer;
+using oceanbase::jni::TextSpan;
+using oceanbase::korean_ftparser::KoreanDictionary;
+using oceanbase::korean_ftparser::KoreanDictionaryHeader;
+using oceanbase::korean_ftparser::KoreanTokenizer;
+using oceanbase::korean_ftparser::KoreanTokenizerOptions;
+using oceanbase::korean_ftparser::KoreanTrieNode;
+using oceanbase::korean_ftparser::KoreanWordEntry;
+
+static int failures = 0;
+
+// Character classes of the test dictionary (a subset of mecab-ko-dic char.def)
+enum TestCharClass { DEFAULT = 0, SPACE, HANGUL, HANJA, ALPHA, NUMERIC, SYMBOL, CLASS_COUNT };
+
+// Script codes of the test dictionary (0 is Common and Inherited)
+enum TestScript { COMMON = 0, LATIN, HANGUL_SCRIPT, HAN };
+
+/**
+ * Writes the dictionary file format of korean_dictionary.h, as NoriDictionaryExport does
+ */
+class TestDictionaryBuilder {
+public:
+    TestDictionaryBuilder() {
+        for (int c = 0; c < CLASS_COUNT; ++c) {
+            KoreanWordEntry entry = {1, 1, 2000, KoreanDictionary::TYPE_MORPHEME, 0, KoreanDictionary::NO_MORPHEMES};
+            unknown_[c].push_back(entry);
+        }
+    }
+
+    /**
+     * @param parts Morpheme surfaces separated by '+', for compound, inflected and pre-analyzed words
+     */
+    void add_word(const std::u16string& surface, int16_t cost, uint8_t type = KoreanDictionary::TYPE_MORPHEME,
+                  const char* parts = nullptr, uint8_t flags = 0) {
+        KoreanWordEntry entry = {1, 1, cost, type, flags, KoreanDictionary::NO_MORPHEMES};
+        if (parts) {
+            std::vector<std::string> split(1);
+            for (const char* p = parts; *p; ++p) {
+                if (*p == '+') {
+                    split.push_back(std::string());
+                } else {
+                    split.back() += *p;
+                }
+            }
+            entry.morphemes = static_cast<uint32_t>(morphemes_.size());
+            morphemes_.push_back(static_cast<uint32_t>(split.size()));
+            for (size_t i = 0; i < split.size(); ++i) {
+                morphemes_.push_back(add_string(split[i]));
+            }
+        }
+        words_[surface].push_back(entry);
+    }
+
+    void build(std::vector<uint64_t>& storage) {
+        nodes_.clear();
+        labels_.clear();
+        targets_.clear();
+        entries_.clear();
+        std::vector<std::pair<std::u16string, std::vector<KoreanWordEntry> > > sorted(words_.begin(), words_.end());
+        build_node(sorted, 0, sorted.size(), 0);
+
+        KoreanDictionaryHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "OBKODIC", 8);
+        header.version = KoreanDictionary::FORMAT_VERSION;
+        header.header_size = sizeof(header);
+        header.left_size = 2;
+        header.right_size = 2;
+        header.node_count = static_cast<uint32_t>(nodes_.size());
+        header.edge_count = static_cast<uint32_t>(labels_.size());
+        header.entry_count = static_cast<uint32_t>(entries_.size());
+        header.morpheme_words = static_cast<uint32_t>(morphemes_.size());
+        header.string_bytes = static_cast<uint32_t>(strings_.size());
+        std::vector<KoreanWordEntry> unknown;
+        for (int c = 0; c < CLASS_COUNT; ++c) {
+            header.unknown_first[c] = static_cast<uint32_t>(unknown.size());
+            header.unknown_count[c] = static_cast<uint32_t>(unknown_[c].size());
+            unknown.insert(unknown.end(), unknown_[c].begin(), unknown_[c].end());
+        }
+        header.unknown_entry_count = static_cast<uint32_t>(unknown.size());
+
+        // No connection costs: the word costs and the space penalty alone decide the tests
+        std::vector<int16_t> costs(header.left_size * header.right_size, 0);
+        std::vector<uint16_t> char_info(65536);
+        std::vector<uint8_t> scripts(65536);
+        std::vector<uint16_t> lower(65536);
+        for (uint32_t c = 0; c < 65536; ++c) {
+            classify(static_cast<uint16_t>(c), char_info[c], scripts[c]);
+            lower[c] = static_cast<uint16_t>(c >= 'A' && c <= 'Z' ? c + 32 : c);
+        }
+
+        std::string file(reinterpret_cast<const char*>(&header), sizeof(header));
+        header.costs_offset = append(file, costs.data(), costs.size() * 2);
+        header.char_info_offset = append(file, char_info.data(), char_info.size() * 2);
+        header.script_offset = append(file, scripts.data(), scripts.size());
+        header.lower_offset = append(file, lower.data(), lower.size() * 2);
+        header.nodes_offset = append(file, nodes_.data(), nodes_.size() * sizeof(KoreanTrieNode));
+        header.edge_labels_offset = append(file, labels_.data(), labels_.size() * 2);
+        header.edge_targets_offset = append(file, targets_.data(), targets_.size() * 4);
+        header.entries_offset = append(file, entries_.data(), entries_.size() * sizeof(KoreanWordEntry));
+        header.unknown_entries_offset = append(file, unknown.data(), unknown.size() * sizeof(KoreanWordEntry));
+        header.morphemes_offset = append(file, morphemes_.data(), morphemes_.size() * 4);
+        header.strings_offset = append(file, strings_.data(), strings_.size());
+        memcpy(&file[0], &header, sizeof(header));
+
+        // uint64_t storage keeps the buffer 8-byte aligned, as a mapping is
+        storage.assign((file.size() + 7) / 8, 0);
+        memcpy(storage.data(), file.data(), file.size());
+    }
+
+private:
+    std::map<std::u16string, std::vector<KoreanWordEntry> > words_;
+    std::vector<KoreanWordEntry> unknown_[CLASS_COUNT];
+    std::vector<uint32_t> morphemes_;
+    std::string strings_;
+    std::vector<KoreanTrieNode> nodes_;
+    std::vector<uint16_t> labels_;
+    std::vector<uint32_t> targets_;
+    std::vector<KoreanWordEntry> entries_;
+
+    uint32_t add_string(const std::string& value) {
+        uint32_t offset = static_cast<uint32_t>(strings_.size());
+        uint16_t length = static_cast<uint16_t>(value.size());
+        strings_.append(reinterpret_cast<const char*>(&length), 2);
+        strings_.append(value);
+        return offset;
+    }
+
+    static uint64_t append(std::string& file, const void* data, size_t size) {
+        file.resize((file.size() + 7) / 8 * 8, '\0');
+        uint64_t offset = file.size();
+        file.append(static_cast<const char*>(data), size);
+        return offset;
+    }
+
+    // mecab-ko-dic-like classes: all but HANJA group, ALPHA, NUMERIC and SYMBOL invoke
+    static void classify(uint16_t c, uint16_t& info, uint8_t& script) {
+        info = KoreanDictionary::CHAR_GROUP;
+        script = COMMON;
+        if (c == ' ' || c == 0x3000) {
+            info |= SPACE | KoreanDictionary::CHAR_SPACE | KoreanDictionary::CHAR_PUNCTUATION;
+        } else if (c >= 0xAC00 && c <= 0xD7A3) {
+            info |= HANGUL;
+            script = HANGUL_SCRIPT;
+        } else if (c >= 0x4E00 && c <= 0x9FFF) {
+            info = HANJA;
+            script = HAN;
+        } else if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+            info |= ALPHA | KoreanDictionary::CHAR_INVOKE;
+            script = LATIN;
+        } else if (c >= '0' && c <= '9') {
+            info |= NUMERIC | KoreanDictionary::CHAR_INVOKE | KoreanDictionary::CHAR_DIGIT;
+        } else if (c >= 0x0300 && c <= 0x036F) {
+            info |= KoreanDictionary::CHAR_NON_SPACING_MARK;
+        } else if (c < 0x80 || c == 0xFFFD || c == 0x318D) {
+            info |= SYMBOL | KoreanDictionary::CHAR_INVOKE | KoreanDictionary::CHAR_PUNCTUATION;
+        }
+    }
+
+    uint32_t build_node(const std::vector<std::pair<std::u16string, std::vector<KoreanWordEntry> > >& words,
+                        size_t from, size_t to, size_t depth) {
+        uint32_t index = static_cast<uint32_t>(nodes_.size());
+        KoreanTrieNode node = {0, 0, 0, 0};
+        nodes_.push_back(node);
+        if (from < to && words[from].first.size() == depth) {
+            nodes_[index].first_entry = static_cast<uint32_t>(entries_.size());
+            nodes_[index].entry_count = static_cast<uint32_t>(words[from].second.size());
+            entries_.insert(entries_.end(), words[from].second.begin(), words[from].second.end());
+            ++from;
+        }
+        std::vector<size_t> starts;
+        for (size_t i = from; i < to; ++i) {
+            if (i == from || words[i].first[depth] != words[i - 1].first[depth]) {
+                starts.push_back(i);
+            }
+        }
+        starts.push_back(to);
+        uint32_t first_edge = static_cast<uint32_t>(labels_.size());
+        nodes_[index].first_edge = first_edge;
+        nodes_[index].edge_count = static_cast<uint32_t>(starts.size() - 1);
+        for (size_t g = 0; g + 1 < starts.size(); ++g) {
+            labels_.push_back(words[starts[g]].first[depth]);
+            targets_.push_back(0);
+        }
+        for (size_t g = 0; g + 1 < starts.size(); ++g) {
+            uint32_t child = build_node(words, starts[g], starts[g + 1], depth + 1);
+            targets_[first_edge + g] = child;
+        }
+        return index;
+    }
+};
+
+static std::string join(const std::vector<std::string>& tokens, const char* separator) {
+    std::string joined;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        joined += (i > 0 ? separator : "") + tokens[i];
+    }
+    return joined;
+}
+
+static std::string segment(const KoreanTokenizer& tokenizer, const std::string& text, const char* separator) {
+    PackedTokenBuffer packed;
+    std::vector<std::string> tokens;
+    if (tokenizer.segment(text.data(), text.size(), packed) != 0) {
+        return "<allocation failed>";
+    }
+    packed.to_vector(tokens);
+    return join(tokens, separator);
+}
+
+static void check(const KoreanTokenizer& tokenizer, const std::string& text, const std::string& expected) {
+    std::string tokens = segment(tokenizer, text, "|");
+    if (tokens != expected) {
+        printf("FAIL \"%s\": \"%s\" (expected \"%s\")\n", text.c_str(), tokens.c_str(), expected.c_str());
+        failures++;
+    }
+}
+
+// Tokens of a document segmented chunk by chunk, cut at every sentence boundary of the chunk cache
+static std::string segment_chunked(const KoreanTokenizer& tokenizer, const std::string& text,
+                                   const char* separator, size_t* chunk_count) {
+    ContentChunker::Options every;
+    every.min_chunk_bytes = 0;
+    every.boundary_mask = 0;
+    ContentChunker chunker(every);
+    std::vector<TextSpan> chunks;
+    chunker.split(text.data(), text.size(), chunks);
+    *chunk_count = chunks.size();
+    PackedTokenBuffer joined;
+    for (const TextSpan& chunk : chunks) {
+        PackedTokenBuffer part;
+        if (tokenizer.segment(chunk.data, chunk.length, part) != 0 ||
+            joined.append_packed(part.data(), part.size()) != 0) {
+            return "<allocation failed>";
+        }
+    }
+    std::vector<std::string> tokens;
+    joined.to_vector(tokens);
+    return join(tokens, separator);
+}
+
+// Up to eight tokens of a joined token list
+static std::string tokens_from(const std::string& joined, size_t from, char separator) {
+    size_t end = from;
+    for (int i = 0; i < 8 && end != std::string::npos; ++i) {
+        end = joined.find(separator, end + 1);
+    }
+    return joined.substr(from, end == std::string::npos ? std::string::npos : end - from);
+}
+
+// The first differing token of two joined token lists, with the tokens before it
+static std::string first_difference(const std::string& whole, const std::string& chunked, char separator) {
+    size_t at = 0;
+    size_t token_start = 0;
+    size_t previous_start = 0;
+    while (at < whole.size() && at < chunked.size() && whole[at] == chunked[at]) {
+        if (whole[at] == separator) {
+            previous_start = token_start;
+            token_start = at + 1;
+        }
+        ++at;
+    }
+    return "whole \"" + tokens_from(whole, previous_start, separator) + "\", chunked \"" +
+           tokens_from(chunked, previous_start, separator) + "\"";
+}
+
+static void check_rejected(std::vector<uint64_t> storage, size_t size, size_t corrupt_at, const char* what) {
+    if (corrupt_at < size) {
+        reinterpret_cast<char*>(storage.data())[corrupt_at] ^= 0x7F;
+    }
+    KoreanDictionary dictionary;
+    std::string error;
+    if (dictionary.open_buffer(reinterpret_cast<const char*>(storage.data()), size, error) == 0) {
+        printf("FAIL %s dictionary was accepted\n", what);
+        failures++;
+    }
+}
+
+static int run_checks() {
+    TestDictionaryBuilder builder;
+    builder.add_word(u"사과", 1000);
+    builder.add_word(u"은행", 2500);
+    builder.add_word(u"은", 100, KoreanDictionary::TYPE_MORPHEME, nullptr, KoreanDictionary::ENTRY_SPACE_PENALTY);
+    builder.add_word(u"행", 100);
+    builder.add_word(u"가곡역", 500, KoreanDictionary::TYPE_COMPOUND, "가곡+역");
+    builder.add_word(u"가곡", 1000);
+    builder.add_word(u"해", 500, KoreanDictionary::TYPE_INFLECT, "하+아");
+    builder.add_word(u"Db", 500, KoreanDictionary::TYPE_PREANALYSIS, "DATA+Base");
+
+    std::vector<uint64_t> storage;
+    builder.build(storage);
+    const char* data = reinterpret_cast<const char*>(storage.data());
+    size_t size = storage.size() * 8;
+
+    KoreanDictionary dictionary;
+    std::string error;
+    if (dictionary.open_buffer(data, size, error) != 0) {
+        printf("FAIL test dictionary rejected: %s\n", error.c_str());
+        return 1;
+    }
+    if (dictionary.entry_count() != 8) {
+        printf("FAIL entry count %u (expected 8)\n", dictionary.entry_count());
+        failures++;
+    }
+
+    // Corrupt or truncated files are rejected on open, never read out of bounds later
+    check_rejected(storage, size, 0, "bad magic");
+    check_rejected(storage, sizeof(KoreanDictionaryHeader) + 8, size, "truncated");
+    check_rejected(storage, size, offsetof(KoreanDictionaryHeader, node_count) + 3, "corrupt node count");
+    check_rejected(storage, size, offsetof(KoreanDictionaryHeader, morpheme_words), "corrupt morpheme table");
+
+    KoreanTokenizerOptions mixed;
+    KoreanTokenizer tokenizer(dictionary, mixed);
+
+    // Least cost path; a dependent morpheme after a space pays the space penalty
+    check(tokenizer, "", "");
+    check(tokenizer, "사과은행", "사과|은|행");
+    check(tokenizer, "사과 은행", "사과|은행");
+
+    // Decompound modes: MIXED (KoreanSegmenter), DISCARD, NONE
+    check(tokenizer, "가곡역 해 Db", "가곡역|가곡|역|해|하|아|db|data|base");
+    KoreanTokenizerOptions discard;
+    discard.decompound_mode = oceanbase::korean_ftparser::DECOMPOUND_DISCARD;
+    check(KoreanTokenizer(dictionary, discard), "가곡역 해 Db", "가곡|역|하|아|data|base");
+    KoreanTokenizerOptions none;
+    none.decompound_mode = oceanbase::korean_ftparser::DECOMPOUND_NONE;
+    check(KoreanTokenizer(dictionary, none), "가곡역 해 Db", "가곡역|해|db");
+
+    // Unknown words split on script, punctuation and digits; marks and Common characters join
+    check(tokenizer, "OceanBase데이터베이스", "oceanbase|데이터베이스");
+    check(tokenizer, "abc123 3.14", "abc|123|3|14");
+    check(tokenizer, "cafe\xCC\x81 韓國語", "cafe\xCC\x81|韓|國|語");
+
+    // Punctuation, spaces, control characters and invalid bytes are discarded; a space inside a
+    // punctuation run is not a word boundary, so no space penalty applies after ", "
+    check(tokenizer, "사과, 은행!\n\t\xE3\x80\x80사과\xE3\x86\x8D\xFF사과", "사과|은|행|사과|사과");
+    KoreanTokenizerOptions punctuation;
+    punctuation.discard_punctuation = false;
+    check(KoreanTokenizer(dictionary, punctuation), "사과,은행", "사과|,|은|행");
+
+    // Long documents are emitted piecewise every time the paths converge
+    std::string text;
+    std::string expected;
+    for (int i = 0; i < 2000; ++i) {
+        text += "사과은행. ";
+        expected += i > 0 ? "|사과|은|행" : "사과|은|행";
+    }
+    check(tokenizer, text, expected);
+
+    // The chunk cache's cuts are not safe for Nori: a space ending a
+    // punctuation run is no word boundary, but a chunk starting at that space
+    // pays the space penalty. korean_ftparser segments long documents whole
+    size_t chunks = 0;
+    check(tokenizer, "사과은행. 은행", "사과|은|행|은|행");
+    if (segment_chunked(tokenizer, "사과은행. 은행", "|", &chunks) != "사과|은|행|은행" || chunks != 2) {
+        printf("FAIL chunked document: expected the space penalty at the start of the second chunk\n");
+        failures++;
+    }
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All Korean tokenizer checks passed\n");
+    return 0;
+}
+
+// Compare with Lucene: reference.txt holds the tab-separated KoreanSegmenter tokens of each corpus line
+static int run_compare(const char* dictionary_path, const char* corpus_path, const char* reference_path) {
+    KoreanDictionary dictionary;
+    std::string error;
+    if (dictionary.open(dictionary_path, error) != 0) {
+        printf("Failed to open dictionary: %s\n", error.c_str());
+        return 1;
+    }
+    printf("Dictionary: %u words, %zu bytes\n", dictionary.entry_count(), dictionary.size());
+    KoreanTokenizer tokenizer(dictionary, KoreanTokenizerOptions());
+
+    std::ifstream corpus(corpus_path);
+    std::ifstream reference(reference_path);
+    if (!corpus || !reference) {
+        printf("Failed to open %s or %s\n", corpus_path, reference_path);
+        return 1;
+    }
+
+    size_t lines = 0;
+    size_t matched = 0;
+    size_t shown = 0;
+    size_t bytes = 0;
+    double seconds = 0;
+    std::string text;
+    std::string expected;
+    while (std::getline(corpus, text) && std::getline(reference, expected)) {
+        lines++;
+        bytes += text.size();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::string actual = segment(tokenizer, text, "\t");
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (actual == expected) {
+            matched++;
+        } else if (shown++ < 10) {
+            printf("DIFF line %zu\n  lucene: %s\n  native: %s\n", lines, expected.c_str(), actual.c_str());
+        }
+    }
+    printf("Lines identical to Lucene: %zu / %zu (%.2f%%)\n", matched, lines,
+           lines > 0 ? 100.0 * matched / lines : 100.0);
+    printf("Native throughput: %.2f MB/s\n", seconds > 0 ? bytes / seconds / 1e6 : 0.0);
+
+    // The corpus as one document, segmented in the chunks of the chunk cache (reported only, see run_checks)
+    std::ifstream again(corpus_path);
+    std::string document;
+    while (std::getline(again, text)) {
+        document += text + "\n";
+    }
+    size_t chunks = 0;
+    std::string whole = segment(tokenizer, document, "\t");
+    std::string chunked = segment_chunked(tokenizer, document, "\t", &chunks);
+    bool chunks_match = chunked == whole;
+    printf("Corpus in %zu chunks: %s\n", chunks,
+           chunks_match ? "tokens identical to the whole document" : first_difference(whole, chunked, '\t').c_str());
+    return matched == lines ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 5 && strcmp(argv[1], "--compare") == 0) {
+        return run_compare(argv[2], argv[3], argv[4]);
+    }
+    return run_checks();
+}
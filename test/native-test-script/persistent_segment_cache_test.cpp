@@ -0,0 +1,281 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Persistent segment cache tests
+ *
+ * Checks that records survive closing and reopening, that a file written
+ * under another configuration is emptied, the size bound, that a torn
+ * or corrupt tail is cut off on open while every record before it is kept,
+ * and that concurrent appends and lookups keep the file consistent.
+ * Usage: persistent_segment_cache_test [directory]
+ */
+
+#include "persistent_segment_cache.h"
+#include "packed_token_buffer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using oceanbase::jni::PackedTokenBuffer;
+using oceanbase::jni::PersistentSegmentCache;
+using oceanbase::jni::PersistentSegmentCacheStats;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                  \
+    do {                                                             \
+        if (!(cond)) {                                               \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);  \
+            failures++;                                              \
+        }                                                            \
+    } while (0)
+
+static const uint64_t CONFIG = 0x1234;
+static const size_t CAPACITY = 1 << 20;
+
+// Stand-in segmenter: the space-separated words of the document, bracketed
+static void fake_segment(const std::string& text, PackedTokenBuffer& tokens) {
+    tokens.clear();
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(' ', pos);
+        end = end == std::string::npos ? text.size() : end;
+        std::string word = "<" + text.substr(pos, end - pos) + ">";
+        tokens.append(word.data(), word.size());
+        pos = end + 1;
+    }
+}
+
+static std::string tokens_of(PackedTokenBuffer& tokens) {
+    std::vector<std::string> words;
+    tokens.to_vector(words);
+    std::string joined;
+    for (size_t i = 0; i < words.size(); ++i) {
+        joined += (i > 0 ? "|" : "") + words[i];
+    }
+    return joined;
+}
+
+static std::string document(int i) {
+    return "row " + std::to_string(i) + " 東京 タワー " + std::string(i % 50, 'x');
+}
+
+static bool open_cache(PersistentSegmentCache& cache, const std::string& path, uint64_t config, size_t capacity) {
+    std::string error;
+    if (cache.open(path, config, capacity, error) != 0) {
+        printf("open %s: %s\n", path.c_str(), error.c_str());
+        return false;
+    }
+    return true;
+}
+
+static void fill(PersistentSegmentCache& cache, int count) {
+    PackedTokenBuffer tokens;
+    for (int i = 0; i < count; ++i) {
+        std::string doc = document(i);
+        fake_segment(doc, tokens);
+        cache.append(doc.data(), doc.size(), tokens);
+    }
+}
+
+// Number of the first documents 0..count-1 found, with the right tokens
+static int count_hits(PersistentSegmentCache& cache, int count) {
+    PackedTokenBuffer tokens;
+    PackedTokenBuffer expected;
+    int hits = 0;
+    for (int i = 0; i < count; ++i) {
+        std::string doc = document(i);
+        if (cache.lookup(doc.data(), doc.size(), tokens)) {
+            fake_segment(doc, expected);
+            CHECK(tokens_of(tokens) == tokens_of(expected));
+            hits++;
+        }
+    }
+    return hits;
+}
+
+static off_t file_size(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+static void check_reopen(const std::string& path) {
+    PersistentSegmentCache cache;
+    CHECK(open_cache(cache, path, CONFIG, CAPACITY));
+    CHECK(count_hits(cache, 10) == 0);
+    fill(cache, 1000);
+    CHECK(count_hits(cache, 1000) == 1000);
+
+    // Same document twice, and empty results, are stored once
+    PackedTokenBuffer tokens;
+    std::string doc = document(3);
+    fake_segment(doc, tokens);
+    CHECK(!cache.append(doc.data(), doc.size(), tokens));
+    PackedTokenBuffer empty;
+    CHECK(cache.append("   ", 3, empty));
+    tokens.append("stale", 5);
+    CHECK(cache.lookup("   ", 3, tokens) && tokens.size() == 0);
+    CHECK(!cache.lookup("row 3", 5, tokens));
+
+    // A second user of the file is refused while it is open
+    PersistentSegmentCache other;
+    std::string error;
+    CHECK(other.open(path, CONFIG, CAPACITY, error) != 0);
+
+    PersistentSegmentCacheStats stats = cache.stats();
+    CHECK(stats.records == 1001);
+    CHECK(stats.appends == 1001);
+    CHECK(stats.bytes == static_cast<uint64_t>(file_size(path)));
+    cache.close();
+
+    // Everything is found again after reopening
+    CHECK(open_cache(cache, path, CONFIG, CAPACITY));
+    CHECK(count_hits(cache, 1000) == 1000);
+    stats = cache.stats();
+    CHECK(stats.records == 1001 && stats.appends == 0 && stats.discarded_bytes == 0);
+    cache.close();
+
+    // Another analyzer configuration starts over
+    CHECK(open_cache(cache, path, CONFIG + 1, CAPACITY));
+    CHECK(count_hits(cache, 1000) == 0);
+    CHECK(cache.stats().records == 0 && cache.stats().discarded_bytes > 0);
+    cache.close();
+    CHECK(open_cache(cache, path, CONFIG, CAPACITY));
+    CHECK(count_hits(cache, 1000) == 0);
+}
+
+static void check_capacity(const std::string& path) {
+    PersistentSegmentCache cache;
+    CHECK(open_cache(cache, path, CONFIG, 16 * 1024));
+    fill(cache, 1000);
+    PersistentSegmentCacheStats stats = cache.stats();
+    CHECK(stats.rejections > 0);
+    CHECK(stats.records > 0 && stats.records < 1000);
+    CHECK(file_size(path) <= 16 * 1024);
+    int hits = count_hits(cache, 1000);
+    CHECK(hits == static_cast<int>(stats.records));
+    cache.close();
+
+    // A smaller bound keeps the records that fit under it
+    CHECK(open_cache(cache, path, CONFIG, 8 * 1024));
+    CHECK(file_size(path) <= 8 * 1024);
+    CHECK(cache.stats().discarded_bytes > 0);
+    int kept = count_hits(cache, 1000);
+    CHECK(kept > 0 && kept < hits);
+
+    std::string error;
+    PersistentSegmentCache tiny;
+    CHECK(tiny.open(path + ".tiny", CONFIG, 16, error) != 0);
+}
+
+static void check_recovery(const std::string& path) {
+    PersistentSegmentCache cache;
+    CHECK(open_cache(cache, path, CONFIG, CAPACITY));
+    fill(cache, 100);
+    off_t complete = file_size(path);
+    cache.close();
+
+    // A crash in the middle of an append: part of a record at the end
+    int fd = open(path.c_str(), O_WRONLY | O_APPEND);
+    CHECK(fd >= 0);
+    std::string partial(40, '\x7f');
+    CHECK(write(fd, partial.data(), partial.size()) == static_cast<ssize_t>(partial.size()));
+    close(fd);
+    CHECK(open_cache(cache, path, CONFIG, CAPACITY));
+    CHECK(count_hits(cache, 100) == 100);
+    CHECK(cache.stats().discarded_bytes == partial.size());
+    CHECK(file_size(path) == complete);
+
+    // Appending goes on from the cut
+    fill(cache, 150);
+    CHECK(count_hits(cache, 150) == 150);
+    cache.close();
+
+    // Zeroed pages at the end (file size updated, data lost)
+    CHECK(truncate(path.c_str(), file_size(path) + 4096) == 0);
+    CHECK(open_cache(cache, path, CONFIG, CAPACITY));
+    CHECK(count_hits(cache, 150) == 150);
+    CHECK(cache.stats().discarded_bytes == 4096);
+    cache.close();
+
+    // A flipped byte in the middle loses that record and everything after it
+    off_t middle = file_size(path) / 2;
+    fd = open(path.c_str(), O_RDWR);
+    char byte = 0;
+    CHECK(pread(fd, &byte, 1, middle) == 1);
+    byte ^= 0x20;
+    CHECK(pwrite(fd, &byte, 1, middle) == 1);
+    close(fd);
+    CHECK(open_cache(cache, path, CONFIG, CAPACITY));
+    int hits = count_hits(cache, 150);
+    CHECK(hits > 50 && hits < 100);
+    CHECK(static_cast<uint64_t>(hits) == cache.stats().records);
+
+    // Not a cache file at all
+    cache.close();
+    fd = open(path.c_str(), O_WRONLY | O_TRUNC);
+    CHECK(write(fd, "garbage", 7) == 7);
+    close(fd);
+    CHECK(open_cache(cache, path, CONFIG, CAPACITY));
+    CHECK(cache.stats().records == 0 && cache.stats().discarded_bytes == 7);
+}
+
+static void check_concurrency(const std::string& path) {
+    // Threads append overlapping ranges of documents while they look them up
+    PersistentSegmentCache cache;
+    CHECK(open_cache(cache, path, CONFIG, CAPACITY));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&cache, t]() {
+            PackedTokenBuffer tokens;
+            PackedTokenBuffer expected;
+            for (int i = t * 100; i < t * 100 + 400; ++i) {
+                std::string doc = document(i);
+                fake_segment(doc, expected);
+                if (cache.lookup(doc.data(), doc.size(), tokens)) {
+                    CHECK(tokens_of(tokens) == tokens_of(expected));
+                } else {
+                    cache.append(doc.data(), doc.size(), expected);
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    // Each document is stored once, whichever thread missed first
+    CHECK(count_hits(cache, 1100) == 1100);
+    CHECK(cache.stats().records == 1100 && cache.stats().appends == 1100);
+
+    cache.close();
+    CHECK(open_cache(cache, path, CONFIG, CAPACITY));
+    CHECK(cache.stats().discarded_bytes == 0);
+    CHECK(count_hits(cache, 1100) == 1100);
+    cache.close();
+}
+
+int main(int argc, char* argv[]) {
+    std::string dir = argc > 1 ? argv[1] : "/tmp";
+    std::string path = dir + "/persistent_segment_cache_test." + std::to_string(getpid());
+
+    check_reopen(path);
+    unlink(path.c_str());
+    check_capacity(path);
+    unlink(path.c_str());
+    check_recovery(path);
+    unlink(path.c_str());
+    check_concurrency(path);
+    unlink(path.c_str());
+    unlink((path + ".tiny").c_str());
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All persistent segment cache checks passed\n");
+    return 0;
+}
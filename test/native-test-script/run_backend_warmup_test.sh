@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# Backend Warm-up Test Script
+# Checks the background initialization started from plugin init
+
+echo "🔥 Backend Warm-up Test"
+echo ""
+
+if [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
+    echo "Usage: $0"
+    echo ""
+    echo "This script will:"
+    echo "  1. Build the test against common/liboceanbase_jni_common/backend_warmup.cpp"
+    echo "  2. Check waiting scans, the time-to-ready metric and unloading during the warm-up"
+    exit 0
+fi
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+COMMON_DIR="$SCRIPT_DIR/../../common/liboceanbase_jni_common"
+BINARY="$SCRIPT_DIR/backend_warmup_test"
+
+g++ -std=c++11 -O2 -Wall -pthread -I"$COMMON_DIR" \
+    "$SCRIPT_DIR/backend_warmup_test.cpp" "$COMMON_DIR/backend_warmup.cpp" \
+    -o "$BINARY" || exit 1
+
+"$BINARY" "$@"
+RESULT=$?
+rm -f "$BINARY"
+exit $RESULT
@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Bigram Tokenizer Test Script
+# Checks the dictionary-free bigram backend shared by all parsers
+
+echo "🔠 Bigram Tokenizer Test"
+echo ""
+
+if [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
+    echo "Usage: $0"
+    echo ""
+    echo "This script will:"
+    echo "  1. Build the test against common/liboceanbase_jni_common/bigram_tokenizer.cpp"
+    echo "  2. Check the bigrams, words and separators, and report the throughput on a mixed document"
+    exit 0
+fi
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+COMMON_DIR="$SCRIPT_DIR/../../common/liboceanbase_jni_common"
+BINARY="$SCRIPT_DIR/bigram_tokenizer_test"
+
+g++ -std=c++11 -O2 -Wall -I"$COMMON_DIR" \
+    "$SCRIPT_DIR/bigram_tokenizer_test.cpp" "$COMMON_DIR/bigram_tokenizer.cpp" \
+    "$COMMON_DIR/packed_token_buffer.cpp" "$COMMON_DIR/scan_arena.cpp" "$COMMON_DIR/utf8_kernel.cpp" \
+    -o "$BINARY" || exit 1
+
+"$BINARY" "$@"
+RESULT=$?
+rm -f "$BINARY"
+exit $RESULT
@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# Class-Data Sharing Test Script
+# Checks the AppCDS dump and use modes of the JVM options
+
+echo "📦 Class-Data Sharing Test"
+echo ""
+
+if [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
+    echo "Usage: $0 [directory]"
+    echo ""
+    echo "This script will:"
+    echo "  1. Build the test against common/liboceanbase_jni_common/class_data_sharing.cpp"
+    echo "  2. Check the dump and use options and the stale archive fallback in [directory] (default /tmp)"
+    exit 0
+fi
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+COMMON_DIR="$SCRIPT_DIR/../../common/liboceanbase_jni_common"
+BINARY="$SCRIPT_DIR/class_data_sharing_test"
+
+g++ -std=c++11 -O2 -Wall -I"$COMMON_DIR" \
+    "$SCRIPT_DIR/class_data_sharing_test.cpp" "$COMMON_DIR/class_data_sharing.cpp" \
+    -o "$BINARY" || exit 1
+
+"$BINARY" "$@"
+RESULT=$?
+rm -f "$BINARY"
+exit $RESULT
@@ -0,0 +1,32 @@
+#!/bin/bash
+
+# Content Chunker Test Script
+# Checks the sentence-boundary chunks that long documents are cached in
+
+echo "✂️ Content Chunker Test"
+echo ""
+
+if [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
+    echo "Usage: $0"
+    echo ""
+    echo "This script will:"
+    echo "  1. Build the test against common/liboceanbase_jni_common/content_chunker.cpp"
+    echo "  2. Check boundaries, size bounds, reuse after an edit and unchanged tokens"
+    echo "  3. Report the chunking throughput"
+    exit 0
+fi
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+COMMON_DIR="$SCRIPT_DIR/../../common/liboceanbase_jni_common"
+BINARY="$SCRIPT_DIR/content_chunker_test"
+
+g++ -std=c++11 -O2 -Wall -I"$COMMON_DIR" \
+    "$SCRIPT_DIR/content_chunker_test.cpp" "$COMMON_DIR/content_chunker.cpp" "$COMMON_DIR/bigram_tokenizer.cpp" \
+    "$COMMON_DIR/script_run_splitter.cpp" \
+    "$COMMON_DIR/packed_token_buffer.cpp" "$COMMON_DIR/scan_arena.cpp" "$COMMON_DIR/utf8_kernel.cpp" \
+    -o "$BINARY" || exit 1
+
+"$BINARY" "$@"
+RESULT=$?
+rm -f "$BINARY"
+exit $RESULT
@@ -0,0 +1,57 @@
+#!/bin/bash
+
+# Japanese Tokenizer Test Script
+# Checks the native Japanese backend, optionally against Lucene Kuromoji tokens on a corpus
+
+echo "🇯🇵 Japanese Tokenizer Test"
+echo ""
+
+if [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
+    echo "Usage: $0 [--compare <ipadic.dic> <corpus.txt>]"
+    echo ""
+    echo "This script will:"
+    echo "  1. Build the test against japanese_ftparser/japanese_tokenizer.cpp"
+    echo "  2. Check the dictionary format, lattice, search mode, token filters and chunked documents"
+    echo "  3. With --compare, write the Lucene tokens of the corpus (needs java and the kuromoji jar)"
+    echo "     and report how many lines the native backend segments identically, and whether"
+    echo "     the corpus gives the same tokens segmented whole and in chunk cache chunks"
+    exit 0
+fi
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+COMMON_DIR="$SCRIPT_DIR/../../common/liboceanbase_jni_common"
+JAPANESE_DIR="$SCRIPT_DIR/../../japanese_ftparser"
+JAVA_DIR="$SCRIPT_DIR/../java-test-script/java"
+BINARY="$SCRIPT_DIR/japanese_tokenizer_test"
+
+g++ -std=c++11 -O2 -Wall -I"$COMMON_DIR" -I"$JAPANESE_DIR" \
+    "$SCRIPT_DIR/japanese_tokenizer_test.cpp" "$JAPANESE_DIR/japanese_tokenizer.cpp" \
+    "$JAPANESE_DIR/japanese_dictionary.cpp" "$COMMON_DIR/content_chunker.cpp" "$COMMON_DIR/mapped_file.cpp" \
+    "$COMMON_DIR/packed_token_buffer.cpp" "$COMMON_DIR/scan_arena.cpp" "$COMMON_DIR/utf8_kernel.cpp" \
+    -o "$BINARY" || exit 1
+
+if [ "$1" = "--compare" ]; then
+    if [ $# -ne 3 ]; then
+        echo "Usage: $0 --compare <ipadic.dic> <corpus.txt>"
+        rm -f "$BINARY"
+        exit 1
+    fi
+    DICT_FILE="$(cd "$(dirname "$2")" && pwd)/$(basename "$2")"
+    CORPUS_FILE="$(cd "$(dirname "$3")" && pwd)/$(basename "$3")"
+    WORK_DIR="$(mktemp -d)"
+    
+    (cd "$JAVA_DIR" && javac -cp ".:lib/*" -d "$WORK_DIR" -sourcepath ".:../../../japanese_ftparser/java:../../../common/liboceanbase_jni_common/java" JapaneseReferenceTokens.java \
+        && java -cp "$WORK_DIR:lib/*" JapaneseReferenceTokens "$CORPUS_FILE" "$WORK_DIR/reference.txt")
+    if [ $? -ne 0 ]; then
+        rm -rf "$WORK_DIR" "$BINARY"
+        exit 1
+    fi
+    "$BINARY" --compare "$DICT_FILE" "$CORPUS_FILE" "$WORK_DIR/reference.txt"
+    RESULT=$?
+    rm -rf "$WORK_DIR"
+else
+    "$BINARY"
+    RESULT=$?
+fi
+rm -f "$BINARY"
+exit $RESULT
@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# JVM Option Test Script
+# Checks the JVM option profiles and OCEANBASE_JNI_EXTRA_OPTS
+
+echo "⚙️ JVM Option Test"
+echo ""
+
+if [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
+    echo "Usage: $0"
+    echo ""
+    echo "This script will:"
+    echo "  1. Build the test against common/liboceanbase_jni_common/jvm_options.cpp"
+    echo "  2. Check the options of each profile and how extra options are split and placed"
+    exit 0
+fi
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+COMMON_DIR="$SCRIPT_DIR/../../common/liboceanbase_jni_common"
+BINARY="$SCRIPT_DIR/jvm_options_test"
+
+g++ -std=c++11 -O2 -Wall -I"$COMMON_DIR" \
+    "$SCRIPT_DIR/jvm_options_test.cpp" "$COMMON_DIR/jvm_options.cpp" \
+    -o "$BINARY" || exit 1
+
+"$BINARY" "$@"
+RESULT=$?
+rm -f "$BINARY"
+exit $RESULT
@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Persistent Segment Cache Test Script
+# Checks the append-only segmentation result file reused across index builds
+
+echo "💾 Persistent Segment Cache Test"
+echo ""
+
+if [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
+    echo "Usage: $0 [directory]"
+    echo ""
+    echo "This script will:"
+    echo "  1. Build the test against common/liboceanbase_jni_common/persistent_segment_cache.cpp"
+    echo "  2. Check reopening, configuration changes, the size bound, crash recovery and concurrent appends in [directory] (default /tmp)"
+    exit 0
+fi
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+COMMON_DIR="$SCRIPT_DIR/../../common/liboceanbase_jni_common"
+BINARY="$SCRIPT_DIR/persistent_segment_cache_test"
+
+g++ -std=c++11 -O2 -Wall -pthread -I"$COMMON_DIR" \
+    "$SCRIPT_DIR/persistent_segment_cache_test.cpp" "$COMMON_DIR/persistent_segment_cache.cpp" \
+    "$COMMON_DIR/packed_token_buffer.cpp" "$COMMON_DIR/scan_arena.cpp" "$COMMON_DIR/utf8_kernel.cpp" \
+    -o "$BINARY" || exit 1
+
+"$BINARY" "$@"
+RESULT=$?
+rm -f "$BINARY"
+exit $RESULT
@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Script Run Splitter Test Script
+# Checks the native ASCII pre-pass that keeps Latin and digit chunks away from the JVM
+
+echo "✂️ Script Run Splitter Test"
+echo ""
+
+if [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
+    echo "Usage: $0"
+    echo ""
+    echo "This script will:"
+    echo "  1. Build the test against common/liboceanbase_jni_common/script_run_splitter.cpp"
+    echo "  2. Check the segmenter text and native tokens for Japanese/Korean and Thai options"
+    exit 0
+fi
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+COMMON_DIR="$SCRIPT_DIR/../../common/liboceanbase_jni_common"
+BINARY="$SCRIPT_DIR/script_run_splitter_test"
+
+g++ -std=c++11 -O2 -Wall -I"$COMMON_DIR" \
+    "$SCRIPT_DIR/script_run_splitter_test.cpp" "$COMMON_DIR/script_run_splitter.cpp" \
+    "$COMMON_DIR/packed_token_buffer.cpp" "$COMMON_DIR/scan_arena.cpp" "$COMMON_DIR/utf8_kernel.cpp" \
+    -o "$BINARY" || exit 1
+
+"$BINARY" "$@"
+RESULT=$?
+rm -f "$BINARY"
+exit $RESULT
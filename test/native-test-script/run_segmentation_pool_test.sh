@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# Segmentation Pool Test Script
+# Checks the work-stealing pool of segmentation threads
+
+echo "🧵 Segmentation Pool Test"
+echo ""
+
+if [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
+    echo "Usage: $0"
+    echo ""
+    echo "This script will:"
+    echo "  1. Build the test against common/liboceanbase_jni_common/segmentation_pool.cpp"
+    echo "  2. Check the thread bound, work stealing, error order and nested jobs"
+    exit 0
+fi
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+COMMON_DIR="$SCRIPT_DIR/../../common/liboceanbase_jni_common"
+BINARY="$SCRIPT_DIR/segmentation_pool_test"
+
+g++ -std=c++11 -O2 -Wall -pthread -I"$COMMON_DIR" \
+    "$SCRIPT_DIR/segmentation_pool_test.cpp" "$COMMON_DIR/segmentation_pool.cpp" \
+    -o "$BINARY" || exit 1
+
+"$BINARY" "$@"
+RESULT=$?
+rm -f "$BINARY"
+exit $RESULT
@@ -0,0 +1,55 @@
+#!/bin/bash
+
+# Thai Word Breaker Test Script
+# Checks the native Thai backend, optionally against Lucene ThaiAnalyzer tokens on a corpus
+
+echo "🇹🇭 Thai Word Breaker Test"
+echo ""
+
+if [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
+    echo "Usage: $0 [--compare <dict.txt> <corpus.txt>]"
+    echo ""
+    echo "This script will:"
+    echo "  1. Build the test against thai_ftparser/thai_word_breaker.cpp"
+    echo "  2. Check the trie, cluster rules, maximal matching and token filters"
+    echo "  3. With --compare, write the Lucene tokens and stopwords of the corpus (needs java)"
+    echo "     and report how many lines the native backend segments identically"
+    exit 0
+fi
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+COMMON_DIR="$SCRIPT_DIR/../../common/liboceanbase_jni_common"
+THAI_DIR="$SCRIPT_DIR/../../thai_ftparser"
+JAVA_DIR="$SCRIPT_DIR/../java-test-script/java"
+BINARY="$SCRIPT_DIR/thai_word_breaker_test"
+
+g++ -std=c++11 -O2 -Wall -I"$COMMON_DIR" -I"$THAI_DIR" \
+    "$SCRIPT_DIR/thai_word_breaker_test.cpp" "$THAI_DIR/thai_word_breaker.cpp" \
+    "$COMMON_DIR/packed_token_buffer.cpp" "$COMMON_DIR/scan_arena.cpp" "$COMMON_DIR/utf8_kernel.cpp" \
+    -o "$BINARY" || exit 1
+
+if [ "$1" = "--compare" ]; then
+    if [ $# -ne 3 ]; then
+        echo "Usage: $0 --compare <dict.txt> <corpus.txt>"
+        rm -f "$BINARY"
+        exit 1
+    fi
+    DICT_FILE="$(cd "$(dirname "$2")" && pwd)/$(basename "$2")"
+    CORPUS_FILE="$(cd "$(dirname "$3")" && pwd)/$(basename "$3")"
+    WORK_DIR="$(mktemp -d)"
+    
+    (cd "$JAVA_DIR" && javac -cp ".:lib/*" -d "$WORK_DIR" -sourcepath ".:../../../thai_ftparser/java:../../../common/liboceanbase_jni_common/java" ThaiReferenceTokens.java \
+        && java -cp "$WORK_DIR:lib/*" ThaiReferenceTokens "$CORPUS_FILE" "$WORK_DIR/reference.txt" "$WORK_DIR/stopwords.txt")
+    if [ $? -ne 0 ]; then
+        rm -rf "$WORK_DIR" "$BINARY"
+        exit 1
+    fi
+    "$BINARY" --compare "$DICT_FILE" "$WORK_DIR/stopwords.txt" "$CORPUS_FILE" "$WORK_DIR/reference.txt"
+    RESULT=$?
+    rm -rf "$WORK_DIR"
+else
+    "$BINARY"
+    RESULT=$?
+fi
+rm -f "$BINARY"
+exit $RESULT
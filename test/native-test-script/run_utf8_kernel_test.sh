@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# UTF-8 Kernel Test Script
+# Checks every SIMD implementation against the original scalar loop, optionally benchmarks them
+
+echo "🔤 UTF-8 Kernel Test"
+echo ""
+
+if [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
+    echo "Usage: $0 [--bench]"
+    echo ""
+    echo "This script will:"
+    echo "  1. Build the test against common/liboceanbase_jni_common/utf8_kernel.cpp"
+    echo "  2. Compare validation and character counts of every supported implementation"
+    echo "  3. With --bench, print the throughput of each implementation"
+    exit 0
+fi
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+COMMON_DIR="$SCRIPT_DIR/../../common/liboceanbase_jni_common"
+BINARY="$SCRIPT_DIR/utf8_kernel_test"
+
+g++ -std=c++11 -O2 -Wall -I"$COMMON_DIR" \
+    "$SCRIPT_DIR/utf8_kernel_test.cpp" "$COMMON_DIR/utf8_kernel.cpp" -o "$BINARY" || exit 1
+
+"$BINARY" "$@"
+RESULT=$?
+rm -f "$BINARY"
+exit $RESULT
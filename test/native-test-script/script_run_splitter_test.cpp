@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Script run splitter tests
+ *
+ * Checks which chunks are sent to the segmenter and which tokens are
+ * produced natively, for the Kuromoji/Nori and the Thai options.
+ * Usage: script_run_splitter_test
+ */
+
+#include "script_run_splitter.h"
+#include "packed_token_buffer.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using oceanbase::jni::PackedTokenBuffer;
+using oceanbase::jni::ScriptRunSplitter;
+
+static int failures = 0;
+
+static ScriptRunSplitter::Options cjk_options() {
+    ScriptRunSplitter::Options options;
+    options.split_letters_and_digits = true;
+    options.punctuation_joins_words = false;
+    return options;
+}
+
+static ScriptRunSplitter::Options thai_options() {
+    ScriptRunSplitter::Options options;
+    options.split_letters_and_digits = false;
+    options.punctuation_joins_words = true;
+    return options;
+}
+
+static std::string join(const std::vector<std::string>& tokens) {
+    std::string joined;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        joined += (i > 0 ? "|" : "") + tokens[i];
+    }
+    return joined;
+}
+
+static void check(const ScriptRunSplitter::Options& options, const std::string& text,
+                  const std::string& expected_segmenter_text, const std::string& expected_tokens) {
+    ScriptRunSplitter splitter(options);
+    std::string segmenter_text = "stale";
+    bool needs_segmenter = splitter.collect_segmenter_text(text.data(), text.size(), segmenter_text);
+    
+    PackedTokenBuffer packed;
+    std::vector<std::string> tokens;
+    if (splitter.append_native_tokens(text.data(), text.size(), packed) != 0) {
+        printf("FAIL \"%s\": allocation failed\n", text.c_str());
+        failures++;
+        return;
+    }
+    packed.to_vector(tokens);
+    
+    if (segmenter_text != expected_segmenter_text ||
+        needs_segmenter != !expected_segmenter_text.empty() ||
+        join(tokens) != expected_tokens) {
+        printf("FAIL \"%s\": segmenter \"%s\" (expected \"%s\"), tokens \"%s\" (expected \"%s\")\n",
+               text.c_str(), segmenter_text.c_str(), expected_segmenter_text.c_str(),
+               join(tokens).c_str(), expected_tokens.c_str());
+        failures++;
+    }
+}
+
+int main() {
+    // Documents that never cross JNI
+    check(cjk_options(), "", "", "");
+    check(cjk_options(), " \t\r\n ", "", "");
+    check(cjk_options(), "OceanBase 4.3, MySQL-compatible!", "", "oceanbase|4|3|mysql|compatible");
+    check(cjk_options(), "SKU123abc", "", "sku|123|abc");
+    check(thai_options(), "SKU123abc (v2)", "", "sku123abc|v2");
+    
+    // Mixed documents: non-ASCII chunks are kept whole and joined with '\n'
+    check(cjk_options(), "OceanBaseデータベース を 選ぶ SQL", "OceanBaseデータベース\nを\n選ぶ", "sql");
+    check(cjk_options(), "Tシャツ 3 枚", "Tシャツ\n枚", "3");
+    check(cjk_options(), "iPhone을 샀다 2024", "iPhone을\n샀다", "2024");
+    check(thai_options(), "ฐานข้อมูล OceanBase", "ฐานข้อมูล", "oceanbase");
+    check(thai_options(), "café au lait", "café", "au|lait");
+    
+    // Thai word breaking keeps inner punctuation, so such chunks go to the segmenter
+    check(thai_options(), "don't 3.14 \"quoted\"", "don't\n3.14", "quoted");
+    check(cjk_options(), "don't 3.14", "", "don|t|3|14");
+    
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All script run splitter checks passed\n");
+    return 0;
+}
@@ -0,0 +1,255 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Segment cache tests
+ *
+ * Checks hits, misses and namespaces, the size bounds, that one-off
+ * documents do not flush frequently used entries, that a replacement
+ * which is not admitted keeps the entry it would replace, and that
+ * concurrent readers and writers keep the cache consistent.
+ * Usage: segment_cache_test
+ */
+
+#include "segment_cache.h"
+#include "packed_token_buffer.h"
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using oceanbase::jni::PackedTokenBuffer;
+using oceanbase::jni::SegmentCache;
+using oceanbase::jni::SegmentCacheStats;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                  \
+    do {                                                             \
+        if (!(cond)) {                                               \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);  \
+            failures++;                                              \
+        }                                                            \
+    } while (0)
+
+// Stand-in segmenter: the space-separated words of the document, bracketed
+static void fake_segment(const std::string& text, PackedTokenBuffer& tokens) {
+    tokens.clear();
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(' ', pos);
+        end = end == std::string::npos ? text.size() : end;
+        std::string word = "<" + text.substr(pos, end - pos) + ">";
+        tokens.append(word.data(), word.size());
+        pos = end + 1;
+    }
+}
+
+static std::string tokens_of(PackedTokenBuffer& tokens) {
+    std::vector<std::string> words;
+    tokens.to_vector(words);
+    std::string joined;
+    for (size_t i = 0; i < words.size(); ++i) {
+        joined += (i > 0 ? "|" : "") + words[i];
+    }
+    return joined;
+}
+
+// Look up, and on a miss segment and offer the result, like the bridges do
+static bool segment_cached(SegmentCache& cache, uint64_t ns, const std::string& text, PackedTokenBuffer& tokens) {
+    if (cache.lookup(ns, text.data(), text.size(), tokens)) {
+        return true;
+    }
+    fake_segment(text, tokens);
+    cache.insert(ns, text.data(), text.size(), tokens);
+    return false;
+}
+
+static void check_hits_and_namespaces() {
+    SegmentCache cache(1 << 20, 256);
+    uint64_t ja = SegmentCache::make_namespace("japanese_ftparser|JapaneseSegmenter");
+    uint64_t ko = SegmentCache::make_namespace("korean_ftparser|KoreanSegmenter");
+    CHECK(ja != ko);
+
+    PackedTokenBuffer tokens;
+    CHECK(!segment_cached(cache, ja, "東京 タワー", tokens));
+    CHECK(segment_cached(cache, ja, "東京 タワー", tokens));
+    CHECK(tokens_of(tokens) == "<東京>|<タワー>");
+    CHECK(!segment_cached(cache, ko, "東京 タワー", tokens));   // Other parser, other namespace
+    CHECK(!segment_cached(cache, ja, "東京 タワ", tokens));     // Prefix of a cached document
+
+    PackedTokenBuffer cached;
+    CHECK(cache.lookup(ja, "abc def", 7, cached) == false);
+    fake_segment("abc def", tokens);
+    CHECK(cache.insert(ja, "abc def", 7, tokens));
+    CHECK(cache.lookup(ja, "abc def", 7, cached));
+    CHECK(tokens_of(cached) == "<abc>|<def>");
+
+    // Empty token lists are results too
+    PackedTokenBuffer empty;
+    CHECK(cache.insert(ja, "   ", 3, empty));
+    cached.append("stale", 5);
+    CHECK(cache.lookup(ja, "   ", 3, cached) && cached.size() == 0);
+
+    SegmentCacheStats stats = cache.stats();
+    CHECK(stats.hits == 3);
+    CHECK(stats.misses == 4);
+    CHECK(stats.insertions == 5);
+    CHECK(stats.entries == 5);
+}
+
+static void check_bounds() {
+    // Documents above the limit are neither looked up nor stored
+    SegmentCache cache(64 * 1024, 16);
+    PackedTokenBuffer tokens;
+    std::string long_doc(17, 'x');
+    CHECK(!cache.cacheable(long_doc.size()));
+    CHECK(!segment_cached(cache, 1, long_doc, tokens));
+    CHECK(!segment_cached(cache, 1, long_doc, tokens));
+    CHECK(cache.stats().misses == 0 && cache.stats().entries == 0);
+
+    // A disabled cache never holds anything
+    SegmentCache disabled(0, 4096);
+    CHECK(!disabled.cacheable(1));
+    CHECK(!segment_cached(disabled, 1, "a", tokens) && !segment_cached(disabled, 1, "a", tokens));
+    CHECK(disabled.stats().entries == 0);
+
+    // The size bound holds however much is offered; each document is used
+    // four times, more often than the entries it replaces, so it is admitted
+    SegmentCache small(16 * 1024, 64);
+    for (int i = 0; i < 5000; ++i) {
+        std::string doc = "document " + std::to_string(i);
+        for (int k = 0; k < 4; ++k) {
+            segment_cached(small, 1, doc, tokens);
+        }
+    }
+    SegmentCacheStats stats = small.stats();
+    CHECK(stats.bytes <= 16 * 1024);
+    CHECK(stats.evictions > 0);
+    CHECK(stats.entries > 0);
+}
+
+static void check_admission() {
+    // Hot short queries fill the cache and are read repeatedly
+    SegmentCache cache(32 * 1024, 4096);
+    PackedTokenBuffer tokens;
+    std::vector<std::string> hot;
+    for (int i = 0; i < 60; ++i) {
+        hot.push_back("hot query " + std::to_string(i));
+    }
+    for (int round = 0; round < 5; ++round) {
+        for (const std::string& doc : hot) {
+            segment_cached(cache, 7, doc, tokens);
+        }
+    }
+
+    // A scan of one-off documents, each seen once, must not displace them
+    for (int i = 0; i < 2000; ++i) {
+        std::string doc = "one-off catalog document number " + std::to_string(i) + " " + std::string(200, 'x');
+        segment_cached(cache, 7, doc, tokens);
+    }
+    int hot_hits = 0;
+    for (const std::string& doc : hot) {
+        hot_hits += cache.lookup(7, doc.data(), doc.size(), tokens) ? 1 : 0;
+    }
+    CHECK(hot_hits == static_cast<int>(hot.size()));
+    CHECK(cache.stats().rejections > 0);
+
+    // A document that becomes popular is admitted after all
+    std::string rising = "rising query";
+    for (int i = 0; i < 8; ++i) {
+        segment_cached(cache, 7, rising, tokens);
+    }
+    CHECK(cache.lookup(7, rising.data(), rising.size(), tokens));
+}
+
+static void check_rejected_replacement() {
+    // Documents stored while there is room, then enough others to fill the shards
+    SegmentCache cache(16 * 1024, 4096);
+    PackedTokenBuffer tokens;
+    std::vector<std::string> stored;
+    for (int i = 0; i < 64; ++i) {
+        stored.push_back("stored " + std::to_string(i));
+        segment_cached(cache, 3, stored.back(), tokens);
+    }
+    for (int i = 0; i < 32; ++i) {
+        std::string doc = "filler " + std::to_string(i) + " " + std::string(100, 'y');
+        for (int k = 0; k < 10; ++k) {
+            segment_cached(cache, 3, doc, tokens);
+        }
+    }
+
+    // The stored documents still cached become the most recently used
+    std::vector<std::string> cached_docs;
+    std::vector<std::string> cached_tokens;
+    for (const std::string& doc : stored) {
+        if (cache.lookup(3, doc.data(), doc.size(), tokens)) {
+            cached_docs.push_back(doc);
+            cached_tokens.push_back(tokens_of(tokens));
+        }
+    }
+    CHECK(!cached_docs.empty());
+
+    // A larger result for one of them, used less often than the fillers it
+    // would evict, is not admitted and must leave the stored entry in place
+    PackedTokenBuffer larger;
+    for (int i = 0; i < 30; ++i) {
+        larger.append("replacement", 11);
+    }
+    int rejected = 0;
+    for (size_t i = 0; i < cached_docs.size(); ++i) {
+        const std::string& doc = cached_docs[i];
+        if (!cache.insert(3, doc.data(), doc.size(), larger)) {
+            rejected++;
+            CHECK(cache.lookup(3, doc.data(), doc.size(), tokens));
+            CHECK(tokens_of(tokens) == cached_tokens[i]);
+        } else {
+            CHECK(cache.lookup(3, doc.data(), doc.size(), tokens));
+            CHECK(tokens.size() == larger.size());
+        }
+    }
+    CHECK(rejected > 0);
+    CHECK(cache.stats().bytes <= 16 * 1024);
+}
+
+static void check_concurrency() {
+    SegmentCache cache(64 * 1024, 4096);
+    std::atomic<int> wrong(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&cache, &wrong, t]() {
+            PackedTokenBuffer tokens;
+            PackedTokenBuffer expected;
+            for (int i = 0; i < 20000; ++i) {
+                std::string doc = "doc " + std::to_string((i * 7 + t) % 500) + " of thread set";
+                segment_cached(cache, 3, doc, tokens);
+                fake_segment(doc, expected);
+                if (tokens_of(tokens) != tokens_of(expected)) {
+                    wrong++;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    SegmentCacheStats stats = cache.stats();
+    CHECK(wrong == 0);
+    CHECK(stats.hits > 0);
+    CHECK(stats.hits + stats.misses == 8 * 20000);
+    CHECK(stats.bytes <= 64 * 1024);
+}
+
+int main() {
+    check_hits_and_namespaces();
+    check_bounds();
+    check_admission();
+    check_rejected_replacement();
+    check_concurrency();
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All segment cache checks passed\n");
+    return 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Segmentation pool tests
+ *
+ * Checks that jobs handed to the pool all run, on no more threads than the
+ * pool has, that idle workers steal from busy ones, that the first error
+ * in input order is returned, that jobs submitted from a worker run inline,
+ * that many scan threads can share one pool, and that the count of queued
+ * jobs stays consistent under many short calls.
+ * Usage: segmentation_pool_test
+ */
+
+#include "segmentation_pool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using oceanbase::jni::SegmentationPool;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                  \
+    do {                                                             \
+        if (!(cond)) {                                               \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);  \
+            failures++;                                              \
+        }                                                            \
+    } while (0)
+
+static void check_bounded_threads() {
+    SegmentationPool pool(4);
+    CHECK(pool.thread_count() == 4);
+    CHECK(!pool.is_worker_thread());
+
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::vector<int> done(200, 0);
+    std::vector<SegmentationPool::Job> jobs;
+    for (size_t i = 0; i < done.size(); ++i) {
+        jobs.push_back([&mutex, &threads, &done, &pool, i]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+            done[i] = pool.is_worker_thread() ? 1 : -1;
+            return 0;
+        });
+    }
+    CHECK(pool.run(jobs) == 0);
+    for (int d : done) {
+        CHECK(d == 1);
+    }
+    CHECK(!threads.empty() && threads.size() <= 4);
+    CHECK(threads.count(std::this_thread::get_id()) == 0);
+    CHECK(pool.get_stats().jobs == 200);
+
+    // One job, and nothing to do
+    CHECK(pool.run([]() { return 7; }) == 7);
+    CHECK(pool.run(std::vector<SegmentationPool::Job>()) == 0);
+}
+
+static void check_stealing() {
+    // Round-robin puts every slow job on the same worker, the others take them
+    SegmentationPool pool(4);
+    std::vector<SegmentationPool::Job> jobs;
+    for (int i = 0; i < 40; ++i) {
+        bool slow = i % 4 == 0;
+        jobs.push_back([slow]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(slow ? 20 : 1));
+            return 0;
+        });
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CHECK(pool.run(jobs) == 0);
+    int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    SegmentationPool::Stats stats = pool.get_stats();
+    printf("Stealing: 40 jobs in %lld ms, %llu steals\n", static_cast<long long>(elapsed),
+           static_cast<unsigned long long>(stats.steals));
+    CHECK(stats.steals > 0);
+    // Alone, the worker owning the slow jobs would need 10 * 20 ms
+    CHECK(elapsed < 180);
+}
+
+static void check_errors_and_nesting() {
+    SegmentationPool pool(2);
+    std::atomic<int> ran(0);
+    std::vector<SegmentationPool::Job> jobs;
+    for (int i = 0; i < 10; ++i) {
+        jobs.push_back([&ran, i]() {
+            ran++;
+            return i == 3 ? -4007 : (i == 6 ? -4002 : 0);
+        });
+    }
+    CHECK(pool.run(jobs) == -4007);
+    CHECK(ran == 10);
+
+    // A job handing work to the pool runs it on its own thread
+    std::thread::id outer_thread;
+    std::thread::id inner_thread;
+    CHECK(pool.run([&pool, &outer_thread, &inner_thread]() {
+        outer_thread = std::this_thread::get_id();
+        return pool.run([&inner_thread]() {
+            inner_thread = std::this_thread::get_id();
+            return 5;
+        });
+    }) == 5);
+    CHECK(outer_thread == inner_thread);
+    CHECK(pool.get_stats().inline_jobs == 1);
+}
+
+static void check_many_callers() {
+    SegmentationPool pool(3);
+    std::atomic<int> total(0);
+    std::vector<std::thread> scans;
+    for (int t = 0; t < 16; ++t) {
+        scans.emplace_back([&pool, &total, t]() {
+            for (int round = 0; round < 50; ++round) {
+                std::vector<SegmentationPool::Job> jobs;
+                for (int i = 0; i < (t + round) % 5; ++i) {
+                    jobs.push_back([&total]() {
+                        total++;
+                        return 0;
+                    });
+                }
+                pool.run(jobs);
+            }
+        });
+    }
+    int expected = 0;
+    for (int t = 0; t < 16; ++t) {
+        for (int round = 0; round < 50; ++round) {
+            expected += (t + round) % 5;
+        }
+    }
+    for (std::thread& scan : scans) {
+        scan.join();
+    }
+    CHECK(total == expected);
+}
+
+static void check_pending_count() {
+    // Many short run() calls: workers often take a task the moment it is
+    // pushed, and the count of queued tasks must never go below zero
+    SegmentationPool pool(4);
+    std::atomic<bool> done(false);
+    uint64_t most_pending = 0;
+    std::thread monitor([&pool, &done, &most_pending]() {
+        while (!done) {
+            uint64_t pending = pool.get_stats().pending;
+            most_pending = pending > most_pending ? pending : most_pending;
+        }
+    });
+    std::vector<std::thread> scans;
+    for (int t = 0; t < 8; ++t) {
+        scans.emplace_back([&pool]() {
+            for (int round = 0; round < 2000; ++round) {
+                std::vector<SegmentationPool::Job> jobs(round % 3 + 1, []() { return 0; });
+                pool.run(jobs);
+            }
+        });
+    }
+    for (std::thread& scan : scans) {
+        scan.join();
+    }
+    done = true;
+    monitor.join();
+    // At most one batch of three per scan thread is queued at a time
+    CHECK(most_pending <= 8 * 3);
+    CHECK(pool.get_stats().pending == 0);
+}
+
+static void check_default_size() {
+    SegmentationPool pool(0);
+    CHECK(pool.thread_count() >= 1);
+    CHECK(pool.run([]() { return 0; }) == 0);
+}
+
+int main() {
+    check_bounded_threads();
+    check_stealing();
+    check_errors_and_nesting();
+    check_many_callers();
+    check_pending_count();
+    check_default_size();
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All segmentation pool checks passed\n");
+    return 0;
+}
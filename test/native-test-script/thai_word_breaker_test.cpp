@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Native Thai word breaker tests
+ *
+ * Checks the dictionary trie, cluster rules, maximal matching and the
+ * ThaiAnalyzer-compatible filters on a small dictionary, and optionally
+ * compares the breaker with Lucene tokens on a reference corpus.
+ * Usage: thai_word_breaker_test
+ *        thai_word_breaker_test --compare <dict.txt> <stopwords.txt> <corpus.txt> <reference.txt>
+ */
+
+#include "thai_word_breaker.h"
+#include "packed_token_buffer.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using oceanbase::jni::PackedTokenBuffer;
+using oceanbase::thai_ftparser::ThaiDictionary;
+using oceanbase::thai_ftparser::ThaiWordBreaker;
+
+static int failures = 0;
+
+static std::string join(const std::vector<std::string>& tokens, const char* separator) {
+    std::string joined;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        joined += (i > 0 ? separator : "") + tokens[i];
+    }
+    return joined;
+}
+
+static std::string segment(const ThaiWordBreaker& breaker, const std::string& text, const char* separator) {
+    PackedTokenBuffer packed;
+    std::vector<std::string> tokens;
+    if (breaker.segment(text.data(), text.size(), packed) != 0) {
+        return "<allocation failed>";
+    }
+    packed.to_vector(tokens);
+    return join(tokens, separator);
+}
+
+static void check(const ThaiWordBreaker& breaker, const std::string& text, const std::string& expected) {
+    std::string tokens = segment(breaker, text, "|");
+    if (tokens != expected) {
+        printf("FAIL \"%s\": \"%s\" (expected \"%s\")\n", text.c_str(), tokens.c_str(), expected.c_str());
+        failures++;
+    }
+}
+
+static void add_words(ThaiDictionary& dictionary, const char* const* words, size_t count, uint8_t flags) {
+    for (size_t i = 0; i < count; ++i) {
+        if (!dictionary.add(words[i], strlen(words[i]), flags)) {
+            printf("FAIL dictionary rejected \"%s\"\n", words[i]);
+            failures++;
+        }
+    }
+}
+
+static int run_checks() {
+    static const char* const WORDS[] = {
+        "ระบบ", "จัดการ", "ฐาน", "ข้อมูล", "ฐานข้อมูล", "ที่", "มี", "ประสิทธิภาพ", "สูง",
+        "แบบ", "กระจาย", "สวัสดี", "ครับ", "ไป", "ไปหา", "หากิน", "ตา", "ตาก", "ลม", "กลม", "เด็ก"
+    };
+    static const char* const STOPWORDS[] = {"ที่", "มี", "และ"};
+
+    ThaiDictionary dictionary;
+    add_words(dictionary, WORDS, sizeof(WORDS) / sizeof(WORDS[0]), ThaiDictionary::WORD);
+    add_words(dictionary, STOPWORDS, sizeof(STOPWORDS) / sizeof(STOPWORDS[0]), ThaiDictionary::STOP_WORD);
+    if (dictionary.add("OceanBase", 9, ThaiDictionary::WORD) || dictionary.add("", 0, ThaiDictionary::WORD)) {
+        printf("FAIL dictionary accepted a non-Thai word\n");
+        failures++;
+    }
+    dictionary.build();
+    if (dictionary.word_count() != 22) {
+        printf("FAIL word count %zu (expected 22)\n", dictionary.word_count());
+        failures++;
+    }
+    ThaiWordBreaker breaker(dictionary);
+
+    // Dictionary words, longest segmentation with the fewest words, stopwords dropped
+    check(breaker, "", "");
+    check(breaker, "ระบบจัดการฐานข้อมูลที่มีประสิทธิภาพสูง", "ระบบ|จัดการ|ฐานข้อมูล|ประสิทธิภาพ|สูง");
+    check(breaker, "ฐานข้อมูลแบบกระจาย", "ฐานข้อมูล|แบบ|กระจาย");
+    check(breaker, "สวัสดีครับ", "สวัสดี|ครับ");
+
+    // Maximal matching: greedy longest match would leave "กิน" unknown
+    check(breaker, "ไปหากิน", "ไป|หากิน");
+    // Equal cost: the longer leading word wins
+    check(breaker, "ตากลม", "ตาก|ลม");
+
+    // Unknown clusters are merged, and never split inside a cluster
+    check(breaker, "ฐานกขค", "ฐาน|กขค");
+    check(breaker, "เด็กเล่นครับ", "เด็ก|เล่น|ครับ");
+    check(breaker, "ไปๆมาๆ", "ไป|ๆ|มา|ๆ");
+    // A stopword spelled out as unknown text is still dropped
+    check(breaker, "และ", "");
+
+    // Other scripts: lower-cased, digits folded, inner punctuation kept
+    check(breaker, "OceanBase 4.3, MySQL-compatible!", "oceanbase|4.3|mysql|compatible");
+    check(breaker, "don't ๑๒๓ 1,000 SKU123abc", "don't|123|1,000|sku123abc");
+    check(breaker, "Café ΑΒΓ Данные", "café|αβγ|данные");
+    check(breaker, "ปี๒๕๖๖ ราคา฿500", "ปี|2566|ราคา|500");
+
+    // Punctuation, Thai signs and invalid bytes never join a token
+    check(breaker, "ฯลฯ “ฐาน” \xFF\xFEข้อมูล", "ล|ฐาน|ข้อมูล");
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All Thai word breaker checks passed\n");
+    return 0;
+}
+
+// Compare with Lucene: reference.txt holds the tab-separated ThaiAnalyzer tokens of each corpus line
+static int run_compare(const char* dictionary_path, const char* stopwords_path,
+                       const char* corpus_path, const char* reference_path) {
+    ThaiDictionary dictionary;
+    int64_t words = dictionary.add_file(dictionary_path, ThaiDictionary::WORD);
+    int64_t stopwords = dictionary.add_file(stopwords_path, ThaiDictionary::STOP_WORD);
+    if (words <= 0 || stopwords < 0) {
+        printf("Failed to load %s or %s\n", dictionary_path, stopwords_path);
+        return 1;
+    }
+    dictionary.build();
+    printf("Dictionary: %lld words, %lld stopwords, %zu trie nodes, %zu bytes\n",
+           static_cast<long long>(words), static_cast<long long>(stopwords),
+           dictionary.node_count(), dictionary.memory_bytes());
+    ThaiWordBreaker breaker(dictionary);
+
+    std::ifstream corpus(corpus_path);
+    std::ifstream reference(reference_path);
+    if (!corpus || !reference) {
+        printf("Failed to open %s or %s\n", corpus_path, reference_path);
+        return 1;
+    }
+
+    size_t lines = 0;
+    size_t matched = 0;
+    size_t shown = 0;
+    std::string text;
+    std::string expected;
+    while (std::getline(corpus, text) && std::getline(reference, expected)) {
+        lines++;
+        std::string actual = segment(breaker, text, "\t");
+        if (actual == expected) {
+            matched++;
+        } else if (shown++ < 10) {
+            printf("DIFF line %zu\n  lucene: %s\n  native: %s\n", lines, expected.c_str(), actual.c_str());
+        }
+    }
+    printf("Lines identical to Lucene: %zu / %zu (%.2f%%)\n", matched, lines,
+           lines > 0 ? 100.0 * matched / lines : 100.0);
+    return matched == lines ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 6 && strcmp(argv[1], "--compare") == 0) {
+        return run_compare(argv[2], argv[3], argv[4], argv[5]);
+    }
+    return run_checks();
+}
@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Token frequency table tests
+ *
+ * Compares the aggregated counts against std::unordered_map for repeated
+ * tokens, tokens whose slots collide, tokens sharing long prefixes, growth
+ * past the first capacity, and build() called again on the same table,
+ * with heap and scan arena storage.
+ * Usage: token_frequency_table_test
+ */
+
+#include "token_frequency_table.h"
+#include "packed_token_buffer.h"
+#include "scan_arena.h"
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using oceanbase::jni::PackedTokenBuffer;
+using oceanbase::jni::ScanArena;
+using oceanbase::jni::TokenFrequencyTable;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                  \
+    do {                                                             \
+        if (!(cond)) {                                               \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);  \
+            failures++;                                              \
+        }                                                            \
+    } while (0)
+
+static void fill(const std::vector<std::string>& words, PackedTokenBuffer& tokens) {
+    tokens.clear();
+    for (const std::string& word : words) {
+        CHECK(tokens.append(word.data(), word.size()) == 0);
+    }
+}
+
+// Build the table and compare it with a map built from the same words
+static void check_counts(TokenFrequencyTable& table, const std::vector<std::string>& words) {
+    PackedTokenBuffer tokens;
+    fill(words, tokens);
+    CHECK(table.build(tokens) == 0);
+
+    std::unordered_map<std::string, int64_t> expected;
+    std::vector<std::string> first_seen;
+    for (const std::string& word : words) {
+        if (expected[word]++ == 0) {
+            first_seen.push_back(word);
+        }
+    }
+    CHECK(table.distinct_count() == expected.size());
+
+    const char* word = nullptr;
+    int64_t word_len = 0;
+    int64_t char_cnt = 0;
+    int64_t word_freq = 0;
+    size_t read = 0;
+    while (table.next(word, word_len, char_cnt, word_freq)) {
+        std::string text(word, static_cast<size_t>(word_len));
+        // Distinct tokens come back in order of first occurrence
+        CHECK(read < first_seen.size() && first_seen[read] == text);
+        CHECK(word_freq == expected[text]);
+        CHECK(char_cnt == PackedTokenBuffer::count_utf8_chars(text.data(), text.size()));
+        expected.erase(text);
+        read++;
+    }
+    CHECK(read == first_seen.size());
+    CHECK(expected.empty());
+}
+
+// Deterministic words: count distinct values, each repeated by a skewed pattern
+static std::vector<std::string> make_words(size_t distinct, size_t total, const std::string& prefix) {
+    std::vector<std::string> words;
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < total; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        size_t pick = static_cast<size_t>(state % distinct);
+        // Favour low indices so some words repeat many times
+        pick = pick * (pick % 7 + 1) % distinct;
+        words.push_back(prefix + std::to_string(pick));
+    }
+    return words;
+}
+
+static void check_repeated_and_colliding(TokenFrequencyTable& table) {
+    // Nothing to aggregate
+    check_counts(table, std::vector<std::string>());
+
+    std::vector<std::string> words = {"東京", "の", "東京", "タワー", "の", "東京", "", "", "a"};
+    check_counts(table, words);
+
+    // 8 distinct tokens in 16 slots: probe chains wrap around the slot array
+    words.clear();
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 8; ++i) {
+            words.push_back(std::string(1, static_cast<char>('a' + i)) + std::to_string(round % (i + 1)));
+        }
+    }
+    check_counts(table, words);
+
+    // Equal up to the last byte, equal first 8 bytes with different lengths,
+    // and tokens that are prefixes of each other
+    words = {"abcdefgh", "abcdefgi", "abcdefgh1", "abcdefgh", "abcdefg", "abcdefgh12345678",
+             "abcdefgh12345679", "abcdefgh1", "abcdefg", "abcdefgh12345678", "a", "ab"};
+    check_counts(table, words);
+
+    std::string long_prefix(40, 'x');
+    check_counts(table, make_words(300, 3000, long_prefix));
+}
+
+static void check_growth_and_rebuild(TokenFrequencyTable& table) {
+    // Small first, then well past the first capacity, then small again
+    check_counts(table, make_words(5, 12, "w"));
+    check_counts(table, make_words(20000, 50000, "w"));
+    check_counts(table, make_words(3, 10, "v"));
+
+    // The same buffer twice gives the same counts, not doubled ones
+    std::vector<std::string> words = make_words(500, 4000, "same");
+    check_counts(table, words);
+    check_counts(table, words);
+
+    PackedTokenBuffer tokens;
+    fill(words, tokens);
+    CHECK(table.build(tokens) == 0);
+    size_t distinct = table.distinct_count();
+    CHECK(table.build(tokens) == 0);
+    CHECK(table.distinct_count() == distinct);
+    // build() leaves the buffer rewound for other readers
+    const char* word = nullptr;
+    int64_t word_len = 0;
+    int64_t char_cnt = 0;
+    CHECK(tokens.next(word, word_len, char_cnt) && std::string(word, word_len) == words[0]);
+}
+
+int main() {
+    TokenFrequencyTable heap_table;
+    check_repeated_and_colliding(heap_table);
+    check_growth_and_rebuild(heap_table);
+
+    ScanArena& arena = ScanArena::current();
+    arena.begin_scan();
+    TokenFrequencyTable arena_table;
+    arena_table.set_arena(&arena);
+    check_repeated_and_colliding(arena_table);
+    check_growth_and_rebuild(arena_table);
+    arena.end_scan();
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All token frequency table checks passed\n");
+    return 0;
+}
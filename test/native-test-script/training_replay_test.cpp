@@ -0,0 +1,183 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Training replay tests
+ *
+ * Replays a corpus through a stand-in segmenter that becomes faster after
+ * a number of documents, the way JIT compilation does, and checks that the
+ * replay runs until the cost settles, honours its limits, stops at the
+ * first error or when cancelled, and that corpus files are read one
+ * document per line.
+ * Usage: training_replay_test
+ */
+
+#include "training_replay.h"
+#include "packed_token_buffer.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using oceanbase::jni::PackedTokenBuffer;
+using oceanbase::jni::TrainingReplay;
+using oceanbase::jni::TrainingReplayReport;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                  \
+    do {                                                             \
+        if (!(cond)) {                                               \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);  \
+            failures++;                                              \
+        }                                                            \
+    } while (0)
+
+static void spin_for(std::chrono::nanoseconds duration) {
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+// Slow until `compiled_after` documents have been segmented, then fast
+struct JitSegmenter {
+    size_t calls;
+    size_t compiled_after;
+
+    explicit JitSegmenter(size_t compiled_after_docs) : calls(0), compiled_after(compiled_after_docs) {}
+
+    int operator()(const char* text, size_t length, PackedTokenBuffer& tokens) {
+        spin_for(std::chrono::microseconds(calls++ < compiled_after ? 40 : 4));
+        tokens.clear();
+        return tokens.append(text, length);
+    }
+};
+
+static std::vector<std::string> corpus() {
+    std::vector<std::string> docs;
+    docs.push_back("東京都に住んでいます。");
+    docs.push_back("OceanBase は分散データベースです。");
+    docs.push_back("全文検索のインデックスを作成する。");
+    docs.push_back("形態素解析の辞書を読み込む。");
+    return docs;
+}
+
+static TrainingReplay::Options test_options() {
+    TrainingReplay::Options options;
+    options.min_documents = 2500;
+    options.window_documents = 250;
+    options.stable_windows = 3;
+    // Generous: the test checks the stopping rule, not the machine's timer noise
+    options.stable_tolerance = 0.5;
+    return options;
+}
+
+static void check_settles_after_compilation() {
+    TrainingReplay replay(test_options());
+    JitSegmenter segmenter(2000);
+    TrainingReplayReport report;
+    CHECK(replay.run(corpus(), std::ref(segmenter), report) == 0);
+    printf("Replay: %zu documents in %lld ms, %.1f -> %.1f ns/byte, %s\n", report.documents,
+           static_cast<long long>(report.elapsed_ms), report.first_ns_per_byte, report.last_ns_per_byte,
+           report.settled ? "settled" : "at a limit");
+    CHECK(report.settled);
+    CHECK(report.documents >= 2000 + 4 * 250);
+    CHECK(report.documents < 50000);
+    CHECK(report.documents % 250 == 0);
+    CHECK(report.last_ns_per_byte * 3 < report.first_ns_per_byte);
+    CHECK(report.documents == segmenter.calls);
+}
+
+static void check_limits() {
+    // A plateau before min_documents does not end the replay
+    TrainingReplay::Options options = test_options();
+    options.min_documents = 4000;
+    JitSegmenter late(3000);
+    TrainingReplayReport report;
+    CHECK(TrainingReplay(options).run(corpus(), std::ref(late), report) == 0);
+    CHECK(report.settled && report.documents >= 4000 && report.last_ns_per_byte * 3 < report.first_ns_per_byte);
+
+    // Document limit before the cost settles
+    options = test_options();
+    options.max_documents = 1000;
+    JitSegmenter segmenter(5000);
+    CHECK(TrainingReplay(options).run(corpus(), std::ref(segmenter), report) == 0);
+    CHECK(!report.settled && report.documents == 1000);
+
+    // Time limit
+    options = test_options();
+    options.max_millis = 50;
+    JitSegmenter slow(1000000);
+    CHECK(TrainingReplay(options).run(corpus(), std::ref(slow), report) == 0);
+    CHECK(!report.settled && report.elapsed_ms >= 50 && report.elapsed_ms < 1000);
+
+    // Disabled, or nothing to replay
+    options = test_options();
+    options.max_documents = 0;
+    JitSegmenter unused(0);
+    CHECK(TrainingReplay(options).run(corpus(), std::ref(unused), report) == 0);
+    CHECK(TrainingReplay(test_options()).run(std::vector<std::string>(), std::ref(unused), report) == 0);
+    CHECK(unused.calls == 0 && report.documents == 0);
+}
+
+static void check_error() {
+    size_t calls = 0;
+    TrainingReplay::SegmentFunction failing = [&calls](const char*, size_t, PackedTokenBuffer&) {
+        return ++calls == 10 ? -4007 : 0;
+    };
+    TrainingReplayReport report;
+    CHECK(TrainingReplay(test_options()).run(corpus(), failing, report) == -4007);
+    CHECK(report.result == -4007 && report.documents == 9 && !report.settled);
+}
+
+static void check_cancel() {
+    // Cancelled before the cost settles, e.g. when the plugin is unloaded
+    TrainingReplay::Options options = test_options();
+    size_t checks = 0;
+    options.cancel = [&checks]() { return ++checks > 300; };
+    JitSegmenter segmenter(5000);
+    TrainingReplayReport report;
+    CHECK(TrainingReplay(options).run(corpus(), std::ref(segmenter), report) == 0);
+    CHECK(report.cancelled && !report.settled && report.documents == 300 && segmenter.calls == 300);
+
+    // Never cancelled: the same replay as without the callback
+    options.cancel = []() { return false; };
+    CHECK(TrainingReplay(options).run(corpus(), std::ref(segmenter), report) == 0);
+    CHECK(!report.cancelled && report.settled);
+}
+
+static void check_corpus_file() {
+    std::string path = "/tmp/training_replay_test." + std::to_string(getpid());
+    {
+        std::ofstream out(path.c_str());
+        out << "first document\r\n\nsecond 文書\n\n\nthird";
+    }
+    std::vector<std::string> docs;
+    std::string error;
+    CHECK(TrainingReplay::load_corpus(path, docs, error) == 0);
+    CHECK(docs.size() == 3 && docs[0] == "first document" && docs[1] == "second 文書" && docs[2] == "third");
+
+    {
+        std::ofstream out(path.c_str());
+        out << "\n\n";
+    }
+    docs.clear();
+    CHECK(TrainingReplay::load_corpus(path, docs, error) != 0 && !error.empty());
+    unlink(path.c_str());
+    CHECK(TrainingReplay::load_corpus(path, docs, error) != 0);
+}
+
+int main() {
+    check_settles_after_compilation();
+    check_limits();
+    check_error();
+    check_cancel();
+    check_corpus_file();
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All training replay checks passed\n");
+    return 0;
+}
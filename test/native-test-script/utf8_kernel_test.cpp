@@ -0,0 +1,187 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * UTF-8 kernel tests and microbenchmark
+ *
+ * Every implementation supported by the CPU is checked against the original
+ * scalar counting loop (count_chars_scalar) and the scalar validator.
+ * Usage: utf8_kernel_test [--bench]
+ */
+
+#include "utf8_kernel.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using oceanbase::jni::Utf8Kernel;
+
+static int failures = 0;
+
+static std::vector<Utf8Kernel::Isa> supported_isas() {
+    std::vector<Utf8Kernel::Isa> isas;
+    for (int isa = Utf8Kernel::ISA_SCALAR; isa <= Utf8Kernel::detected_isa(); ++isa) {
+        isas.push_back(static_cast<Utf8Kernel::Isa>(isa));
+    }
+    return isas;
+}
+
+static void check(const std::string& text, const char* label) {
+    bool expected_valid = Utf8Kernel::validate(Utf8Kernel::ISA_SCALAR, text.data(), text.size());
+    int64_t expected_count = Utf8Kernel::count_chars_scalar(text.data(), text.size());
+    
+    for (Utf8Kernel::Isa isa : supported_isas()) {
+        bool valid = Utf8Kernel::validate(isa, text.data(), text.size());
+        int64_t count = Utf8Kernel::count_chars(isa, text.data(), text.size());
+        if (valid != expected_valid || count != expected_count) {
+            printf("FAIL [%s] %s (%zu bytes): valid %d/%d, count %lld/%lld\n",
+                   Utf8Kernel::isa_name(isa), label, text.size(), valid, expected_valid,
+                   (long long)count, (long long)expected_count);
+            failures++;
+        }
+    }
+}
+
+static void expect_valid(const std::string& text, bool valid, const char* label) {
+    if (Utf8Kernel::validate(Utf8Kernel::ISA_SCALAR, text.data(), text.size()) != valid) {
+        printf("FAIL [scalar] %s: expected %s\n", label, valid ? "valid" : "invalid");
+        failures++;
+    }
+    // Place the case at every offset of a vector block, surrounded by ASCII and CJK
+    for (size_t pad = 0; pad < 40; ++pad) {
+        check(std::string(pad, 'a') + text, label);
+        check(std::string(pad, 'a') + text + std::string(40 - pad, 'b'), label);
+        check("日本語" + std::string(pad, 'x') + text + "한국어", label);
+    }
+}
+
+static void run_fixed_cases() {
+    expect_valid("", true, "empty");
+    expect_valid("OceanBase", true, "ascii");
+    expect_valid("東京都渋谷区でコンピューターを勉強しています", true, "japanese");
+    expect_valid("한국어 형태소 분석기를 사용하여 문장을 분석합니다", true, "korean");
+    expect_valid("ระบบจัดการฐานข้อมูลที่มีประสิทธิภาพสูง", true, "thai");
+    expect_valid("\xF0\x9F\x98\x80 emoji \xF4\x8F\xBF\xBF", true, "4-byte and U+10FFFF");
+    expect_valid("\xC2\x80\xDF\xBF\xE0\xA0\x80\xEF\xBF\xBF", true, "range boundaries");
+    
+    expect_valid("\xC0\x80", false, "overlong NUL (modified UTF-8)");
+    expect_valid("\xC1\xBF", false, "overlong 2-byte");
+    expect_valid("\xE0\x9F\xBF", false, "overlong 3-byte");
+    expect_valid("\xF0\x8F\xBF\xBF", false, "overlong 4-byte");
+    expect_valid("\xED\xA0\x80", false, "surrogate");
+    expect_valid("\xF4\x90\x80\x80", false, "above U+10FFFF");
+    expect_valid("\xF5\x80\x80\x80", false, "F5 lead");
+    expect_valid("\xFF", false, "FF byte");
+    expect_valid("\x80", false, "stray continuation");
+    expect_valid("\xE3\x81", false, "truncated 3-byte");
+    expect_valid("\xF0\x9F\x98", false, "truncated 4-byte");
+    expect_valid("\xE3\x41\x42", false, "lead followed by ASCII");
+    expect_valid("\xC3\xA9\xA9", false, "extra continuation");
+}
+
+static void run_random_cases() {
+    std::mt19937 rng(20231016);
+    const char* pieces[] = { "a", "Z", " ", "\xC3\xA9", "\xE3\x81\x82", "\xEA\xB0\x80",
+                             "\xE0\xB8\x81", "\xF0\x9F\x98\x80", "\xE2\x80\x8B" };
+    const size_t piece_count = sizeof(pieces) / sizeof(pieces[0]);
+    
+    for (int round = 0; round < 20000; ++round) {
+        std::string text;
+        size_t target = rng() % 300;
+        while (text.size() < target) {
+            text += pieces[rng() % piece_count];
+        }
+        check(text, "random valid");
+        
+        // Corrupt a few bytes, most of these become invalid
+        if (!text.empty()) {
+            int mutations = 1 + rng() % 3;
+            for (int m = 0; m < mutations; ++m) {
+                text[rng() % text.size()] = static_cast<char>(rng() & 0xFF);
+            }
+            check(text, "random mutated");
+            check(text.substr(0, rng() % (text.size() + 1)), "random truncated");
+        }
+    }
+    
+    for (int round = 0; round < 20000; ++round) {
+        std::string text(rng() % 100, '\0');
+        for (size_t i = 0; i < text.size(); ++i) {
+            text[i] = static_cast<char>(0x80 | (rng() & 0x7F));
+        }
+        check(text, "random high bytes");
+    }
+}
+
+static void bench(const char* label, const std::vector<std::string>& inputs, size_t repeat) {
+    size_t total_bytes = 0;
+    for (const std::string& input : inputs) {
+        total_bytes += input.size();
+    }
+    
+    printf("%s (%zu inputs, %zu bytes)\n", label, inputs.size(), total_bytes);
+    volatile int64_t sink = 0;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < repeat; ++r) {
+        for (const std::string& input : inputs) {
+            sink += Utf8Kernel::count_chars_scalar(input.data(), input.size());
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("  %-26s %8.2f GB/s\n", "original scalar count", total_bytes * repeat / seconds / 1e9);
+    
+    for (Utf8Kernel::Isa isa : supported_isas()) {
+        start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < repeat; ++r) {
+            for (const std::string& input : inputs) {
+                sink += Utf8Kernel::count_chars(isa, input.data(), input.size());
+            }
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("  %-26s %8.2f GB/s\n", (std::string(Utf8Kernel::isa_name(isa)) + " count").c_str(),
+               total_bytes * repeat / seconds / 1e9);
+    }
+}
+
+static void run_benchmark() {
+    const char* samples[] = {
+        "東京都渋谷区でコンピューターを勉強しています。",
+        "한국어 형태소 분석기를 사용하여 문장을 분석합니다. ",
+        "ระบบจัดการฐานข้อมูลที่มีประสิทธิภาพสูง ",
+        "OceanBase is a distributed relational database. "
+    };
+    
+    std::vector<std::string> documents;
+    std::vector<std::string> tokens;
+    for (const char* sample : samples) {
+        std::string document;
+        while (document.size() < 1024 * 1024) {
+            document += sample;
+        }
+        documents.push_back(document);
+    }
+    for (int i = 0; i < 100000; ++i) {
+        tokens.push_back(i % 2 ? "データベース" : "database");
+    }
+    
+    printf("Detected implementation: %s\n", Utf8Kernel::isa_name(Utf8Kernel::detected_isa()));
+    bench("1MB documents", documents, 20);
+    bench("short tokens", tokens, 20);
+}
+
+int main(int argc, char** argv) {
+    run_fixed_cases();
+    run_random_cases();
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All UTF-8 kernel checks passed (%s)\n", Utf8Kernel::isa_name(Utf8Kernel::detected_isa()));
+    
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        run_benchmark();
+    }
+    return 0;
+}
@@ -4,10 +4,19 @@
  */
 
 #include "thai_jni_bridge.h"
-#include <iostream>
+#include "thai_native_segmenter.h"
+#include "bigram_segmenter.h"
+#include "jni_log.h"
+#include "scan_arena.h"
+#include "segment_cache.h"
+#include "token_frequency_table.h"
+#include "training_replay.h"
+#include "utf8_kernel.h"
+#include <algorithm>
 #include <sstream>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
 #include <new>
 
 using namespace oceanbase::jni;
@@ -18,21 +27,82 @@ namespace thai_ftparser {
 // Configuration implementation
 ThaiJNIBridgeConfig::ThaiJNIBridgeConfig() 
     : segmenter_class_name("ThaiSegmenter")
-    , segment_method_name("segment") {
+    , segment_method_name("segment")
+    , segment_into_method_name("segmentInto")
+    , segment_batch_method_name("segmentBatch")
+    , open_cursor_method_name("openCursor")
+    , next_tokens_method_name("nextTokens")
+    , close_cursor_method_name("closeCursor")
+    , pipeline_fingerprint_method_name("pipelineFingerprint")
+    , use_direct_buffer_input(oceanbase::jni::JNIConfigUtils::get_config().direct_buffer_input)
+    , use_packed_token_output(oceanbase::jni::JNIConfigUtils::get_config().packed_token_output)
+    , reject_invalid_utf8(oceanbase::jni::JNIConfigUtils::get_config().reject_invalid_utf8)
+    , native_ascii_runs(oceanbase::jni::JNIConfigUtils::get_config().native_ascii_runs)
+    , max_batch_bytes(oceanbase::jni::JNIConfigUtils::get_config().max_batch_bytes)
+    , streaming_threshold_bytes(oceanbase::jni::JNIConfigUtils::get_config().streaming_threshold)
+    , streaming_chunk_bytes(oceanbase::jni::JNIConfigUtils::get_config().streaming_chunk_bytes)
+    , chunk_cache(oceanbase::jni::JNIConfigUtils::get_config().chunk_cache) {
     // JVM configurations are now managed by JNIConfigUtils in common library
 }
 
+// Thai word breaking keeps "abc123", "don't" or "3.14" whole
+static oceanbase::jni::ScriptRunSplitter::Options thai_splitter_options() {
+    oceanbase::jni::ScriptRunSplitter::Options options;
+    options.split_letters_and_digits = false;
+    options.punctuation_joins_words = true;
+    return options;
+}
+
+// Chunks of long documents are cacheable, and not much shorter than that
+static oceanbase::jni::ContentChunker::Options chunker_options() {
+    oceanbase::jni::ContentChunker::Options options;
+    options.max_chunk_bytes = oceanbase::jni::JNIConfigUtils::get_config().segment_cache_max_doc_bytes;
+    options.min_chunk_bytes = options.max_chunk_bytes / 8;
+    return options;
+}
+
 // ThaiJNIBridge implementation
 ThaiJNIBridge::ThaiJNIBridge() 
     : plugin_name_("thai_ftparser")
     , is_initialized_(false)
     , segmenter_class_(nullptr)
     , constructor_method_(nullptr)
-    , segment_method_(nullptr) {
+    , segment_method_(nullptr)
+    , segment_buffer_method_(nullptr)
+    , segment_into_method_(nullptr)
+    , segment_batch_method_(nullptr)
+    , open_cursor_method_(nullptr)
+    , next_tokens_method_(nullptr)
+    , close_cursor_method_(nullptr)
+    , segmenter_instance_(nullptr)
+    , splitter_(thai_splitter_options())
+    , chunker_(chunker_options())
+    , cache_namespace_(oceanbase::jni::SegmentCache::make_namespace(
+          plugin_name_ + "|" + config_.segmenter_class_name + (config_.native_ascii_runs ? "|native_ascii_runs" : "") +
+          "|" + oceanbase::jni::JNIConfigUtils::get_config().classpath)) {
     clear_error();
 }
 
 ThaiJNIBridge::~ThaiJNIBridge() {
+    // The segmenter and its class stay reachable from the JVM, which outlives
+    // the plugin, until their global references are deleted
+    if (segmenter_instance_ || segmenter_class_) {
+        oceanbase::jni::ScopedJNIEnvironment jni_env(plugin_name_);
+        if (jni_env) {
+            JNIEnv* env = jni_env.get();
+            if (segmenter_instance_) {
+                env->DeleteGlobalRef(segmenter_instance_);
+            }
+            if (segmenter_class_) {
+                env->DeleteGlobalRef(segmenter_class_);
+            }
+        } else {
+            JNI_LOG_WARN("Failed to acquire JNI environment, Thai segmenter references leaked");
+        }
+        segmenter_instance_ = nullptr;
+        segmenter_class_ = nullptr;
+    }
+    
     if (is_initialized_) {
         // Unregister from global JVM manager
         oceanbase::jni::GlobalJVMManager::unregister_plugin(plugin_name_);
@@ -68,16 +138,155 @@ int ThaiJNIBridge::initialize() {
         return ret;
     }
     
+    open_persistent_cache();
     is_initialized_ = true;
     return OBP_SUCCESS;
 }
 
 int ThaiJNIBridge::segment(const std::string& text, std::vector<std::string>& tokens) {
+    return segment(text.data(), text.size(), tokens);
+}
+
+int ThaiJNIBridge::segment(const char* text, size_t length, std::vector<std::string>& tokens) {
+    oceanbase::jni::PackedTokenBuffer packed;
+    int ret = segment(text, length, packed);
+    if (ret == OBP_SUCCESS) {
+        packed.to_vector(tokens);
+    }
+    return ret;
+}
+
+int ThaiJNIBridge::segment(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) {
     if (!is_initialized_) {
         set_error(OBP_PLUGIN_ERROR, "Thai JNI Bridge not initialized");
         return OBP_PLUGIN_ERROR;
     }
     
+    // Repeated queries and short documents are answered without crossing JNI
+    oceanbase::jni::SegmentCache& cache = oceanbase::jni::SegmentCache::instance();
+    if (cache.lookup(cache_namespace_, text, length, tokens)) {
+        return OBP_SUCCESS;
+    }
+    
+    // Rows that have not changed since the last index build are read back from disk
+    if (persistent_cache_ && persistent_cache_->lookup(text, length, tokens)) {
+        cache.insert(cache_namespace_, text, length, tokens);
+        return OBP_SUCCESS;
+    }
+    
+    // Documents too long for the cache are cached in chunks when chunk_cache is set
+    bool chunked = config_.chunk_cache && cache.cacheable(0) && !cache.cacheable(length);
+    int ret = chunked ? segment_chunked(text, length, tokens) : segment_uncached(text, length, tokens);
+    if (ret == OBP_SUCCESS) {
+        cache.insert(cache_namespace_, text, length, tokens);
+        if (persistent_cache_) {
+            persistent_cache_->append(text, length, tokens);
+        }
+    }
+    return ret;
+}
+
+void ThaiJNIBridge::open_persistent_cache() {
+    const oceanbase::jni::JNIConfig& jni_config = oceanbase::jni::JNIConfigUtils::get_config();
+    if (jni_config.persistent_cache_dir.empty()) {
+        return;
+    }
+    
+    // One file per plugin, versioned by the segment cache namespace
+    std::string path = jni_config.persistent_cache_dir + "/" + plugin_name_ + ".segcache";
+    std::unique_ptr<oceanbase::jni::PersistentSegmentCache> cache(new oceanbase::jni::PersistentSegmentCache());
+    std::string error;
+    if (cache->open(path, cache_namespace_, jni_config.persistent_cache_bytes, error) != 0) {
+        JNI_LOG_WARN("Persistent segment cache disabled: %s", error.c_str());
+        return;
+    }
+    oceanbase::jni::PersistentSegmentCacheStats stats = cache->stats();
+    JNI_LOG_INFO("Persistent segment cache %s: %llu records in %llu bytes, %llu bytes discarded",
+                 path.c_str(), static_cast<unsigned long long>(stats.records),
+                 static_cast<unsigned long long>(stats.bytes), static_cast<unsigned long long>(stats.discarded_bytes));
+    persistent_cache_ = std::move(cache);
+}
+
+int ThaiJNIBridge::segment_chunked(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) {
+    std::vector<oceanbase::jni::TextSpan> chunks;
+    chunker_.split(text, length, chunks);
+    if (chunks.size() <= 1) {
+        return segment_uncached(text, length, tokens);
+    }
+    
+    // Cut only where no token or context crosses and never inside an ASCII
+    // chunk of the native pre-pass, so the tokens of the chunks are those of
+    // the whole document (with native_ascii_runs, in another order)
+    oceanbase::jni::SegmentCache& cache = oceanbase::jni::SegmentCache::instance();
+    std::vector<oceanbase::jni::PackedTokenBuffer> chunk_tokens(chunks.size());
+    std::vector<oceanbase::jni::TextSpan> missing;
+    std::vector<size_t> missing_index;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (!cache.lookup(cache_namespace_, chunks[i].data, chunks[i].length, chunk_tokens[i])) {
+            missing.push_back(chunks[i]);
+            missing_index.push_back(i);
+        }
+    }
+    
+    // Chunks not seen before (an edited paragraph) cross JNI together, each
+    // segmented by segment_batch exactly as segment_uncached would
+    if (!missing.empty()) {
+        std::vector<oceanbase::jni::PackedTokenBuffer> results;
+        int ret = segment_batch(missing, results);
+        if (ret != OBP_SUCCESS) {
+            return ret;
+        }
+        for (size_t i = 0; i < missing.size(); ++i) {
+            cache.insert(cache_namespace_, missing[i].data, missing[i].length, results[i]);
+            chunk_tokens[missing_index[i]] = std::move(results[i]);
+        }
+    }
+    
+    tokens.clear();
+    for (size_t i = 0; i < chunk_tokens.size(); ++i) {
+        if (tokens.append_packed(chunk_tokens[i].data(), chunk_tokens[i].size()) != 0) {
+            set_error(OBP_ALLOCATE_MEMORY_FAILED, "Failed to allocate Thai token buffer");
+            return OBP_ALLOCATE_MEMORY_FAILED;
+        }
+    }
+    return OBP_SUCCESS;
+}
+
+int ThaiJNIBridge::segment_uncached(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) {
+    // With native_ascii_runs a pure-ASCII document crosses neither JNI nor the segmentation pool
+    std::string buffer;
+    oceanbase::jni::TextSpan input;
+    if (!segmenter_input(text, length, buffer, input)) {
+        tokens.clear();
+        return append_native_tokens(text, length, tokens);
+    }
+    
+    // With the segmentation pool the document is segmented on one of its attached
+    // threads, into a heap buffer: tokens may live in this thread's scan arena,
+    // which only this thread may grow
+    int ret = OBP_SUCCESS;
+    oceanbase::jni::SegmentationPool* pool = oceanbase::jni::GlobalThreadManager::get_segmentation_pool(length);
+    if (pool) {
+        oceanbase::jni::PackedTokenBuffer pool_tokens;
+        ret = pool->run([this, &input, &pool_tokens]() {
+            return segment_on_current_thread(input.data, input.length, pool_tokens);
+        });
+        if (ret == OBP_SUCCESS && tokens.assign(pool_tokens.data(), pool_tokens.size()) != 0) {
+            set_error(OBP_ALLOCATE_MEMORY_FAILED, "Failed to allocate Thai token buffer");
+            ret = OBP_ALLOCATE_MEMORY_FAILED;
+        }
+    } else {
+        ret = segment_on_current_thread(input.data, input.length, tokens);
+    }
+    
+    if (ret == OBP_SUCCESS) {
+        ret = append_native_tokens(text, length, tokens);
+    }
+    return ret;
+}
+
+int ThaiJNIBridge::segment_on_current_thread(const char* text, size_t length,
+                                             oceanbase::jni::PackedTokenBuffer& tokens) {
     // Create scoped JNI environment for segmentation
     oceanbase::jni::ScopedJNIEnvironment jni_env(plugin_name_);
     
@@ -86,7 +295,352 @@ int ThaiJNIBridge::segment(const std::string& text, std::vector<std::string>& to
         return OBP_PLUGIN_ERROR;
     }
     
-    return do_segment(jni_env.get(), text, tokens);
+    return do_segment(jni_env.get(), text, length, tokens);
+}
+
+bool ThaiJNIBridge::segmenter_input(const char* text, size_t length, std::string& buffer,
+                                    oceanbase::jni::TextSpan& input) const {
+    if (!config_.native_ascii_runs) {
+        input = oceanbase::jni::TextSpan(text, length);
+        return true;
+    }
+    
+    // Only chunks with non-ASCII text need the segmenter, the rest is tokenized here
+    if (!splitter_.collect_segmenter_text(text, length, buffer)) {
+        return false;
+    }
+    input = oceanbase::jni::TextSpan(buffer.data(), buffer.size());
+    return true;
+}
+
+int ThaiJNIBridge::append_native_tokens(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) {
+    if (!config_.native_ascii_runs) {
+        return OBP_SUCCESS;
+    }
+    if (splitter_.append_native_tokens(text, length, tokens) != 0) {
+        set_error(OBP_ALLOCATE_MEMORY_FAILED, "Failed to allocate Thai native token buffer");
+        return OBP_ALLOCATE_MEMORY_FAILED;
+    }
+    return OBP_SUCCESS;
+}
+
+int ThaiJNIBridge::segment_batch(const std::vector<oceanbase::jni::TextSpan>& docs,
+                                 std::vector<oceanbase::jni::PackedTokenBuffer>& results) {
+    if (!is_initialized_) {
+        set_error(OBP_PLUGIN_ERROR, "Thai JNI bridge not initialized");
+        return OBP_PLUGIN_ERROR;
+    }
+    
+    clear_error();
+    results.clear();
+    results.resize(docs.size());
+    
+    // Each document reaches the segmenter as it would alone, through
+    // segmenter_input(); documents without non-ASCII text do not reach it
+    std::vector<std::string> buffers(docs.size());
+    std::vector<oceanbase::jni::TextSpan> inputs;
+    std::vector<size_t> input_index;
+    for (size_t i = 0; i < docs.size(); ++i) {
+        oceanbase::jni::TextSpan input;
+        if (segmenter_input(docs[i].data, docs[i].length, buffers[i], input)) {
+            inputs.push_back(input);
+            input_index.push_back(i);
+        }
+    }
+    
+    // Split so that one call never carries more than max_batch_bytes of input,
+    // a single larger document still goes alone; each part acquires its own
+    // JNI environment, so on the segmentation pool the parts run in parallel
+    std::vector<oceanbase::jni::PackedTokenBuffer> segmented(inputs.size());
+    std::vector<oceanbase::jni::SegmentationPool::Job> parts;
+    size_t total_bytes = 0;
+    size_t begin = 0;
+    while (begin < inputs.size()) {
+        size_t end = begin;
+        size_t input_bytes = 0;
+        while (end < inputs.size() &&
+               (end == begin || input_bytes + sizeof(int32_t) + inputs[end].length <= config_.max_batch_bytes)) {
+            input_bytes += sizeof(int32_t) + inputs[end].length;
+            ++end;
+        }
+        parts.push_back([this, &inputs, begin, end, input_bytes, &segmented]() {
+            return segment_batch_part(inputs, begin, end, input_bytes, segmented);
+        });
+        total_bytes += input_bytes;
+        begin = end;
+    }
+    
+    int ret = OBP_SUCCESS;
+    oceanbase::jni::SegmentationPool* pool = oceanbase::jni::GlobalThreadManager::get_segmentation_pool(total_bytes);
+    if (pool) {
+        ret = pool->run(parts);
+    } else {
+        for (size_t i = 0; i < parts.size() && ret == OBP_SUCCESS; ++i) {
+            ret = parts[i]();
+        }
+    }
+    
+    for (size_t i = 0; i < inputs.size() && ret == OBP_SUCCESS; ++i) {
+        results[input_index[i]] = std::move(segmented[i]);
+    }
+    for (size_t i = 0; i < docs.size() && ret == OBP_SUCCESS; ++i) {
+        ret = append_native_tokens(docs[i].data, docs[i].length, results[i]);
+    }
+    return ret;
+}
+
+int ThaiJNIBridge::segment_batch_part(const std::vector<oceanbase::jni::TextSpan>& docs,
+                                      size_t begin, size_t end, size_t input_bytes,
+                                      std::vector<oceanbase::jni::PackedTokenBuffer>& results) {
+    oceanbase::jni::ScopedJNIEnvironment jni_env(plugin_name_);
+    
+    if (!jni_env) {
+        set_error(OBP_PLUGIN_ERROR, "Failed to acquire JNI environment for Thai batch segmentation");
+        return OBP_PLUGIN_ERROR;
+    }
+    
+    if (!segment_batch_method_) {
+        // No batch entry point: still one environment, but one call per document
+        int ret = OBP_SUCCESS;
+        for (size_t i = begin; i < end && ret == OBP_SUCCESS; ++i) {
+            ret = do_segment(jni_env.get(), docs[i].data, docs[i].length, results[i]);
+        }
+        return ret;
+    }
+    return do_segment_batch(jni_env.get(), docs, begin, end, input_bytes, results);
+}
+
+int ThaiJNIBridge::check_document(const char* text, size_t length) {
+    if (oceanbase::jni::Utf8Kernel::validate(text, length)) {
+        return OBP_SUCCESS;
+    }
+    if (config_.reject_invalid_utf8) {
+        set_error(OBP_INVALID_ARGUMENT, "Thai document is not valid UTF-8");
+        return OBP_INVALID_ARGUMENT;
+    }
+    // Java decodes malformed sequences as U+FFFD
+    JNI_LOG_WARN("Thai document is not valid UTF-8 (%zu bytes), malformed sequences are replaced", length);
+    return OBP_SUCCESS;
+}
+
+// Token cursor of one streamed document, closed with the scan: the chunks of
+// the Java cursor, then the natively tokenized ASCII chunks of the document.
+// With the segmentation pool every call into Java runs on a pool thread
+class ThaiJNICursor : public oceanbase::jni::SegmenterCursor {
+public:
+    ThaiJNICursor(ThaiJNIBridge* bridge, const char* text, size_t length)
+        : bridge_(bridge), text_(text), length_(length), java_cursor_(nullptr), native_done_(false)
+        , pool_(oceanbase::jni::GlobalThreadManager::get_segmentation_pool(length)) {}
+    
+    ~ThaiJNICursor() override {
+        close_java_cursor();
+    }
+    
+    // Open the Java cursor over the text the segmenter needs, if there is any
+    int open() {
+        oceanbase::jni::TextSpan input;
+        if (!bridge_->segmenter_input(text_, length_, segmenter_text_, input)) {
+            return OBP_SUCCESS;
+        }
+        return run([this, &input]() {
+            return bridge_->open_cursor(input.data, input.length, java_cursor_);
+        });
+    }
+    
+    int next_chunk(oceanbase::jni::PackedTokenBuffer& tokens) override {
+        if (java_cursor_) {
+            int ret = fetch_java_chunk(tokens);
+            if (ret != OBP_SUCCESS || tokens.size() > 0) {
+                return ret;
+            }
+            close_java_cursor();
+        }
+        
+        tokens.clear();
+        if (native_done_) {
+            return OBP_SUCCESS;
+        }
+        native_done_ = true;
+        return bridge_->append_native_tokens(text_, length_, tokens);
+    }
+
+private:
+    int run(const oceanbase::jni::SegmentationPool::Job& job) {
+        return pool_ ? pool_->run(job) : job();
+    }
+    
+    // A pool thread fills a heap buffer: tokens may live in the scan arena,
+    // which only the scan thread may grow
+    int fetch_java_chunk(oceanbase::jni::PackedTokenBuffer& tokens) {
+        if (!pool_) {
+            return bridge_->next_chunk(java_cursor_, tokens);
+        }
+        int ret = run([this]() {
+            return bridge_->next_chunk(java_cursor_, chunk_);
+        });
+        if (ret == OBP_SUCCESS && tokens.assign(chunk_.data(), chunk_.size()) != 0) {
+            bridge_->set_error(OBP_ALLOCATE_MEMORY_FAILED, "Failed to allocate Thai token buffer");
+            ret = OBP_ALLOCATE_MEMORY_FAILED;
+        }
+        return ret;
+    }
+    
+    void close_java_cursor() {
+        if (java_cursor_) {
+            run([this]() {
+                bridge_->close_cursor(java_cursor_);
+                return OBP_SUCCESS;
+            });
+            java_cursor_ = nullptr;
+        }
+    }
+    
+    ThaiJNIBridge* bridge_;
+    const char* text_;
+    size_t length_;
+    // Read by the Java cursor until it is closed
+    std::string segmenter_text_;
+    jobject java_cursor_;
+    bool native_done_;
+    oceanbase::jni::SegmentationPool* pool_;
+    // Chunk written by a pool thread
+    oceanbase::jni::PackedTokenBuffer chunk_;
+};
+
+bool ThaiJNIBridge::should_stream(size_t length) const {
+    return open_cursor_method_ && config_.streaming_threshold_bytes > 0 &&
+           length >= config_.streaming_threshold_bytes;
+}
+
+int ThaiJNIBridge::open_cursor(const char* text, size_t length, jobject& cursor) {
+    cursor = nullptr;
+    if (!is_initialized_ || !open_cursor_method_) {
+        set_error(OBP_PLUGIN_ERROR, "Thai streaming segmentation not available");
+        return OBP_PLUGIN_ERROR;
+    }
+    
+    clear_error();
+    
+    oceanbase::jni::ScopedJNIEnvironment jni_env(plugin_name_);
+    
+    if (!jni_env) {
+        set_error(OBP_PLUGIN_ERROR, "Failed to acquire JNI environment for Thai streaming segmentation");
+        return OBP_PLUGIN_ERROR;
+    }
+    
+    JNIEnv* env = jni_env.get();
+    jobject jtext = oceanbase::jni::JNIUtils::cpp_bytes_to_direct_buffer(env, text, length);
+    if (!jtext) {
+        set_error(OBP_PLUGIN_ERROR, "Failed to pass text to Java for Thai streaming segmentation");
+        return OBP_PLUGIN_ERROR;
+    }
+    
+    // The cursor keeps reading the document buffer until it is closed
+    jobject local_cursor = env->CallObjectMethod(segmenter_instance_, open_cursor_method_, jtext);
+    env->DeleteLocalRef(jtext);
+    std::string error_msg;
+    if (oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg)) {
+        set_error(OBP_PLUGIN_ERROR, "Thai openCursor failed: " + error_msg);
+        return OBP_PLUGIN_ERROR;
+    }
+    if (!local_cursor) {
+        set_error(OBP_PLUGIN_ERROR, "Thai openCursor returned null cursor");
+        return OBP_PLUGIN_ERROR;
+    }
+    
+    cursor = env->NewGlobalRef(local_cursor);
+    env->DeleteLocalRef(local_cursor);
+    if (!cursor) {
+        set_error(OBP_PLUGIN_ERROR, "Failed to create global reference for Thai token cursor");
+        return OBP_PLUGIN_ERROR;
+    }
+    return OBP_SUCCESS;
+}
+
+int ThaiJNIBridge::open_cursor(const char* text, size_t length,
+                          std::unique_ptr<oceanbase::jni::SegmenterCursor>& cursor) {
+    cursor.reset();
+    std::unique_ptr<ThaiJNICursor> document_cursor(new (std::nothrow) ThaiJNICursor(this, text, length));
+    if (!document_cursor) {
+        set_error(OBP_ALLOCATE_MEMORY_FAILED, "Failed to allocate Thai token cursor");
+        return OBP_ALLOCATE_MEMORY_FAILED;
+    }
+    
+    int ret = document_cursor->open();
+    if (ret != OBP_SUCCESS) {
+        return ret;
+    }
+    cursor = std::move(document_cursor);
+    return OBP_SUCCESS;
+}
+
+int ThaiJNIBridge::next_chunk(jobject cursor, oceanbase::jni::PackedTokenBuffer& tokens) {
+    tokens.clear();
+    
+    oceanbase::jni::ScopedJNIEnvironment jni_env(plugin_name_);
+    
+    if (!jni_env) {
+        set_error(OBP_PLUGIN_ERROR, "Failed to acquire JNI environment for Thai streaming segmentation");
+        return OBP_PLUGIN_ERROR;
+    }
+    
+    JNIEnv* env = jni_env.get();
+    std::string error_msg;
+    
+    // One chunk normally fits; a single token larger than the chunk gets one retry
+    size_t capacity = config_.streaming_chunk_bytes;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (tokens.reserve(capacity) != 0) {
+            set_error(OBP_ALLOCATE_MEMORY_FAILED, "Failed to allocate Thai token buffer");
+            return OBP_ALLOCATE_MEMORY_FAILED;
+        }
+        
+        jobject joutput = oceanbase::jni::JNIUtils::cpp_bytes_to_direct_buffer(
+            env, tokens.data(), tokens.capacity());
+        if (!joutput) {
+            set_error(OBP_PLUGIN_ERROR, "Failed to wrap Thai token buffer for Java");
+            return OBP_PLUGIN_ERROR;
+        }
+        
+        jint used = env->CallIntMethod(segmenter_instance_, next_tokens_method_, cursor, joutput);
+        env->DeleteLocalRef(joutput);
+        if (oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg)) {
+            set_error(OBP_PLUGIN_ERROR, "Thai nextTokens failed: " + error_msg);
+            return OBP_PLUGIN_ERROR;
+        }
+        
+        if (used >= 0) {
+            tokens.set_size(static_cast<size_t>(used));
+            return OBP_SUCCESS;
+        }
+        
+        // Next token larger than the chunk, Java returned the negated required size
+        capacity = static_cast<size_t>(-static_cast<int64_t>(used));
+    }
+    
+    set_error(OBP_PLUGIN_ERROR, "Thai token cursor result does not fit in the token buffer");
+    return OBP_PLUGIN_ERROR;
+}
+
+void ThaiJNIBridge::close_cursor(jobject cursor) {
+    if (!cursor) {
+        return;
+    }
+    
+    oceanbase::jni::ScopedJNIEnvironment jni_env(plugin_name_);
+    
+    if (!jni_env) {
+        JNI_LOG_WARN("Failed to acquire JNI environment to close Thai token cursor");
+        return;
+    }
+    
+    JNIEnv* env = jni_env.get();
+    env->CallVoidMethod(segmenter_instance_, close_cursor_method_, cursor);
+    std::string error_msg;
+    if (oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg)) {
+        JNI_LOG_WARN("Failed to close Thai token cursor: %s", error_msg.c_str());
+    }
+    env->DeleteGlobalRef(cursor);
 }
 
 int ThaiJNIBridge::load_java_classes(JNIEnv* env) {
@@ -123,11 +677,101 @@ int ThaiJNIBridge::load_java_classes(JNIEnv* env) {
         return OBP_PLUGIN_ERROR;
     }
     
+    // Get direct ByteBuffer segment method ID (optional, String input is the fallback)
+    if (config_.use_direct_buffer_input) {
+        segment_buffer_method_ = env->GetMethodID(segmenter_class_, config_.segment_method_name.c_str(), 
+                                                 "(Ljava/nio/ByteBuffer;)[Ljava/lang/String;");
+        if (oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg) || !segment_buffer_method_) {
+            JNI_LOG_WARN("Thai segmenter has no ByteBuffer input method, falling back to String input");
+            segment_buffer_method_ = nullptr;
+        }
+    }
+    
+    // Get packed output method ID (optional, needs direct ByteBuffer input)
+    if (segment_buffer_method_ && config_.use_packed_token_output) {
+        segment_into_method_ = env->GetMethodID(segmenter_class_, config_.segment_into_method_name.c_str(), 
+                                               "(Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;)I");
+        if (oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg) || !segment_into_method_) {
+            JNI_LOG_WARN("Thai segmenter has no packed output method, falling back to String[] output");
+            segment_into_method_ = nullptr;
+        }
+    }
+    
+    // Get batch method ID (optional, uses the same packed layout)
+    if (segment_into_method_) {
+        segment_batch_method_ = env->GetMethodID(segmenter_class_, config_.segment_batch_method_name.c_str(), 
+                                                "(Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;)I");
+        if (oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg) || !segment_batch_method_) {
+            JNI_LOG_WARN("Thai segmenter has no batch method, batches fall back to one call per document");
+            segment_batch_method_ = nullptr;
+        }
+    }
+    
+    // Get token cursor method IDs (optional, streaming uses the packed layout)
+    if (segment_into_method_ && config_.streaming_threshold_bytes > 0) {
+        std::string cursor_type = "L" + config_.segmenter_class_name + "$TokenCursor;";
+        std::string open_signature = "(Ljava/nio/ByteBuffer;)" + cursor_type;
+        std::string next_signature = "(" + cursor_type + "Ljava/nio/ByteBuffer;)I";
+        std::string close_signature = "(" + cursor_type + ")V";
+        open_cursor_method_ = env->GetMethodID(segmenter_class_, config_.open_cursor_method_name.c_str(), 
+                                              open_signature.c_str());
+        if (open_cursor_method_) {
+            next_tokens_method_ = env->GetMethodID(segmenter_class_, config_.next_tokens_method_name.c_str(), 
+                                                  next_signature.c_str());
+        }
+        if (next_tokens_method_) {
+            close_cursor_method_ = env->GetMethodID(segmenter_class_, config_.close_cursor_method_name.c_str(), 
+                                                   close_signature.c_str());
+        }
+        if (oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg) || !close_cursor_method_) {
+            JNI_LOG_WARN("Thai segmenter has no token cursor methods, large documents are segmented up front");
+            open_cursor_method_ = nullptr;
+            next_tokens_method_ = nullptr;
+            close_cursor_method_ = nullptr;
+        }
+    }
+    
+    // Create the segmenter once and share it across calls (segment() is thread-safe)
+    jobject local_segmenter = env->NewObject(segmenter_class_, constructor_method_);
+    if (!local_segmenter || oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg)) {
+        set_error(OBP_PLUGIN_ERROR, "Failed to create Thai segmenter instance: " + error_msg);
+        return OBP_PLUGIN_ERROR;
+    }
+    
+    segmenter_instance_ = env->NewGlobalRef(local_segmenter);
+    env->DeleteLocalRef(local_segmenter);
+    if (!segmenter_instance_) {
+        set_error(OBP_PLUGIN_ERROR, "Failed to create global reference for Thai segmenter instance");
+        return OBP_PLUGIN_ERROR;
+    }
+    
+    // Cached results, in memory and on disk, are only reused under the same
+    // analyzer chain: changing filters, dictionary mode or stop words with
+    // the same jars must not serve the old tokens
+    std::string fingerprint;
+    jmethodID fingerprint_method = env->GetMethodID(segmenter_class_, 
+                                                  config_.pipeline_fingerprint_method_name.c_str(), 
+                                                  "()Ljava/lang/String;");
+    if (oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg) || !fingerprint_method) {
+        JNI_LOG_WARN("Thai segmenter has no pipeline fingerprint, cached results are keyed by its class path only");
+    } else {
+        jstring jfingerprint = (jstring)env->CallObjectMethod(segmenter_instance_, fingerprint_method);
+        if (oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg) || !jfingerprint) {
+            JNI_LOG_WARN("Failed to read the Thai segmenter's pipeline fingerprint: %s", error_msg.c_str());
+        } else {
+            fingerprint = oceanbase::jni::JNIUtils::jstring_to_cpp_string(env, jfingerprint);
+            env->DeleteLocalRef(jfingerprint);
+        }
+    }
+    cache_namespace_ = oceanbase::jni::SegmentCache::make_namespace(
+        std::to_string(cache_namespace_) + "|" + fingerprint);
+    JNI_LOG_INFO("Thai segmenter pipeline: %s", fingerprint.c_str());
+    
     return OBP_SUCCESS;
 }
 
-int ThaiJNIBridge::do_segment(JNIEnv* env, const std::string& text, std::vector<std::string>& tokens) {
-    std::string error_msg;
+int ThaiJNIBridge::do_segment(JNIEnv* env, const char* text, size_t length, 
+                               oceanbase::jni::PackedTokenBuffer& tokens) {
     tokens.clear();
     
     // Push local frame for automatic local reference cleanup
@@ -136,54 +780,217 @@ int ThaiJNIBridge::do_segment(JNIEnv* env, const std::string& text, std::vector<
         return OBP_PLUGIN_ERROR;
     }
     
-    // Convert C++ string to Java string
-    jstring jtext = oceanbase::jni::JNIUtils::cpp_string_to_jstring(env, text);
+    // Pass the original bytes as a direct ByteBuffer, or fall back to a Java string copy
+    jobject jtext = nullptr;
+    jmethodID method = segment_method_;
+    if (segment_buffer_method_) {
+        jtext = oceanbase::jni::JNIUtils::cpp_bytes_to_direct_buffer(env, text, length);
+        method = segment_buffer_method_;
+    } else {
+        jtext = oceanbase::jni::JNIUtils::cpp_string_to_jstring(env, std::string(text, length));
+    }
     if (!jtext) {
         env->PopLocalFrame(nullptr);
-        set_error(OBP_PLUGIN_ERROR, "Failed to convert text to Java string for Thai segmentation");
+        set_error(OBP_PLUGIN_ERROR, "Failed to pass text to Java for Thai segmentation");
         return OBP_PLUGIN_ERROR;
     }
     
-    // Create Thai segmenter instance
-    jobject local_segmenter = env->NewObject(segmenter_class_, constructor_method_);
-    if (!local_segmenter || oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg)) {
-        env->PopLocalFrame(nullptr);
-        set_error(OBP_PLUGIN_ERROR, "Failed to create Thai segmenter instance: " + error_msg);
+    int ret = segment_into_method_ ? do_segment_packed(env, jtext, length, tokens)
+                                   : do_segment_array(env, method, jtext, tokens);
+    
+    // Pop local frame to clean up local references
+    env->PopLocalFrame(nullptr);
+    
+    return ret;
+}
+
+int ThaiJNIBridge::do_segment_packed(JNIEnv* env, jobject jtext, size_t length, 
+                                      oceanbase::jni::PackedTokenBuffer& tokens) {
+    std::string error_msg;
+    
+    // Large enough for almost every document; otherwise retry once with the size Java asks for
+    size_t capacity = length * 3 + 256;
+    
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (tokens.reserve(capacity) != 0) {
+            set_error(OBP_ALLOCATE_MEMORY_FAILED, "Failed to allocate Thai token buffer");
+            return OBP_ALLOCATE_MEMORY_FAILED;
+        }
+        
+        jobject joutput = oceanbase::jni::JNIUtils::cpp_bytes_to_direct_buffer(
+            env, tokens.data(), tokens.capacity());
+        if (!joutput) {
+            set_error(OBP_PLUGIN_ERROR, "Failed to wrap Thai token buffer for Java");
+            return OBP_PLUGIN_ERROR;
+        }
+        
+        // Call segmentInto, tokens are written straight into C++ memory
+        jint used = env->CallIntMethod(segmenter_instance_, segment_into_method_, jtext, joutput);
+        env->DeleteLocalRef(joutput);
+        if (oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg)) {
+            set_error(OBP_PLUGIN_ERROR, "Thai segmentation failed: " + error_msg);
+            return OBP_PLUGIN_ERROR;
+        }
+        
+        if (used >= 0) {
+            tokens.set_size(static_cast<size_t>(used));
+            return OBP_SUCCESS;
+        }
+        
+        // Buffer too small, Java returned the negated required size
+        capacity = static_cast<size_t>(-static_cast<int64_t>(used));
+    }
+    
+    set_error(OBP_PLUGIN_ERROR, "Thai segmentation result does not fit in the token buffer");
+    return OBP_PLUGIN_ERROR;
+}
+
+int ThaiJNIBridge::do_segment_batch(JNIEnv* env, const std::vector<oceanbase::jni::TextSpan>& docs,
+                                    size_t begin, size_t end, size_t input_bytes,
+                                    std::vector<oceanbase::jni::PackedTokenBuffer>& results) {
+    // Pack the documents back to back: int32 byte length followed by the UTF-8 bytes,
+    // remembering where each one starts so a partial call can be resumed
+    std::unique_ptr<char[]> input(new (std::nothrow) char[input_bytes]);
+    std::vector<size_t> offsets;
+    if (!input) {
+        set_error(OBP_ALLOCATE_MEMORY_FAILED, "Failed to allocate Thai batch input buffer");
+        return OBP_ALLOCATE_MEMORY_FAILED;
+    }
+    offsets.reserve(end - begin);
+    size_t pos = 0;
+    for (size_t i = begin; i < end; ++i) {
+        if (docs[i].length > static_cast<size_t>(INT32_MAX)) {
+            set_error(OBP_INVALID_ARGUMENT, "Document too large for Thai batch segmentation");
+            return OBP_INVALID_ARGUMENT;
+        }
+        int32_t length = static_cast<int32_t>(docs[i].length);
+        offsets.push_back(pos);
+        memcpy(input.get() + pos, &length, sizeof(length));
+        pos += sizeof(length);
+        if (length > 0) {
+            memcpy(input.get() + pos, docs[i].data, docs[i].length);
+            pos += docs[i].length;
+        }
+    }
+    
+    if (env->PushLocalFrame(16) < 0) {
+        set_error(OBP_PLUGIN_ERROR, "Failed to push local frame for Thai batch segmentation");
         return OBP_PLUGIN_ERROR;
     }
     
-    // Call segment method
-    jobjectArray jresult = (jobjectArray)env->CallObjectMethod(local_segmenter, segment_method_, jtext);
+    // Raw storage for the per-document token blocks Java writes back
+    oceanbase::jni::PackedTokenBuffer output;
+    size_t capacity = input_bytes * 3 + 256 * (end - begin);
+    std::string error_msg;
+    int ret = OBP_SUCCESS;
+    size_t next = begin;
+    
+    while (next < end && ret == OBP_SUCCESS) {
+        if (output.reserve(capacity) != 0) {
+            set_error(OBP_ALLOCATE_MEMORY_FAILED, "Failed to allocate Thai batch token buffer");
+            ret = OBP_ALLOCATE_MEMORY_FAILED;
+            break;
+        }
+        
+        size_t offset = offsets[next - begin];
+        jobject jinput = oceanbase::jni::JNIUtils::cpp_bytes_to_direct_buffer(
+            env, input.get() + offset, input_bytes - offset);
+        jobject joutput = oceanbase::jni::JNIUtils::cpp_bytes_to_direct_buffer(
+            env, output.data(), output.capacity());
+        if (!jinput || !joutput) {
+            set_error(OBP_PLUGIN_ERROR, "Failed to wrap Thai batch buffers for Java");
+            ret = OBP_PLUGIN_ERROR;
+            break;
+        }
+        
+        // Java segments documents in order until the next one does not fit
+        jint used = env->CallIntMethod(segmenter_instance_, segment_batch_method_, jinput, joutput);
+        env->DeleteLocalRef(jinput);
+        env->DeleteLocalRef(joutput);
+        if (oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg)) {
+            set_error(OBP_PLUGIN_ERROR, "Thai batch segmentation failed: " + error_msg);
+            ret = OBP_PLUGIN_ERROR;
+            break;
+        }
+        
+        if (used < 0) {
+            // Not even the next document fits, Java returned the negated size it needs
+            size_t required = static_cast<size_t>(-static_cast<int64_t>(used));
+            if (required <= capacity) {
+                set_error(OBP_PLUGIN_ERROR, "Thai batch segmentation returned a malformed result");
+                ret = OBP_PLUGIN_ERROR;
+                break;
+            }
+            capacity = required;
+            continue;
+        }
+        
+        // Split the output into one token buffer per completed document
+        size_t consumed = 0;
+        while (next < end && consumed + sizeof(int32_t) <= static_cast<size_t>(used)) {
+            int32_t block_size = 0;
+            memcpy(&block_size, output.data() + consumed, sizeof(block_size));
+            consumed += sizeof(block_size);
+            if (block_size < 0 || consumed + block_size > static_cast<size_t>(used)) {
+                break;
+            }
+            if (results[next].assign(output.data() + consumed, block_size) != 0) {
+                set_error(OBP_ALLOCATE_MEMORY_FAILED, "Failed to allocate Thai batch token buffer");
+                ret = OBP_ALLOCATE_MEMORY_FAILED;
+                break;
+            }
+            consumed += block_size;
+            ++next;
+        }
+        if (ret == OBP_SUCCESS && consumed != static_cast<size_t>(used)) {
+            set_error(OBP_PLUGIN_ERROR, "Thai batch segmentation returned a malformed result");
+            ret = OBP_PLUGIN_ERROR;
+        }
+    }
+    
+    // Pop local frame (automatic cleanup)
+    env->PopLocalFrame(nullptr);
+    return ret;
+}
+
+int ThaiJNIBridge::do_segment_array(JNIEnv* env, jmethodID method, jobject jtext, 
+                                     oceanbase::jni::PackedTokenBuffer& tokens) {
+    std::string error_msg;
+    
+    // Call segment method on the shared segmenter instance
+    jobjectArray jresult = (jobjectArray)env->CallObjectMethod(segmenter_instance_, method, jtext);
     if (oceanbase::jni::JNIUtils::check_and_handle_exception(env, error_msg)) {
-        env->PopLocalFrame(nullptr);
         set_error(OBP_PLUGIN_ERROR, "Thai segmentation failed: " + error_msg);
         return OBP_PLUGIN_ERROR;
     }
     
     if (!jresult) {
-        env->PopLocalFrame(nullptr);
         set_error(OBP_PLUGIN_ERROR, "Thai segmentation returned null result");
         return OBP_PLUGIN_ERROR;
     }
     
-    // Convert result to C++ vector
-    int ret = oceanbase::jni::JNIUtils::jstring_array_to_cpp_vector(env, jresult, tokens);
-    
-    // Pop local frame to clean up local references
-    env->PopLocalFrame(nullptr);
-    
+    // Convert result to packed tokens
+    std::vector<std::string> token_list;
+    int ret = oceanbase::jni::JNIUtils::jstring_array_to_cpp_vector(env, jresult, token_list);
     if (ret != OBP_SUCCESS) {
         set_error(OBP_PLUGIN_ERROR, "Failed to convert Thai segmentation result to C++ vector");
         return ret;
     }
     
+    for (const auto& token : token_list) {
+        if (tokens.append(token.data(), token.size()) != 0) {
+            set_error(OBP_ALLOCATE_MEMORY_FAILED, "Failed to allocate Thai token buffer");
+            return OBP_ALLOCATE_MEMORY_FAILED;
+        }
+    }
+    
     return OBP_SUCCESS;
 }
 
 void ThaiJNIBridge::set_error(int code, const std::string& message) {
     last_error_code_ = code;
     last_error_message_ = message;
-    std::cout << "[ERROR][ThaiJNIBridge] " << message << std::endl;
+    JNI_LOG_ERROR("[ThaiJNIBridge] %s", message.c_str());
 }
 
 void ThaiJNIBridge::clear_error() {
@@ -192,6 +999,25 @@ void ThaiJNIBridge::clear_error() {
 }
 
 // ThaiJNIBridgeManager implementation
+// Factory of the "jvm" backend: the manager's shared bridge
+static std::shared_ptr<oceanbase::jni::SegmenterBackend> create_jvm_backend() {
+    return ThaiJNIBridgeManager::get_instance().get_bridge();
+}
+
+static std::shared_ptr<oceanbase::jni::SegmenterBackend> create_native_backend() {
+    return std::make_shared<ThaiNativeSegmenter>();
+}
+
+static std::shared_ptr<oceanbase::jni::SegmenterBackend> create_bigram_backend() {
+    return std::make_shared<oceanbase::jni::BigramSegmenter>("thai_ftparser");
+}
+
+ThaiJNIBridgeManager::ThaiJNIBridgeManager() {
+    oceanbase::jni::SegmenterBackendRegistry::register_backend("thai_ftparser", "jvm", &create_jvm_backend);
+    oceanbase::jni::SegmenterBackendRegistry::register_backend("thai_ftparser", "native", &create_native_backend);
+    oceanbase::jni::SegmenterBackendRegistry::register_backend("thai_ftparser", "bigram", &create_bigram_backend);
+}
+
 ThaiJNIBridgeManager& ThaiJNIBridgeManager::get_instance() {
     static ThaiJNIBridgeManager instance;
     return instance;
@@ -205,17 +1031,186 @@ std::shared_ptr<ThaiJNIBridge> ThaiJNIBridgeManager::get_bridge() {
     return bridge_;
 }
 
+std::shared_ptr<oceanbase::jni::SegmenterBackend> ThaiJNIBridgeManager::get_backend() {
+    std::call_once(backend_once_, [this]() {
+        std::string name = oceanbase::jni::JNIConfigUtils::get_plugin_backend("thai_ftparser");
+        backend_ = oceanbase::jni::SegmenterBackendRegistry::create("thai_ftparser", name);
+        if (!backend_) {
+            JNI_LOG_ERROR("Unknown thai_ftparser backend '%s', available: %s", name.c_str(),
+                          oceanbase::jni::SegmenterBackendRegistry::backend_names("thai_ftparser").c_str());
+        } else {
+            JNI_LOG_INFO("thai_ftparser uses the '%s' segmenter backend", backend_->name());
+        }
+    });
+    return backend_;
+}
+
 int ThaiJNIBridgeManager::initialize() {
-    auto bridge = get_bridge();
-    return bridge ? bridge->initialize() : OBP_PLUGIN_ERROR;
+    // Scans arriving during the warm-up wait for it instead of racing to initialize
+    int ret = OBP_SUCCESS;
+    if (warmup_.wait(ret) && ret == OBP_SUCCESS) {
+        return OBP_SUCCESS;
+    }
+    
+    auto backend = get_backend();
+    return backend ? backend->initialize() : OBP_PLUGIN_ERROR;
+}
+
+// Bundled training corpus, replayed when OCEANBASE_JNI_WARMUP_CORPUS is not set
+static const char* const TRAINING_CORPUS[] = {
+    "ภาษาไทยเป็นภาษาที่สวยงาม",
+    "OceanBase เป็นฐานข้อมูลเชิงสัมพันธ์แบบกระจาย",
+    "การสร้างดัชนีค้นหาข้อความเต็มช่วยให้ค้นหาได้เร็วขึ้น",
+    "ตัวตัดคำแบ่งประโยคออกเป็นคำ",
+    "เมื่อวานนี้ที่ประชุมได้หารือเรื่องงบประมาณของปีหน้า",
+    "สินค้านี้จัดส่งฟรีและจะถึงภายในวันพรุ่งนี้",
+    "ในฤดูหนาวมีนักท่องเที่ยวจำนวนมากเดินทางไปเชียงใหม่",
+    "หากระบบขัดข้องโปรดตรวจสอบไฟล์บันทึก",
+    "เธอชอบร้องเพลงไปพร้อมกับเล่นเปียโน",
+    "เราปรับแต่งคำสั่งค้นหาเพื่อเพิ่มประสิทธิภาพของฐานข้อมูล",
+};
+
+// Run the analysis chain until the JIT has compiled it, so that the first
+// real scans do not pay for the interpreter; stops early when the plugin
+// is unloaded
+static void replay_training_corpus(oceanbase::jni::SegmenterBackend& backend,
+                                   const oceanbase::jni::BackendWarmup& warmup) {
+    const oceanbase::jni::JNIConfig& config = oceanbase::jni::JNIConfigUtils::get_config();
+    if (config.warmup_documents == 0) {
+        return;
+    }
+    
+    std::vector<std::string> corpus;
+    if (!config.warmup_corpus.empty()) {
+        std::string error;
+        if (oceanbase::jni::TrainingReplay::load_corpus(config.warmup_corpus, corpus, error) != 0) {
+            JNI_LOG_WARN("thai_ftparser warm-up corpus not used: %s", error.c_str());
+            corpus.clear();
+        }
+    }
+    if (corpus.empty()) {
+        corpus.assign(TRAINING_CORPUS, TRAINING_CORPUS + sizeof(TRAINING_CORPUS) / sizeof(TRAINING_CORPUS[0]));
+    }
+    
+    oceanbase::jni::TrainingReplay::Options options;
+    options.max_documents = config.warmup_documents;
+    options.min_documents = std::min(options.min_documents, options.max_documents);
+    options.cancel = [&warmup]() { return warmup.stop_requested(); };
+    oceanbase::jni::TrainingReplayReport report;
+    int ret = oceanbase::jni::TrainingReplay(options).run(
+        corpus,
+        [&backend](const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) {
+            return backend.segment_uncached(text, length, tokens);
+        },
+        report);
+    if (ret != OBP_SUCCESS) {
+        JNI_LOG_WARN("thai_ftparser warm-up replay stopped after %zu documents (error %d)", report.documents, ret);
+        return;
+    }
+    if (report.cancelled) {
+        JNI_LOG_INFO("thai_ftparser warm-up replay cancelled after %zu documents", report.documents);
+        return;
+    }
+    JNI_LOG_INFO("thai_ftparser warm-up replayed %zu documents in %lld ms, %.1f -> %.1f ns/byte, %s",
+                 report.documents, static_cast<long long>(report.elapsed_ms), report.first_ns_per_byte,
+                 report.last_ns_per_byte, report.settled ? "settled" : "stopped at the limit");
+}
+
+int ThaiJNIBridgeManager::warm_up() {
+    auto backend = get_backend();
+    int ret = backend ? backend->initialize() : OBP_PLUGIN_ERROR;
+    if (ret == OBP_SUCCESS) {
+        static const char SAMPLE[] = "ภาษาไทยเป็นภาษาที่สวยงาม";
+        oceanbase::jni::PackedTokenBuffer tokens;
+        ret = backend->segment(SAMPLE, sizeof(SAMPLE) - 1, tokens);
+    }
+    return ret;
+}
+
+void ThaiJNIBridgeManager::start_warmup() {
+    if (!oceanbase::jni::JNIConfigUtils::get_config().warmup) {
+        return;
+    }
+    bool started = warmup_.start([this]() { return warm_up(); }, [](int result, int64_t time_to_ready_ms) {
+        if (result == OBP_SUCCESS) {
+            JNI_LOG_INFO("thai_ftparser warm-up finished, ready %lld ms after plugin init",
+                         static_cast<long long>(time_to_ready_ms));
+        } else {
+            JNI_LOG_WARN("thai_ftparser warm-up failed after %lld ms (error %d), scans initialize on first use",
+                         static_cast<long long>(time_to_ready_ms), result);
+        }
+    }, [this]() {
+        // After readiness, so scans do not wait for the replay; a failed
+        // replay only leaves the segmenter colder
+        auto backend = get_backend();
+        if (backend) {
+            replay_training_corpus(*backend, warmup_);
+        }
+    });
+    if (started) {
+        JNI_LOG_INFO("thai_ftparser warm-up started in the background");
+    }
+}
+
+void ThaiJNIBridgeManager::stop_warmup() {
+    warmup_.join();
 }
 
 // Plugin parser structure
 struct ThaiParserState {
-    std::vector<std::string> tokens;
-    size_t current_token_index;
+    oceanbase::jni::PackedTokenBuffer tokens;
+    // Set when the document is streamed: tokens then holds only the current chunk
+    // (declared after backend, so the cursor is closed first)
+    std::shared_ptr<oceanbase::jni::SegmenterBackend> backend;
+    std::unique_ptr<oceanbase::jni::SegmenterCursor> cursor;
+    
+    // Distinct tokens with their frequencies, used when aggregate is set
+    oceanbase::jni::TokenFrequencyTable frequencies;
+    bool aggregate;
+    
+    // Arena holding this state and its token storage
+    oceanbase::jni::ScanArena* arena;
+    
+    ThaiParserState() : aggregate(false), arena(nullptr) {}
+    
+    // Create the state in the calling thread's scan arena
+    static ThaiParserState* create() {
+        oceanbase::jni::ScanArena& scan_arena = oceanbase::jni::ScanArena::current();
+        scan_arena.begin_scan();
+        ThaiParserState* state = scan_arena.create<ThaiParserState>();
+        if (!state) {
+            scan_arena.end_scan();
+            return nullptr;
+        }
+        state->arena = &scan_arena;
+        state->tokens.set_arena(&scan_arena);
+        state->frequencies.set_arena(&scan_arena);
+        return state;
+    }
+    
+    // Make the tokens (or the current chunk) readable, aggregating them if enabled
+    int publish_tokens() {
+        if (aggregate && frequencies.build(tokens) != 0) {
+            return OBP_ALLOCATE_MEMORY_FAILED;
+        }
+        return OBP_SUCCESS;
+    }
+    
+    // Read the next word, from the frequency table when aggregating
+    bool next_word(const char*& word, int64_t& word_len, int64_t& char_cnt, int64_t& word_freq) {
+        if (aggregate) {
+            return frequencies.next(word, word_len, char_cnt, word_freq);
+        }
+        word_freq = 1;
+        return tokens.next(word, word_len, char_cnt);
+    }
     
-    ThaiParserState() : current_token_index(0) {}
+    // Destroy the state and finish its scan, the arena is reused by the next scan
+    static void destroy(ThaiParserState* state) {
+        oceanbase::jni::ScanArena* scan_arena = state->arena;
+        state->~ThaiParserState();
+        scan_arena->end_scan();
+    }
 };
 
 } // namespace thai_ftparser
@@ -230,7 +1225,10 @@ int thai_ftparser_init(ObPluginParamPtr param) {
     }
     
     // Don't initialize JVM here - do it lazily on first use (scan_begin)
-    // This avoids issues with classpath when Observer is starting up
+    // This avoids issues with classpath when Observer is starting up.
+    // With OCEANBASE_JNI_WARMUP it starts now on a background thread, and
+    // the first scans wait for it
+    oceanbase::thai_ftparser::ThaiJNIBridgeManager::get_instance().start_warmup();
     return OBP_SUCCESS;
 }
 
@@ -239,6 +1237,15 @@ int thai_ftparser_deinit(ObPluginParamPtr param) {
         return OBP_INVALID_ARGUMENT;
     }
     
+    oceanbase::thai_ftparser::ThaiJNIBridgeManager::get_instance().stop_warmup();
+    
+    oceanbase::jni::SegmentCacheStats cache_stats = oceanbase::jni::SegmentCache::instance().stats();
+    JNI_LOG_INFO("Segment cache: %llu hits, %llu misses, %llu insertions, %llu rejections, %llu evictions, %llu entries in %llu bytes",
+                 static_cast<unsigned long long>(cache_stats.hits), static_cast<unsigned long long>(cache_stats.misses),
+                 static_cast<unsigned long long>(cache_stats.insertions), static_cast<unsigned long long>(cache_stats.rejections),
+                 static_cast<unsigned long long>(cache_stats.evictions), static_cast<unsigned long long>(cache_stats.entries),
+                 static_cast<unsigned long long>(cache_stats.bytes));
+    
     return OBP_SUCCESS;
 }
 
@@ -254,8 +1261,8 @@ int thai_ftparser_scan_begin(ObPluginFTParserParamPtr param) {
         return ret;
     }
     
-    // Create parser instance
-    oceanbase::thai_ftparser::ThaiParserState* tp = new (std::nothrow) oceanbase::thai_ftparser::ThaiParserState();
+    // Create parser instance in this thread's scan arena
+    oceanbase::thai_ftparser::ThaiParserState* tp = oceanbase::thai_ftparser::ThaiParserState::create();
     if (!tp) {
         return OBP_ALLOCATE_MEMORY_FAILED;
     }
@@ -265,22 +1272,37 @@ int thai_ftparser_scan_begin(ObPluginFTParserParamPtr param) {
     int64_t fulltext_len = obp_ftparser_fulltext_length(param);
     
     if (!fulltext || fulltext_len <= 0) {
-        delete tp;
+        oceanbase::thai_ftparser::ThaiParserState::destroy(tp);
         return OBP_INVALID_ARGUMENT;
     }
     
-    std::string text(fulltext, fulltext_len);
-    
-    // Perform segmentation
-    auto bridge = manager.get_bridge();
-    if (!bridge) {
-        delete tp;
+    // Segment with the configured backend (no copy of the document)
+    auto backend = manager.get_backend();
+    if (!backend) {
+        oceanbase::thai_ftparser::ThaiParserState::destroy(tp);
         return OBP_PLUGIN_ERROR;
     }
     
-    ret = bridge->segment(text, tp->tokens);
+    // Validate the whole document once, before any of it is segmented
+    ret = backend->check_document(fulltext, static_cast<size_t>(fulltext_len));
+    if (ret != OBP_SUCCESS) {
+        oceanbase::thai_ftparser::ThaiParserState::destroy(tp);
+        return ret;
+    }
+    
+    tp->aggregate = oceanbase::jni::JNIConfigUtils::get_config().aggregate_tokens;
+    if (backend->should_stream(static_cast<size_t>(fulltext_len))) {
+        // Large document: tokens are pulled from a cursor chunk by chunk
+        tp->backend = backend;
+        ret = backend->open_cursor(fulltext, static_cast<size_t>(fulltext_len), tp->cursor);
+    } else {
+        ret = backend->segment(fulltext, static_cast<size_t>(fulltext_len), tp->tokens);
+    }
+    if (ret == OBP_SUCCESS) {
+        ret = tp->publish_tokens();
+    }
     if (ret != OBP_SUCCESS) {
-        delete tp;
+        oceanbase::thai_ftparser::ThaiParserState::destroy(tp);
         return ret;
     }
     
@@ -297,7 +1319,7 @@ int thai_ftparser_scan_end(ObPluginFTParserParamPtr param) {
     
     oceanbase::thai_ftparser::ThaiParserState* tp = (oceanbase::thai_ftparser::ThaiParserState*)obp_ftparser_user_data(param);
     if (tp) {
-        delete tp;
+        oceanbase::thai_ftparser::ThaiParserState::destroy(tp);
         obp_ftparser_set_user_data(param, nullptr);
     }
     
@@ -314,43 +1336,33 @@ int thai_ftparser_next_token(ObPluginFTParserParamPtr param, char **word, int64_
         return OBP_PLUGIN_ERROR;
     }
     
-    if (tp->current_token_index >= tp->tokens.size()) {
-        return OBP_ITER_END;
-    }
-    
-    const std::string& token = tp->tokens[tp->current_token_index++];
-    
-    // Set word properties
-    *word = const_cast<char*>(token.c_str());
-    *word_len = token.length();
-    
-    // Calculate character count (UTF-8 character count, not byte count)
-    // Use the same algorithm as the original plugin
-    int64_t char_count = 0;
-    const char* p = token.c_str();
-    const char* end = p + token.length();
-    
-    while (p < end) {
-        unsigned char c = *p;
-        
-        if ((c & 0x80) == 0) {
-            p += 1;  // ASCII character
-        } else if ((c & 0xE0) == 0xC0) {
-            p += 2;  // 2-byte UTF-8 character
-        } else if ((c & 0xF0) == 0xE0) {
-            p += 3;  // 3-byte UTF-8 character (most CJK characters)
-        } else if ((c & 0xF8) == 0xF0) {
-            p += 4;  // 4-byte UTF-8 character
-        } else {
-            p += 1;  // Invalid UTF-8, skip
-            continue;  // Don't count invalid characters
+    const char* token = nullptr;
+    int64_t token_len = 0;
+    int64_t token_chars = 0;
+    int64_t token_freq = 1;
+    while (!tp->next_word(token, token_len, token_chars, token_freq)) {
+        // Streaming: refill from the cursor (words were already copied by the
+        // caller, so the previous chunk can be overwritten); an empty chunk ends it
+        if (!tp->cursor) {
+            return OBP_ITER_END;
+        }
+        int ret = tp->cursor->next_chunk(tp->tokens);
+        if (ret == OBP_SUCCESS) {
+            ret = tp->publish_tokens();
+        }
+        if (ret != OBP_SUCCESS) {
+            return ret;
+        }
+        if (tp->tokens.size() == 0) {
+            return OBP_ITER_END;
         }
-        
-        char_count++;
     }
     
-    *char_cnt = char_count;  // Set character count
-    *word_freq = 1;          // Set word frequency to 1
+    // Set word properties (character count was computed by the segmenter)
+    *word = const_cast<char*>(token);
+    *word_len = token_len;
+    *char_cnt = token_chars;
+    *word_freq = token_freq; // 1, or the number of occurrences when aggregating
     
     return OBP_SUCCESS;
 }
@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Thai Fulltext Parser Plugin - Native Segmenter Backend
+ */
+
+#include "thai_native_segmenter.h"
+#include "jni_log.h"
+#include "oceanbase/ob_plugin_ftparser.h"
+#include <cstdlib>
+#include <new>
+
+using namespace oceanbase::jni;
+
+namespace oceanbase {
+namespace thai_ftparser {
+
+static std::string get_env_string(const char* name) {
+    const char* value = std::getenv(name);
+    return value ? std::string(value) : std::string();
+}
+
+ThaiNativeSegmenterConfig::ThaiNativeSegmenterConfig()
+    : dictionary_path(get_env_string("OCEANBASE_THAI_DICT_PATH"))
+    , stopwords_path(get_env_string("OCEANBASE_THAI_STOPWORDS_PATH")) {
+}
+
+ThaiNativeSegmenter::ThaiNativeSegmenter()
+    : breaker_(dictionary_)
+    , is_initialized_(false) {
+}
+
+int ThaiNativeSegmenter::initialize() {
+    std::lock_guard<std::mutex> lock(init_mutex_);
+
+    if (is_initialized_) {
+        return OBP_SUCCESS;
+    }
+
+    if (config_.dictionary_path.empty()) {
+        JNI_LOG_ERROR("[ThaiNativeSegmenter] OCEANBASE_THAI_DICT_PATH is not set, the native backend needs a word list");
+        return OBP_PLUGIN_ERROR;
+    }
+
+    try {
+        int64_t words = dictionary_.add_file(config_.dictionary_path, ThaiDictionary::WORD);
+        if (words <= 0) {
+            JNI_LOG_ERROR("[ThaiNativeSegmenter] No Thai words loaded from %s", config_.dictionary_path.c_str());
+            dictionary_.build();
+            return OBP_PLUGIN_ERROR;
+        }
+
+        int64_t stopwords = 0;
+        if (!config_.stopwords_path.empty()) {
+            stopwords = dictionary_.add_file(config_.stopwords_path, ThaiDictionary::STOP_WORD);
+            if (stopwords < 0) {
+                JNI_LOG_ERROR("[ThaiNativeSegmenter] Failed to read stopwords from %s", config_.stopwords_path.c_str());
+                dictionary_.build();
+                return OBP_PLUGIN_ERROR;
+            }
+        }
+
+        dictionary_.build();
+        JNI_LOG_INFO("[ThaiNativeSegmenter] Loaded %lld words and %lld stopwords (%zu trie nodes, %zu bytes)",
+                     static_cast<long long>(words), static_cast<long long>(stopwords),
+                     dictionary_.node_count(), dictionary_.memory_bytes());
+    } catch (const std::bad_alloc&) {
+        JNI_LOG_ERROR("[ThaiNativeSegmenter] Failed to allocate the Thai dictionary");
+        return OBP_ALLOCATE_MEMORY_FAILED;
+    }
+
+    is_initialized_ = true;
+    return OBP_SUCCESS;
+}
+
+int ThaiNativeSegmenter::segment(const char* text, size_t length, PackedTokenBuffer& tokens) {
+    tokens.clear();
+    if (!text || length == 0) {
+        return OBP_SUCCESS;
+    }
+
+    try {
+        if (breaker_.segment(text, length, tokens) != 0) {
+            return OBP_ALLOCATE_MEMORY_FAILED;
+        }
+    } catch (const std::bad_alloc&) {
+        return OBP_ALLOCATE_MEMORY_FAILED;
+    }
+    return OBP_SUCCESS;
+}
+
+} // namespace thai_ftparser
+} // namespace oceanbase
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Thai Fulltext Parser Plugin - Native Segmenter Backend
+ */
+
+#pragma once
+
+#include "segmenter_backend.h"
+#include "thai_word_breaker.h"
+#include <mutex>
+#include <string>
+
+namespace oceanbase {
+namespace thai_ftparser {
+
+/**
+ * Thai Native Segmenter Configuration
+ */
+struct ThaiNativeSegmenterConfig {
+    // Word list, one UTF-8 word per line (OCEANBASE_THAI_DICT_PATH, required)
+    std::string dictionary_path;
+    // Stopword list in the same format (OCEANBASE_THAI_STOPWORDS_PATH, optional)
+    std::string stopwords_path;
+
+    ThaiNativeSegmenterConfig();
+};
+
+/**
+ * Thai Native Segmenter
+ * @brief The "native" backend of thai_ftparser: ThaiWordBreaker without a JVM
+ * @details Selected with OCEANBASE_THAI_FTPARSER_BACKEND=native. The
+ * dictionary is loaded by the first scan and shared by all threads; no JVM
+ * is created and no JNI call is made.
+ */
+class ThaiNativeSegmenter : public oceanbase::jni::SegmenterBackend {
+public:
+    ThaiNativeSegmenter();
+
+    /**
+     * Backend name used in OCEANBASE_THAI_FTPARSER_BACKEND
+     */
+    const char* name() const override { return "native"; }
+
+    /**
+     * Load the dictionary and stopwords (once)
+     * @return OBP_SUCCESS on success, OBP_PLUGIN_ERROR if the dictionary cannot be loaded
+     */
+    int initialize() override;
+
+    /**
+     * Segment a UTF-8 document into packed tokens
+     * @return OBP_SUCCESS on success, error code on failure
+     */
+    int segment(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) override;
+
+private:
+    ThaiNativeSegmenterConfig config_;
+    ThaiDictionary dictionary_;
+    ThaiWordBreaker breaker_;
+    bool is_initialized_;
+    std::mutex init_mutex_;
+
+    // Disable copy
+    ThaiNativeSegmenter(const ThaiNativeSegmenter&) = delete;
+    ThaiNativeSegmenter& operator=(const ThaiNativeSegmenter&) = delete;
+};
+
+} // namespace thai_ftparser
+} // namespace oceanbase
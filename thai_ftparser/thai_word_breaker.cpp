@@ -0,0 +1,518 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Thai Fulltext Parser Plugin - Native Thai Word Breaker
+ */
+
+#include "thai_word_breaker.h"
+#include <fstream>
+#include <limits>
+
+using namespace oceanbase::jni;
+
+namespace oceanbase {
+namespace thai_ftparser {
+
+namespace {
+
+const uint32_t INVALID_CODE_POINT = 0xFFFFFFFFu;
+
+enum CharClass {
+    CHAR_OTHER = 0,   // Whitespace, punctuation, symbols, invalid bytes
+    CHAR_THAI,        // Thai letters, vowels and tone marks
+    CHAR_LETTER,      // Letters of other scripts
+    CHAR_DIGIT        // Decimal digits of any script
+};
+
+// Decode the code point at pos, returning the position after it (invalid bytes decode one at a time)
+size_t decode_utf8(const char* text, size_t length, size_t pos, uint32_t& code_point) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text) + pos;
+    size_t remaining = length - pos;
+    unsigned char lead = p[0];
+    code_point = INVALID_CODE_POINT;
+    if (lead < 0x80) {
+        code_point = lead;
+        return pos + 1;
+    }
+    size_t needed;
+    uint32_t value;
+    uint32_t minimum;
+    if ((lead & 0xE0) == 0xC0) {
+        needed = 2; value = lead & 0x1F; minimum = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+        needed = 3; value = lead & 0x0F; minimum = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+        needed = 4; value = lead & 0x07; minimum = 0x10000;
+    } else {
+        return pos + 1;
+    }
+    if (remaining < needed) {
+        return pos + 1;
+    }
+    for (size_t i = 1; i < needed; ++i) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return pos + 1;
+        }
+        value = (value << 6) | (p[i] & 0x3F);
+    }
+    if (value < minimum || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF)) {
+        return pos + 1;
+    }
+    code_point = value;
+    return pos + needed;
+}
+
+void append_utf8(std::string& out, uint32_t code_point) {
+    if (code_point < 0x80) {
+        out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+// Zero of the decimal digit block holding code_point, or 0 if it is not a digit
+uint32_t digit_zero(uint32_t code_point) {
+    static const uint32_t ZEROS[] = {
+        0x0030, 0x0660, 0x06F0, 0x0966, 0x09E6, 0x0A66, 0x0AE6, 0x0B66,
+        0x0BE6, 0x0C66, 0x0CE6, 0x0D66, 0x0E50, 0x0ED0, 0x0F20, 0x1040, 0xFF10
+    };
+    for (size_t i = 0; i < sizeof(ZEROS) / sizeof(ZEROS[0]); ++i) {
+        if (code_point >= ZEROS[i] && code_point <= ZEROS[i] + 9) {
+            return ZEROS[i];
+        }
+    }
+    return 0;
+}
+
+// Punctuation, symbols and spaces outside ASCII (everything else counts as a letter)
+bool is_separator(uint32_t code_point) {
+    if (code_point <= 0xBF) {
+        return code_point != 0xAA && code_point != 0xB5 && code_point != 0xBA;
+    }
+    return code_point == 0xD7 || code_point == 0xF7
+        || (code_point >= 0x2000 && code_point <= 0x2BFF)    // General punctuation .. misc symbols
+        || (code_point >= 0x3000 && code_point <= 0x303F)    // CJK symbols and punctuation
+        || (code_point >= 0xFE10 && code_point <= 0xFE6F)    // Vertical, compatibility and small forms
+        || (code_point >= 0xFF00 && code_point <= 0xFF0F)    // Fullwidth punctuation
+        || (code_point >= 0xFF1A && code_point <= 0xFF20)
+        || (code_point >= 0xFF3B && code_point <= 0xFF40)
+        || (code_point >= 0xFF5B && code_point <= 0xFF65)
+        || (code_point >= 0xFFF0 && code_point <= 0xFFFF)    // Specials
+        || (code_point >= 0x1F000 && code_point <= 0x1FAFF); // Emoji and pictographs
+}
+
+CharClass classify(uint32_t code_point) {
+    if (code_point == INVALID_CODE_POINT) {
+        return CHAR_OTHER;
+    }
+    if (code_point < 0x80) {
+        if (code_point >= '0' && code_point <= '9') {
+            return CHAR_DIGIT;
+        }
+        if ((code_point | 0x20) >= 'a' && (code_point | 0x20) <= 'z') {
+            return CHAR_LETTER;
+        }
+        return CHAR_OTHER;
+    }
+    if (ThaiDictionary::is_thai_letter(code_point)) {
+        return CHAR_THAI;
+    }
+    if (digit_zero(code_point) != 0) {
+        return CHAR_DIGIT;
+    }
+    if ((code_point >= 0x0E00 && code_point <= 0x0E7F) || is_separator(code_point)) {
+        return CHAR_OTHER;
+    }
+    return CHAR_LETTER;
+}
+
+// LowerCaseFilter + DecimalDigitFilter for one code point
+uint32_t fold(uint32_t code_point) {
+    uint32_t zero = digit_zero(code_point);
+    if (zero != 0) {
+        return '0' + (code_point - zero);
+    }
+    if ((code_point >= 'A' && code_point <= 'Z')
+        || (code_point >= 0xC0 && code_point <= 0xDE && code_point != 0xD7)     // Latin-1
+        || (code_point >= 0x0391 && code_point <= 0x03A9 && code_point != 0x03A2)  // Greek
+        || (code_point >= 0x0410 && code_point <= 0x042F)) {                    // Cyrillic
+        return code_point + 0x20;
+    }
+    if (code_point >= 0x0400 && code_point <= 0x040F) {
+        return code_point + 0x50;
+    }
+    return code_point;
+}
+
+// Apostrophes keep "don't" together, decimal and group separators keep "3.14" and "1,000"
+bool is_joiner(uint32_t code_point, CharClass before) {
+    if (before == CHAR_LETTER) {
+        return code_point == '\'' || code_point == 0x2019;
+    }
+    return before == CHAR_DIGIT && (code_point == '.' || code_point == ',');
+}
+
+// Thai character clusters: marks that never start a cluster, vowels that never end one
+bool is_thai_combining(uint32_t code_point) {
+    return code_point == 0x0E31 || (code_point >= 0x0E34 && code_point <= 0x0E3A)
+        || (code_point >= 0x0E47 && code_point <= 0x0E4E);
+}
+
+bool is_thai_following_vowel(uint32_t code_point) {
+    return code_point == 0x0E30 || code_point == 0x0E32 || code_point == 0x0E33 || code_point == 0x0E45;
+}
+
+bool is_thai_leading_vowel(uint32_t code_point) {
+    return code_point >= 0x0E40 && code_point <= 0x0E44;
+}
+
+const uint32_t MAI_YAMOK = 0x0E46;  // Repetition mark, always a token of its own
+
+// Can a word boundary fall between code_points[index - 1] and code_points[index]
+bool is_cluster_boundary(const uint32_t* code_points, size_t index, size_t count) {
+    if (index == 0 || index == count) {
+        return true;
+    }
+    uint32_t current = code_points[index];
+    uint32_t previous = code_points[index - 1];
+    if (current == MAI_YAMOK || previous == MAI_YAMOK) {
+        return true;
+    }
+    return !is_thai_combining(current) && !is_thai_following_vowel(current) && !is_thai_leading_vowel(previous);
+}
+
+// Per-thread scratch space, reused across documents
+struct BreakerScratch {
+    std::vector<uint32_t> code_points;
+    std::vector<size_t> offsets;
+    std::vector<uint8_t> boundary;
+    std::vector<uint32_t> unknown_cost;
+    std::vector<uint32_t> word_cost;
+    std::vector<uint32_t> from;
+    std::vector<uint8_t> known;
+    std::vector<uint32_t> path;
+    std::string token;
+};
+
+BreakerScratch& scratch() {
+    static thread_local BreakerScratch instance;
+    return instance;
+}
+
+} // namespace
+
+// ThaiDictionary implementation
+ThaiDictionary::ThaiDictionary() : word_count_(0) {
+    build();
+}
+
+bool ThaiDictionary::add(const char* word, size_t length, uint8_t flags) {
+    std::vector<uint8_t> labels;
+    size_t pos = 0;
+    while (pos < length) {
+        uint32_t code_point;
+        pos = decode_utf8(word, length, pos, code_point);
+        if (!is_thai_letter(code_point)) {
+            return false;
+        }
+        labels.push_back(static_cast<uint8_t>(code_point - 0x0E00));
+    }
+    if (labels.empty()) {
+        return false;
+    }
+    staged_[labels] |= flags;
+    return true;
+}
+
+int64_t ThaiDictionary::add_file(const std::string& path, uint8_t flags) {
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+    if (!in) {
+        return -1;
+    }
+
+    int64_t added = 0;
+    std::string line;
+    bool first_line = true;
+    while (std::getline(in, line)) {
+        size_t begin = 0;
+        size_t end = line.size();
+        // Skip a UTF-8 byte order mark
+        if (first_line && line.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+            begin = 3;
+        }
+        first_line = false;
+        while (begin < end && (line[begin] == ' ' || line[begin] == '\t')) {
+            ++begin;
+        }
+        while (end > begin && (line[end - 1] == ' ' || line[end - 1] == '\t' || line[end - 1] == '\r')) {
+            --end;
+        }
+        if (begin == end || line[begin] == '#') {
+            continue;
+        }
+        if (add(line.data() + begin, end - begin, flags)) {
+            ++added;
+        }
+    }
+    return added;
+}
+
+void ThaiDictionary::build() {
+    first_edge_.clear();
+    edge_count_.clear();
+    node_flags_.clear();
+    edge_labels_.clear();
+    edge_targets_.clear();
+
+    first_edge_.push_back(0);
+    edge_count_.push_back(0);
+    node_flags_.push_back(0);
+    build_node(root(), staged_.begin(), staged_.end(), 0);
+
+    word_count_ = staged_.size();
+    staged_.clear();
+}
+
+void ThaiDictionary::build_node(uint32_t node, StagedIterator begin, StagedIterator end, size_t depth) {
+    // A word equal to the node's prefix sorts first
+    if (begin != end && begin->first.size() == depth) {
+        node_flags_[node] |= begin->second;
+        ++begin;
+    }
+    if (begin == end) {
+        return;
+    }
+
+    // Children share the label at depth and are contiguous in sorted order
+    std::vector<StagedIterator> groups;
+    for (StagedIterator it = begin; it != end; ++it) {
+        if (groups.empty() || groups.back()->first[depth] != it->first[depth]) {
+            groups.push_back(it);
+        }
+    }
+
+    uint32_t first = static_cast<uint32_t>(edge_labels_.size());
+    first_edge_[node] = first;
+    edge_count_[node] = static_cast<uint8_t>(groups.size());
+    for (size_t i = 0; i < groups.size(); ++i) {
+        edge_labels_.push_back(groups[i]->first[depth]);
+        edge_targets_.push_back(static_cast<uint32_t>(node_flags_.size()));
+        first_edge_.push_back(0);
+        edge_count_.push_back(0);
+        node_flags_.push_back(0);
+    }
+    for (size_t i = 0; i < groups.size(); ++i) {
+        StagedIterator group_end = (i + 1 < groups.size()) ? groups[i + 1] : end;
+        build_node(edge_targets_[first + i], groups[i], group_end, depth + 1);
+    }
+}
+
+uint32_t ThaiDictionary::child(uint32_t node, uint32_t code_point) const {
+    if (code_point < 0x0E01 || code_point > 0x0E4E) {
+        return NO_NODE;
+    }
+    uint8_t label = static_cast<uint8_t>(code_point - 0x0E00);
+    uint32_t edge = first_edge_[node];
+    uint32_t edge_end = edge + edge_count_[node];
+    for (; edge < edge_end; ++edge) {
+        if (edge_labels_[edge] >= label) {
+            return edge_labels_[edge] == label ? edge_targets_[edge] : NO_NODE;
+        }
+    }
+    return NO_NODE;
+}
+
+uint8_t ThaiDictionary::lookup(const uint32_t* code_points, size_t count) const {
+    uint32_t node = root();
+    for (size_t i = 0; i < count; ++i) {
+        node = child(node, code_points[i]);
+        if (node == NO_NODE) {
+            return 0;
+        }
+    }
+    return node_flags_[node];
+}
+
+size_t ThaiDictionary::memory_bytes() const {
+    return node_flags_.size() * (sizeof(uint32_t) + 2 * sizeof(uint8_t))
+         + edge_labels_.size() * (sizeof(uint8_t) + sizeof(uint32_t));
+}
+
+// ThaiWordBreaker implementation
+ThaiWordBreaker::ThaiWordBreaker(const ThaiDictionary& dictionary) : dictionary_(dictionary) {}
+
+int ThaiWordBreaker::segment(const char* text, size_t length, PackedTokenBuffer& tokens) const {
+    BreakerScratch& s = scratch();
+    size_t pos = 0;
+
+    while (pos < length) {
+        uint32_t code_point;
+        size_t next = decode_utf8(text, length, pos, code_point);
+        CharClass cls = classify(code_point);
+
+        if (cls == CHAR_THAI) {
+            // Collect the whole Thai run, then split it by dictionary
+            s.code_points.clear();
+            s.offsets.clear();
+            while (pos < length) {
+                next = decode_utf8(text, length, pos, code_point);
+                if (classify(code_point) != CHAR_THAI) {
+                    break;
+                }
+                s.code_points.push_back(code_point);
+                s.offsets.push_back(pos);
+                pos = next;
+            }
+            s.offsets.push_back(pos);
+            if (segment_thai_run(text, s.code_points.data(), s.offsets.data(), s.code_points.size(), tokens) != 0) {
+                return -1;
+            }
+        } else if (cls == CHAR_LETTER || cls == CHAR_DIGIT) {
+            // Letters and digits of other scripts, folded while they are copied
+            s.token.clear();
+            int64_t char_count = 1;
+            append_utf8(s.token, fold(code_point));
+            pos = next;
+            while (pos < length) {
+                next = decode_utf8(text, length, pos, code_point);
+                CharClass current = classify(code_point);
+                if (current == CHAR_LETTER || current == CHAR_DIGIT) {
+                    append_utf8(s.token, fold(code_point));
+                    ++char_count;
+                    cls = current;
+                    pos = next;
+                    continue;
+                }
+                uint32_t after = INVALID_CODE_POINT;
+                size_t after_next = next < length ? decode_utf8(text, length, next, after) : next;
+                if (!is_joiner(code_point, cls) || classify(after) != cls) {
+                    break;
+                }
+                append_utf8(s.token, code_point);
+                append_utf8(s.token, fold(after));
+                char_count += 2;
+                pos = after_next;
+            }
+            if (tokens.append(s.token.data(), s.token.size(), char_count) != 0) {
+                return -1;
+            }
+        } else {
+            pos = next;
+        }
+    }
+    return 0;
+}
+
+int ThaiWordBreaker::segment_thai_run(const char* text, const uint32_t* code_points, const size_t* offsets,
+                                      size_t count, PackedTokenBuffer& tokens) const {
+    BreakerScratch& s = scratch();
+    const uint32_t UNREACHED = std::numeric_limits<uint32_t>::max();
+
+    s.boundary.resize(count + 1);
+    s.unknown_cost.assign(count + 1, UNREACHED);
+    s.word_cost.assign(count + 1, UNREACHED);
+    s.from.resize(count + 1);
+    s.known.resize(count + 1);
+    for (size_t i = 0; i <= count; ++i) {
+        s.boundary[i] = is_cluster_boundary(code_points, i, count) ? 1 : 0;
+    }
+    s.unknown_cost[0] = 0;
+    s.word_cost[0] = 0;
+
+    // Keep the cheaper way to reach end; on a tie the later start (longer leading words) wins
+    struct Relax {
+        static void apply(BreakerScratch& s, size_t end, uint32_t unknown, uint32_t words, size_t start, bool known) {
+            if (unknown < s.unknown_cost[end] || (unknown == s.unknown_cost[end] && words <= s.word_cost[end])) {
+                s.unknown_cost[end] = unknown;
+                s.word_cost[end] = words;
+                s.from[end] = static_cast<uint32_t>(start);
+                s.known[end] = known ? 1 : 0;
+            }
+        }
+    };
+
+    for (size_t start = 0; start < count; ++start) {
+        if (!s.boundary[start] || s.unknown_cost[start] == UNREACHED) {
+            continue;
+        }
+        uint32_t unknown = s.unknown_cost[start];
+        uint32_t words = s.word_cost[start] + 1;
+
+        // Every dictionary word starting here that ends on a cluster boundary
+        uint32_t node = dictionary_.root();
+        for (size_t end = start; end < count; ++end) {
+            node = dictionary_.child(node, code_points[end]);
+            if (node == ThaiDictionary::NO_NODE) {
+                break;
+            }
+            if ((dictionary_.flags(node) & ThaiDictionary::WORD) && s.boundary[end + 1]) {
+                Relax::apply(s, end + 1, unknown, words, start, true);
+            }
+        }
+
+        // Or skip one cluster as unknown text
+        size_t cluster_end = start + 1;
+        while (!s.boundary[cluster_end]) {
+            ++cluster_end;
+        }
+        bool mai_yamok = code_points[start] == MAI_YAMOK;
+        Relax::apply(s, cluster_end, unknown + (mai_yamok ? 0 : static_cast<uint32_t>(cluster_end - start)),
+                     words, start, mai_yamok);
+    }
+
+    // Walk back from the end, then emit front to back merging consecutive unknown clusters
+    s.path.clear();
+    for (size_t end = count; end > 0; end = s.from[end]) {
+        s.path.push_back(static_cast<uint32_t>(end));
+    }
+    size_t token_begin = 0;
+    bool pending_unknown = false;
+    while (!s.path.empty()) {
+        size_t end = s.path.back();
+        s.path.pop_back();
+        if (s.known[end]) {
+            if (pending_unknown) {
+                size_t unknown_end = s.from[end];
+                if (append_thai_token(text, code_points, offsets, token_begin, unknown_end, tokens) != 0) {
+                    return -1;
+                }
+                token_begin = unknown_end;
+                pending_unknown = false;
+            }
+            if (append_thai_token(text, code_points, offsets, token_begin, end, tokens) != 0) {
+                return -1;
+            }
+            token_begin = end;
+        } else {
+            pending_unknown = true;
+        }
+    }
+    if (pending_unknown) {
+        return append_thai_token(text, code_points, offsets, token_begin, count, tokens);
+    }
+    return 0;
+}
+
+int ThaiWordBreaker::append_thai_token(const char* text, const uint32_t* code_points, const size_t* offsets,
+                                       size_t begin, size_t end, PackedTokenBuffer& tokens) const {
+    // Lucene drops tokens that do not start with a letter (a stray mark at the start of a run)
+    if (is_thai_combining(code_points[begin])) {
+        return 0;
+    }
+    if (dictionary_.lookup(code_points + begin, end - begin) & ThaiDictionary::STOP_WORD) {
+        return 0;
+    }
+    return tokens.append(text + offsets[begin], offsets[end] - offsets[begin], static_cast<int64_t>(end - begin));
+}
+
+} // namespace thai_ftparser
+} // namespace oceanbase
@@ -0,0 +1,167 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * Thai Fulltext Parser Plugin - Native Thai Word Breaker
+ */
+
+#pragma once
+
+#include "packed_token_buffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace oceanbase {
+namespace thai_ftparser {
+
+/**
+ * Thai Dictionary
+ * @brief Thai words and stopwords in one compact trie
+ * @details Words are staged with add()/add_file() and frozen by build().
+ * Every Thai character (U+0E01..U+0E4E) is stored as a one-byte label, the
+ * children of a node are contiguous and sorted, so a node costs 6 bytes and
+ * an edge 5 bytes. Only Thai words are kept: other scripts are broken by
+ * character class, not by dictionary.
+ */
+class ThaiDictionary {
+public:
+    // Node flags
+    static const uint8_t WORD = 1;       // Segmentation dictionary entry
+    static const uint8_t STOP_WORD = 2;  // Dropped from the output
+
+    static const uint32_t NO_NODE = 0xFFFFFFFFu;
+
+    ThaiDictionary();
+
+    /**
+     * Stage one UTF-8 word
+     * @return false if the word is empty or not entirely Thai (then it is ignored)
+     */
+    bool add(const char* word, size_t length, uint8_t flags);
+
+    /**
+     * Stage the words of a UTF-8 file, one per line; blank lines and lines starting with '#' are skipped
+     * @return Number of words staged, or -1 if the file cannot be read
+     */
+    int64_t add_file(const std::string& path, uint8_t flags);
+
+    /**
+     * Freeze the staged words into the trie, replacing any previous content
+     */
+    void build();
+
+    /**
+     * Root node of the trie
+     */
+    uint32_t root() const { return 0; }
+
+    /**
+     * Follow the edge labelled with a code point
+     * @return The child node, or NO_NODE
+     */
+    uint32_t child(uint32_t node, uint32_t code_point) const;
+
+    /**
+     * Flags of the word ending at a node (0 if none ends there)
+     */
+    uint8_t flags(uint32_t node) const { return node_flags_[node]; }
+
+    /**
+     * Flags of a whole word given as code points (0 if it is not in the trie)
+     */
+    uint8_t lookup(const uint32_t* code_points, size_t count) const;
+
+    /**
+     * Number of distinct words
+     */
+    size_t word_count() const { return word_count_; }
+
+    /**
+     * Number of trie nodes
+     */
+    size_t node_count() const { return node_flags_.size(); }
+
+    /**
+     * Approximate memory held by the trie in bytes
+     */
+    size_t memory_bytes() const;
+
+    /**
+     * Check whether a code point can be part of a dictionary word
+     */
+    static bool is_thai_letter(uint32_t code_point) {
+        return code_point >= 0x0E01 && code_point <= 0x0E4E && code_point != 0x0E2F && code_point != 0x0E3F;
+    }
+
+private:
+    // Staged words (labels) with their merged flags, sorted for build()
+    std::map<std::vector<uint8_t>, uint8_t> staged_;
+
+    // Trie: node i owns edges [first_edge_[i], first_edge_[i] + edge_count_[i])
+    std::vector<uint32_t> first_edge_;
+    std::vector<uint8_t> edge_count_;
+    std::vector<uint8_t> node_flags_;
+    std::vector<uint8_t> edge_labels_;
+    std::vector<uint32_t> edge_targets_;
+    size_t word_count_;
+
+    typedef std::map<std::vector<uint8_t>, uint8_t>::const_iterator StagedIterator;
+
+    /**
+     * Fill node with the words in [begin, end), which all share depth labels
+     */
+    void build_node(uint32_t node, StagedIterator begin, StagedIterator end, size_t depth);
+};
+
+/**
+ * Thai Word Breaker
+ * @brief Native replacement for Lucene's ThaiAnalyzer
+ * @details Follows the same chain: word breaking, lower-casing, decimal
+ * digits folded to ASCII, stopword removal.
+ * - Thai runs are split by maximal matching: the segmentation with the
+ *   fewest characters outside the dictionary, then the fewest words, ties
+ *   going to the longer leading word. Boundaries are only placed between
+ *   Thai character clusters (no break before a tone mark, upper/lower vowel
+ *   or following vowel, nor after a leading vowel), and consecutive unknown
+ *   clusters form one token.
+ * - Other letters and digits form words the way the JDK word iterator
+ *   does: "abc123", "don't", "3.14" and "1,000" stay whole.
+ * - Tokens not starting with a letter or digit are dropped.
+ * segment() is const and keeps its scratch space per thread, so one
+ * breaker serves all threads.
+ */
+class ThaiWordBreaker {
+public:
+    /**
+     * @param dictionary Built dictionary, must outlive the breaker
+     */
+    explicit ThaiWordBreaker(const ThaiDictionary& dictionary);
+
+    /**
+     * Segment a UTF-8 document
+     * @param text Input UTF-8 bytes; invalid sequences never join a token
+     * @param length Length of the input in bytes
+     * @param tokens Output buffer, tokens are appended
+     * @return 0 on success, -1 on allocation failure
+     */
+    int segment(const char* text, size_t length, oceanbase::jni::PackedTokenBuffer& tokens) const;
+
+private:
+    const ThaiDictionary& dictionary_;
+
+    /**
+     * Split one Thai run (code points with their byte offsets) and append its tokens
+     */
+    int segment_thai_run(const char* text, const uint32_t* code_points, const size_t* offsets,
+                         size_t count, oceanbase::jni::PackedTokenBuffer& tokens) const;
+
+    /**
+     * Append one Thai token made of code_points[begin, end) unless it is dropped
+     */
+    int append_thai_token(const char* text, const uint32_t* code_points, const size_t* offsets,
+                          size_t begin, size_t end, oceanbase::jni::PackedTokenBuffer& tokens) const;
+};
+
+} // namespace thai_ftparser
+} // namespace oceanbase